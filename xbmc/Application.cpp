@@ -17,6 +17,7 @@
 #include "events/NotificationEvent.h"
 #include "interfaces/builtins/Builtins.h"
 #include "utils/JobManager.h"
+#include "utils/MemoryBudget.h"
 #include "utils/Variant.h"
 #include "LangInfo.h"
 #include "utils/Screenshot.h"
@@ -65,6 +66,7 @@
 #include "filesystem/PluginDirectory.h"
 #include "utils/SystemInfo.h"
 #include "utils/TimeUtils.h"
+#include "utils/Trace.h"
 #include "GUILargeTextureManager.h"
 #include "TextureCache.h"
 #include "playlists/SmartPlayList.h"
@@ -541,6 +543,9 @@ bool CApplication::Create(const CAppParamParser &params)
   if (!m_pSettingsComponent->Load())
     return false;
 
+  // thread policies of advancedsettings.xml are known now, this is the render thread
+  CThread::SetCurrentThreadClass(XbmcThreads::THREAD_CLASS_RENDER);
+
   CLog::Log(LOGINFO, "creating subdirectories");
   const std::shared_ptr<CProfileManager> profileManager = m_pSettingsComponent->GetProfileManager();
   const std::shared_ptr<CSettings> settings = m_pSettingsComponent->GetSettings();
@@ -1513,6 +1518,8 @@ bool CApplication::LoadCustomWindows()
 
 void CApplication::Render()
 {
+  TRACE_SPAN("CApplication::Render");
+
   // do not render if we are stopped or in background
   if (m_bStop)
     return;
@@ -2330,6 +2337,8 @@ void CApplication::UnlockFrameMoveGuard()
 
 void CApplication::FrameMove(bool processEvents, bool processGUI)
 {
+  TRACE_SPAN("CApplication::FrameMove");
+
   if (processEvents)
   {
     // currently we calculate the repeat time (ie time from last similar keypress) just global as fps
@@ -2409,7 +2418,10 @@ void CApplication::FrameMove(bool processEvents, bool processGUI)
     if (!m_bStop)
     {
       if (!m_skipGuiRender)
+      {
+        CServiceBroker::GetGUI()->GetTextureManager().ProcessAsyncLoads();
         CServiceBroker::GetGUI()->GetWindowManager().Process(CTimeUtils::GetFrameTime());
+      }
     }
     CServiceBroker::GetGUI()->GetWindowManager().FrameMove();
   }
@@ -4134,6 +4146,9 @@ void CApplication::ProcessSlow()
 
   CServiceBroker::GetGUI()->GetTextureManager().FreeUnusedTextures(5000);
 
+  // keep the caches within the memory budget
+  CMemoryBudget::GetInstance().Process();
+
 #ifdef HAS_DVD_DRIVE
   // checks whats in the DVD drive and tries to autostart the content (xbox games, dvd, cdda, avi files...)
   if (!m_appPlayer.IsPlayingVideo())
@@ -40,7 +40,7 @@ bool CImageLoader::DoWork()
     return false;
 
   if (m_use_cache)
-    loadPath = CTextureCache::GetInstance().CheckCachedImage(texturePath, needsChecking);
+    loadPath = CTextureCache::GetInstance().CheckCachedImage(texturePath, needsChecking, true);
   else
     loadPath = texturePath;
 
@@ -123,9 +123,52 @@ void CGUILargeTextureManager::CLargeTexture::SetTexture(CBaseTexture* texture)
     m_texture.Set(texture, texture->GetWidth(), texture->GetHeight());
 }
 
-CGUILargeTextureManager::CGUILargeTextureManager() = default;
+size_t CGUILargeTextureManager::CLargeTexture::GetMemoryUsage() const
+{
+  size_t memUsage = 0;
+  for (const CBaseTexture* texture : m_texture.m_textures)
+    memUsage += sizeof(CTexture) + texture->GetTextureWidth() * texture->GetTextureHeight() * 4;
+  return memUsage;
+}
+
+CGUILargeTextureManager::CGUILargeTextureManager()
+{
+  CMemoryBudget::GetInstance().RegisterConsumer(this, "largetextures", MEMORY_PRIORITY_LOW);
+}
 
-CGUILargeTextureManager::~CGUILargeTextureManager() = default;
+CGUILargeTextureManager::~CGUILargeTextureManager()
+{
+  CMemoryBudget::GetInstance().UnregisterConsumer(this);
+}
+
+size_t CGUILargeTextureManager::GetMemoryUsage() const
+{
+  CSingleLock lock(m_listSection);
+  size_t memUsage = 0;
+  for (const CLargeTexture* image : m_allocated)
+    memUsage += image->GetMemoryUsage();
+  return memUsage;
+}
+
+size_t CGUILargeTextureManager::GetTrimmableMemory() const
+{
+  CSingleLock lock(m_listSection);
+  size_t memUsage = 0;
+  for (const CLargeTexture* image : m_allocated)
+  {
+    if (image->IsUnused())
+      memUsage += image->GetMemoryUsage();
+  }
+  return memUsage;
+}
+
+size_t CGUILargeTextureManager::TrimMemory(size_t bytes)
+{
+  CSingleLock lock(m_listSection);
+  size_t freed = GetTrimmableMemory();
+  CleanupUnusedImages(true);
+  return freed;
+}
 
 void CGUILargeTextureManager::CleanupUnusedImages(bool immediately)
 {
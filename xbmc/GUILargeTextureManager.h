@@ -14,6 +14,7 @@
 #include "guilib/TextureManager.h"
 #include "threads/CriticalSection.h"
 #include "utils/Job.h"
+#include "utils/MemoryBudget.h"
 
 /*!
  \ingroup textures,jobs
@@ -48,7 +49,7 @@ public:
 
  \sa IJobCallback, CGUITexture
  */
-class CGUILargeTextureManager : public IJobCallback
+class CGUILargeTextureManager : public IJobCallback, public IMemoryConsumer
 {
 public:
   CGUILargeTextureManager();
@@ -103,6 +104,21 @@ public:
    */
   void CleanupUnusedImages(bool immediately = false);
 
+  /*!
+   \brief Get the memory of the loaded images
+   */
+  size_t GetMemoryUsage() const override;
+
+  /*!
+   \brief Get the memory of the images that are no longer in use
+   */
+  size_t GetTrimmableMemory() const override;
+
+  /*!
+   \brief Unload the images that are no longer in use without waiting for their delay
+   */
+  size_t TrimMemory(size_t bytes) override;
+
 private:
   class CLargeTexture
   {
@@ -117,6 +133,8 @@ private:
 
     const std::string &GetPath() const { return m_path; };
     const CTextureArray &GetTexture() const { return m_texture; };
+    bool IsUnused() const { return m_refCount == 0; };
+    size_t GetMemoryUsage() const;
 
   private:
     static const unsigned int TIME_TO_DELETE = 2000;
@@ -134,6 +152,6 @@ private:
   typedef std::vector<CLargeTexture *>::iterator listIterator;
   typedef std::vector< std::pair<unsigned int, CLargeTexture *> >::iterator queueIterator;
 
-  CCriticalSection m_listSection;
+  mutable CCriticalSection m_listSection;
 };
 
@@ -10,9 +10,47 @@
 #include "URL.h"
 #include "Util.h"
 #include "filesystem/File.h"
+#include "utils/Digest.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 
+using KODI::UTILITY::CDigest;
+
+CInfoScanner::CPathHash::CPathHash(bool legacy /* = false */)
+{
+  if (legacy)
+    m_legacyHash.reset(new CDigest(CDigest::Type::MD5));
+}
+
+CInfoScanner::CPathHash::~CPathHash() = default;
+
+void CInfoScanner::CPathHash::Update(const std::string& data)
+{
+  if (m_legacyHash)
+    m_legacyHash->Update(data);
+  else
+    m_hash.Update(data);
+}
+
+void CInfoScanner::CPathHash::Update(const void* data, std::size_t size)
+{
+  if (m_legacyHash)
+    m_legacyHash->Update(data, size);
+  else
+    m_hash.Update(data, size);
+}
+
+std::string CInfoScanner::CPathHash::Finalize()
+{
+  return m_legacyHash ? m_legacyHash->Finalize() : m_hash.Finalize();
+}
+
+bool CInfoScanner::IsLegacyPathHash(const std::string& hash)
+{
+  // MD5 in hex, XXH64 hashes have 16 characters
+  return hash.size() == 32;
+}
+
 bool CInfoScanner::HasNoMedia(const std::string &strDirectory) const
 {
   std::string noMediaFile = URIUtils::AddFileToFolder(strDirectory, ".nomedia");
@@ -8,12 +8,24 @@
 
 #pragma once
 
+#include "utils/FastHash.h"
+
+#include <cstddef>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
 
 class CGUIDialogProgressBarHandle;
 
+namespace KODI
+{
+namespace UTILITY
+{
+class CDigest;
+}
+}
+
 class CInfoScanner
 {
 public:
@@ -66,6 +78,31 @@ protected:
   //! \brief Protected constructor to only allow subclass instances.
   CInfoScanner() = default;
 
+  /*! \brief Digest for the hashes of scanned paths.
+   Hashes are XXH64, older versions stored MD5. Those are recognised by IsLegacyPathHash()
+   and can be computed with a legacy digest, so unchanged paths don't have to be rescanned.
+   */
+  class CPathHash
+  {
+  public:
+    explicit CPathHash(bool legacy = false);
+    ~CPathHash();
+
+    void Update(const std::string& data);
+    void Update(const void* data, std::size_t size);
+    std::string Finalize();
+
+  private:
+    KODI::UTILITY::CFastHash m_hash;
+    std::unique_ptr<KODI::UTILITY::CDigest> m_legacyHash;
+  };
+
+  /*! \brief Check whether a stored path hash was computed with MD5 by an older version
+   \param hash hash stored in the database
+   \return true if the hash needs a legacy digest to be compared
+   */
+  static bool IsLegacyPathHash(const std::string& hash);
+
   std::set<std::string> m_pathsToScan; //!< Set of paths to scan
   bool m_showDialog = false; //!< Whether or not to show progress bar dialog
   CGUIDialogProgressBarHandle* m_handle = nullptr; //!< Progress bar handle
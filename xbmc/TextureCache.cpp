@@ -10,6 +10,7 @@
 #include "TextureCacheJob.h"
 #include "filesystem/File.h"
 #include "profiles/ProfileManager.h"
+#include "rendering/RenderSystem.h"
 #include "threads/SingleLock.h"
 #include "utils/Crc32.h"
 #include "settings/AdvancedSettings.h"
@@ -99,13 +100,23 @@ bool CTextureCache::CanCacheImageURL(const CURL &url)
           StringUtils::StartsWith(url.GetUserName(), "video_");
 }
 
-std::string CTextureCache::CheckCachedImage(const std::string &url, bool &needsRecaching)
+std::string CTextureCache::CheckCachedImage(const std::string &url, bool &needsRecaching, bool returnDDS /* = false */)
 {
   CTextureDetails details;
   std::string path(GetCachedImage(url, details, true));
   needsRecaching = !details.hash.empty();
   if (!path.empty())
+  {
+    if (returnDDS && !details.file.empty() &&
+        CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_imageUseDDS &&
+        CServiceBroker::GetRenderSystem()->SupportsDXT())
+    {
+      std::string ddsPath = URIUtils::ReplaceExtension(path, ".dds");
+      if (CFile::Exists(ddsPath))
+        return ddsPath;
+    }
     return path;
+  }
   return "";
 }
 
@@ -52,10 +52,11 @@ public:
 
    \param image url of the image to check
    \param needsRecaching [out] whether the image needs recaching.
+   \param returnDDS whether to return the .dds version if available and usable by the render system.
    \return cached url of this image
    \sa GetCachedImage
    */
-  std::string CheckCachedImage(const std::string &image, bool &needsRecaching);
+  std::string CheckCachedImage(const std::string &image, bool &needsRecaching, bool returnDDS = false);
 
   /*! \brief Cache image (if required) using a background job
 
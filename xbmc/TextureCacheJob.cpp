@@ -9,7 +9,9 @@
 #include "TextureCacheJob.h"
 #include "ServiceBroker.h"
 #include "TextureCache.h"
+#include "guilib/DDSImage.h"
 #include "guilib/Texture.h"
+#include "rendering/RenderSystem.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/SettingsComponent.h"
 #include "utils/log.h"
@@ -26,6 +28,8 @@
 #include "cores/omxplayer/OMXImage.h"
 #endif
 
+#include <memory>
+
 CTextureCacheJob::CTextureCacheJob(const std::string &url, const std::string &oldHash):
   m_url(url),
   m_oldHash(oldHash),
@@ -78,6 +82,11 @@ bool CTextureCacheJob::CacheTexture(CBaseTexture **out_texture)
   else if (m_details.hash == m_oldHash)
     return true;
 
+  // a compressed version of a previous image would be served instead of the new one
+  std::string ddsFile = CTextureCache::GetCachedPath(m_cachePath + ".dds");
+  if (XFILE::CFile::Exists(ddsFile))
+    XFILE::CFile::Delete(ddsFile);
+
 #if defined(TARGET_RASPBERRY_PI)
   if (COMXImage::CreateThumb(image, width, height, additional_info, CTextureCache::GetCachedPath(m_cachePath + ".jpg")))
   {
@@ -106,6 +115,9 @@ bool CTextureCacheJob::CacheTexture(CBaseTexture **out_texture)
     {
       m_details.width = width;
       m_details.height = height;
+      if (CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_imageUseDDS &&
+          CServiceBroker::GetRenderSystem()->SupportsDXT())
+        CacheDDS(texture, width, height);
       if (out_texture) // caller wants the texture
         *out_texture = texture;
       else
@@ -219,6 +231,34 @@ CBaseTexture *CTextureCacheJob::LoadImage(const std::string &image, unsigned int
   return texture;
 }
 
+bool CTextureCacheJob::CacheDDS(CBaseTexture *texture, unsigned int width, unsigned int height) const
+{
+  std::string cachedFile = CTextureCache::GetCachedPath(m_details.file);
+  std::string ddsFile = URIUtils::ReplaceExtension(cachedFile, ".dds");
+
+  // the cached image is scaled and orientated, so compress that rather than the source if they differ
+  std::unique_ptr<CBaseTexture> cachedTexture;
+  if (texture->GetWidth() != width || texture->GetHeight() != height || texture->GetOrientation())
+  {
+    cachedTexture.reset(CBaseTexture::LoadFromFile(cachedFile, 0, 0, true));
+    texture = cachedTexture.get();
+  }
+  if (!texture || !texture->GetPixels() || texture->GetFormat() != XB_FMT_A8R8G8B8)
+    return false;
+
+  CDDSImage dds;
+  if (!dds.Compress(texture->GetWidth(), texture->GetHeight(), texture->GetPitch(), texture->GetPixels(), texture->HasAlpha()) ||
+      !dds.WriteFile(ddsFile))
+  {
+    CLog::Log(LOGERROR, "%s - unable to store compressed version of %s", __FUNCTION__, CURL::GetRedacted(cachedFile).c_str());
+    // don't leave a partially written file behind
+    if (XFILE::CFile::Exists(ddsFile))
+      XFILE::CFile::Delete(ddsFile);
+    return false;
+  }
+  return true;
+}
+
 bool CTextureCacheJob::UpdateableURL(const std::string &url) const
 {
   // we don't constantly check online images
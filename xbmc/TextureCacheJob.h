@@ -112,6 +112,18 @@ private:
    */
   static CBaseTexture *LoadImage(const std::string &image, unsigned int width, unsigned int height, const std::string &additional_info, bool requirePixels = false);
 
+  /*! \brief Store a DXT compressed .dds version of the cached image next to it.
+
+   The .dds version is uploaded to the GPU as is, which avoids decoding the image on load
+   and uses 1/8 (opaque) or 1/4 (alpha) of the texture memory.
+
+   \param texture the texture that was cached.
+   \param width the width of the cached image.
+   \param height the height of the cached image.
+   \return true if the .dds version was stored, false otherwise.
+   */
+  bool CacheDDS(CBaseTexture *texture, unsigned int width, unsigned int height) const;
+
   std::string    m_cachePath;
 };
 
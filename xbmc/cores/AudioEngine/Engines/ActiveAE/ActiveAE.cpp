@@ -25,6 +25,7 @@ using namespace ActiveAE;
 #include "settings/SettingsComponent.h"
 #include "windowing/WinSystem.h"
 #include "utils/log.h"
+#include "utils/Trace.h"
 
 #define MAX_CACHE_LEVEL 0.4   // total cache time of stream in seconds
 #define MAX_WATER_LEVEL 0.2   // buffered time after stream stages in seconds
@@ -247,7 +248,7 @@ AEAudioFormat CEngineStats::GetCurrentSinkFormat()
 }
 
 CActiveAE::CActiveAE() :
-  CThread("ActiveAE"),
+  CThread("ActiveAE", XbmcThreads::THREAD_CLASS_AUDIO),
   m_controlPort("OutputControlPort", &m_inMsgEvent, &m_outMsgEvent),
   m_dataPort("OutputDataPort", &m_inMsgEvent, &m_outMsgEvent),
   m_sink(&m_outMsgEvent)
@@ -329,6 +330,8 @@ int AE_parentStates[] = {
 
 void CActiveAE::StateMachine(int signal, Protocol *port, Message *msg)
 {
+  TRACE_SPAN("CActiveAE::StateMachine");
+
   for (int state = m_state; ; state = AE_parentStates[state])
   {
     switch (state)
@@ -28,7 +28,7 @@ using namespace AE;
 using namespace ActiveAE;
 
 CActiveAESink::CActiveAESink(CEvent *inMsgEvent) :
-  CThread("AESink"),
+  CThread("AESink", XbmcThreads::THREAD_CLASS_AUDIO),
   m_controlPort("SinkControlPort", inMsgEvent, &m_outMsgEvent),
   m_dataPort("SinkDataPort", inMsgEvent, &m_outMsgEvent)
 {
@@ -45,7 +45,6 @@ void CActiveAESink::Start()
   if (!IsRunning())
   {
     Create();
-    SetPriority(THREAD_PRIORITY_ABOVE_NORMAL);
   }
 }
 
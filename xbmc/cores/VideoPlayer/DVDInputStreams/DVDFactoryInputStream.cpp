@@ -15,6 +15,7 @@
 #include "InputStreamMultiSource.h"
 #include "InputStreamPVRChannel.h"
 #include "InputStreamPVRRecording.h"
+#include "InputStreamPVRZapAhead.h"
 #ifdef HAVE_LIBBLURAY
 #include "DVDInputStreamBluray.h"
 #endif
@@ -28,6 +29,7 @@
 #include "utils/URIUtils.h"
 #include "ServiceBroker.h"
 #include "addons/binary-addons/BinaryAddonManager.h"
+#include "pvr/PVRManager.h"
 #include "Util.h"
 
 
@@ -112,6 +114,15 @@ std::shared_ptr<CDVDInputStream> CDVDFactoryInputStream::CreateInputStream(IVide
   else if(StringUtils::StartsWithNoCase(file, "stack://"))
     return std::shared_ptr<CDVDInputStreamStack>(new CDVDInputStreamStack(fileitem));
 
+  if (fileitem.IsPVRChannel())
+  {
+    // continue with the stream prepared in the background, if the channel was prepared
+    std::vector<uint8_t> data;
+    std::unique_ptr<XFILE::CFile> preparedFile = CServiceBroker::GetPVRManager().ZapAhead().TakeStream(fileitem, data);
+    if (preparedFile)
+      return std::shared_ptr<CInputStreamPVRZapAhead>(new CInputStreamPVRZapAhead(fileitem, std::move(preparedFile), std::move(data)));
+  }
+
   CFileItem finalFileitem(fileitem);
 
   if (finalFileitem.IsInternetStream())
@@ -8,7 +8,11 @@
 
 #include "InputStreamPVRChannel.h"
 
+#include "PVRTimeshiftBuffer.h"
+#include "ServiceBroker.h"
 #include "addons/PVRClient.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/SettingsComponent.h"
 #include "utils/log.h"
 
 CInputStreamPVRChannel::CInputStreamPVRChannel(IVideoPlayer* pPlayer, const CFileItem& fileitem)
@@ -30,12 +34,49 @@ CDVDInputStream::IDemux* CInputStreamPVRChannel::GetIDemux()
   return CInputStreamPVRBase::GetIDemux();
 }
 
+bool CInputStreamPVRChannel::IsRealtime()
+{
+  // when playing from the local timeshift buffer, the player must not try to keep up with the source
+  if (m_timeshift && !m_timeshift->IsAtLivePosition())
+    return false;
+
+  return CInputStreamPVRBase::IsRealtime();
+}
+
+void CInputStreamPVRChannel::Pause(bool bPaused)
+{
+  // the local timeshift buffer keeps reading from the client while paused
+  if (!m_timeshift)
+    CInputStreamPVRBase::Pause(bPaused);
+}
+
 bool CInputStreamPVRChannel::OpenPVRStream()
 {
   if (m_client && (m_client->OpenLiveStream(m_item) == PVR_ERROR_NO_ERROR))
   {
     m_bDemuxActive = m_client->GetClientCapabilities().HandlesDemuxing();
     CLog::Log(LOGDEBUG, "CInputStreamPVRChannel - %s - opened channel stream %s", __FUNCTION__, m_item.GetPath().c_str());
+
+    const int iTimeshiftSize = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_iPVRLocalTimeshiftSize;
+    bool bCanPause = false;
+    bool bCanSeek = false;
+    m_client->CanPauseStream(bCanPause);
+    m_client->CanSeekStream(bCanSeek);
+
+    // demuxing clients deliver packets, not a byte stream, so they can't use the local buffer
+    if (iTimeshiftSize > 0 && !m_bDemuxActive && !bCanPause && !bCanSeek)
+    {
+      const std::shared_ptr<PVR::CPVRClient> client = m_client;
+      m_timeshift.reset(new CPVRTimeshiftBuffer([client](uint8_t* buf, int buf_size)
+      {
+        int ret = -1;
+        client->ReadLiveStream(buf, buf_size, ret);
+        return ret;
+      }, static_cast<int64_t>(iTimeshiftSize) * 1024 * 1024));
+
+      if (!m_timeshift->Open())
+        m_timeshift.reset();
+    }
     return true;
   }
   return false;
@@ -43,6 +84,9 @@ bool CInputStreamPVRChannel::OpenPVRStream()
 
 void CInputStreamPVRChannel::ClosePVRStream()
 {
+  // stop reading from the client before closing the stream
+  m_timeshift.reset();
+
   if (m_client && (m_client->CloseLiveStream() == PVR_ERROR_NO_ERROR))
   {
     m_bDemuxActive = false;
@@ -52,6 +96,9 @@ void CInputStreamPVRChannel::ClosePVRStream()
 
 int CInputStreamPVRChannel::ReadPVRStream(uint8_t* buf, int buf_size)
 {
+  if (m_timeshift)
+    return m_timeshift->Read(buf, buf_size);
+
   int ret = -1;
 
   if (m_client)
@@ -62,6 +109,9 @@ int CInputStreamPVRChannel::ReadPVRStream(uint8_t* buf, int buf_size)
 
 int64_t CInputStreamPVRChannel::SeekPVRStream(int64_t offset, int whence)
 {
+  if (m_timeshift)
+    return m_timeshift->Seek(offset, whence);
+
   int64_t ret = -1;
 
   if (m_client)
@@ -72,6 +122,9 @@ int64_t CInputStreamPVRChannel::SeekPVRStream(int64_t offset, int whence)
 
 int64_t CInputStreamPVRChannel::GetPVRStreamLength()
 {
+  if (m_timeshift)
+    return m_timeshift->GetLength();
+
   int64_t ret = -1;
 
   if (m_client)
@@ -90,6 +143,9 @@ CDVDInputStream::ENextStream CInputStreamPVRChannel::NextPVRStream()
 
 bool CInputStreamPVRChannel::CanPausePVRStream()
 {
+  if (m_timeshift)
+    return true;
+
   bool ret = false;
 
   if (m_client)
@@ -100,6 +156,9 @@ bool CInputStreamPVRChannel::CanPausePVRStream()
 
 bool CInputStreamPVRChannel::CanSeekPVRStream()
 {
+  if (m_timeshift)
+    return true;
+
   bool ret = false;
 
   if (m_client)
@@ -8,8 +8,12 @@
 
 #pragma once
 
+#include <memory>
+
 #include "InputStreamPVRBase.h"
 
+class CPVRTimeshiftBuffer;
+
 class CInputStreamPVRChannel : public CInputStreamPVRBase
 {
 public:
@@ -17,6 +21,8 @@ public:
   ~CInputStreamPVRChannel() override;
 
   CDVDInputStream::IDemux* GetIDemux() override;
+  bool IsRealtime() override;
+  void Pause(bool bPaused) override;
 
 protected:
   bool OpenPVRStream() override;
@@ -30,4 +36,5 @@ protected:
 
 private:
   bool m_bDemuxActive;
+  std::unique_ptr<CPVRTimeshiftBuffer> m_timeshift; /*!< local timeshift, if the client can't pause and seek */
 };
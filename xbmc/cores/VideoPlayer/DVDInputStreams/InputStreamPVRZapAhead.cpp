@@ -0,0 +1,73 @@
+/*
+ *  Copyright (C) 2012-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "InputStreamPVRZapAhead.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "filesystem/File.h"
+#include "filesystem/IFile.h"
+
+CInputStreamPVRZapAhead::CInputStreamPVRZapAhead(const CFileItem& fileitem, std::unique_ptr<XFILE::CFile> file, std::vector<uint8_t> data)
+  : CDVDInputStreamFile(fileitem, XFILE::READ_TRUNCATED | XFILE::READ_BITRATE | XFILE::READ_CHUNKED),
+    m_preparedFile(std::move(file)),
+    m_data(std::move(data))
+{
+}
+
+bool CInputStreamPVRZapAhead::Open()
+{
+  if (!m_preparedFile || !CDVDInputStream::Open())
+    return false;
+
+  // the base class owns the file from now on and deletes it on close
+  m_pFile = m_preparedFile.release();
+
+  if (m_pFile->GetImplementation() && (m_item.GetMimeType().empty() || m_item.GetMimeType() == "application/octet-stream"))
+    m_content = m_pFile->GetImplementation()->GetProperty(XFILE::FILE_PROPERTY_CONTENT_TYPE);
+
+  m_eof = false;
+  return true;
+}
+
+int CInputStreamPVRZapAhead::Read(uint8_t* buf, int buf_size)
+{
+  if (!m_pFile)
+    return -1;
+
+  int iRead;
+  if (m_iDataPos < m_data.size())
+  {
+    iRead = static_cast<int>(std::min(m_data.size() - m_iDataPos, static_cast<size_t>(buf_size)));
+    std::memcpy(buf, m_data.data() + m_iDataPos, iRead);
+    m_iDataPos += iRead;
+
+    if (m_iDataPos == m_data.size())
+      std::vector<uint8_t>().swap(m_data);
+  }
+  else
+  {
+    iRead = CDVDInputStreamFile::Read(buf, buf_size);
+  }
+
+  if (iRead > 0)
+    m_iPosition += iRead;
+
+  return iRead;
+}
+
+int64_t CInputStreamPVRZapAhead::Seek(int64_t offset, int whence)
+{
+  if (whence == SEEK_POSSIBLE)
+    return 0;
+  else if (whence == SEEK_CUR && offset == 0)
+    return m_iPosition;
+
+  return -1;
+}
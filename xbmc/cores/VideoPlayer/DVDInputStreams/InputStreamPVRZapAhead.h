@@ -0,0 +1,36 @@
+/*
+ *  Copyright (C) 2012-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "DVDInputStreamFile.h"
+
+/*!
+ * Plays a channel stream that was opened and buffered in the background for fast switching.
+ * The buffered data, starting at the latest keyframe, is returned before reading on from the
+ * already opened connection. The stream is live and can't be seeked.
+ */
+class CInputStreamPVRZapAhead : public CDVDInputStreamFile
+{
+public:
+  CInputStreamPVRZapAhead(const CFileItem& fileitem, std::unique_ptr<XFILE::CFile> file, std::vector<uint8_t> data);
+  ~CInputStreamPVRZapAhead() override = default;
+
+  bool Open() override;
+  int Read(uint8_t* buf, int buf_size) override;
+  int64_t Seek(int64_t offset, int whence) override;
+
+private:
+  std::unique_ptr<XFILE::CFile> m_preparedFile;
+  std::vector<uint8_t> m_data;
+  size_t m_iDataPos = 0;
+  int64_t m_iPosition = 0;
+};
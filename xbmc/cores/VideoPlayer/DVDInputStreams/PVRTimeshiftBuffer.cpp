@@ -0,0 +1,310 @@
+/*
+ *  Copyright (C) 2012-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "PVRTimeshiftBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/StringUtils.h"
+#include "utils/log.h"
+
+using namespace XFILE;
+
+namespace
+{
+  const int SOURCE_READ_SIZE = 64 * 1024;
+  const unsigned int DATA_WAIT_TIMEOUT = 1000; // ms
+  const unsigned int SOURCE_RETRY_MIN = 10; // ms
+  const unsigned int SOURCE_RETRY_MAX = 500; // ms
+  const unsigned int SOURCE_ERROR_TIMEOUT = 10000; // ms of failed reads after which the source is given up
+
+  bool IsKeyframePacket(const uint8_t* packet)
+  {
+    // random access indicator set and payload starting with a video PES header
+    if (packet[0] != 0x47 || !(packet[1] & 0x40) || !(packet[3] & 0x20) || packet[4] == 0 || !(packet[5] & 0x40))
+      return false;
+
+    const size_t iPayload = 5 + packet[4];
+    return iPayload + 4 <= 188 &&
+           packet[iPayload] == 0x00 && packet[iPayload + 1] == 0x00 && packet[iPayload + 2] == 0x01 &&
+           (packet[iPayload + 3] & 0xF0) == 0xE0;
+  }
+}
+
+const size_t CPVRTimeshiftBuffer::TS_PACKET_SIZE;
+
+CPVRTimeshiftBuffer::CPVRTimeshiftBuffer(SourceReader reader, int64_t iMaxSize)
+: CThread("PVRTimeshiftBuffer"),
+  m_reader(std::move(reader)),
+  m_iMaxSize(iMaxSize)
+{
+}
+
+CPVRTimeshiftBuffer::~CPVRTimeshiftBuffer()
+{
+  Close();
+}
+
+bool CPVRTimeshiftBuffer::Open()
+{
+  m_strPath = "special://temp/pvrtimeshift-" + StringUtils::CreateUUID() + ".ts";
+
+  if (!m_writeFile.OpenForWrite(m_strPath, true) ||
+      !m_readFile.Open(m_strPath, READ_NO_CACHE | READ_CHUNKED))
+  {
+    CLog::LogF(LOGERROR, "Unable to create timeshift buffer '%s'", m_strPath.c_str());
+    Close();
+    return false;
+  }
+
+  CLog::LogF(LOGDEBUG, "Created timeshift buffer '%s' for %lld bytes", m_strPath.c_str(), static_cast<long long>(m_iMaxSize));
+  Create();
+  return true;
+}
+
+void CPVRTimeshiftBuffer::Close()
+{
+  StopThread(true);
+
+  m_readFile.Close();
+  m_writeFile.Close();
+
+  if (!m_strPath.empty())
+  {
+    CFile::Delete(m_strPath);
+    m_strPath.clear();
+  }
+}
+
+void CPVRTimeshiftBuffer::Process()
+{
+  std::vector<uint8_t> buffer(SOURCE_READ_SIZE);
+  unsigned int iRetryDelay = 0;
+  XbmcThreads::EndTime errorTimeout;
+  while (!m_bStop)
+  {
+    const int iRead = m_reader(buffer.data(), SOURCE_READ_SIZE);
+    if (iRead < 0)
+    {
+      // source not ready, retry less and less often until giving up on it
+      if (iRetryDelay == 0)
+      {
+        iRetryDelay = SOURCE_RETRY_MIN;
+        errorTimeout.Set(SOURCE_ERROR_TIMEOUT);
+      }
+      else if (errorTimeout.IsTimePast())
+      {
+        CLog::LogF(LOGERROR, "Reading from the source failed for %u ms, ending timeshift", SOURCE_ERROR_TIMEOUT);
+        CSingleLock lock(m_critSection);
+        m_bSourceEnded = true;
+        m_dataAvailable.Set();
+        break;
+      }
+
+      Sleep(iRetryDelay);
+      iRetryDelay = std::min(iRetryDelay * 2, SOURCE_RETRY_MAX);
+      continue;
+    }
+    iRetryDelay = 0;
+
+    if (iRead == 0 || !Write(buffer.data(), iRead))
+    {
+      CSingleLock lock(m_critSection);
+      m_bSourceEnded = true;
+      m_dataAvailable.Set();
+      break;
+    }
+  }
+}
+
+bool CPVRTimeshiftBuffer::Write(const uint8_t* data, size_t iSize)
+{
+  // only this thread writes, the lock is only taken to publish the positions so that reading
+  // never waits for the disk
+  std::vector<int64_t> keyframes;
+  while (iSize > 0)
+  {
+    const int64_t iWritePos = m_iWritePos;
+    const int64_t iFilePos = iWritePos % m_iMaxSize;
+    const size_t iChunk = static_cast<size_t>(std::min<int64_t>(iSize, m_iMaxSize - iFilePos));
+
+    {
+      // the data about to be overwritten is no longer available
+      CSingleLock lock(m_critSection);
+      m_iReservedPos = iWritePos + iChunk;
+      const int64_t iStart = GetStart();
+      while (!m_keyframes.empty() && m_keyframes.front() < iStart)
+        m_keyframes.pop_front();
+    }
+
+    if (m_writeFile.Seek(iFilePos, SEEK_SET) != iFilePos ||
+        m_writeFile.Write(data, iChunk) != static_cast<ssize_t>(iChunk))
+    {
+      CLog::LogF(LOGERROR, "Unable to write to timeshift buffer '%s'", m_strPath.c_str());
+      return false;
+    }
+
+    keyframes.clear();
+    IndexPackets(data, iChunk, iWritePos, keyframes);
+
+    {
+      CSingleLock lock(m_critSection);
+      m_keyframes.insert(m_keyframes.end(), keyframes.begin(), keyframes.end());
+      m_iWritePos = m_iReservedPos;
+      m_dataAvailable.Set();
+    }
+
+    data += iChunk;
+    iSize -= iChunk;
+  }
+
+  return true;
+}
+
+void CPVRTimeshiftBuffer::IndexPackets(const uint8_t* data, size_t iSize, int64_t iOffset, std::vector<int64_t>& keyframes)
+{
+  size_t iPos = 0;
+  while (iPos < iSize)
+  {
+    if (m_iPacketFill == 0)
+    {
+      // (re)sync at the next sync byte
+      const uint8_t* sync = static_cast<const uint8_t*>(std::memchr(data + iPos, 0x47, iSize - iPos));
+      if (!sync)
+        return;
+
+      iPos = sync - data;
+      m_iPacketOffset = iOffset + iPos;
+    }
+
+    const size_t iCopy = std::min(TS_PACKET_SIZE - m_iPacketFill, iSize - iPos);
+    std::memcpy(m_packet + m_iPacketFill, data + iPos, iCopy);
+    m_iPacketFill += iCopy;
+    iPos += iCopy;
+
+    if (m_iPacketFill == TS_PACKET_SIZE)
+    {
+      if (IsKeyframePacket(m_packet))
+        keyframes.emplace_back(m_iPacketOffset);
+
+      m_iPacketFill = 0;
+    }
+  }
+}
+
+int64_t CPVRTimeshiftBuffer::GetStart() const
+{
+  return std::max<int64_t>(0, m_iReservedPos - m_iMaxSize);
+}
+
+int64_t CPVRTimeshiftBuffer::GetRecoveryPosition() const
+{
+  // the oldest keyframe still available, or the oldest data if there is none
+  return m_keyframes.empty() ? GetStart() : m_keyframes.front();
+}
+
+int CPVRTimeshiftBuffer::Read(uint8_t* buf, int buf_size)
+{
+  if (buf_size <= 0)
+    return 0;
+
+  bool bWaited = false;
+  while (true)
+  {
+    int64_t iReadPos = 0;
+    size_t iChunk = 0;
+    {
+      CSingleLock lock(m_critSection);
+
+      if (m_iReadPos < GetStart())
+      {
+        // paused too long, the data was overwritten
+        m_iReadPos = GetRecoveryPosition();
+        CLog::LogF(LOGDEBUG, "Timeshift buffer overrun, continuing at %lld", static_cast<long long>(m_iReadPos));
+      }
+
+      if (m_iReadPos < m_iWritePos)
+      {
+        iReadPos = m_iReadPos;
+        iChunk = static_cast<size_t>(std::min<int64_t>({static_cast<int64_t>(buf_size),
+                                                        m_iWritePos - m_iReadPos,
+                                                        m_iMaxSize - m_iReadPos % m_iMaxSize}));
+      }
+      else if (m_bSourceEnded)
+        return 0;
+    }
+
+    if (iChunk > 0)
+    {
+      // read without the lock, the writer must not wait for the disk either
+      const int64_t iFilePos = iReadPos % m_iMaxSize;
+      if (m_readFile.Seek(iFilePos, SEEK_SET) != iFilePos)
+        return -1;
+
+      const ssize_t iRead = m_readFile.Read(buf, iChunk);
+      if (iRead <= 0)
+        return -1;
+
+      CSingleLock lock(m_critSection);
+      if (iReadPos < GetStart())
+        continue; // overwritten while it was read
+
+      m_iReadPos = iReadPos + iRead;
+      return static_cast<int>(iRead);
+    }
+
+    if (bWaited || m_bStop)
+      return -1;
+
+    m_dataAvailable.WaitMSec(DATA_WAIT_TIMEOUT);
+    bWaited = true;
+  }
+}
+
+int64_t CPVRTimeshiftBuffer::Seek(int64_t offset, int whence)
+{
+  CSingleLock lock(m_critSection);
+
+  int64_t iPos;
+  switch (whence)
+  {
+    case SEEK_SET:
+      iPos = offset;
+      break;
+    case SEEK_CUR:
+      iPos = m_iReadPos + offset;
+      break;
+    case SEEK_END:
+      iPos = m_iWritePos + offset;
+      break;
+    default:
+      return -1;
+  }
+
+  if (iPos < GetStart())
+    m_iReadPos = GetRecoveryPosition();
+  else
+    m_iReadPos = std::min(iPos, m_iWritePos);
+  return m_iReadPos;
+}
+
+int64_t CPVRTimeshiftBuffer::GetLength() const
+{
+  CSingleLock lock(m_critSection);
+  return m_iWritePos;
+}
+
+bool CPVRTimeshiftBuffer::IsAtLivePosition() const
+{
+  CSingleLock lock(m_critSection);
+  return m_iWritePos - m_iReadPos < SOURCE_READ_SIZE;
+}
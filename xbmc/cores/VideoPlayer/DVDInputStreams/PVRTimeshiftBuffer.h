@@ -0,0 +1,110 @@
+/*
+ *  Copyright (C) 2012-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "filesystem/File.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+
+/*!
+ * Local timeshift for live streams whose source can neither pause nor seek. The stream is read
+ * continuously in the background into a ring file of bounded size, while reads and seeks are
+ * served from the file. Positions are absolute stream offsets, the oldest available one moves
+ * forward as the ring is overwritten. MPEG-TS video keyframes are indexed, so that a reader which
+ * was overrun continues at a keyframe instead of in the middle of a GOP.
+ */
+class CPVRTimeshiftBuffer : private CThread
+{
+public:
+  using SourceReader = std::function<int(uint8_t* buf, int buf_size)>;
+
+  /*!
+   * @brief Create a buffer.
+   * @param reader Reads from the live source. Returns the number of bytes read, 0 at the end of the
+   * stream and a negative value on errors. Errors are retried with increasing delays, the stream
+   * ends once the source failed for a while.
+   * @param iMaxSize The size of the ring file in bytes.
+   */
+  CPVRTimeshiftBuffer(SourceReader reader, int64_t iMaxSize);
+  ~CPVRTimeshiftBuffer() override;
+
+  /*!
+   * @brief Create the ring file and start reading from the source.
+   * @return True on success, false otherwise.
+   */
+  bool Open();
+
+  /*!
+   * @brief Stop reading from the source and delete the ring file.
+   */
+  void Close();
+
+  /*!
+   * @brief Read from the current position, waiting a while for new data when at the live position.
+   * @return The number of bytes read, 0 at the end of the stream or -1 if no data is available yet.
+   */
+  int Read(uint8_t* buf, int buf_size);
+
+  /*!
+   * @brief Move the read position. Positions outside the buffered range are clamped to it.
+   * @return The new position or -1 on error.
+   */
+  int64_t Seek(int64_t offset, int whence);
+
+  /*!
+   * @brief Get the end of the buffered data.
+   * @return The number of bytes received from the source so far.
+   */
+  int64_t GetLength() const;
+
+  /*!
+   * @brief Check whether the read position is at the live position.
+   * @return True if all received data has been read, false when playing from the past.
+   */
+  bool IsAtLivePosition() const;
+
+private:
+  CPVRTimeshiftBuffer(const CPVRTimeshiftBuffer&) = delete;
+  CPVRTimeshiftBuffer& operator=(const CPVRTimeshiftBuffer&) = delete;
+
+  void Process() override;
+
+  bool Write(const uint8_t* data, size_t iSize);
+  void IndexPackets(const uint8_t* data, size_t iSize, int64_t iOffset, std::vector<int64_t>& keyframes);
+  int64_t GetStart() const;
+  int64_t GetRecoveryPosition() const;
+
+  static const size_t TS_PACKET_SIZE = 188;
+
+  const SourceReader m_reader;
+  const int64_t m_iMaxSize;
+  std::string m_strPath;
+
+  mutable CCriticalSection m_critSection;
+  CEvent m_dataAvailable;
+  XFILE::CFile m_writeFile;
+  XFILE::CFile m_readFile;
+  int64_t m_iWritePos = 0; /*!< absolute offset of the end of the data */
+  int64_t m_iReservedPos = 0; /*!< absolute offset of the end of the data being written, the ring
+                                   file no longer holds anything older than this minus its size */
+  int64_t m_iReadPos = 0; /*!< absolute offset of the next byte to read */
+  bool m_bSourceEnded = false;
+
+  std::deque<int64_t> m_keyframes; /*!< absolute offsets of video keyframe packets, ascending */
+  uint8_t m_packet[TS_PACKET_SIZE];
+  size_t m_iPacketFill = 0;
+  int64_t m_iPacketOffset = 0;
+};
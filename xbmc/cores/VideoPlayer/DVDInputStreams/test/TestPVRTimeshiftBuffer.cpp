@@ -0,0 +1,185 @@
+/*
+ *  Copyright (C) 2005-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/VideoPlayer/DVDInputStreams/PVRTimeshiftBuffer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <thread>
+#include <vector>
+
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+const int64_t PACKET_SIZE = 188;
+const int64_t RING_PACKETS = 10;
+const uint16_t PID_VIDEO = 0x101;
+
+std::vector<uint8_t> CreatePacket(uint8_t iFill)
+{
+  std::vector<uint8_t> packet(PACKET_SIZE, iFill);
+  packet[0] = 0x47;
+  packet[1] = (PID_VIDEO >> 8) & 0x1F;
+  packet[2] = PID_VIDEO & 0xFF;
+  packet[3] = 0x10; // payload only
+  return packet;
+}
+
+std::vector<uint8_t> CreateKeyframe(uint8_t iFill)
+{
+  std::vector<uint8_t> packet = CreatePacket(iFill);
+  packet[1] |= 0x40; // payload start
+  packet[3] = 0x30; // adaptation field and payload
+  packet[4] = 1; // adaptation field length
+  packet[5] = 0x40; // random access indicator
+  packet[6] = 0x00;
+  packet[7] = 0x00;
+  packet[8] = 0x01;
+  packet[9] = 0xE0; // video stream id
+  return packet;
+}
+
+//! A live source handing out the pushed packets, failing while there are none
+class CTestSource
+{
+public:
+  void Push(const std::vector<uint8_t>& packet)
+  {
+    CSingleLock lock(m_critSection);
+    m_packets.push_back(packet);
+  }
+
+  void End()
+  {
+    CSingleLock lock(m_critSection);
+    m_bEnded = true;
+  }
+
+  CPVRTimeshiftBuffer::SourceReader Reader()
+  {
+    return [this](uint8_t* buf, int buf_size)
+    {
+      CSingleLock lock(m_critSection);
+      if (m_packets.empty())
+        return m_bEnded ? 0 : -1;
+
+      const std::vector<uint8_t> packet = m_packets.front();
+      m_packets.pop_front();
+      std::memcpy(buf, packet.data(), std::min<size_t>(buf_size, packet.size()));
+      return static_cast<int>(packet.size());
+    };
+  }
+
+private:
+  CCriticalSection m_critSection;
+  std::deque<std::vector<uint8_t>> m_packets;
+  bool m_bEnded = false;
+};
+
+bool WaitForLength(const CPVRTimeshiftBuffer& buffer, int64_t iLength)
+{
+  XbmcThreads::EndTime timeout(5000);
+  while (buffer.GetLength() < iLength)
+  {
+    if (timeout.IsTimePast())
+      return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+//! Reads packets until the end of the stream and returns their fill bytes
+std::vector<uint8_t> ReadPackets(CPVRTimeshiftBuffer& buffer)
+{
+  std::vector<uint8_t> fills;
+  uint8_t packet[PACKET_SIZE];
+  while (buffer.Read(packet, PACKET_SIZE) == PACKET_SIZE)
+    fills.push_back(packet[PACKET_SIZE - 1]);
+  return fills;
+}
+
+} // unnamed namespace
+
+TEST(TestPVRTimeshiftBuffer, WrapsAround)
+{
+  CTestSource source;
+  for (uint8_t i = 0; i < 25; i++)
+    source.Push(CreatePacket(i));
+  source.End();
+
+  CPVRTimeshiftBuffer buffer(source.Reader(), RING_PACKETS * PACKET_SIZE);
+  ASSERT_TRUE(buffer.Open());
+  ASSERT_TRUE(WaitForLength(buffer, 25 * PACKET_SIZE));
+
+  // the ring holds the last packets, starting in the middle of the file
+  EXPECT_EQ(15 * PACKET_SIZE, buffer.Seek(0, SEEK_SET));
+  std::vector<uint8_t> expected;
+  for (uint8_t i = 15; i < 25; i++)
+    expected.push_back(i);
+  EXPECT_EQ(expected, ReadPackets(buffer));
+  EXPECT_EQ(0, buffer.Read(nullptr, 0));
+}
+
+TEST(TestPVRTimeshiftBuffer, OverrunRecoversToOldestKeyframe)
+{
+  CTestSource source;
+  for (uint8_t i = 0; i < 5; i++)
+    source.Push(i == 3 ? CreateKeyframe(i) : CreatePacket(i));
+
+  CPVRTimeshiftBuffer buffer(source.Reader(), RING_PACKETS * PACKET_SIZE);
+  ASSERT_TRUE(buffer.Open());
+  ASSERT_TRUE(WaitForLength(buffer, 5 * PACKET_SIZE));
+
+  uint8_t packet[PACKET_SIZE];
+  ASSERT_EQ(PACKET_SIZE, buffer.Read(packet, PACKET_SIZE));
+  EXPECT_EQ(0, packet[PACKET_SIZE - 1]);
+
+  // paused while the ring is overwritten, the keyframe at packet 3 is gone by then
+  for (uint8_t i = 5; i < 25; i++)
+    source.Push(i == 17 || i == 21 ? CreateKeyframe(i) : CreatePacket(i));
+  source.End();
+  ASSERT_TRUE(WaitForLength(buffer, 25 * PACKET_SIZE));
+
+  ASSERT_EQ(PACKET_SIZE, buffer.Read(packet, PACKET_SIZE));
+  EXPECT_EQ(17, packet[PACKET_SIZE - 1]);
+  EXPECT_EQ(18 * PACKET_SIZE, buffer.Seek(0, SEEK_CUR));
+}
+
+TEST(TestPVRTimeshiftBuffer, SeekIsClamped)
+{
+  CTestSource source;
+  for (uint8_t i = 0; i < 25; i++)
+    source.Push(i == 20 ? CreateKeyframe(i) : CreatePacket(i));
+  source.End();
+
+  CPVRTimeshiftBuffer buffer(source.Reader(), RING_PACKETS * PACKET_SIZE);
+  ASSERT_TRUE(buffer.Open());
+  ASSERT_TRUE(WaitForLength(buffer, 25 * PACKET_SIZE));
+
+  EXPECT_EQ(25 * PACKET_SIZE, buffer.Seek(1000, SEEK_END));
+  EXPECT_TRUE(buffer.IsAtLivePosition());
+
+  // before the oldest data, continue at the oldest keyframe
+  EXPECT_EQ(20 * PACKET_SIZE, buffer.Seek(0, SEEK_SET));
+  EXPECT_EQ(19 * PACKET_SIZE, buffer.Seek(-PACKET_SIZE, SEEK_CUR));
+  EXPECT_EQ(16 * PACKET_SIZE, buffer.Seek(16 * PACKET_SIZE, SEEK_SET));
+  EXPECT_EQ(-1, buffer.Seek(0, 42));
+
+  uint8_t packet[PACKET_SIZE];
+  ASSERT_EQ(PACKET_SIZE, buffer.Read(packet, PACKET_SIZE));
+  EXPECT_EQ(16, packet[PACKET_SIZE - 1]);
+}
@@ -9,6 +9,7 @@
 #include "DVDMessageQueue.h"
 #include "cores/VideoPlayer/Interface/Addon/DemuxPacket.h"
 #include "utils/log.h"
+#include "utils/Trace.h"
 #include "threads/SingleLock.h"
 #include "cores/VideoPlayer/Interface/Addon/TimingConstants.h"
 #include "math.h"
@@ -158,6 +159,7 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority, bool front
 
 MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutInMilliSeconds, int &priority)
 {
+  TRACE_SPAN("CDVDMessageQueue::Get");
   CSingleLock lock(m_section);
 
   *pMsg = NULL;
@@ -58,6 +58,7 @@
 #include "dialogs/GUIDialogKaiToast.h"
 #include "utils/JobManager.h"
 #include "utils/StringUtils.h"
+#include "utils/Trace.h"
 #include "video/Bookmark.h"
 #include "video/VideoInfoTag.h"
 #include "Util.h"
@@ -616,7 +617,7 @@ void CVideoPlayer::DestroyPlayers()
 
 CVideoPlayer::CVideoPlayer(IPlayerCallback& callback)
     : IPlayer(callback),
-      CThread("VideoPlayer"),
+      CThread("VideoPlayer", XbmcThreads::THREAD_CLASS_VIDEO_DECODE),
       m_CurrentAudio(STREAM_AUDIO, VideoPlayer_AUDIO),
       m_CurrentVideo(STREAM_VIDEO, VideoPlayer_VIDEO),
       m_CurrentSubtitle(STREAM_SUBTITLE, VideoPlayer_SUBTITLE),
@@ -1369,6 +1370,8 @@ void CVideoPlayer::Process()
 
   while (!m_bAbortRequest)
   {
+    TRACE_SPAN("CVideoPlayer::Process");
+
 #ifdef TARGET_RASPBERRY_PI
     if (m_omxplayer_mode && OMXDoProcessing(m_OmxPlayerState, m_playSpeed, m_VideoPlayerVideo, m_VideoPlayerAudio, m_CurrentAudio, m_CurrentVideo, m_HasVideo, m_HasAudio, *m_processInfo))
     {
@@ -46,7 +46,7 @@ CVideoPlayerVideo::CVideoPlayerVideo(CDVDClock* pClock
                                 ,CDVDMessageQueue& parent
                                 ,CRenderManager& renderManager
                                 ,CProcessInfo &processInfo)
-: CThread("VideoPlayerVideo")
+: CThread("VideoPlayerVideo", XbmcThreads::THREAD_CLASS_VIDEO_DECODE)
 , IDVDStreamPlayerVideo(processInfo)
 , m_messageQueue("video")
 , m_messageParent(parent)
@@ -17,16 +17,28 @@
 #include "climits"
 
 #include <algorithm>
+#include <vector>
 
 // Maximum number of directories to keep in our cache
 #define MAX_CACHED_DIRS 50
 
 using namespace XFILE;
 
+namespace
+{
+
+size_t GetItemMemoryUsage(const CFileItem& item)
+{
+  return sizeof(CFileItem) + item.GetPath().capacity() + item.GetLabel().capacity();
+}
+
+}
+
 CDirectoryCache::CDir::CDir(DIR_CACHE_TYPE cacheType)
 {
   m_cacheType = cacheType;
   m_lastAccess = 0;
+  m_memoryUsage = sizeof(CDir) + sizeof(CFileItemList);
   m_Items = new CFileItemList;
   m_Items->SetIgnoreURLOptions(true);
   m_Items->SetFastLookup(true);
@@ -45,13 +57,18 @@ void CDirectoryCache::CDir::SetLastAccess(unsigned int &accessCounter)
 CDirectoryCache::CDirectoryCache(void)
 {
   m_accessCounter = 0;
+  m_memoryUsage = 0;
 #ifdef _DEBUG
   m_cacheHits = 0;
   m_cacheMisses = 0;
 #endif
+  CMemoryBudget::GetInstance().RegisterConsumer(this, "directorycache", MEMORY_PRIORITY_NORMAL);
 }
 
-CDirectoryCache::~CDirectoryCache(void) = default;
+CDirectoryCache::~CDirectoryCache(void)
+{
+  CMemoryBudget::GetInstance().UnregisterConsumer(this);
+}
 
 bool CDirectoryCache::GetDirectory(const std::string& strPath, CFileItemList &items, bool retrieveAll)
 {
@@ -107,6 +124,9 @@ void CDirectoryCache::SetDirectory(const std::string& strPath, const CFileItemLi
 
   CDir* dir = new CDir(cacheType);
   dir->m_Items->Copy(items);
+  for (const auto& item : *dir->m_Items)
+    dir->m_memoryUsage += GetItemMemoryUsage(*item);
+  m_memoryUsage += dir->m_memoryUsage;
   dir->SetLastAccess(m_accessCounter);
   m_cache.insert(std::pair<std::string, CDir*>(storedPath, dir));
 }
@@ -163,6 +183,8 @@ void CDirectoryCache::AddFile(const std::string& strFile)
     CDir *dir = i->second;
     CFileItemPtr item(new CFileItem(strFile, false));
     dir->m_Items->Add(item);
+    dir->m_memoryUsage += GetItemMemoryUsage(*item);
+    m_memoryUsage += GetItemMemoryUsage(*item);
     dir->SetLastAccess(m_accessCounter);
   }
 }
@@ -253,10 +275,56 @@ void CDirectoryCache::CheckIfFull()
 void CDirectoryCache::Delete(iCache it)
 {
   CDir* dir = it->second;
+  m_memoryUsage -= dir->m_memoryUsage;
   delete dir;
   m_cache.erase(it);
 }
 
+size_t CDirectoryCache::GetMemoryUsage() const
+{
+  CSingleLock lock (m_cs);
+  return m_memoryUsage;
+}
+
+size_t CDirectoryCache::GetTrimmableMemory() const
+{
+  CSingleLock lock (m_cs);
+  size_t trimmable = 0;
+  for (ciCache i = m_cache.begin(); i != m_cache.end(); i++)
+  {
+    if (i->second->m_cacheType != DIR_CACHE_ALWAYS)
+      trimmable += i->second->m_memoryUsage;
+  }
+  return trimmable;
+}
+
+size_t CDirectoryCache::TrimMemory(size_t bytes)
+{
+  CSingleLock lock (m_cs);
+
+  // least recently accessed folders first, the ones that are always cached are
+  // expected to be there (same as in CheckIfFull())
+  std::vector<iCache> folders;
+  for (iCache i = m_cache.begin(); i != m_cache.end(); i++)
+  {
+    if (i->second->m_cacheType != DIR_CACHE_ALWAYS)
+      folders.push_back(i);
+  }
+  std::sort(folders.begin(), folders.end(), [](const iCache& a, const iCache& b) {
+    return a->second->GetLastAccess() < b->second->GetLastAccess();
+  });
+
+  size_t freed = 0;
+  for (iCache i : folders)
+  {
+    if (freed >= bytes)
+      break;
+    freed += i->second->m_memoryUsage;
+    Delete(i);
+  }
+  return freed;
+}
+
 #ifdef _DEBUG
 void CDirectoryCache::PrintStats() const
 {
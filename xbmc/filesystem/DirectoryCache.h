@@ -10,6 +10,7 @@
 
 #include "IDirectory.h"
 #include "threads/CriticalSection.h"
+#include "utils/MemoryBudget.h"
 
 #include <map>
 #include <set>
@@ -18,7 +19,7 @@ class CFileItem;
 
 namespace XFILE
 {
-  class CDirectoryCache
+  class CDirectoryCache : public IMemoryConsumer
   {
     class CDir
     {
@@ -31,6 +32,7 @@ namespace XFILE
 
       CFileItemList* m_Items;
       DIR_CACHE_TYPE m_cacheType;
+      size_t m_memoryUsage; ///< estimated bytes held by the items
     private:
       CDir(const CDir&) = delete;
       CDir& operator=(const CDir&) = delete;
@@ -38,7 +40,7 @@ namespace XFILE
     };
   public:
     CDirectoryCache(void);
-    virtual ~CDirectoryCache(void);
+    ~CDirectoryCache(void) override;
     bool GetDirectory(const std::string& strPath, CFileItemList &items, bool retrieveAll = false);
     void SetDirectory(const std::string& strPath, const CFileItemList &items, DIR_CACHE_TYPE cacheType);
     void ClearDirectory(const std::string& strPath);
@@ -47,6 +49,11 @@ namespace XFILE
     void Clear();
     void AddFile(const std::string& strFile);
     bool FileExists(const std::string& strPath, bool& bInCache);
+
+    // IMemoryConsumer implementation
+    size_t GetMemoryUsage() const override;
+    size_t GetTrimmableMemory() const override;
+    size_t TrimMemory(size_t bytes) override;
 #ifdef _DEBUG
     void PrintStats() const;
 #endif
@@ -63,6 +70,7 @@ namespace XFILE
     mutable CCriticalSection m_cs;
 
     unsigned int m_accessCounter;
+    size_t m_memoryUsage;
 
 #ifdef _DEBUG
     unsigned int m_cacheHits;
@@ -98,8 +98,11 @@ CFileCache::CFileCache(const unsigned int flags)
   , m_bFilling(false)
   , m_bLowSpeedDetected(false)
   , m_fileSize(0)
+  , m_cacheSize(0)
+  , m_memoryUsage(0)
   , m_flags(flags)
 {
+  CMemoryBudget::GetInstance().RegisterConsumer(this, "filecache", MEMORY_PRIORITY_HIGH);
 }
 
 CFileCache::CFileCache(CCacheStrategy *pCache, bool bDeleteCache /* = true */)
@@ -112,6 +115,8 @@ CFileCache::CFileCache(CCacheStrategy *pCache, bool bDeleteCache /* = true */)
   , m_forward(0)
   , m_bFilling(false)
   , m_bLowSpeedDetected(false)
+  , m_cacheSize(0)
+  , m_memoryUsage(0)
 {
   m_pCache = pCache;
   m_bDeleteCache = bDeleteCache;
@@ -119,10 +124,12 @@ CFileCache::CFileCache(CCacheStrategy *pCache, bool bDeleteCache /* = true */)
   m_readPos = 0;
   m_writePos = 0;
   m_nSeekResult = 0;
+  CMemoryBudget::GetInstance().RegisterConsumer(this, "filecache", MEMORY_PRIORITY_HIGH);
 }
 
 CFileCache::~CFileCache()
 {
+  CMemoryBudget::GetInstance().UnregisterConsumer(this);
   Close();
 
   if (m_bDeleteCache && m_pCache)
@@ -180,6 +187,7 @@ bool CFileCache::Open(const CURL& url)
       // Use cache on disk
       m_pCache = new CSimpleFileCache();
       m_forwardCacheSize = 0;
+      m_cacheSize = 0;
     }
     else
     {
@@ -205,6 +213,7 @@ bool CFileCache::Open(const CURL& url)
       }
       m_pCache = new CCircularCache(front, back);
       m_forwardCacheSize = front;
+      m_cacheSize = cacheSize;
     }
 
     if (m_flags & READ_MULTI_STREAM)
@@ -222,6 +231,8 @@ bool CFileCache::Open(const CURL& url)
     return false;
   }
 
+  m_memoryUsage = m_cacheSize;
+
   m_readPos = 0;
   m_writePos = 0;
   m_writeRate = 1024 * 1024;
@@ -571,6 +582,7 @@ void CFileCache::Close()
   CSingleLock lock(m_sync);
   if (m_pCache)
     m_pCache->Close();
+  m_memoryUsage = 0;
 
   m_source.Close();
 }
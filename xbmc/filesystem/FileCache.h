@@ -13,12 +13,13 @@
 #include "threads/CriticalSection.h"
 #include "File.h"
 #include "threads/Thread.h"
+#include "utils/MemoryBudget.h"
 #include <atomic>
 
 namespace XFILE
 {
 
-  class CFileCache : public IFile, public CThread
+  class CFileCache : public IFile, public CThread, public IMemoryConsumer
   {
   public:
     explicit CFileCache(const unsigned int flags);
@@ -55,6 +56,11 @@ namespace XFILE
       return std::vector<std::string>();
     }
 
+    // IMemoryConsumer methods, the buffers of open files can't be trimmed
+    size_t GetMemoryUsage() const override { return m_memoryUsage; }
+    size_t GetTrimmableMemory() const override { return 0; }
+    size_t TrimMemory(size_t bytes) override { return 0; }
+
   private:
     CCacheStrategy *m_pCache;
     bool m_bDeleteCache;
@@ -75,6 +81,8 @@ namespace XFILE
     bool m_bFilling;
     bool m_bLowSpeedDetected;
     std::atomic<int64_t> m_fileSize;
+    size_t m_cacheSize; ///< bytes of the memory cache while open, 0 on disk
+    std::atomic<size_t> m_memoryUsage;
     unsigned int m_flags;
     CCriticalSection m_sync;
   };
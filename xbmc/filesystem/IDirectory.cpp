@@ -117,11 +117,13 @@ void IDirectory::SetFlags(int flags)
 
 bool IDirectory::ProcessRequirements()
 {
-  std::string type = m_requirements["type"].asString();
+  // read only, so looking up several members at once doesn't add any
+  const CVariant& requirements = m_requirements;
+  std::string type = requirements["type"].asString();
   if (type == "keyboard")
   {
     std::string input;
-    if (CGUIKeyboardFactory::ShowAndGetInput(input, m_requirements["heading"], false, m_requirements["hidden"].asBoolean()))
+    if (CGUIKeyboardFactory::ShowAndGetInput(input, requirements["heading"], false, requirements["hidden"].asBoolean()))
     {
       m_requirements["input"] = input;
       return true;
@@ -138,7 +140,7 @@ bool IDirectory::ProcessRequirements()
   }
   else if (type == "error")
   {
-    HELPERS::ShowOKDialogLines(CVariant{m_requirements["heading"]}, CVariant{m_requirements["line1"]}, CVariant{m_requirements["line2"]}, CVariant{m_requirements["line3"]});
+    HELPERS::ShowOKDialogLines(CVariant{requirements["heading"]}, CVariant{requirements["line1"]}, CVariant{requirements["line2"]}, CVariant{requirements["line3"]});
   }
   m_requirements.clear();
   return false;
@@ -10,6 +10,8 @@
 #include "DDSImage.h"
 #include "XBTF.h"
 #include "utils/log.h"
+#include <cstdint>
+#include <cstdlib>
 #include <string.h>
 
 #ifndef NO_XBMC_FILESYSTEM
@@ -103,6 +105,287 @@ bool CDDSImage::ReadFile(const std::string &inputFile)
   return true;
 }
 
+bool CDDSImage::WriteFile(const std::string &outputFile) const
+{
+  if (!m_data)
+    return false;
+
+  // open the file
+  CFile file;
+  if (!file.OpenForWrite(outputFile, true))
+    return false;
+
+  // write the header
+  file.Write("DDS ", 4);
+  file.Write(&m_desc, sizeof(m_desc));
+  // now the data
+  file.Write(m_data, m_desc.linearSize);
+  file.Close();
+  return true;
+}
+
+bool CDDSImage::Compress(unsigned int width, unsigned int height, unsigned int pitch, const unsigned char *brga, bool hasAlpha)
+{
+  if (!brga || !width || !height)
+    return false;
+
+  unsigned int format = hasAlpha ? XB_FMT_DXT5 : XB_FMT_DXT1;
+  Allocate(width, height, format);
+  if (!m_data)
+    return false;
+
+  unsigned int blockSize = (format == XB_FMT_DXT1) ? 8 : 16;
+  unsigned char block[64];
+  unsigned char *dst = m_data;
+  for (unsigned int by = 0; by < height; by += 4)
+  {
+    for (unsigned int bx = 0; bx < width; bx += 4)
+    {
+      // gather the 4x4 block, repeating the edge pixels for partial blocks
+      for (unsigned int y = 0; y < 4; y++)
+      {
+        const unsigned char *src = brga + std::min(by + y, height - 1) * pitch;
+        for (unsigned int x = 0; x < 4; x++)
+          memcpy(block + (y * 4 + x) * 4, src + std::min(bx + x, width - 1) * 4, 4);
+      }
+      if (format == XB_FMT_DXT5)
+      {
+        CompressAlphaBlock(block, dst);
+        CompressColorBlock(block, dst + 8);
+      }
+      else
+        CompressColorBlock(block, dst);
+      dst += blockSize;
+    }
+  }
+  return true;
+}
+
+bool CDDSImage::Decompress(unsigned char *brga, unsigned int pitch) const
+{
+  unsigned int format = GetFormat();
+  if (!m_data || !brga || (format != XB_FMT_DXT1 && format != XB_FMT_DXT5))
+    return false;
+
+  unsigned int blockSize = (format == XB_FMT_DXT1) ? 8 : 16;
+  unsigned char block[64];
+  const unsigned char *src = m_data;
+  for (unsigned int by = 0; by < m_desc.height; by += 4)
+  {
+    for (unsigned int bx = 0; bx < m_desc.width; bx += 4)
+    {
+      if (format == XB_FMT_DXT5)
+      {
+        DecompressColorBlock(src + 8, block, false);
+        DecompressAlphaBlock(src, block);
+      }
+      else
+        DecompressColorBlock(src, block, true);
+      src += blockSize;
+
+      for (unsigned int y = 0; y < 4 && by + y < m_desc.height; y++)
+      {
+        unsigned int count = std::min(4u, m_desc.width - bx);
+        memcpy(brga + (by + y) * pitch + bx * 4, block + y * 16, count * 4);
+      }
+    }
+  }
+  return true;
+}
+
+namespace
+{
+
+inline uint16_t To565(const unsigned char *bgr)
+{
+  return ((bgr[2] >> 3) << 11) | ((bgr[1] >> 2) << 5) | (bgr[0] >> 3);
+}
+
+inline void From565(uint16_t color, unsigned char *bgr)
+{
+  unsigned char r = (color >> 11) & 0x1f;
+  unsigned char g = (color >> 5) & 0x3f;
+  unsigned char b = color & 0x1f;
+  bgr[0] = (b << 3) | (b >> 2);
+  bgr[1] = (g << 2) | (g >> 4);
+  bgr[2] = (r << 3) | (r >> 2);
+}
+
+}
+
+void CDDSImage::CompressColorBlock(const unsigned char *block, unsigned char *out)
+{
+  // bounding box of the block colours, inset slightly to reduce the error at the end points
+  unsigned char minColor[3] = { 255, 255, 255 };
+  unsigned char maxColor[3] = { 0, 0, 0 };
+  for (unsigned int i = 0; i < 16; i++)
+  {
+    for (unsigned int c = 0; c < 3; c++)
+    {
+      minColor[c] = std::min(minColor[c], block[i * 4 + c]);
+      maxColor[c] = std::max(maxColor[c], block[i * 4 + c]);
+    }
+  }
+  for (unsigned int c = 0; c < 3; c++)
+  {
+    unsigned char inset = (maxColor[c] - minColor[c]) >> 4;
+    minColor[c] += inset;
+    maxColor[c] -= inset;
+  }
+
+  uint16_t color0 = To565(maxColor);
+  uint16_t color1 = To565(minColor);
+  if (color0 < color1)
+    std::swap(color0, color1);
+
+  uint32_t indices = 0;
+  if (color0 != color1)
+  {
+    // four colour mode (color0 > color1), so no transparent entry
+    int palette[4][3];
+    unsigned char end[3];
+    From565(color0, end);
+    for (unsigned int c = 0; c < 3; c++)
+      palette[0][c] = end[c];
+    From565(color1, end);
+    for (unsigned int c = 0; c < 3; c++)
+    {
+      palette[1][c] = end[c];
+      palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+      palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    for (unsigned int i = 0; i < 16; i++)
+    {
+      unsigned int best = 0;
+      int bestError = INT32_MAX;
+      for (unsigned int p = 0; p < 4; p++)
+      {
+        int error = 0;
+        for (unsigned int c = 0; c < 3; c++)
+        {
+          int d = block[i * 4 + c] - palette[p][c];
+          error += d * d;
+        }
+        if (error < bestError)
+        {
+          bestError = error;
+          best = p;
+        }
+      }
+      indices |= best << (2 * i);
+    }
+  }
+
+  out[0] = color0 & 0xff;
+  out[1] = color0 >> 8;
+  out[2] = color1 & 0xff;
+  out[3] = color1 >> 8;
+  out[4] = indices & 0xff;
+  out[5] = (indices >> 8) & 0xff;
+  out[6] = (indices >> 16) & 0xff;
+  out[7] = indices >> 24;
+}
+
+void CDDSImage::CompressAlphaBlock(const unsigned char *block, unsigned char *out)
+{
+  unsigned char minAlpha = 255;
+  unsigned char maxAlpha = 0;
+  for (unsigned int i = 0; i < 16; i++)
+  {
+    minAlpha = std::min(minAlpha, block[i * 4 + 3]);
+    maxAlpha = std::max(maxAlpha, block[i * 4 + 3]);
+  }
+
+  uint64_t indices = 0;
+  if (maxAlpha != minAlpha)
+  {
+    // eight alpha mode (alpha0 > alpha1)
+    int palette[8];
+    palette[0] = maxAlpha;
+    palette[1] = minAlpha;
+    for (unsigned int p = 1; p < 7; p++)
+      palette[p + 1] = ((7 - p) * maxAlpha + p * minAlpha) / 7;
+
+    for (unsigned int i = 0; i < 16; i++)
+    {
+      uint64_t best = 0;
+      int bestError = INT32_MAX;
+      for (unsigned int p = 0; p < 8; p++)
+      {
+        int error = std::abs(block[i * 4 + 3] - palette[p]);
+        if (error < bestError)
+        {
+          bestError = error;
+          best = p;
+        }
+      }
+      indices |= best << (3 * i);
+    }
+  }
+
+  out[0] = maxAlpha;
+  out[1] = minAlpha;
+  for (unsigned int i = 0; i < 6; i++)
+    out[2 + i] = (indices >> (8 * i)) & 0xff;
+}
+
+void CDDSImage::DecompressColorBlock(const unsigned char *in, unsigned char *block, bool dxt1)
+{
+  uint16_t color0 = in[0] | (in[1] << 8);
+  uint16_t color1 = in[2] | (in[3] << 8);
+  uint32_t indices = in[4] | (in[5] << 8) | (in[6] << 16) | (static_cast<uint32_t>(in[7]) << 24);
+
+  unsigned char palette[4][4];
+  From565(color0, palette[0]);
+  From565(color1, palette[1]);
+  palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+  for (unsigned int c = 0; c < 3; c++)
+  {
+    if (!dxt1 || color0 > color1)
+    {
+      palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+      palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+    else
+    {
+      palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+      palette[3][c] = 0;
+    }
+  }
+  if (dxt1 && color0 <= color1)
+    palette[3][3] = 0;
+
+  for (unsigned int i = 0; i < 16; i++)
+    memcpy(block + i * 4, palette[(indices >> (2 * i)) & 3], 4);
+}
+
+void CDDSImage::DecompressAlphaBlock(const unsigned char *in, unsigned char *block)
+{
+  int palette[8];
+  palette[0] = in[0];
+  palette[1] = in[1];
+  if (palette[0] > palette[1])
+  {
+    for (unsigned int p = 1; p < 7; p++)
+      palette[p + 1] = ((7 - p) * palette[0] + p * palette[1]) / 7;
+  }
+  else
+  {
+    for (unsigned int p = 1; p < 5; p++)
+      palette[p + 1] = ((5 - p) * palette[0] + p * palette[1]) / 5;
+    palette[6] = 0;
+    palette[7] = 255;
+  }
+
+  uint64_t indices = 0;
+  for (unsigned int i = 0; i < 6; i++)
+    indices |= static_cast<uint64_t>(in[2 + i]) << (8 * i);
+
+  for (unsigned int i = 0; i < 16; i++)
+    block[i * 4 + 3] = palette[(indices >> (3 * i)) & 7];
+}
+
 unsigned int CDDSImage::GetStorageRequirements(unsigned int width, unsigned int height, unsigned int format)
 {
   switch (format)
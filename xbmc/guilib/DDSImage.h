@@ -25,11 +25,35 @@ public:
   unsigned char *GetData() const;
 
   bool ReadFile(const std::string &file);
+  bool WriteFile(const std::string &file) const;
+
+  /*! \brief Compress an image into a DXT texture
+   Opaque images are stored as DXT1 (4 bits per pixel), images with alpha as DXT5 (8 bits per pixel).
+   \param width width of the image
+   \param height height of the image
+   \param pitch pitch of the image in bytes
+   \param brga pixels of the image in XB_FMT_A8R8G8B8 layout
+   \param hasAlpha whether the alpha channel of the image is used
+   \return true on success, false otherwise
+   */
+  bool Compress(unsigned int width, unsigned int height, unsigned int pitch, const unsigned char *brga, bool hasAlpha);
+
+  /*! \brief Decompress the texture into XB_FMT_A8R8G8B8 pixels
+   \param brga output buffer, at least pitch * height bytes
+   \param pitch pitch of the output buffer in bytes
+   \return true on success, false otherwise
+   */
+  bool Decompress(unsigned char *brga, unsigned int pitch) const;
 
 private:
   void Allocate(unsigned int width, unsigned int height, unsigned int format);
   static const char *GetFourCC(unsigned int format);
 
+  static void CompressColorBlock(const unsigned char *block, unsigned char *out);
+  static void CompressAlphaBlock(const unsigned char *block, unsigned char *out);
+  static void DecompressColorBlock(const unsigned char *in, unsigned char *block, bool dxt1);
+  static void DecompressAlphaBlock(const unsigned char *in, unsigned char *block);
+
   static unsigned int GetStorageRequirements(unsigned int width, unsigned int height, unsigned int format);
   enum {
     ddsd_caps        = 0x00000001,
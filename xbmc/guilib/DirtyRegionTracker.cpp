@@ -13,6 +13,8 @@
 #include <stdio.h>
 #include "DirtyRegionSolvers.h"
 #include "ServiceBroker.h"
+#include "windowing/GraphicContext.h"
+#include "windowing/WinSystem.h"
 
 CDirtyRegionTracker::CDirtyRegionTracker(int buffering)
 {
@@ -62,18 +64,81 @@ const CDirtyRegionList &CDirtyRegionTracker::GetMarkedRegions() const
   return m_markedRegions;
 }
 
-CDirtyRegionList CDirtyRegionTracker::GetDirtyRegions()
+void CDirtyRegionTracker::UpdateSwapHistory(unsigned int swapCount)
+{
+  const unsigned int swaps = swapCount - m_swapCount;
+  m_swapCount = swapCount;
+
+  if (swaps == 1)
+  {
+    // the changes drawn since the previous swap were presented by it
+    m_swapHistory.push_front(m_unpresentedRegions);
+    m_unpresentedRegions.clear();
+    while (m_swapHistory.size() > static_cast<size_t>(m_buffering))
+      m_swapHistory.pop_back();
+  }
+  else if (swaps > 1)
+  {
+    // buffers were swapped without us knowing what they contain
+    m_swapHistory.clear();
+    m_unpresentedRegions.clear();
+  }
+}
+
+CDirtyRegionList CDirtyRegionTracker::GetDirtyRegions(int bufferAge, unsigned int swapCount)
 {
   CDirtyRegionList output;
 
-  if (m_solver)
+  if (!m_solver)
+    return output;
+
+  if (bufferAge < 0)
+  {
+    m_swapHistory.clear();
+    m_unpresentedRegions.clear();
     m_solver->Solve(m_markedRegions, output);
+    return output;
+  }
+
+  UpdateSwapHistory(swapCount);
+
+  // everything changed since the last swap, including frames that were drawn but not presented
+  CDirtyRegionList changes = m_unpresentedRegions;
+  for (const auto& region : m_markedRegions)
+  {
+    if (region.GetAge() == 0)
+      changes.push_back(region);
+  }
+
+  // the front buffer is up to date unless something changed
+  if (changes.empty())
+    return output;
+
+  if (bufferAge == 0 || static_cast<size_t>(bufferAge - 1) > m_swapHistory.size())
+  {
+    // contents of the back buffer are unknown or older than our history
+    output.push_back(CDirtyRegion(CServiceBroker::GetWinSystem()->GetGfxContext().GetViewWindow()));
+  }
+  else
+  {
+    // the back buffer misses the changes presented since it was last drawn
+    for (int i = 0; i < bufferAge - 1; i++)
+      changes.insert(changes.end(), m_swapHistory[i].begin(), m_swapHistory[i].end());
+    m_solver->Solve(changes, output);
+  }
 
   return output;
 }
 
 void CDirtyRegionTracker::CleanMarkedRegions()
 {
+  // remember this frame's changes until it is known whether they were presented
+  for (const auto& region : m_markedRegions)
+  {
+    if (region.GetAge() == 0)
+      m_unpresentedRegions.push_back(region);
+  }
+
   int buffering = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_guiVisualizeDirtyRegions ? 20 : m_buffering;
   int i = m_markedRegions.size() - 1;
   while (i >= 0)
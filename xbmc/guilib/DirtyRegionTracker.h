@@ -10,6 +10,8 @@
 
 #include "IDirtyRegionSolver.h"
 
+#include <deque>
+
 #if defined(TARGET_DARWIN_IOS)
 #define DEFAULT_BUFFERING 4
 #else
@@ -25,11 +27,22 @@ public:
   void MarkDirtyRegion(const CDirtyRegion &region);
 
   const CDirtyRegionList &GetMarkedRegions() const;
-  CDirtyRegionList GetDirtyRegions();
+  /*!
+   \brief Solve the regions needing a redraw
+   \param bufferAge age of the back buffer in swaps, 0 if its contents are undefined
+                    or -1 to assume the default buffering
+   \param swapCount number of buffer swaps presented so far, only used with a buffer age
+   */
+  CDirtyRegionList GetDirtyRegions(int bufferAge = -1, unsigned int swapCount = 0);
   void CleanMarkedRegions();
 
 private:
+  void UpdateSwapHistory(unsigned int swapCount);
+
   CDirtyRegionList m_markedRegions;
+  CDirtyRegionList m_unpresentedRegions; // changed in frames that were not swapped yet
+  std::deque<CDirtyRegionList> m_swapHistory; // changes presented by the last swaps, newest first
+  unsigned int m_swapCount = 0;
   int m_buffering;
   IDirtyRegionSolver *m_solver;
 };
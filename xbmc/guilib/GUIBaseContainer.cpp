@@ -25,6 +25,9 @@
 #include "settings/SettingsComponent.h"
 #include "guilib/guiinfo/GUIInfoLabels.h"
 
+#include <algorithm>
+#include <unordered_set>
+
 #define HOLD_TIME_START 100
 #define HOLD_TIME_END   3000
 #define SCROLLING_GAP   200U
@@ -61,6 +64,7 @@ CGUIBaseContainer::~CGUIBaseContainer(void)
   // release the container from items
   for (auto item : m_items)
     item->FreeMemory();
+  FreeAllLayouts();
 
   delete m_listProvider;
 }
@@ -99,10 +103,6 @@ void CGUIBaseContainer::Process(unsigned int currentTime, CDirtyRegionList &dirt
   int cacheBefore, cacheAfter;
   GetCacheOffsets(cacheBefore, cacheAfter);
 
-  // Free memory not used on screen
-  if ((int)m_items.size() > m_itemsPerPage + cacheBefore + cacheAfter)
-    FreeMemory(CorrectOffset(offset - cacheBefore, 0), CorrectOffset(offset + m_itemsPerPage + 1 + cacheAfter, 0));
-
   CPoint origin = CPoint(m_posX, m_posY) + m_renderOffset;
   float pos = (m_orientation == VERTICAL) ? origin.y : origin.x;
   float end = (m_orientation == VERTICAL) ? m_posY + m_height : m_posX + m_width;
@@ -136,6 +136,9 @@ void CGUIBaseContainer::Process(unsigned int currentTime, CDirtyRegionList &dirt
     current++;
   }
 
+  // Free memory not used on screen
+  FreeMemory();
+
   // when we are scrolling up, offset will become lower (integer division, see offset calc)
   // to have same behaviour when scrolling down, we need to set page control to offset+1
   UpdatePageControl(offset + (m_scroller.IsScrollingDown() ? 1 : 0));
@@ -154,6 +157,7 @@ void CGUIBaseContainer::ProcessItem(float posX, float posY, CGUIListItemPtr& ite
 
   if (m_bInvalidated)
     item->SetInvalid();
+  m_processedItems.push_back(item);
   if (focused)
   {
     if (!item->GetFocusedLayout())
@@ -873,9 +877,10 @@ void CGUIBaseContainer::FreeResources(bool immediately)
 void CGUIBaseContainer::UpdateLayout(bool updateAllItems)
 {
   if (updateAllItems)
-  { // free memory of items
+  { // free memory of items, layouts may also have been created outside of Process()
     for (iItems it = m_items.begin(); it != m_items.end(); ++it)
       (*it)->FreeMemory();
+    FreeAllLayouts();
   }
   // and recalculate the layout
   CalculateLayout();
@@ -1139,6 +1144,8 @@ int CGUIBaseContainer::CorrectOffset(int offset, int cursor) const
 void CGUIBaseContainer::Reset()
 {
   m_wasReset = true;
+  // the tracked items may not be in the next list
+  FreeAllLayouts();
   m_items.clear();
   m_lastItem.reset();
   ResetAutoScrolling();
@@ -1184,22 +1191,57 @@ void CGUIBaseContainer::SetRenderOffset(const CPoint &offset)
   m_renderOffset = offset;
 }
 
-void CGUIBaseContainer::FreeMemory(int keepStart, int keepEnd)
+void CGUIBaseContainer::FreeMemory()
 {
-  if (keepStart < keepEnd)
-  { // remove before keepStart and after keepEnd
-    for (int i = 0; i < keepStart && i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
-    for (int i = std::max(keepEnd + 1, 0); i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
+  std::unordered_set<const CGUIListItem*> processed;
+  for (const auto& item : m_processedItems)
+    processed.insert(item.get());
+
+  // items that left the view keep their layouts for a while
+  for (const auto& item : m_boundItems)
+  {
+    if (processed.find(item.get()) == processed.end())
+    {
+      item->FreeLayoutResources();
+      m_cachedItems.push_back(item);
+    }
   }
-  else
-  { // wrapping
-    for (int i = std::max(keepEnd + 1, 0); i < keepStart && i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
+
+  // items that came back into view are bound again
+  m_cachedItems.erase(std::remove_if(m_cachedItems.begin(), m_cachedItems.end(),
+                                     [&processed](const CGUIListItemPtr& item) { return processed.find(item.get()) != processed.end(); }),
+                      m_cachedItems.end());
+
+  // wrapping containers may process an item more than once
+  m_boundItems.clear();
+  for (const auto& item : m_processedItems)
+  {
+    if (processed.erase(item.get()))
+      m_boundItems.push_back(item);
+  }
+  m_processedItems.clear();
+
+  // keep about a page worth of layouts out of view
+  while (m_cachedItems.size() > std::max<size_t>(m_boundItems.size(), 1))
+  {
+    m_cachedItems.front()->FreeMemory();
+    m_cachedItems.pop_front();
   }
 }
 
+void CGUIBaseContainer::FreeAllLayouts()
+{
+  for (const auto& item : m_processedItems)
+    item->FreeMemory();
+  for (const auto& item : m_boundItems)
+    item->FreeMemory();
+  for (const auto& item : m_cachedItems)
+    item->FreeMemory();
+  m_processedItems.clear();
+  m_boundItems.clear();
+  m_cachedItems.clear();
+}
+
 bool CGUIBaseContainer::InsideLayout(const CGUIListItemLayout *layout, const CPoint &point) const
 {
   if (!layout) return false;
@@ -13,6 +13,7 @@
 \brief
 */
 
+#include <deque>
 #include <utility>
 #include <vector>
 #include <list>
@@ -126,7 +127,14 @@ protected:
 
   int ScrollCorrectionRange() const;
   inline float Size() const;
-  void FreeMemory(int keepStart, int keepEnd);
+  /*! \brief Release the layouts of items no longer processed
+   Items that left the view free their resources but keep their layouts in a cache
+   of roughly one page, so scrolling back doesn't need to recreate them. Only items
+   holding layouts are visited, so the cost doesn't depend on the size of the list.
+   */
+  void FreeMemory();
+  /*! \brief Release the layouts of all items */
+  void FreeAllLayouts();
   void GetCurrentLayouts();
   CGUIListItemLayout *GetFocusedLayout() const;
 
@@ -142,6 +150,10 @@ protected:
   typedef std::vector<CGUIListItemPtr> ::iterator iItems;
   CGUIListItemPtr m_lastItem;
 
+  std::vector<CGUIListItemPtr> m_processedItems; ///< items processed this frame
+  std::vector<CGUIListItemPtr> m_boundItems;     ///< items processed last frame
+  std::deque<CGUIListItemPtr> m_cachedItems;     ///< items out of view keeping their layouts, oldest first
+
   int m_pageControl;
 
   std::list<CGUIListItemLayout> m_layouts;
@@ -71,6 +71,21 @@ class CGUIFontCacheImpl
     AgeMap ageMap;
   };
 
+  static size_t GetValueMemoryUsage(const CGUIFontCacheStaticValue &value)
+  {
+    return value ? sizeof(std::vector<SVertex>) + value->capacity() * sizeof(SVertex) : 0;
+  }
+  static size_t GetValueMemoryUsage(const CGUIFontCacheDynamicValue &value)
+  {
+    // size is the number of quads in the buffer
+    return value.size * 4 * sizeof(SVertex);
+  }
+  static size_t GetEntryMemoryUsage(const CGUIFontCacheEntry<Position, Value> &entry)
+  {
+    return sizeof(entry) + entry.m_key.m_colors.capacity() * sizeof(UTILS::Color) +
+           entry.m_key.m_text.capacity() * sizeof(character_t) + GetValueMemoryUsage(entry.m_value);
+  }
+
   EntryList m_list;
   CGUIFontCache<Position, Value> *m_parent;
 
@@ -83,6 +98,9 @@ public:
                 bool scrolling,
                 unsigned int nowMillis, bool &dirtyCache);
   void Flush();
+  size_t GetMemoryUsage() const;
+  size_t GetExpiredMemoryUsage(unsigned int nowMillis) const;
+  size_t Trim(unsigned int nowMillis);
 };
 
 template<class Position, class Value>
@@ -196,17 +214,80 @@ void CGUIFontCacheImpl<Position, Value>::Flush()
   m_list.Flush();
 }
 
+template<class Position, class Value>
+size_t CGUIFontCache<Position, Value>::GetMemoryUsage() const
+{
+  return m_impl->GetMemoryUsage();
+}
+
+template<class Position, class Value>
+size_t CGUIFontCacheImpl<Position, Value>::GetMemoryUsage() const
+{
+  size_t usage = 0;
+  for (const auto &it : m_list.hashMap)
+    usage += GetEntryMemoryUsage(*it.second);
+  return usage;
+}
+
+template<class Position, class Value>
+size_t CGUIFontCache<Position, Value>::GetExpiredMemoryUsage(unsigned int nowMillis) const
+{
+  return m_impl->GetExpiredMemoryUsage(nowMillis);
+}
+
+template<class Position, class Value>
+size_t CGUIFontCacheImpl<Position, Value>::GetExpiredMemoryUsage(unsigned int nowMillis) const
+{
+  size_t usage = 0;
+  for (const auto &it : m_list.ageMap)
+  {
+    if ((nowMillis - it.first) <= FONT_CACHE_TIME_LIMIT)
+      break;
+    usage += GetEntryMemoryUsage(*it.second->second);
+  }
+  return usage;
+}
+
+template<class Position, class Value>
+size_t CGUIFontCache<Position, Value>::Trim(unsigned int nowMillis)
+{
+  return m_impl->Trim(nowMillis);
+}
+
+template<class Position, class Value>
+size_t CGUIFontCacheImpl<Position, Value>::Trim(unsigned int nowMillis)
+{
+  // entries are only reused once expired, so without trimming the cache
+  // keeps the size it had when the most text was on screen
+  size_t freed = 0;
+  while (!m_list.ageMap.empty() && (nowMillis - m_list.ageMap.begin()->first) > FONT_CACHE_TIME_LIMIT)
+  {
+    auto entry = m_list.ageMap.begin()->second;
+    freed += GetEntryMemoryUsage(*entry->second);
+    delete entry->second;
+    m_list.hashMap.erase(entry);
+    m_list.ageMap.erase(m_list.ageMap.begin());
+  }
+  return freed;
+}
+
 template CGUIFontCache<CGUIFontCacheStaticPosition, CGUIFontCacheStaticValue>::CGUIFontCache(CGUIFontTTFBase &font);
 template CGUIFontCache<CGUIFontCacheStaticPosition, CGUIFontCacheStaticValue>::~CGUIFontCache();
 template CGUIFontCacheEntry<CGUIFontCacheStaticPosition, CGUIFontCacheStaticValue>::~CGUIFontCacheEntry();
 template CGUIFontCacheStaticValue &CGUIFontCache<CGUIFontCacheStaticPosition, CGUIFontCacheStaticValue>::Lookup(CGUIFontCacheStaticPosition &, const std::vector<UTILS::Color> &, const vecText &, uint32_t, float, bool, unsigned int, bool &);
 template void CGUIFontCache<CGUIFontCacheStaticPosition, CGUIFontCacheStaticValue>::Flush();
+template size_t CGUIFontCache<CGUIFontCacheStaticPosition, CGUIFontCacheStaticValue>::GetMemoryUsage() const;
+template size_t CGUIFontCache<CGUIFontCacheStaticPosition, CGUIFontCacheStaticValue>::GetExpiredMemoryUsage(unsigned int) const;
+template size_t CGUIFontCache<CGUIFontCacheStaticPosition, CGUIFontCacheStaticValue>::Trim(unsigned int);
 
 template CGUIFontCache<CGUIFontCacheDynamicPosition, CGUIFontCacheDynamicValue>::CGUIFontCache(CGUIFontTTFBase &font);
 template CGUIFontCache<CGUIFontCacheDynamicPosition, CGUIFontCacheDynamicValue>::~CGUIFontCache();
 template CGUIFontCacheEntry<CGUIFontCacheDynamicPosition, CGUIFontCacheDynamicValue>::~CGUIFontCacheEntry();
 template CGUIFontCacheDynamicValue &CGUIFontCache<CGUIFontCacheDynamicPosition, CGUIFontCacheDynamicValue>::Lookup(CGUIFontCacheDynamicPosition &, const std::vector<UTILS::Color> &, const vecText &, uint32_t, float, bool, unsigned int, bool &);
 template void CGUIFontCache<CGUIFontCacheDynamicPosition, CGUIFontCacheDynamicValue>::Flush();
+template size_t CGUIFontCache<CGUIFontCacheDynamicPosition, CGUIFontCacheDynamicValue>::GetMemoryUsage() const;
+template size_t CGUIFontCache<CGUIFontCacheDynamicPosition, CGUIFontCacheDynamicValue>::GetExpiredMemoryUsage(unsigned int) const;
+template size_t CGUIFontCache<CGUIFontCacheDynamicPosition, CGUIFontCacheDynamicValue>::Trim(unsigned int);
 
 void CVertexBuffer::clear()
 {
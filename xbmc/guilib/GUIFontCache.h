@@ -142,6 +142,19 @@ public:
                 bool scrolling,
                 unsigned int nowMillis, bool &dirtyCache);
   void Flush();
+  /*!
+   \brief Get the estimated number of bytes held by the cache
+   */
+  size_t GetMemoryUsage() const;
+  /*!
+   \brief Get the estimated number of bytes Trim() would free
+   */
+  size_t GetExpiredMemoryUsage(unsigned int nowMillis) const;
+  /*!
+   \brief Remove the entries that were not used for FONT_CACHE_TIME_LIMIT
+   \return the estimated number of bytes freed
+   */
+  size_t Trim(unsigned int nowMillis);
 };
 
 struct CGUIFontCacheStaticPosition
@@ -36,13 +36,56 @@ using namespace ADDON;
 GUIFontManager::GUIFontManager(void)
 {
   m_canReload = true;
+  CMemoryBudget::GetInstance().RegisterConsumer(this, "fonts", MEMORY_PRIORITY_LOW);
 }
 
 GUIFontManager::~GUIFontManager(void)
 {
+  CMemoryBudget::GetInstance().UnregisterConsumer(this);
   Clear();
 }
 
+size_t GUIFontManager::GetMemoryUsage() const
+{
+  CWinSystemBase* winSystem = CServiceBroker::GetWinSystem();
+  if (!winSystem)
+    return 0;
+
+  CSingleLock lock(winSystem->GetGfxContext());
+  size_t usage = 0;
+  for (const CGUIFontTTFBase* font : m_vecFontFiles)
+    usage += font->GetCacheMemoryUsage();
+  return usage;
+}
+
+size_t GUIFontManager::GetTrimmableMemory() const
+{
+  CWinSystemBase* winSystem = CServiceBroker::GetWinSystem();
+  if (!winSystem)
+    return 0;
+
+  CSingleLock lock(winSystem->GetGfxContext());
+  size_t usage = 0;
+  for (const CGUIFontTTFBase* font : m_vecFontFiles)
+    usage += font->GetExpiredCacheMemoryUsage();
+  return usage;
+}
+
+size_t GUIFontManager::TrimMemory(size_t bytes)
+{
+  // text drawn in the last second is likely drawn again next frame, the rest
+  // is rebuilt cheaply when needed
+  CWinSystemBase* winSystem = CServiceBroker::GetWinSystem();
+  if (!winSystem)
+    return 0;
+
+  CSingleLock lock(winSystem->GetGfxContext());
+  size_t freed = 0;
+  for (CGUIFontTTFBase* font : m_vecFontFiles)
+    freed += font->TrimCache();
+  return freed;
+}
+
 void GUIFontManager::RescaleFontSizeAndAspect(float *size, float *aspect, const RESOLUTION_INFO &sourceRes, bool preserveAspect)
 {
   // get the UI scaling constants so that we can scale our font sizes correctly
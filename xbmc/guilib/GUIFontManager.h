@@ -20,6 +20,7 @@
 #include "IMsgTargetCallback.h"
 #include "utils/Color.h"
 #include "utils/GlobalsHandling.h"
+#include "utils/MemoryBudget.h"
 
 // Forward
 class CGUIFont;
@@ -43,7 +44,7 @@ struct OrigFontInfo
  \ingroup textures
  \brief
  */
-class GUIFontManager : public IMsgTargetCallback
+class GUIFontManager : public IMsgTargetCallback, public IMemoryConsumer
 {
 public:
   GUIFontManager(void);
@@ -51,6 +52,10 @@ public:
 
   bool OnMessage(CGUIMessage &message) override;
 
+  size_t GetMemoryUsage() const override;
+  size_t GetTrimmableMemory() const override;
+  size_t TrimMemory(size_t bytes) override;
+
   void Unload(const std::string& strFontName);
   void LoadFonts(const std::string &fontSet);
   CGUIFont* LoadTTF(const std::string& strFontName, const std::string& strFilename, UTILS::Color textColor, UTILS::Color shadowColor, const int iSize, const int iStyle, bool border = false, float lineSpacing = 1.0f, float aspect = 1.0f, const RESOLUTION_INFO *res = NULL, bool preserveAspect = false);
@@ -232,6 +232,23 @@ void CGUIFontTTFBase::Clear()
   m_fontFileInMemory.clear();
 }
 
+size_t CGUIFontTTFBase::GetCacheMemoryUsage() const
+{
+  return m_staticCache.GetMemoryUsage() + m_dynamicCache.GetMemoryUsage();
+}
+
+size_t CGUIFontTTFBase::GetExpiredCacheMemoryUsage() const
+{
+  const unsigned int now = XbmcThreads::SystemClockMillis();
+  return m_staticCache.GetExpiredMemoryUsage(now) + m_dynamicCache.GetExpiredMemoryUsage(now);
+}
+
+size_t CGUIFontTTFBase::TrimCache()
+{
+  const unsigned int now = XbmcThreads::SystemClockMillis();
+  return m_staticCache.Trim(now) + m_dynamicCache.Trim(now);
+}
+
 bool CGUIFontTTFBase::Load(const std::string& strFilename, float height, float aspect, float lineSpacing, bool border)
 {
   // we now know that this object is unique - only the GUIFont objects are non-unique, so no need
@@ -85,6 +85,20 @@ public:
 
   const std::string& GetFileName() const { return m_strFileName; };
 
+  /*!
+   \brief Get the estimated number of bytes held by the caches of rendered text
+   */
+  size_t GetCacheMemoryUsage() const;
+  /*!
+   \brief Get the estimated number of bytes TrimCache() would free
+   */
+  size_t GetExpiredCacheMemoryUsage() const;
+  /*!
+   \brief Remove the rendered text from the caches that was not drawn recently
+   \return the estimated number of bytes freed
+   */
+  size_t TrimCache();
+
 protected:
   struct Character
   {
@@ -343,6 +343,14 @@ void CGUIListItem::FreeMemory(bool immediately)
   }
 }
 
+void CGUIListItem::FreeLayoutResources(bool immediately)
+{
+  if (m_layout)
+    m_layout->FreeResources(immediately);
+  if (m_focusedLayout)
+    m_focusedLayout->FreeResources(immediately);
+}
+
 void CGUIListItem::SetLayout(CGUIListItemLayoutPtr layout)
 {
   m_layout = std::move(layout);
@@ -137,6 +137,10 @@ public:
 
   void FreeIcons();
   void FreeMemory(bool immediately = false);
+  /*! \brief Free the resources held by the layouts of this item but keep the layouts
+   themselves, so they can be used again without being recreated.
+   */
+  void FreeLayoutResources(bool immediately = false);
   void SetInvalid();
 
   bool m_bIsFolder;     ///< is item a folder or a file
@@ -111,7 +111,7 @@ bool CGUITextureBase::AllocateOnDemand()
 {
   if (m_visible)
   { // visible, so make sure we're allocated
-    if (!IsAllocated() || (m_isAllocated == LARGE && !m_texture.size()))
+    if (!IsAllocated() || ((m_isAllocated == LARGE || m_isAllocated == ASYNC) && !m_texture.size()))
       return AllocResources();
   }
   else
@@ -315,6 +315,22 @@ bool CGUITextureBase::AllocResources()
         m_isAllocated = LARGE_FAILED;
     }
   }
+  else if (m_isAllocated == ASYNC || (!IsAllocated() && CServiceBroker::GetGUI()->GetTextureManager().IsAsyncLoadingEnabled()))
+  { // decode in the background, the texture manager uploads it once ready
+    CTextureArray texture;
+    if (!CServiceBroker::GetGUI()->GetTextureManager().LoadAsync(m_info.filename, texture, !IsAllocated(), m_visible))
+    {
+      m_isAllocated = NORMAL_FAILED;
+      return false;
+    }
+    m_isAllocated = ASYNC;
+
+    if (!texture.size()) // not ready as yet
+      return false;
+
+    m_texture = texture;
+    changed = true;
+  }
   else if (!IsAllocated())
   {
     CTextureArray texture = CServiceBroker::GetGUI()->GetTextureManager().Load(m_info.filename);
@@ -443,7 +459,7 @@ void CGUITextureBase::FreeResources(bool immediately /* = false */)
 {
   if (m_isAllocated == LARGE || m_isAllocated == LARGE_FAILED)
     CServiceBroker::GetGUI()->GetLargeTextureManager().ReleaseImage(m_info.filename, immediately || (m_isAllocated == LARGE_FAILED));
-  else if (m_isAllocated == NORMAL && m_texture.size())
+  else if ((m_isAllocated == NORMAL && m_texture.size()) || m_isAllocated == ASYNC)
     CServiceBroker::GetGUI()->GetTextureManager().ReleaseTexture(m_info.filename, immediately);
 
   if (m_diffuse.size())
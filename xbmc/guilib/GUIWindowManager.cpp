@@ -20,10 +20,12 @@
 #include "settings/SettingsComponent.h"
 #include "addons/Skin.h"
 #include "GUITexture.h"
+#include "rendering/RenderSystem.h"
 #include "utils/Variant.h"
 #include "input/Key.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
+#include "utils/Trace.h"
 
 #include "windows/GUIWindowHome.h"
 #include "events/windows/GUIWindowEventLog.h"
@@ -1085,6 +1087,7 @@ bool RenderOrderSortFunction(CGUIWindow *first, CGUIWindow *second)
 
 void CGUIWindowManager::Process(unsigned int currentTime)
 {
+  TRACE_SPAN("CGUIWindowManager::Process");
   assert(g_application.IsCurrentThread());
   CSingleLock lock(CServiceBroker::GetWinSystem()->GetGfxContext());
 
@@ -1169,7 +1172,10 @@ bool CGUIWindowManager::Render()
   assert(g_application.IsCurrentThread());
   CSingleExit lock(CServiceBroker::GetWinSystem()->GetGfxContext());
 
-  CDirtyRegionList dirtyRegions = m_tracker.GetDirtyRegions();
+  CRenderSystemBase* renderSystem = CServiceBroker::GetRenderSystem();
+  bool stereo = CServiceBroker::GetWinSystem()->GetGfxContext().GetStereoMode() != RENDER_STEREO_MODE_OFF;
+
+  CDirtyRegionList dirtyRegions = m_tracker.GetDirtyRegions(renderSystem->GetBufferAge(), renderSystem->GetSwapCount());
 
   bool hasRendered = false;
   // If we visualize the regions we will always render the entire viewport
@@ -1198,6 +1204,10 @@ bool CGUIWindowManager::Render()
       hasRendered = true;
     }
     CServiceBroker::GetWinSystem()->GetGfxContext().ResetScissors();
+
+    // both stereo views end up in the same buffer, so present it as a whole
+    if (!stereo)
+      renderSystem->SetDamagedRegions(dirtyRegions);
   }
 
   if (CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_guiVisualizeDirtyRegions)
@@ -54,13 +54,16 @@ void CBaseTexture::Allocate(unsigned int width, unsigned int height, unsigned in
   m_textureWidth = m_imageWidth;
   m_textureHeight = m_imageHeight;
 
-  if (m_format & XB_FMT_DXT_MASK)
+  // without a render system (e.g. during shutdown) the texture can only be used in memory
+  CRenderSystemBase* renderSystem = CServiceBroker::GetRenderSystem();
+
+  if (renderSystem && (m_format & XB_FMT_DXT_MASK))
   {
-    while (GetPitch() < CServiceBroker::GetRenderSystem()->GetMinDXTPitch())
+    while (GetPitch() < renderSystem->GetMinDXTPitch())
       m_textureWidth += GetBlockSize();
   }
 
-  if (!CServiceBroker::GetRenderSystem()->SupportsNPOT((m_format & XB_FMT_DXT_MASK) != 0))
+  if (renderSystem && !renderSystem->SupportsNPOT((m_format & XB_FMT_DXT_MASK) != 0))
   {
     m_textureWidth = PadPow2(m_textureWidth);
     m_textureHeight = PadPow2(m_textureHeight);
@@ -89,8 +92,11 @@ void CBaseTexture::Allocate(unsigned int width, unsigned int height, unsigned in
 
   // check for max texture size
   #define CLAMP(x, y) { if (x > y) x = y; }
-  CLAMP(m_textureWidth, CServiceBroker::GetRenderSystem()->GetMaxTextureSize());
-  CLAMP(m_textureHeight, CServiceBroker::GetRenderSystem()->GetMaxTextureSize());
+  if (renderSystem)
+  {
+    CLAMP(m_textureWidth, renderSystem->GetMaxTextureSize());
+    CLAMP(m_textureHeight, renderSystem->GetMaxTextureSize());
+  }
   CLAMP(m_imageWidth, m_textureWidth);
   CLAMP(m_imageHeight, m_textureHeight);
 
@@ -113,7 +119,7 @@ void CBaseTexture::Update(unsigned int width, unsigned int height, unsigned int
   if (pixels == NULL)
     return;
 
-  if (format & XB_FMT_DXT_MASK)
+  if ((format & XB_FMT_DXT_MASK) && !CServiceBroker::GetRenderSystem()->SupportsDXT())
     return;
 
   Allocate(width, height, format);
@@ -223,12 +229,20 @@ bool CBaseTexture::LoadFromFileInternal(const std::string& texturePath, unsigned
   if (URIUtils::HasExtension(texturePath, ".dds"))
   { // special case for DDS images
     CDDSImage image;
-    if (image.ReadFile(texturePath))
-    {
-      Update(image.GetWidth(), image.GetHeight(), 0, image.GetFormat(), image.GetData(), false);
+    if (!image.ReadFile(texturePath))
+      return false;
+
+    if ((image.GetFormat() & XB_FMT_DXT_MASK) && !CServiceBroker::GetRenderSystem()->SupportsDXT())
+    { // no compressed texture support, so decode on the CPU
+      Allocate(image.GetWidth(), image.GetHeight(), XB_FMT_A8R8G8B8);
+      if (!m_pixels || !image.Decompress(m_pixels, GetPitch()))
+        return false;
+      ClampToEdge();
       return true;
     }
-    return false;
+
+    Update(image.GetWidth(), image.GetHeight(), 0, image.GetFormat(), image.GetData(), false);
+    return m_pixels != nullptr;
   }
 
   unsigned int width = maxWidth ? std::min(maxWidth, CServiceBroker::GetRenderSystem()->GetMaxTextureSize()) :
@@ -95,6 +95,7 @@ public:
   /*! \brief return the original height of the image, before scaling/cropping */
   unsigned int GetOriginalHeight() const { return m_originalHeight; }
 
+  unsigned int GetFormat() const { return m_format; }
   int GetOrientation() const { return m_orientation; }
   void SetOrientation(int orientation) { m_orientation = orientation; }
 
@@ -66,6 +66,16 @@ int CTextureBundle::LoadAnim(const std::string& Filename, CBaseTexture*** ppText
   return 0;
 }
 
+bool CTextureBundle::ReadFile(const std::string& Filename, CXBTFPackedFile& packed)
+{
+  if (m_useXBT)
+  {
+    return m_tbXBT.ReadFile(Filename, packed);
+  }
+
+  return false;
+}
+
 void CTextureBundle::Close()
 {
   m_tbXBT.CloseBundle();
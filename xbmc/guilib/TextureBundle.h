@@ -27,6 +27,7 @@ public:
   bool LoadTexture(const std::string& Filename, CBaseTexture** ppTexture, int &width, int &height);
 
   int LoadAnim(const std::string& Filename, CBaseTexture*** ppTextures, int &width, int &height, int& nLoops, int** ppDelays);
+  bool ReadFile(const std::string& Filename, CXBTFPackedFile& packed);
   void Close();
 private:
   CTextureBundleXBT m_tbXBT;
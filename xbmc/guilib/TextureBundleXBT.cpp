@@ -16,12 +16,20 @@
 #include "settings/SettingsComponent.h"
 #include "filesystem/SpecialProtocol.h"
 #include "filesystem/XbtManager.h"
+#include "threads/IRunnable.h"
+#include "threads/Thread.h"
 #include "utils/URIUtils.h"
 #include "utils/StringUtils.h"
 #include "XBTF.h"
 #include "XBTFReader.h"
 #include <lzo/lzo1x.h>
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string.h>
+#include <thread>
+
 #ifdef TARGET_WINDOWS_DESKTOP
 #ifdef NDEBUG
 #pragma comment(lib,"lzo2.lib")
@@ -32,6 +40,34 @@
 #endif
 #endif
 
+namespace
+{
+
+// unpacks the next frame not taken by another worker until all frames are done
+class CFrameUnpacker : public IRunnable
+{
+public:
+  CFrameUnpacker(const std::vector<CXBTFFrame>& frames, const std::vector<const uint8_t*>& packedData,
+                 std::vector<uint8_t*>& buffers)
+    : m_frames(frames), m_packedData(packedData), m_buffers(buffers)
+  {
+  }
+
+  void Run() override
+  {
+    for (size_t i = m_next++; i < m_frames.size(); i = m_next++)
+      m_buffers[i] = CTextureBundleXBT::UnpackFrame(m_frames[i], m_packedData[i]);
+  }
+
+private:
+  const std::vector<CXBTFFrame>& m_frames;
+  const std::vector<const uint8_t*>& m_packedData;
+  std::vector<uint8_t*>& m_buffers;
+  std::atomic<size_t> m_next{0};
+};
+
+}
+
 CTextureBundleXBT::CTextureBundleXBT()
   : m_TimeStamp{0}
   , m_themeBundle{false}
@@ -146,113 +182,152 @@ void CTextureBundleXBT::GetTexturesFromPath(const std::string &path, std::vector
   }
 }
 
-bool CTextureBundleXBT::LoadTexture(const std::string& Filename, CBaseTexture** ppTexture,
-                                     int &width, int &height)
+bool CTextureBundleXBT::ReadFile(const std::string& Filename, CXBTFPackedFile& packed)
 {
+  if (m_XBTFReader == nullptr || !m_XBTFReader->IsOpen())
+    return false;
+
   std::string name = Normalize(Filename);
 
-  CXBTFFile file;
-  if (!m_XBTFReader->Get(name, file))
+  if (!m_XBTFReader->Get(name, packed.file))
     return false;
 
-  if (file.GetFrames().empty())
+  const std::vector<CXBTFFrame>& frames = packed.file.GetFrames();
+  if (frames.empty())
     return false;
 
-  CXBTFFrame& frame = file.GetFrames().at(0);
-  if (!ConvertFrameToTexture(Filename, frame, ppTexture))
+  // frames of a mapped bundle are used in place, holding on to the mapping keeps them valid
+  packed.mapping = m_XBTFReader->GetMapping();
+  if (packed.mapping)
   {
-    return false;
+    for (const auto& frame : frames)
+    {
+      const uint8_t* data = m_XBTFReader->GetFrameData(frame);
+      if (data == nullptr)
+      {
+        CLog::Log(LOGERROR, "Error loading texture: %s", Filename.c_str());
+        return false;
+      }
+      packed.frames.push_back(data);
+    }
+    return true;
   }
 
-  width = frame.GetWidth();
-  height = frame.GetHeight();
+  packed.buffers.resize(frames.size());
+  for (size_t i = 0; i < frames.size(); i++)
+  {
+    if (!ReadFrame(*m_XBTFReader, frames[i], packed.buffers[i]))
+    {
+      CLog::Log(LOGERROR, "Error loading texture: %s", Filename.c_str());
+      return false;
+    }
+    packed.frames.push_back(packed.buffers[i].data());
+  }
 
   return true;
 }
 
+bool CTextureBundleXBT::LoadTexture(const std::string& Filename, CBaseTexture** ppTexture,
+                                     int &width, int &height)
+{
+  CXBTFPackedFile packed;
+  if (!ReadFile(Filename, packed))
+    return false;
+
+  return LoadTexture(Filename, packed, ppTexture, width, height);
+}
+
 int CTextureBundleXBT::LoadAnim(const std::string& Filename, CBaseTexture*** ppTextures,
                               int &width, int &height, int& nLoops, int** ppDelays)
 {
-  std::string name = Normalize(Filename);
-
-  CXBTFFile file;
-  if (!m_XBTFReader->Get(name, file))
+  CXBTFPackedFile packed;
+  if (!ReadFile(Filename, packed))
     return false;
 
-  if (file.GetFrames().empty())
+  return LoadAnim(Filename, packed, ppTextures, width, height, nLoops, ppDelays);
+}
+
+bool CTextureBundleXBT::LoadTexture(const std::string& Filename, const CXBTFPackedFile& packed,
+                                    CBaseTexture** ppTexture, int &width, int &height)
+{
+  if (packed.file.GetFrames().empty() || packed.frames.empty())
     return false;
 
-  size_t nTextures = file.GetFrames().size();
-  *ppTextures = new CBaseTexture*[nTextures];
-  *ppDelays = new int[nTextures];
+  const CXBTFFrame& frame = packed.file.GetFrames().at(0);
 
-  for (size_t i = 0; i < nTextures; i++)
+  // unpacked frames are uploaded straight from the bundle
+  if (!frame.IsPacked())
   {
-    CXBTFFrame& frame = file.GetFrames().at(i);
-
-    if (!ConvertFrameToTexture(Filename, frame, &((*ppTextures)[i])))
-    {
-      return false;
-    }
+    *ppTexture = CreateTexture(frame, packed.frames[0]);
+    width = frame.GetWidth();
+    height = frame.GetHeight();
+    return true;
+  }
 
-    (*ppDelays)[i] = frame.GetDuration();
+  uint8_t* buffer = UnpackFrame(frame, packed.frames[0]);
+  if (buffer == nullptr)
+  {
+    CLog::Log(LOGERROR, "Error loading texture: %s", Filename.c_str());
+    return false;
   }
 
-  width = file.GetFrames().at(0).GetWidth();
-  height = file.GetFrames().at(0).GetHeight();
-  nLoops = file.GetLoop();
+  *ppTexture = CreateTexture(frame, buffer);
 
-  return nTextures;
+  delete[] buffer;
+
+  width = frame.GetWidth();
+  height = frame.GetHeight();
+
+  return true;
 }
 
-bool CTextureBundleXBT::ConvertFrameToTexture(const std::string& name, CXBTFFrame& frame, CBaseTexture** ppTexture)
+int CTextureBundleXBT::LoadAnim(const std::string& Filename, const CXBTFPackedFile& packed,
+                                CBaseTexture*** ppTextures, int &width, int &height, int& nLoops, int** ppDelays)
 {
-  // found texture - allocate the necessary buffers
-  unsigned char *buffer = new unsigned char [(size_t)frame.GetPackedSize()];
-  if (buffer == NULL)
-  {
-    CLog::Log(LOGERROR, "Out of memory loading texture: %s (need %" PRIu64" bytes)", name.c_str(), frame.GetPackedSize());
+  const std::vector<CXBTFFrame>& frames = packed.file.GetFrames();
+  if (frames.empty() || packed.frames.size() != frames.size())
     return false;
-  }
 
-  // load the compressed texture
-  if (!m_XBTFReader->Load(frame, buffer))
-  {
-    CLog::Log(LOGERROR, "Error loading texture: %s", name.c_str());
-    delete[] buffer;
-    return false;
-  }
+  size_t nTextures = frames.size();
+  *ppTextures = new CBaseTexture*[nTextures];
+  *ppDelays = new int[nTextures];
 
-  // check if it's packed with lzo
-  if (frame.IsPacked())
-  { // unpack
-    unsigned char *unpacked = new unsigned char[(size_t)frame.GetUnpackedSize()];
-    if (unpacked == NULL)
-    {
-      CLog::Log(LOGERROR, "Out of memory unpacking texture: %s (need %" PRIu64" bytes)", name.c_str(), frame.GetUnpackedSize());
-      delete[] buffer;
-      return false;
-    }
-    lzo_uint s = (lzo_uint)frame.GetUnpackedSize();
-    if (lzo1x_decompress_safe(buffer, (lzo_uint)frame.GetPackedSize(), unpacked, &s, NULL) != LZO_E_OK ||
-        s != frame.GetUnpackedSize())
+  // unpack all frames up front so they can be decompressed in parallel
+  std::vector<uint8_t*> buffers = UnpackFrames(frames, packed.frames);
+
+  bool success = true;
+  for (size_t i = 0; i < nTextures; i++)
+  {
+    if (buffers[i] == nullptr)
     {
-      CLog::Log(LOGERROR, "Error loading texture: %s: Decompression error", name.c_str());
-      delete[] buffer;
-      delete[] unpacked;
-      return false;
+      CLog::Log(LOGERROR, "Error loading texture: %s", Filename.c_str());
+      success = false;
+      break;
     }
-    delete[] buffer;
-    buffer = unpacked;
+
+    (*ppTextures)[i] = CreateTexture(frames[i], buffers[i]);
+    (*ppDelays)[i] = frames[i].GetDuration();
   }
 
-  // create an xbmc texture
-  *ppTexture = new CTexture();
-  (*ppTexture)->LoadFromMemory(frame.GetWidth(), frame.GetHeight(), 0, frame.GetFormat(), frame.HasAlpha(), buffer);
+  for (auto buffer : buffers)
+    delete[] buffer;
 
-  delete[] buffer;
+  if (!success)
+    return false;
 
-  return true;
+  width = frames.at(0).GetWidth();
+  height = frames.at(0).GetHeight();
+  nLoops = packed.file.GetLoop();
+
+  return nTextures;
+}
+
+CBaseTexture* CTextureBundleXBT::CreateTexture(const CXBTFFrame& frame, const uint8_t* buffer)
+{
+  // create an xbmc texture
+  CBaseTexture* texture = new CTexture();
+  texture->LoadFromMemory(frame.GetWidth(), frame.GetHeight(), 0, frame.GetFormat(), frame.HasAlpha(), buffer);
+  return texture;
 }
 
 void CTextureBundleXBT::SetThemeBundle(bool themeBundle)
@@ -273,32 +348,52 @@ std::string CTextureBundleXBT::Normalize(const std::string &name)
   return newName;
 }
 
-uint8_t* CTextureBundleXBT::UnpackFrame(const CXBTFReader& reader, const CXBTFFrame& frame)
+bool CTextureBundleXBT::ReadFrame(const CXBTFReader& reader, const CXBTFFrame& frame, std::vector<uint8_t>& packedData)
 {
-  uint8_t* packedBuffer = new uint8_t[static_cast<size_t>(frame.GetPackedSize())];
-  if (packedBuffer == nullptr)
-  {
-    CLog::Log(LOGERROR, "CTextureBundleXBT: out of memory loading frame with %" PRIu64" packed bytes", frame.GetPackedSize());
-    return nullptr;
-  }
+  packedData.resize(static_cast<size_t>(frame.GetPackedSize()));
 
   // load the compressed texture
-  if (!reader.Load(frame, packedBuffer))
+  if (!reader.Load(frame, packedData.data()))
   {
     CLog::Log(LOGERROR, "CTextureBundleXBT: error loading frame");
-    delete[] packedBuffer;
-    return nullptr;
+    return false;
+  }
+
+  return true;
+}
+
+uint8_t* CTextureBundleXBT::UnpackFrame(const CXBTFReader& reader, const CXBTFFrame& frame)
+{
+  // use the mapped frame data if available, otherwise read it into a buffer
+  const uint8_t* packedData = reader.GetFrameData(frame);
+  std::vector<uint8_t> packedBuffer;
+  if (packedData == nullptr)
+  {
+    if (!ReadFrame(reader, frame, packedBuffer))
+      return nullptr;
+    packedData = packedBuffer.data();
   }
 
+  return UnpackFrame(frame, packedData);
+}
+
+uint8_t* CTextureBundleXBT::UnpackFrame(const CXBTFFrame& frame, const uint8_t* packedData)
+{
+  if (packedData == nullptr)
+    return nullptr;
+
   // if the frame isn't packed there's nothing else to be done
   if (!frame.IsPacked())
-    return packedBuffer;
+  {
+    uint8_t* buffer = new uint8_t[static_cast<size_t>(frame.GetPackedSize())];
+    memcpy(buffer, packedData, static_cast<size_t>(frame.GetPackedSize()));
+    return buffer;
+  }
 
   uint8_t* unpackedBuffer = new uint8_t[static_cast<size_t>(frame.GetUnpackedSize())];
   if (unpackedBuffer == nullptr)
   {
     CLog::Log(LOGERROR, "CTextureBundleXBT: out of memory loading frame with %" PRIu64" unpacked bytes", frame.GetPackedSize());
-    delete[] packedBuffer;
     return nullptr;
   }
 
@@ -306,21 +401,62 @@ uint8_t* CTextureBundleXBT::UnpackFrame(const CXBTFReader& reader, const CXBTFFr
   if (lzo_init() != LZO_E_OK)
   {
     CLog::Log(LOGERROR, "CTextureBundleXBT: failed to initialize lzo");
-    delete[] packedBuffer;
     delete[] unpackedBuffer;
     return nullptr;
   }
 
   lzo_uint size = static_cast<lzo_uint>(frame.GetUnpackedSize());
-  if (lzo1x_decompress_safe(packedBuffer, static_cast<lzo_uint>(frame.GetPackedSize()), unpackedBuffer, &size, nullptr) != LZO_E_OK || size != frame.GetUnpackedSize())
+  if (lzo1x_decompress_safe(packedData, static_cast<lzo_uint>(frame.GetPackedSize()), unpackedBuffer, &size, nullptr) != LZO_E_OK || size != frame.GetUnpackedSize())
   {
     CLog::Log(LOGERROR, "CTextureBundleXBT: failed to decompress frame with %" PRIu64" unpacked bytes to %" PRIu64" bytes", frame.GetPackedSize(), frame.GetUnpackedSize());
-    delete[] packedBuffer;
     delete[] unpackedBuffer;
     return nullptr;
   }
 
-  delete[] packedBuffer;
-
   return unpackedBuffer;
 }
+
+std::vector<uint8_t*> CTextureBundleXBT::UnpackFrames(const CXBTFReader& reader, const std::vector<CXBTFFrame>& frames)
+{
+  // frames of a mapped file don't share a file position, so they can be unpacked concurrently
+  if (!reader.IsMapped())
+  {
+    std::vector<uint8_t*> buffers(frames.size(), nullptr);
+    for (size_t i = 0; i < frames.size(); i++)
+      buffers[i] = UnpackFrame(reader, frames[i]);
+    return buffers;
+  }
+
+  std::vector<const uint8_t*> packedData;
+  for (const auto& frame : frames)
+    packedData.push_back(reader.GetFrameData(frame));
+  return UnpackFrames(frames, packedData);
+}
+
+std::vector<uint8_t*> CTextureBundleXBT::UnpackFrames(const std::vector<CXBTFFrame>& frames, const std::vector<const uint8_t*>& packedData)
+{
+  std::vector<uint8_t*> buffers(frames.size(), nullptr);
+
+  unsigned int threads = std::min(static_cast<unsigned int>(frames.size()), std::thread::hardware_concurrency());
+  if (threads < 2)
+  {
+    for (size_t i = 0; i < frames.size(); i++)
+      buffers[i] = UnpackFrame(frames[i], packedData[i]);
+    return buffers;
+  }
+
+  // the textures are waited for by the GUI, so the workers run at its priority
+  CFrameUnpacker unpacker(frames, packedData, buffers);
+  std::vector<std::unique_ptr<CThread>> workers;
+  for (unsigned int i = 1; i < threads; i++)
+  {
+    workers.emplace_back(new CThread(&unpacker, "XBTFUnpacker", XbmcThreads::THREAD_CLASS_DEFAULT));
+    workers.back()->Create();
+  }
+  unpacker.Run();
+
+  for (auto& worker : workers)
+    worker->StopThread();
+
+  return buffers;
+}
@@ -14,9 +14,32 @@
 #include <string>
 #include <vector>
 
+#include <stdint.h>
+
+#include "XBTF.h"
+
 class CBaseTexture;
 class CXBTFReader;
-class CXBTFFrame;
+
+/*!
+ \brief A bundled file with the still packed data of its frames, read from the
+ bundle so that it can be decoded without access to it.
+
+ The frames of a memory mapped bundle are views on the mapping, which is kept
+ alive by the file even if the bundle is reopened meanwhile. Frames of other
+ bundles are read into buffers.
+ */
+struct CXBTFPackedFile
+{
+  CXBTFPackedFile() = default;
+  CXBTFPackedFile(const CXBTFPackedFile&) = delete;
+  CXBTFPackedFile& operator=(const CXBTFPackedFile&) = delete;
+
+  CXBTFFile file;
+  std::vector<const uint8_t*> frames; //!< packed data of each frame
+  std::shared_ptr<const void> mapping; //!< mapping of the bundle the frames point into
+  std::vector<std::vector<uint8_t>> buffers; //!< data of the frames if the bundle isn't mapped
+};
 
 class CTextureBundleXBT
 {
@@ -36,13 +59,36 @@ public:
   int LoadAnim(const std::string& Filename, CBaseTexture*** ppTextures,
                 int &width, int &height, int& nLoops, int** ppDelays);
 
+  /*!
+   \brief Read the packed frames of a file, the only part of loading a texture that accesses the bundle.
+   \return false if the file isn't in the bundle or can't be read.
+   */
+  bool ReadFile(const std::string& Filename, CXBTFPackedFile& packed);
+
+  /*!
+   \brief Decode a file read with ReadFile(), may be called without access to the bundle.
+   */
+  static bool LoadTexture(const std::string& Filename, const CXBTFPackedFile& packed,
+                          CBaseTexture** ppTexture, int &width, int &height);
+  static int LoadAnim(const std::string& Filename, const CXBTFPackedFile& packed,
+                      CBaseTexture*** ppTextures, int &width, int &height, int& nLoops, int** ppDelays);
+
   static uint8_t* UnpackFrame(const CXBTFReader& reader, const CXBTFFrame& frame);
+  static uint8_t* UnpackFrame(const CXBTFFrame& frame, const uint8_t* packedData);
+
+  /*!
+   \brief Unpack several frames, in parallel if the reader is memory mapped.
+   \return one buffer per frame (nullptr on failure), to be released with delete[].
+   */
+  static std::vector<uint8_t*> UnpackFrames(const CXBTFReader& reader, const std::vector<CXBTFFrame>& frames);
+  static std::vector<uint8_t*> UnpackFrames(const std::vector<CXBTFFrame>& frames, const std::vector<const uint8_t*>& packedData);
   
   void CloseBundle();
 
 private:
   bool OpenBundle();
-  bool ConvertFrameToTexture(const std::string& name, CXBTFFrame& frame, CBaseTexture** ppTexture);
+  static bool ReadFrame(const CXBTFReader& reader, const CXBTFFrame& frame, std::vector<uint8_t>& packedData);
+  static CBaseTexture* CreateTexture(const CXBTFFrame& frame, const uint8_t* buffer);
 
   time_t m_TimeStamp;
 
@@ -18,6 +18,9 @@
 #include "threads/SingleLock.h"
 #include "threads/SystemClock.h"
 #include "URL.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/SettingsComponent.h"
+#include "utils/JobManager.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
@@ -198,6 +201,11 @@ bool CTextureMap::IsEmpty() const
   return m_texture.m_textures.empty();
 }
 
+void CTextureMap::AddRef(unsigned int count)
+{
+  m_referenceCount += count;
+}
+
 void CTextureMap::Add(CBaseTexture* texture, int delay)
 {
   m_texture.Add(texture, delay);
@@ -206,6 +214,148 @@ void CTextureMap::Add(CBaseTexture* texture, int delay)
     m_memUsage += sizeof(CTexture) + (texture->GetTextureWidth() * texture->GetTextureHeight() * 4);
 }
 
+/************************************************************************/
+/*                                                                      */
+/************************************************************************/
+CTextureLoadJob::CTextureLoadJob(CGUITextureManager &manager, const std::string &textureName, const std::string &path, int bundle)
+: m_textureName(textureName)
+, m_texture(nullptr)
+, m_width(0)
+, m_height(0)
+, m_manager(manager)
+, m_path(path)
+, m_bundle(bundle)
+{
+}
+
+CTextureLoadJob::~CTextureLoadJob()
+{
+  delete m_texture;
+}
+
+bool CTextureLoadJob::DoWork()
+{
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  m_texture = m_manager.DecodeTexture(m_textureName, m_path, m_bundle, m_width, m_height);
+
+  if (XbmcThreads::SystemClockMillis() - start > 100)
+    CLog::Log(LOGDEBUG, "%s - took %u ms to decode %s", __FUNCTION__, XbmcThreads::SystemClockMillis() - start, m_textureName.c_str());
+
+  return m_texture != nullptr;
+}
+
+/************************************************************************/
+/*                                                                      */
+/************************************************************************/
+CTextureLoadQueue::~CTextureLoadQueue()
+{
+  Clear();
+}
+
+bool CTextureLoadQueue::Add(const std::string& textureName, CJob* job, IJobCallback* callback, bool visible)
+{
+  // hold the lock until the entry exists, the job may complete before AddJob() returns
+  CSingleLock lock(m_section);
+  unsigned int jobID = CJobManager::GetInstance().AddJob(job, callback, visible ? CJob::PRIORITY_NORMAL : CJob::PRIORITY_LOW);
+  if (!jobID)
+  {
+    delete job;
+    return false;
+  }
+
+  CPendingTexture &pending = m_textures[textureName];
+  pending.jobID = jobID;
+  pending.refCount = 1;
+  pending.visible = visible;
+  return true;
+}
+
+bool CTextureLoadQueue::Request(const std::string& textureName, bool firstRequest, bool visible)
+{
+  CSingleLock lock(m_section);
+  auto it = m_textures.find(textureName);
+  if (it == m_textures.end())
+    return false;
+
+  if (firstRequest)
+    it->second.refCount++;
+  it->second.visible |= visible;
+  return true;
+}
+
+bool CTextureLoadQueue::OnDecoded(const std::string& textureName, unsigned int jobID, CBaseTexture* texture, int width, int height)
+{
+  CSingleLock lock(m_section);
+  auto it = m_textures.find(textureName);
+  if (it == m_textures.end() || it->second.jobID != jobID)
+    return false; // released while decoding
+
+  if (!texture)
+  {
+    m_textures.erase(it);
+    return false;
+  }
+
+  it->second.jobID = 0;
+  it->second.texture = texture;
+  it->second.width = width;
+  it->second.height = height;
+  return true;
+}
+
+std::vector<CTextureLoadQueue::CDecodedTexture> CTextureLoadQueue::TakeDecoded(unsigned int count)
+{
+  std::vector<CDecodedTexture> decoded;
+
+  CSingleLock lock(m_section);
+  // visible controls first, then anything else that fits in
+  for (int pass = 0; pass < 2 && decoded.size() < count; pass++)
+  {
+    for (auto it = m_textures.begin(); it != m_textures.end() && decoded.size() < count;)
+    {
+      const CPendingTexture &pending = it->second;
+      if (pending.texture && (pass == 1 || pending.visible))
+      {
+        decoded.push_back({ it->first, pending.texture, pending.width, pending.height, pending.refCount });
+        it = m_textures.erase(it);
+      }
+      else
+        ++it;
+    }
+  }
+
+  return decoded;
+}
+
+bool CTextureLoadQueue::Release(const std::string& textureName)
+{
+  CSingleLock lock(m_section);
+  auto it = m_textures.find(textureName);
+  if (it == m_textures.end())
+    return false;
+
+  if (--it->second.refCount == 0)
+  {
+    if (it->second.jobID)
+      CJobManager::GetInstance().CancelJob(it->second.jobID);
+    delete it->second.texture;
+    m_textures.erase(it);
+  }
+  return true;
+}
+
+void CTextureLoadQueue::Clear()
+{
+  CSingleLock lock(m_section);
+  for (auto &it : m_textures)
+  {
+    if (it.second.jobID)
+      CJobManager::GetInstance().CancelJob(it.second.jobID);
+    delete it.second.texture;
+  }
+  m_textures.clear();
+}
+
 /************************************************************************/
 /*                                                                      */
 /************************************************************************/
@@ -213,10 +363,12 @@ CGUITextureManager::CGUITextureManager(void)
 {
   // we set the theme bundle to be the first bundle (thus prioritizing it)
   m_TexBundle[0].SetThemeBundle(true);
+  CMemoryBudget::GetInstance().RegisterConsumer(this, "textures", MEMORY_PRIORITY_LOW);
 }
 
 CGUITextureManager::~CGUITextureManager(void)
 {
+  CMemoryBudget::GetInstance().UnregisterConsumer(this);
   Cleanup();
 }
 
@@ -262,12 +414,16 @@ bool CGUITextureManager::HasTexture(const std::string &textureName, std::string
     }
   }
 
-  for (int i = 0; i < 2; i++)
   {
-    if (m_TexBundle[i].HasFile(bundledName))
+    // HasFile() may reopen a bundle
+    CSingleLock bundleLock(m_bundleSection);
+    for (int i = 0; i < 2; i++)
     {
-      if (bundle) *bundle = i;
-      return true;
+      if (m_TexBundle[i].HasFile(bundledName))
+      {
+        if (bundle) *bundle = i;
+        return true;
+      }
     }
   }
 
@@ -334,7 +490,15 @@ const CTextureArray& CGUITextureManager::Load(const std::string& strTextureName,
     CBaseTexture **pTextures = nullptr;
     int nLoops = 0, width = 0, height = 0;
     int* Delay = nullptr;
-    int nImages = m_TexBundle[bundle].LoadAnim(strTextureName, &pTextures, width, height, nLoops, &Delay);
+    int nImages = 0;
+    CXBTFPackedFile packed;
+    bool found = false;
+    {
+      CSingleLock bundleLock(m_bundleSection);
+      found = m_TexBundle[bundle].ReadFile(strTextureName, packed);
+    }
+    if (found)
+      nImages = CTextureBundleXBT::LoadAnim(strTextureName, packed, &pTextures, width, height, nLoops, &Delay);
     if (!nImages)
     {
       CLog::Log(LOGERROR, "Texture manager unable to load bundled file: %s", strTextureName.c_str());
@@ -420,25 +584,8 @@ const CTextureArray& CGUITextureManager::Load(const std::string& strTextureName,
     return pMap->GetTexture();
   }
 
-  CBaseTexture *pTexture = NULL;
   int width = 0, height = 0;
-  if (bundle >= 0)
-  {
-    if (!m_TexBundle[bundle].LoadTexture(strTextureName, &pTexture, width, height))
-    {
-      CLog::Log(LOGERROR, "Texture manager unable to load bundled file: %s", strTextureName.c_str());
-      return emptyTexture;
-    }
-  }
-  else
-  {
-    pTexture = CBaseTexture::LoadFromFile(strPath);
-    if (!pTexture)
-      return emptyTexture;
-    width = pTexture->GetWidth();
-    height = pTexture->GetHeight();
-  }
-
+  CBaseTexture *pTexture = DecodeTexture(strTextureName, strPath, bundle, width, height);
   if (!pTexture) return emptyTexture;
 
   CTextureMap* pMap = new CTextureMap(strTextureName, width, height, 0);
@@ -458,8 +605,130 @@ const CTextureArray& CGUITextureManager::Load(const std::string& strTextureName,
 }
 
 
+CBaseTexture* CGUITextureManager::DecodeTexture(const std::string& textureName, const std::string& path, int bundle, int& width, int& height)
+{
+  CBaseTexture *texture = nullptr;
+  if (bundle >= 0)
+  {
+    // only reading from the bundle is serialized, decoding runs in parallel
+    CXBTFPackedFile packed;
+    bool found = false;
+    {
+      CSingleLock lock(m_bundleSection);
+      found = m_TexBundle[bundle].ReadFile(textureName, packed);
+    }
+    if (!found || !CTextureBundleXBT::LoadTexture(textureName, packed, &texture, width, height))
+    {
+      CLog::Log(LOGERROR, "Texture manager unable to load bundled file: %s", textureName.c_str());
+      return nullptr;
+    }
+  }
+  else
+  {
+    texture = CBaseTexture::LoadFromFile(path);
+    if (!texture)
+      return nullptr;
+    width = texture->GetWidth();
+    height = texture->GetHeight();
+  }
+  return texture;
+}
+
+bool CGUITextureManager::IsAsyncLoadingEnabled() const
+{
+  return CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_guiAsyncTextureLoading;
+}
+
+bool CGUITextureManager::LoadAsync(const std::string& textureName, CTextureArray& texture, bool firstRequest, bool visible)
+{
+  texture.Reset();
+  if (textureName.empty())
+    return false;
+
+  // already uploaded?
+  for (int i = 0; i < (int)m_vecTextures.size(); ++i)
+  {
+    CTextureMap *pMap = m_vecTextures[i];
+    if (pMap->GetName() == textureName)
+    {
+      texture = firstRequest ? pMap->GetTexture() : pMap->PeekTexture();
+      return true;
+    }
+  }
+
+  if (m_loadQueue.Request(textureName, firstRequest, visible))
+    return true;
+
+  if (!firstRequest)
+    return false; // decoding failed
+
+  // no need to decode again if it's still waiting to be freed
+  for (ilistUnused i = m_unusedTextures.begin(); i != m_unusedTextures.end(); ++i)
+  {
+    CTextureMap* pMap = i->first;
+    if (pMap->GetName() == textureName && i->second > 0)
+    {
+      m_vecTextures.push_back(pMap);
+      m_unusedTextures.erase(i);
+      texture = pMap->GetTexture();
+      return true;
+    }
+  }
+
+  std::string path;
+  int bundle = -1;
+  if (!HasTexture(textureName, &path, &bundle))
+    return false;
+
+  // animated textures are rare, keep them on the synchronous path
+  if (StringUtils::EndsWithNoCase(path, ".gif") ||
+      StringUtils::EndsWithNoCase(path, ".apng"))
+  {
+    texture = Load(textureName);
+    return texture.size() > 0;
+  }
+
+  if (!m_loadQueue.Add(textureName, new CTextureLoadJob(*this, textureName, path, bundle), this, visible))
+  { // job manager is shutting down
+    texture = Load(textureName);
+    return texture.size() > 0;
+  }
+
+  return true;
+}
+
+void CGUITextureManager::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CTextureLoadJob *loader = static_cast<CTextureLoadJob*>(job);
+
+  if (m_loadQueue.OnDecoded(loader->m_textureName, jobID, success ? loader->m_texture : nullptr, loader->m_width, loader->m_height) && success)
+    loader->m_texture = nullptr; // we want to keep the texture, and jobs are auto-deleted.
+}
+
+void CGUITextureManager::ProcessAsyncLoads()
+{
+  std::vector<CTextureLoadQueue::CDecodedTexture> decoded =
+    m_loadQueue.TakeDecoded(CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_guiAsyncTextureUploads);
+  if (decoded.empty())
+    return;
+
+  CSingleLock lock(CServiceBroker::GetWinSystem()->GetGfxContext());
+  for (auto &it : decoded)
+  {
+    it.texture->LoadToGPU();
+
+    CTextureMap* pMap = new CTextureMap(it.name, it.width, it.height, 0);
+    pMap->Add(it.texture, 100);
+    pMap->AddRef(it.refCount);
+    m_vecTextures.push_back(pMap);
+  }
+}
+
 void CGUITextureManager::ReleaseTexture(const std::string& strTextureName, bool immediately /*= false */)
 {
+  if (m_loadQueue.Release(strTextureName))
+    return;
+
   CSingleLock lock(CServiceBroker::GetWinSystem()->GetGfxContext());
 
   ivecTextures i;
@@ -522,6 +791,8 @@ void CGUITextureManager::ReleaseHwTexture(unsigned int texture)
 
 void CGUITextureManager::Cleanup()
 {
+  m_loadQueue.Clear();
+
   CSingleLock lock(CServiceBroker::GetWinSystem()->GetGfxContext());
 
   ivecTextures i;
@@ -533,10 +804,13 @@ void CGUITextureManager::Cleanup()
     delete pMap;
     i = m_vecTextures.erase(i);
   }
-  m_TexBundle[0].Close();
-  m_TexBundle[1].Close();
-  m_TexBundle[0] = CTextureBundle(true);
-  m_TexBundle[1] = CTextureBundle();
+  {
+    CSingleLock bundleLock(m_bundleSection);
+    m_TexBundle[0].Close();
+    m_TexBundle[1].Close();
+    m_TexBundle[0] = CTextureBundle(true);
+    m_TexBundle[1] = CTextureBundle();
+  }
   FreeUnusedTextures();
 }
 
@@ -574,16 +848,36 @@ void CGUITextureManager::Flush()
   }
 }
 
-unsigned int CGUITextureManager::GetMemoryUsage() const
+size_t CGUITextureManager::GetMemoryUsage() const
 {
-  unsigned int memUsage = 0;
-  for (int i = 0; i < (int)m_vecTextures.size(); ++i)
-  {
-    memUsage += m_vecTextures[i]->GetMemoryUsage();
-  }
+  CSingleLock lock(CServiceBroker::GetWinSystem()->GetGfxContext());
+  size_t memUsage = 0;
+  for (const CTextureMap* texture : m_vecTextures)
+    memUsage += texture->GetMemoryUsage();
+  for (const auto& unused : m_unusedTextures)
+    memUsage += unused.first->GetMemoryUsage();
+  return memUsage;
+}
+
+size_t CGUITextureManager::GetTrimmableMemory() const
+{
+  CSingleLock lock(CServiceBroker::GetWinSystem()->GetGfxContext());
+  size_t memUsage = 0;
+  for (const auto& unused : m_unusedTextures)
+    memUsage += unused.first->GetMemoryUsage();
   return memUsage;
 }
 
+size_t CGUITextureManager::TrimMemory(size_t bytes)
+{
+  // textures in use can't be freed, released ones are usually kept for a few
+  // seconds in case they are needed again
+  CSingleLock lock(CServiceBroker::GetWinSystem()->GetGfxContext());
+  size_t freed = GetTrimmableMemory();
+  FreeUnusedTextures();
+  return freed;
+}
+
 void CGUITextureManager::SetTexturePath(const std::string &texturePath)
 {
   CSingleLock lock(m_section);
@@ -640,6 +934,7 @@ std::string CGUITextureManager::GetTexturePath(const std::string &textureName, b
 
 void CGUITextureManager::GetBundledTexturesFromPath(const std::string& texturePath, std::vector<std::string> &items)
 {
+  CSingleLock bundleLock(m_bundleSection);
   m_TexBundle[0].GetTexturesFromPath(texturePath, items);
   if (items.empty())
     m_TexBundle[1].GetTexturesFromPath(texturePath, items);
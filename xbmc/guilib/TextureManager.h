@@ -9,11 +9,15 @@
 #pragma once
 
 #include <list>
+#include <map>
+#include <string>
 #include <vector>
 #include <utility>
 
 #include "TextureBundle.h"
 #include "threads/CriticalSection.h"
+#include "utils/Job.h"
+#include "utils/MemoryBudget.h"
 
 #include "GUIComponent.h"
 
@@ -65,12 +69,14 @@ public:
 
   const std::string& GetName() const;
   const CTextureArray& GetTexture();
+  const CTextureArray& PeekTexture() const { return m_texture; } ///< as GetTexture() without taking a reference
   void Dump() const;
   uint32_t GetMemoryUsage() const;
   void Flush();
   bool IsEmpty() const;
   void SetHeight(int height);
   void SetWidth(int height);
+  void AddRef(unsigned int count);
 protected:
   void FreeTexture();
 
@@ -80,6 +86,124 @@ protected:
   uint32_t m_memUsage;
 };
 
+class CGUITextureManager;
+
+/*!
+ \ingroup textures,jobs
+ \brief Texture decode job class
+
+ Used by the CGUITextureManager to decode skin textures into CPU memory on a job worker.
+ The GPU upload is done later on the render thread by CGUITextureManager::ProcessAsyncLoads().
+
+ \sa CGUITextureManager and CJob
+ */
+class CTextureLoadJob : public CJob
+{
+public:
+  CTextureLoadJob(CGUITextureManager &manager, const std::string &textureName, const std::string &path, int bundle);
+  ~CTextureLoadJob() override;
+
+  /*!
+   \brief Work function that decodes the texture.
+   */
+  bool DoWork() override;
+  const char *GetType() const override { return "textureload"; }
+
+  std::string m_textureName; ///< name of the texture as requested by the skin
+  CBaseTexture *m_texture;   ///< decoded texture, not yet uploaded to the GPU
+  int m_width;
+  int m_height;
+
+private:
+  CGUITextureManager &m_manager;
+  std::string m_path;
+  int m_bundle;
+};
+
+/*!
+ \ingroup textures,jobs
+ \brief Textures being decoded on a job worker or waiting for their GPU upload
+
+ Pending textures are reference counted as loaded ones. Releasing the last reference cancels the
+ decode job, and a result arriving after that is left to the job to free.
+
+ \sa CGUITextureManager::LoadAsync and CGUITextureManager::ProcessAsyncLoads
+ */
+class CTextureLoadQueue
+{
+public:
+  struct CDecodedTexture
+  {
+    std::string name;
+    CBaseTexture *texture;
+    int width;
+    int height;
+    unsigned int refCount;
+  };
+
+  ~CTextureLoadQueue();
+
+  /*!
+   \brief Start decoding a texture, holding the first reference to it.
+   \param textureName name of the texture.
+   \param job decode job, owned by the queue from here on.
+   \param callback callback to be told once the job completes, which should pass its result to OnDecoded().
+   \param visible true if the texture is needed for a visible control, decoding it with a higher priority.
+   \return true if the job was queued, false if the job manager is shutting down.
+   */
+  bool Add(const std::string& textureName, CJob* job, IJobCallback* callback, bool visible);
+
+  /*!
+   \brief Request a texture that might still be pending.
+   \param textureName name of the texture.
+   \param firstRequest true to add a reference, false if the caller holds one already.
+   \param visible true if the caller is visible, uploading the texture ahead of others.
+   \return true if the texture is pending, false otherwise.
+   */
+  bool Request(const std::string& textureName, bool firstRequest, bool visible);
+
+  /*!
+   \brief Pass the result of a decode job on to the queue.
+   \param textureName name of the texture.
+   \param jobID id of the job that decoded the texture.
+   \param texture decoded texture, or nullptr if decoding failed.
+   \return true if the queue took over the texture, false if it has been released in the meantime.
+   */
+  bool OnDecoded(const std::string& textureName, unsigned int jobID, CBaseTexture* texture, int width, int height);
+
+  /*!
+   \brief Take decoded textures for their GPU upload, those of visible controls first.
+   \param count maximum number of textures to take.
+   \return the decoded textures, owned by the caller.
+   */
+  std::vector<CDecodedTexture> TakeDecoded(unsigned int count);
+
+  /*!
+   \brief Release a reference to a pending texture.
+   \return true if the texture was pending, false otherwise.
+   */
+  bool Release(const std::string& textureName);
+
+  /*!
+   \brief Cancel all decode jobs and free the textures not uploaded yet.
+   */
+  void Clear();
+
+private:
+  struct CPendingTexture
+  {
+    unsigned int jobID = 0;
+    unsigned int refCount = 0;
+    bool visible = false;
+    CBaseTexture *texture = nullptr; ///< decoded, waiting for upload
+    int width = 0;
+    int height = 0;
+  };
+
+  std::map<std::string, CPendingTexture> m_textures;
+  CCriticalSection m_section;
+};
+
 /*!
  \ingroup textures
  \brief
@@ -87,19 +211,49 @@ protected:
 /************************************************************************/
 /*                                                                      */
 /************************************************************************/
-class CGUITextureManager
+class CGUITextureManager : public IJobCallback, public IMemoryConsumer
 {
+  friend class CTextureLoadJob;
+
 public:
   CGUITextureManager(void);
-  virtual ~CGUITextureManager(void);
+  ~CGUITextureManager(void) override;
 
   bool HasTexture(const std::string &textureName, std::string *path = NULL, int *bundle = NULL, int *size = NULL);
   static bool CanLoad(const std::string &texturePath); ///< Returns true if the texture manager can load this texture
   const CTextureArray& Load(const std::string& strTextureName, bool checkBundleOnly = false);
+
+  /*!
+   \brief Request a texture to be decoded in the background.
+
+   Textures are reference counted as with Load(). Only the first request of a control adds a reference;
+   subsequent requests poll for the result. While the texture is decoding (or waiting for its GPU upload)
+   the call returns true with an empty texture, so callers should render nothing and retry next frame.
+   Animated textures are loaded synchronously.
+
+   \param textureName name of the texture to load.
+   \param texture texture object to hold the resulting texture.
+   \param firstRequest true if this is the first time the caller requests this texture.
+   \param visible true if the caller is currently visible, prioritizing decode and upload.
+   \return true if the texture exists and is loaded or loading, false otherwise.
+   \sa ProcessAsyncLoads
+   */
+  bool LoadAsync(const std::string& textureName, CTextureArray& texture, bool firstRequest, bool visible);
+
+  /*!
+   \brief Upload a bounded number of decoded textures to the GPU (called from app thread only, once per frame)
+   */
+  void ProcessAsyncLoads();
+
+  /*!
+   \brief Whether controls should use LoadAsync() rather than Load()
+   */
+  bool IsAsyncLoadingEnabled() const;
+
+  void OnJobComplete(unsigned int jobID, bool success, CJob *job) override;
   void ReleaseTexture(const std::string& strTextureName, bool immediately = false);
   void Cleanup();
   void Dump() const;
-  uint32_t GetMemoryUsage() const;
   void Flush();
   std::string GetTexturePath(const std::string& textureName, bool directory = false);
   void GetBundledTexturesFromPath(const std::string& texturePath, std::vector<std::string> &items);
@@ -110,7 +264,22 @@ public:
 
   void FreeUnusedTextures(unsigned int timeDelay = 0); ///< Free textures (called from app thread only)
   void ReleaseHwTexture(unsigned int texture);
+
+  /*!
+   \brief Get the memory of the loaded textures, including released ones not freed yet
+   */
+  size_t GetMemoryUsage() const override;
+  /*!
+   \brief Get the memory of the released textures not freed yet
+   */
+  size_t GetTrimmableMemory() const override;
+  /*!
+   \brief Free the released textures without waiting for their delay (called from app thread only)
+   */
+  size_t TrimMemory(size_t bytes) override;
 protected:
+  CBaseTexture* DecodeTexture(const std::string& textureName, const std::string& path, int bundle, int& width, int& height);
+
   std::vector<CTextureMap*> m_vecTextures;
   std::list<std::pair<CTextureMap*, unsigned int> > m_unusedTextures;
   std::vector<unsigned int> m_unusedHwTextures;
@@ -121,5 +290,8 @@ protected:
 
   std::vector<std::string> m_texturePaths;
   CCriticalSection m_section;
+
+  CTextureLoadQueue m_loadQueue;
+  CCriticalSection m_bundleSection; ///< guards the bundles and their readers, held for reading only, not for decoding
 };
 
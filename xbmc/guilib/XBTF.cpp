@@ -8,6 +8,7 @@
 
 #include "XBTF.h"
 
+#include <algorithm>
 #include <cstring>
 #include <utility>
 
@@ -223,6 +224,10 @@ std::vector<CXBTFFile> CXBTFBase::GetFiles() const
   for (const auto& file : m_files)
     files.push_back(file.second);
 
+  // keep the order stable for writers and directory listings
+  std::sort(files.begin(), files.end(),
+            [](const CXBTFFile& lhs, const CXBTFFile& rhs) { return lhs.GetPath() < rhs.GetPath(); });
+
   return files;
 }
 
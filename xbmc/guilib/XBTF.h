@@ -9,8 +9,8 @@
 #pragma once
 
 #include <ctime>
-#include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <stdint.h>
@@ -104,5 +104,5 @@ public:
 protected:
   CXBTFBase() = default;
 
-  std::map<std::string, CXBTFFile> m_files;
+  std::unordered_map<std::string, CXBTFFile> m_files;
 };
@@ -10,6 +10,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <system_error>
 
 #include "XBTFReader.h"
 #include "guilib/XBTF.h"
@@ -63,7 +64,7 @@ CXBTFReader::~CXBTFReader()
   Close();
 }
 
-bool CXBTFReader::Open(const std::string& path)
+bool CXBTFReader::Open(const std::string& path, bool map /* = true */)
 {
   if (path.empty())
     return false;
@@ -164,6 +165,24 @@ bool CXBTFReader::Open(const std::string& path)
   if (pos != GetHeaderSize())
     return false;
 
+#if defined(TARGET_POSIX)
+  // map the whole file so frames can be read without seeking, falling back to fread if this fails
+  struct stat fileStat;
+  if (map && fstat(fileno(m_file), &fileStat) == 0 && fileStat.st_size > 0)
+  {
+    try
+    {
+      m_mapping = std::make_shared<KODI::UTILS::POSIX::CMmap>(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_SHARED, fileno(m_file), 0);
+      // the skin will need most of its textures, so let the kernel read them in ahead of use
+      madvise(m_mapping->Data(), m_mapping->Size(), MADV_WILLNEED);
+    }
+    catch (const std::system_error&)
+    {
+      m_mapping.reset();
+    }
+  }
+#endif
+
   return true;
 }
 
@@ -174,6 +193,10 @@ bool CXBTFReader::IsOpen() const
 
 void CXBTFReader::Close()
 {
+#if defined(TARGET_POSIX)
+  m_mapping.reset();
+#endif
+
   if (m_file != nullptr)
   {
     fclose(m_file);
@@ -196,11 +219,53 @@ time_t CXBTFReader::GetLastModificationTimestamp() const
   return fileStat.st_mtime;
 }
 
+bool CXBTFReader::IsMapped() const
+{
+#if defined(TARGET_POSIX)
+  return m_mapping != nullptr;
+#else
+  return false;
+#endif
+}
+
+const uint8_t* CXBTFReader::GetFrameData(const CXBTFFrame& frame) const
+{
+#if defined(TARGET_POSIX)
+  if (m_mapping == nullptr ||
+      frame.GetOffset() > m_mapping->Size() ||
+      frame.GetPackedSize() > m_mapping->Size() - frame.GetOffset())
+    return nullptr;
+
+  return static_cast<const uint8_t*>(m_mapping->Data()) + frame.GetOffset();
+#else
+  return nullptr;
+#endif
+}
+
+std::shared_ptr<const void> CXBTFReader::GetMapping() const
+{
+#if defined(TARGET_POSIX)
+  return m_mapping;
+#else
+  return nullptr;
+#endif
+}
+
 bool CXBTFReader::Load(const CXBTFFrame& frame, unsigned char* buffer) const
 {
   if (m_file == nullptr)
     return false;
 
+  if (IsMapped())
+  {
+    const uint8_t* data = GetFrameData(frame);
+    if (data == nullptr)
+      return false;
+
+    memcpy(buffer, data, static_cast<size_t>(frame.GetPackedSize()));
+    return true;
+  }
+
 #if defined(TARGET_DARWIN) || defined(TARGET_FREEBSD)
   if (fseeko(m_file, static_cast<off_t>(frame.GetOffset()), SEEK_SET) == -1)
 #elif defined(TARGET_ANDROID)
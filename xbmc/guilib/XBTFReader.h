@@ -16,13 +16,22 @@
 
 #include "XBTF.h"
 
+#if defined(TARGET_POSIX)
+#include "platform/posix/utils/Mmap.h"
+#endif
+
 class CXBTFReader : public CXBTFBase
 {
 public:
   CXBTFReader();
   ~CXBTFReader() override;
 
-  bool Open(const std::string& path);
+  /*!
+   \brief Open a texture bundle.
+   \param path the bundle to open.
+   \param map whether to memory map the bundle if possible, frames are read with stdio otherwise.
+   */
+  bool Open(const std::string& path, bool map = true);
   bool IsOpen() const;
   void Close();
 
@@ -30,9 +39,35 @@ public:
 
   bool Load(const CXBTFFrame& frame, unsigned char* buffer) const;
 
+  /*!
+   \brief Whether the file is memory mapped.
+
+   When mapped, frames can be accessed through GetFrameData() and Load() may be
+   called from several threads at once.
+   */
+  bool IsMapped() const;
+
+  /*!
+   \brief Get a zero-copy view on the (possibly packed) data of a frame.
+   \param frame the frame to get the data of.
+   \return pointer to frame.GetPackedSize() bytes valid until Close(), nullptr if the file isn't mapped.
+   */
+  const uint8_t* GetFrameData(const CXBTFFrame& frame) const;
+
+  /*!
+   \brief Get a reference on the mapping of the file.
+
+   Data returned by GetFrameData() stays valid as long as a reference is held, even after Close().
+   \return nullptr if the file isn't mapped.
+   */
+  std::shared_ptr<const void> GetMapping() const;
+
 private:
   std::string m_path;
   FILE* m_file = nullptr;
+#if defined(TARGET_POSIX)
+  std::shared_ptr<KODI::UTILS::POSIX::CMmap> m_mapping;
+#endif
 };
 
 typedef std::shared_ptr<CXBTFReader> CXBTFReaderPtr;
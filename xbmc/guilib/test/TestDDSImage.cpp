@@ -0,0 +1,141 @@
+/*
+ *  Copyright (C) 2005-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "guilib/DDSImage.h"
+#include "guilib/TextureFormats.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+std::vector<unsigned char> CreateGradient(unsigned int width, unsigned int height, bool alpha)
+{
+  std::vector<unsigned char> pixels(width * height * 4);
+  for (unsigned int y = 0; y < height; y++)
+  {
+    for (unsigned int x = 0; x < width; x++)
+    {
+      unsigned char *p = &pixels[(y * width + x) * 4];
+      p[0] = static_cast<unsigned char>(x * 255 / width);
+      p[1] = static_cast<unsigned char>(y * 255 / height);
+      p[2] = static_cast<unsigned char>((x + y) * 255 / (width + height));
+      p[3] = alpha ? static_cast<unsigned char>(255 - x * 255 / width) : 255;
+    }
+  }
+  return pixels;
+}
+
+double GetPSNR(const std::vector<unsigned char> &a, const std::vector<unsigned char> &b, unsigned int channels)
+{
+  double mse = 0;
+  size_t count = 0;
+  for (size_t i = 0; i < a.size(); i += 4)
+  {
+    for (unsigned int c = 0; c < 4; c++)
+    {
+      if (!(channels & (1 << c)))
+        continue;
+      double d = static_cast<double>(a[i + c]) - b[i + c];
+      mse += d * d;
+      count++;
+    }
+  }
+  mse /= count;
+  if (mse == 0)
+    return 100.0;
+  return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+}
+
+TEST(TestDDSImage, CompressOpaque)
+{
+  std::vector<unsigned char> pixels = CreateGradient(64, 64, false);
+  CDDSImage image;
+  ASSERT_TRUE(image.Compress(64, 64, 64 * 4, pixels.data(), false));
+  EXPECT_EQ(static_cast<unsigned int>(XB_FMT_DXT1), image.GetFormat());
+  EXPECT_EQ(16u * 16u * 8u, image.GetSize());
+  EXPECT_EQ(64u, image.GetWidth());
+  EXPECT_EQ(64u, image.GetHeight());
+
+  std::vector<unsigned char> decoded(pixels.size());
+  ASSERT_TRUE(image.Decompress(decoded.data(), 64 * 4));
+  EXPECT_GT(GetPSNR(pixels, decoded, 7), 32.0);
+  for (size_t i = 3; i < decoded.size(); i += 4)
+    EXPECT_EQ(255, decoded[i]);
+}
+
+TEST(TestDDSImage, CompressAlpha)
+{
+  std::vector<unsigned char> pixels = CreateGradient(64, 64, true);
+  CDDSImage image;
+  ASSERT_TRUE(image.Compress(64, 64, 64 * 4, pixels.data(), true));
+  EXPECT_EQ(static_cast<unsigned int>(XB_FMT_DXT5), image.GetFormat());
+  EXPECT_EQ(16u * 16u * 16u, image.GetSize());
+
+  std::vector<unsigned char> decoded(pixels.size());
+  ASSERT_TRUE(image.Decompress(decoded.data(), 64 * 4));
+  EXPECT_GT(GetPSNR(pixels, decoded, 7), 32.0);
+  EXPECT_GT(GetPSNR(pixels, decoded, 8), 40.0);
+}
+
+TEST(TestDDSImage, SolidColor)
+{
+  // colour exactly representable in 565
+  std::vector<unsigned char> pixels(8 * 8 * 4);
+  for (size_t i = 0; i < pixels.size(); i += 4)
+  {
+    pixels[i + 0] = 0x08;
+    pixels[i + 1] = 0x82;
+    pixels[i + 2] = 0xff;
+    pixels[i + 3] = 0xff;
+  }
+  CDDSImage image;
+  ASSERT_TRUE(image.Compress(8, 8, 8 * 4, pixels.data(), false));
+  std::vector<unsigned char> decoded(pixels.size());
+  ASSERT_TRUE(image.Decompress(decoded.data(), 8 * 4));
+  EXPECT_EQ(pixels, decoded);
+}
+
+TEST(TestDDSImage, PartialBlocks)
+{
+  std::vector<unsigned char> pixels = CreateGradient(13, 7, true);
+  CDDSImage image;
+  ASSERT_TRUE(image.Compress(13, 7, 13 * 4, pixels.data(), true));
+  EXPECT_EQ(4u * 2u * 16u, image.GetSize());
+
+  std::vector<unsigned char> decoded(pixels.size());
+  ASSERT_TRUE(image.Decompress(decoded.data(), 13 * 4));
+  EXPECT_GT(GetPSNR(pixels, decoded, 15), 20.0);
+}
+
+TEST(TestDDSImage, DISABLED_Benchmark)
+{
+  const unsigned int width = 1920;
+  const unsigned int height = 1080;
+  std::vector<unsigned char> pixels = CreateGradient(width, height, false);
+  std::vector<unsigned char> decoded(pixels.size());
+  CDDSImage image;
+
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_TRUE(image.Compress(width, height, width * 4, pixels.data(), false));
+  auto encoded = std::chrono::steady_clock::now();
+  ASSERT_TRUE(image.Decompress(decoded.data(), width * 4));
+  auto end = std::chrono::steady_clock::now();
+
+  printf("DXT1 %ux%u: encode %.1f ms, decode %.1f ms, %u -> %u bytes, PSNR %.1f dB\n", width, height,
+         std::chrono::duration<double, std::milli>(encoded - start).count(),
+         std::chrono::duration<double, std::milli>(end - encoded).count(),
+         width * height * 4, image.GetSize(), GetPSNR(pixels, decoded, 7));
+}
@@ -0,0 +1,220 @@
+/*
+ *  Copyright (C) 2005-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "guilib/Texture.h"
+#include "guilib/TextureManager.h"
+#include "threads/Event.h"
+#include "utils/Job.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+const unsigned int JOB_TIMEOUT = 5000;
+
+/*!
+ \brief Texture that is never uploaded, counting how often it gets freed
+ */
+class CTestTexture : public CBaseTexture
+{
+public:
+  explicit CTestTexture(std::atomic<int>& freed) : CBaseTexture(1, 1), m_freed(freed) {}
+  ~CTestTexture() override { m_freed++; }
+
+  void CreateTextureObject() override {}
+  void DestroyTextureObject() override {}
+  void LoadToGPU() override {}
+  void BindToUnit(unsigned int unit) override {}
+
+private:
+  std::atomic<int>& m_freed;
+};
+
+class CTestDecodeJob : public CJob
+{
+public:
+  CTestDecodeJob(const std::string& textureName, CEvent* decode, CEvent* deleted)
+    : m_textureName(textureName), m_decode(decode), m_deleted(deleted)
+  {
+  }
+
+  ~CTestDecodeJob() override
+  {
+    if (m_deleted)
+      m_deleted->Set();
+  }
+
+  bool DoWork() override
+  {
+    if (m_decode)
+      m_decode->Wait();
+    return true;
+  }
+
+  const char* GetType() const override { return "testtextureload"; }
+
+  std::string m_textureName;
+
+private:
+  CEvent* m_decode;
+  CEvent* m_deleted;
+};
+
+/*!
+ \brief Stands in for CGUITextureManager, passing a decoded texture for each completed job to the queue
+ */
+class CTestLoader : public IJobCallback
+{
+public:
+  /*!
+   \param decode event to wait for before decoding, nullptr to decode right away.
+   \param deleted event to set once the job is gone.
+   */
+  bool Load(const std::string& textureName, bool visible, CEvent* decode = nullptr, CEvent* deleted = nullptr)
+  {
+    return m_queue.Add(textureName, new CTestDecodeJob(textureName, decode, deleted), this, visible);
+  }
+
+  void OnJobComplete(unsigned int jobID, bool success, CJob* job) override
+  {
+    CBaseTexture* texture = new CTestTexture(m_freed);
+    if (!m_queue.OnDecoded(static_cast<CTestDecodeJob*>(job)->m_textureName, jobID, texture, 1, 1))
+      delete texture;
+
+    m_completed++;
+    m_completedEvent.Set();
+  }
+
+  bool WaitForJobs(int count)
+  {
+    while (m_completed < count)
+    {
+      if (!m_completedEvent.WaitMSec(JOB_TIMEOUT))
+        return false;
+    }
+    return true;
+  }
+
+  std::vector<std::string> Upload(unsigned int count)
+  {
+    std::vector<std::string> names;
+    for (const auto& decoded : m_queue.TakeDecoded(count))
+    {
+      names.push_back(decoded.name);
+      delete decoded.texture;
+    }
+    return names;
+  }
+
+  std::atomic<int> m_freed{0};
+  std::atomic<int> m_completed{0};
+  CEvent m_completedEvent;
+  CTextureLoadQueue m_queue;
+};
+
+}
+
+TEST(TestTextureLoadQueue, BoundsUploadsPerFrame)
+{
+  CTestLoader loader;
+  for (int i = 0; i < 6; i++)
+    ASSERT_TRUE(loader.Load("texture" + std::to_string(i), false));
+  ASSERT_TRUE(loader.WaitForJobs(6));
+
+  EXPECT_EQ(4U, loader.Upload(4).size());
+  EXPECT_EQ(2U, loader.Upload(4).size());
+  EXPECT_TRUE(loader.Upload(4).empty());
+  EXPECT_EQ(6, loader.m_freed);
+}
+
+TEST(TestTextureLoadQueue, UploadsVisibleTexturesFirst)
+{
+  CTestLoader loader;
+  ASSERT_TRUE(loader.Load("a", false));
+  ASSERT_TRUE(loader.Load("b", false));
+  ASSERT_TRUE(loader.Load("c", false));
+  ASSERT_TRUE(loader.Load("d", true));
+
+  // a control showing the texture makes it visible
+  EXPECT_TRUE(loader.m_queue.Request("b", false, true));
+  ASSERT_TRUE(loader.WaitForJobs(4));
+
+  std::vector<std::string> visible = loader.Upload(2);
+  std::sort(visible.begin(), visible.end());
+  EXPECT_EQ(std::vector<std::string>({ "b", "d" }), visible);
+
+  std::vector<std::string> hidden = loader.Upload(2);
+  std::sort(hidden.begin(), hidden.end());
+  EXPECT_EQ(std::vector<std::string>({ "a", "c" }), hidden);
+}
+
+TEST(TestTextureLoadQueue, ServesPendingTexturesUntilUploaded)
+{
+  CTestLoader loader;
+  CEvent decode(true);
+  ASSERT_TRUE(loader.Load("texture", false, &decode));
+
+  // controls get the pending placeholder while decoding, a second control adds a reference
+  EXPECT_TRUE(loader.m_queue.Request("texture", false, false));
+  EXPECT_TRUE(loader.m_queue.Request("texture", true, false));
+  EXPECT_FALSE(loader.m_queue.Request("missing", true, false));
+  EXPECT_TRUE(loader.m_queue.TakeDecoded(4).empty());
+
+  decode.Set();
+  ASSERT_TRUE(loader.WaitForJobs(1));
+
+  // still pending until uploaded
+  EXPECT_TRUE(loader.m_queue.Request("texture", false, false));
+
+  std::vector<CTextureLoadQueue::CDecodedTexture> decoded = loader.m_queue.TakeDecoded(4);
+  ASSERT_EQ(1U, decoded.size());
+  EXPECT_EQ("texture", decoded[0].name);
+  EXPECT_EQ(2U, decoded[0].refCount);
+  delete decoded[0].texture;
+
+  EXPECT_FALSE(loader.m_queue.Request("texture", false, false));
+}
+
+TEST(TestTextureLoadQueue, CancelsReleasedLoads)
+{
+  CTestLoader loader;
+  CEvent decode(true);
+  CEvent deleted(true);
+  ASSERT_TRUE(loader.Load("texture", true, &decode, &deleted));
+  EXPECT_TRUE(loader.m_queue.Request("texture", true, true));
+
+  // the job keeps going while a reference is left
+  EXPECT_TRUE(loader.m_queue.Release("texture"));
+  EXPECT_TRUE(loader.m_queue.Request("texture", false, true));
+
+  EXPECT_TRUE(loader.m_queue.Release("texture"));
+  EXPECT_FALSE(loader.m_queue.Request("texture", false, true));
+
+  // the cancelled job isn't reported, whether it was running or not
+  decode.Set();
+  ASSERT_TRUE(deleted.WaitMSec(JOB_TIMEOUT));
+  EXPECT_EQ(0, loader.m_completed);
+  EXPECT_TRUE(loader.m_queue.TakeDecoded(4).empty());
+
+  // a late result for a released texture is left to its job
+  CTestTexture late(loader.m_freed);
+  EXPECT_FALSE(loader.m_queue.OnDecoded("texture", 1, &late, 1, 1));
+
+  // textures decoded but not uploaded yet are freed on release
+  ASSERT_TRUE(loader.Load("decoded", false));
+  ASSERT_TRUE(loader.WaitForJobs(1));
+  EXPECT_TRUE(loader.m_queue.Release("decoded"));
+  EXPECT_EQ(1, loader.m_freed);
+  EXPECT_TRUE(loader.m_queue.TakeDecoded(4).empty());
+}
@@ -0,0 +1,318 @@
+/*
+ *  Copyright (C) 2005-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "guilib/TextureBundleXBT.h"
+#include "guilib/XBTFReader.h"
+#include "test/TestUtils.h"
+#include "utils/EndianSwap.h"
+#include "utils/StringUtils.h"
+
+#include <lzo/lzo1x.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+const unsigned int TEST_FILES = 100;
+const unsigned int TEST_ANIMATION_FRAMES = 8;
+const uint32_t TEST_FRAME_SIZE = 16;
+
+std::vector<uint8_t> GetPixels(unsigned int seed)
+{
+  std::vector<uint8_t> pixels(TEST_FRAME_SIZE * TEST_FRAME_SIZE * 4);
+  for (size_t i = 0; i < pixels.size(); i++)
+    pixels[i] = static_cast<uint8_t>((i / 64) * 7 + seed); // runs of equal bytes, so lzo has something to pack
+  return pixels;
+}
+
+void AppendUInt32(std::vector<uint8_t>& data, uint32_t value)
+{
+  value = Endian_SwapLE32(value);
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+  data.insert(data.end(), bytes, bytes + sizeof(value));
+}
+
+void AppendUInt64(std::vector<uint8_t>& data, uint64_t value)
+{
+  value = Endian_SwapLE64(value);
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+  data.insert(data.end(), bytes, bytes + sizeof(value));
+}
+
+/*!
+ \brief A small bundle written to a temporary file: TEST_FILES still images stored as they are
+ and one lzo packed animation.
+ */
+class CTestBundle
+{
+public:
+  struct TestFile
+  {
+    std::string path;
+    std::vector<std::vector<uint8_t>> frames; // unpacked pixels
+    bool packed;
+  };
+
+  CTestBundle()
+  {
+    for (unsigned int i = 0; i < TEST_FILES; i++)
+      m_files.push_back({ StringUtils::Format("images/image%u.png", i), { GetPixels(i) }, false });
+
+    TestFile animation{ "animations/animation.gif", {}, true };
+    for (unsigned int i = 0; i < TEST_ANIMATION_FRAMES; i++)
+      animation.frames.push_back(GetPixels(TEST_FILES + i));
+    m_files.push_back(animation);
+
+    m_file = XBMC_CREATETEMPFILE(".xbt");
+    if (m_file)
+    {
+      const std::vector<uint8_t> bundle = Serialize();
+      m_file->Write(bundle.data(), bundle.size());
+      m_file->Close();
+    }
+  }
+
+  ~CTestBundle()
+  {
+    XBMC_DELETETEMPFILE(m_file);
+  }
+
+  std::string GetPath() const { return m_file ? XBMC_TEMPFILEPATH(m_file) : ""; }
+  const std::vector<TestFile>& GetFiles() const { return m_files; }
+  const TestFile& GetAnimation() const { return m_files.back(); }
+
+private:
+  std::vector<uint8_t> Serialize() const
+  {
+    // the frame data follows the header, which has a fixed size per file and frame
+    uint64_t offset = XBTF_MAGIC.size() + XBTF_VERSION.size() + sizeof(uint32_t);
+    for (const auto& file : m_files)
+      offset += CXBTFFile::MaximumPathLength + 2 * sizeof(uint32_t) + file.frames.size() * (4 * sizeof(uint32_t) + 3 * sizeof(uint64_t));
+
+    std::vector<uint8_t> header(XBTF_MAGIC.begin(), XBTF_MAGIC.end());
+    header.insert(header.end(), XBTF_VERSION.begin(), XBTF_VERSION.end());
+    AppendUInt32(header, static_cast<uint32_t>(m_files.size()));
+
+    std::vector<uint8_t> data;
+    for (const auto& file : m_files)
+    {
+      std::vector<uint8_t> path(CXBTFFile::MaximumPathLength, 0);
+      memcpy(path.data(), file.path.c_str(), file.path.size());
+      header.insert(header.end(), path.begin(), path.end());
+      AppendUInt32(header, 0); // loop
+      AppendUInt32(header, static_cast<uint32_t>(file.frames.size()));
+
+      for (const auto& pixels : file.frames)
+      {
+        std::vector<uint8_t> stored = file.packed ? Pack(pixels) : pixels;
+        AppendUInt32(header, TEST_FRAME_SIZE);
+        AppendUInt32(header, TEST_FRAME_SIZE);
+        AppendUInt32(header, XB_FMT_A8R8G8B8);
+        AppendUInt64(header, stored.size());
+        AppendUInt64(header, pixels.size());
+        AppendUInt32(header, 100); // duration
+        AppendUInt64(header, offset + data.size());
+        data.insert(data.end(), stored.begin(), stored.end());
+      }
+    }
+
+    header.insert(header.end(), data.begin(), data.end());
+    return header;
+  }
+
+  static std::vector<uint8_t> Pack(const std::vector<uint8_t>& pixels)
+  {
+    std::vector<uint8_t> packed(pixels.size() + pixels.size() / 16 + 64 + 3);
+    std::vector<uint8_t> workMemory(LZO1X_1_MEM_COMPRESS);
+    lzo_uint size = packed.size();
+    if (lzo_init() != LZO_E_OK ||
+        lzo1x_1_compress(pixels.data(), pixels.size(), packed.data(), &size, workMemory.data()) != LZO_E_OK)
+      return pixels;
+
+    packed.resize(size);
+    return packed;
+  }
+
+  std::vector<TestFile> m_files;
+  XFILE::CFile* m_file = nullptr;
+};
+
+void ExpectFrame(const std::vector<uint8_t>& expected, const uint8_t* buffer)
+{
+  ASSERT_NE(nullptr, buffer);
+  EXPECT_EQ(0, memcmp(expected.data(), buffer, expected.size()));
+}
+
+double UnpackAll(const CXBTFReader& reader, const std::vector<CXBTFFrame>& frames, bool parallel)
+{
+  auto start = std::chrono::steady_clock::now();
+  std::vector<uint8_t*> buffers;
+  if (parallel)
+    buffers = CTextureBundleXBT::UnpackFrames(reader, frames);
+  else
+  {
+    for (const auto& frame : frames)
+      buffers.push_back(CTextureBundleXBT::UnpackFrame(reader, frame));
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  for (auto buffer : buffers)
+  {
+    EXPECT_NE(nullptr, buffer);
+    delete[] buffer;
+  }
+
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+}
+
+TEST(TestXBTFReader, DISABLED_Benchmark)
+{
+  // Textures.xbt is generated at build time
+  std::string path = CSpecialProtocol::TranslatePath("special://xbmc/addons/skin.estuary/media/Textures.xbt");
+
+  auto start = std::chrono::steady_clock::now();
+  CXBTFReader reader;
+  ASSERT_TRUE(reader.Open(path)) << "unable to open " << path;
+  auto opened = std::chrono::steady_clock::now();
+
+  std::vector<CXBTFFrame> frames;
+  for (const auto& file : reader.GetFiles())
+  {
+    CXBTFFile entry;
+    ASSERT_TRUE(reader.Get(file.GetPath(), entry));
+    frames.insert(frames.end(), entry.GetFrames().begin(), entry.GetFrames().end());
+  }
+  auto lookedUp = std::chrono::steady_clock::now();
+
+  double serial = UnpackAll(reader, frames, false);
+  double parallel = UnpackAll(reader, frames, true);
+
+  printf("%s (%s): open %.1f ms, %zu lookups %.1f ms, unpack %zu frames serial %.1f ms, parallel %.1f ms\n",
+         path.c_str(), reader.IsMapped() ? "mapped" : "not mapped",
+         std::chrono::duration<double, std::milli>(opened - start).count(),
+         reader.GetFiles().size(),
+         std::chrono::duration<double, std::milli>(lookedUp - opened).count(),
+         frames.size(), serial, parallel);
+}
+
+#if defined(TARGET_POSIX)
+TEST(TestXBTFReader, ReadsMappedFrames)
+{
+  CTestBundle bundle;
+  CXBTFReader reader;
+  ASSERT_TRUE(reader.Open(bundle.GetPath()));
+  ASSERT_TRUE(reader.IsMapped());
+
+  const auto& expected = bundle.GetFiles().front();
+  CXBTFFile file;
+  ASSERT_TRUE(reader.Get(expected.path, file));
+  ASSERT_EQ(1U, file.GetFrames().size());
+  const CXBTFFrame& frame = file.GetFrames().front();
+  EXPECT_FALSE(frame.IsPacked());
+
+  // the frame is viewed in place and stays valid as long as the mapping is referenced
+  const uint8_t* data = reader.GetFrameData(frame);
+  ExpectFrame(expected.frames.front(), data);
+  std::shared_ptr<const void> mapping = reader.GetMapping();
+  ASSERT_NE(nullptr, mapping);
+  reader.Close();
+  ExpectFrame(expected.frames.front(), data);
+}
+#endif
+
+TEST(TestXBTFReader, ReadsFramesWithoutMapping)
+{
+  CTestBundle bundle;
+  CXBTFReader reader;
+  ASSERT_TRUE(reader.Open(bundle.GetPath(), false));
+  EXPECT_FALSE(reader.IsMapped());
+  EXPECT_EQ(nullptr, reader.GetMapping());
+
+  const auto& expected = bundle.GetFiles().front();
+  CXBTFFile file;
+  ASSERT_TRUE(reader.Get(expected.path, file));
+  const CXBTFFrame& frame = file.GetFrames().front();
+  EXPECT_EQ(nullptr, reader.GetFrameData(frame));
+
+  std::vector<uint8_t> buffer(static_cast<size_t>(frame.GetPackedSize()));
+  ASSERT_TRUE(reader.Load(frame, buffer.data()));
+  ExpectFrame(expected.frames.front(), buffer.data());
+
+  // packed frames are read with stdio and unpacked
+  CXBTFFile animation;
+  ASSERT_TRUE(reader.Get(bundle.GetAnimation().path, animation));
+  for (size_t i = 0; i < animation.GetFrames().size(); i++)
+  {
+    EXPECT_TRUE(animation.GetFrames()[i].IsPacked());
+    std::unique_ptr<uint8_t[]> unpacked(CTextureBundleXBT::UnpackFrame(reader, animation.GetFrames()[i]));
+    ExpectFrame(bundle.GetAnimation().frames[i], unpacked.get());
+  }
+}
+
+TEST(TestXBTFReader, LooksUpFilesByName)
+{
+  CTestBundle bundle;
+  CXBTFReader reader;
+  ASSERT_TRUE(reader.Open(bundle.GetPath()));
+
+  for (const auto& expected : bundle.GetFiles())
+  {
+    CXBTFFile file;
+    ASSERT_TRUE(reader.Get(expected.path, file)) << expected.path;
+    EXPECT_EQ(expected.path, file.GetPath());
+    ASSERT_EQ(expected.frames.size(), file.GetFrames().size());
+
+    std::unique_ptr<uint8_t[]> unpacked(CTextureBundleXBT::UnpackFrame(reader, file.GetFrames().front()));
+    ExpectFrame(expected.frames.front(), unpacked.get());
+  }
+
+  EXPECT_FALSE(reader.Exists("images/missing.png"));
+  EXPECT_FALSE(reader.Exists("images/"));
+
+  // listed in the order of their paths
+  const std::vector<CXBTFFile> files = reader.GetFiles();
+  ASSERT_EQ(bundle.GetFiles().size(), files.size());
+  for (size_t i = 1; i < files.size(); i++)
+    EXPECT_LT(files[i - 1].GetPath(), files[i].GetPath());
+}
+
+TEST(TestXBTFReader, UnpacksFramesInParallel)
+{
+  CTestBundle bundle;
+  const auto& expected = bundle.GetAnimation();
+
+  // frames of a mapped bundle are unpacked in parallel, the others serially
+  for (bool map : { true, false })
+  {
+    CXBTFReader reader;
+    ASSERT_TRUE(reader.Open(bundle.GetPath(), map));
+
+    CXBTFFile animation;
+    ASSERT_TRUE(reader.Get(expected.path, animation));
+    std::vector<uint8_t*> buffers = CTextureBundleXBT::UnpackFrames(reader, animation.GetFrames());
+    ASSERT_EQ(expected.frames.size(), buffers.size());
+
+    for (size_t i = 0; i < buffers.size(); i++)
+    {
+      ExpectFrame(expected.frames[i], buffers[i]);
+      delete[] buffers[i];
+    }
+  }
+}
@@ -21,12 +21,34 @@
 #include "utils/JSONVariantParser.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
+#include "utils/Trace.h"
 #include "utils/URIUtils.h"
 #include "utils/Variant.h"
+#include <algorithm>
 #include <stdlib.h>
 
 using namespace KODI::MESSAGING;
 
+#if defined(HAS_TRACING)
+/*! \brief Write the recorded tracing spans to a file.
+ *  \param params The parameters.
+ *  \details params[0] = Number of seconds to dump, counting back from now (optional).
+ *           params[1] = The file to write to (optional).
+ */
+static int DumpTrace(const std::vector<std::string>& params)
+{
+  unsigned int seconds = 10;
+  if (!params.empty())
+    seconds = std::max(1, atoi(params[0].c_str()));
+
+  std::string file = "special://temp/trace.json";
+  if (params.size() > 1)
+    file = params[1];
+
+  return CTrace::Dump(file, seconds * 1000) ? 0 : -1;
+}
+#endif
+
 /*! \brief Extract an archive.
  *  \param params The parameters
  *  \details params[0] = The archive URL.
@@ -152,6 +174,14 @@ static int WakeOnLAN(const std::vector<std::string>& params)
 ///     Function,
 ///     Description }
 ///   \table_row2_l{
+///     <b>`DumpTrace([seconds\, file])`</b>
+///     ,
+///     Writes the tracing spans recorded during the last seconds to a file in the
+///     Chrome trace event format. Only available in builds with ENABLE_TRACING.
+///     @param[in] seconds               Number of seconds to dump (optional\, default 10).
+///     @param[in] file                  File to write to (optional\, default special://temp/trace.json).
+///   }
+///   \table_row2_l{
 ///     <b>`Extract(url [\, dest])`</b>
 ///     ,
 ///     Extracts a specified archive to an optionally specified 'absolute' path.
@@ -203,6 +233,9 @@ static int WakeOnLAN(const std::vector<std::string>& params)
 CBuiltins::CommandMap CApplicationBuiltins::GetOperations() const
 {
   return {
+#if defined(HAS_TRACING)
+           {"dumptrace", {"Writes the recorded tracing spans to a file", 0, DumpTrace}},
+#endif
            {"extract", {"Extracts the specified archive", 1, Extract}},
            {"mute", {"Mute the player", 0, Mute}},
            {"notifyall", {"Notify all connected clients", 2, NotifyAll}},
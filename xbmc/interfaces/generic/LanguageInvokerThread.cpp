@@ -11,7 +11,7 @@
 
 CLanguageInvokerThread::CLanguageInvokerThread(LanguageInvokerPtr invoker, CScriptInvocationManager *invocationManager, bool reuseable)
   : ILanguageInvoker(NULL),
-    CThread("LanguageInvoker"),
+    CThread("LanguageInvoker", XbmcThreads::THREAD_CLASS_DEFAULT),
     m_invoker(invoker),
     m_invocationManager(invocationManager),
     m_reusable(reuseable)
@@ -500,7 +500,7 @@ JSONRPC_STATUS CAudioLibrary::GetRecentlyAddedAlbums(const std::string &method,
   if (ret != OK)
     return ret;
 
-  HandleFileItemList("albumid", false, "albums", items, parameterObject, result);
+  StreamFileItemList("albumid", false, "albums", items, parameterObject, result);
   return OK;
 }
 
@@ -522,7 +522,7 @@ JSONRPC_STATUS CAudioLibrary::GetRecentlyAddedSongs(const std::string &method, I
   if (ret != OK)
     return ret;
 
-  HandleFileItemList("songid", true, "songs", items, parameterObject, result);
+  StreamFileItemList("songid", true, "songs", items, parameterObject, result);
   return OK;
 }
 
@@ -550,7 +550,7 @@ JSONRPC_STATUS CAudioLibrary::GetRecentlyPlayedAlbums(const std::string &method,
   if (ret != OK)
     return ret;
 
-  HandleFileItemList("albumid", false, "albums", items, parameterObject, result);
+  StreamFileItemList("albumid", false, "albums", items, parameterObject, result);
   return OK;
 }
 
@@ -568,7 +568,7 @@ JSONRPC_STATUS CAudioLibrary::GetRecentlyPlayedSongs(const std::string &method,
   if (ret != OK)
     return ret;
 
-  HandleFileItemList("songid", true, "songs", items, parameterObject, result);
+  StreamFileItemList("songid", true, "songs", items, parameterObject, result);
   return OK;
 }
 
@@ -590,7 +590,7 @@ JSONRPC_STATUS CAudioLibrary::GetGenres(const std::string &method, ITransportLay
   if (!musicdatabase.GetGenresJSON(items, sourcesneeded))
     return InternalError;
 
-  HandleFileItemList("genreid", false, "genres", items, parameterObject, result);
+  StreamFileItemList("genreid", false, "genres", items, parameterObject, result);
   return OK;
 }
 
@@ -608,7 +608,7 @@ JSONRPC_STATUS CAudioLibrary::GetRoles(const std::string &method, ITransportLaye
   for (unsigned int i = 0; i < (unsigned int)items.Size(); i++)
     items[i]->GetMusicInfoTag()->SetTitle(items[i]->GetLabel());
 
-  HandleFileItemList("roleid", false, "roles", items, parameterObject, result);
+  StreamFileItemList("roleid", false, "roles", items, parameterObject, result);
   return OK;
 }
 
@@ -629,7 +629,7 @@ JSONRPC_STATUS JSONRPC::CAudioLibrary::GetSources(const std::string& method, ITr
   if (!musicdatabase.GetSources(items))
     return InternalError;
 
-  HandleFileItemList("sourceid", true, "sources", items, param, result);
+  StreamFileItemList("sourceid", true, "sources", items, param, result);
   return OK;
 }
 
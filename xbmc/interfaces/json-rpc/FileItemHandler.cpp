@@ -7,6 +7,7 @@
  */
 
 #include <map>
+#include <memory>
 #include <string.h>
 
 #include "FileItemHandler.h"
@@ -16,6 +17,7 @@
 #include "utils/SortUtils.h"
 #include "utils/URIUtils.h"
 #include "utils/ISerializable.h"
+#include "utils/JSONStreamWriter.h"
 #include "utils/Variant.h"
 #include "video/VideoInfoTag.h"
 #include "music/tags/MusicInfoTag.h"
@@ -198,6 +200,21 @@ void CFileItemHandler::HandleFileItemList(const char *ID, bool allowFile, const
 }
 
 void CFileItemHandler::HandleFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result, int size, bool sortLimit /* = true */)
+{
+  HandleFileItems(ID, allowFile, resultname, items, parameterObject, result, size, sortLimit, false);
+}
+
+void CFileItemHandler::StreamFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result, bool sortLimit /* = true */)
+{
+  HandleFileItems(ID, allowFile, resultname, items, parameterObject, result, items.Size(), sortLimit, true);
+}
+
+void CFileItemHandler::StreamFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result, int size, bool sortLimit /* = true */)
+{
+  HandleFileItems(ID, allowFile, resultname, items, parameterObject, result, size, sortLimit, true);
+}
+
+void CFileItemHandler::HandleFileItems(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result, int size, bool sortLimit, bool stream)
 {
   int start, end;
   HandleLimits(parameterObject, result, size, start, end);
@@ -210,18 +227,6 @@ void CFileItemHandler::HandleFileItemList(const char *ID, bool allowFile, const
     end = items.Size();
   }
 
-  CThumbLoader *thumbLoader = NULL;
-  if (end - start > 0)
-  {
-    if (items.Get(start)->HasVideoInfoTag())
-      thumbLoader = new CVideoThumbLoader();
-    else if (items.Get(start)->HasMusicInfoTag())
-      thumbLoader = new CMusicThumbLoader();
-
-    if (thumbLoader != NULL)
-      thumbLoader->OnLoaderStart();
-  }
-
   std::set<std::string> fields;
   if (parameterObject.isMember("properties") && parameterObject["properties"].isArray())
   {
@@ -229,6 +234,23 @@ void CFileItemHandler::HandleFileItemList(const char *ID, bool allowFile, const
       fields.insert(field->asString());
   }
 
+  if (stream && resultname && end - start > 0)
+  {
+    // the given list usually is a local of the calling method, keep the items until the response is written
+    std::shared_ptr<CFileItemList> list = std::make_shared<CFileItemList>();
+    for (int i = start; i < end; i++)
+      list->Add(items.Get(i));
+
+    if (CJSONRPC::DeferResult(result, resultname, [ID, allowFile, list, fields](CJSONStreamWriter &writer) {
+          return WriteFileItems(ID, allowFile, *list, fields, writer);
+        }))
+      return;
+  }
+
+  CThumbLoader *thumbLoader = NULL;
+  if (end - start > 0)
+    thumbLoader = CreateThumbLoader(items.Get(start));
+
   for (int i = start; i < end; i++)
   {
     CFileItemPtr item = items.Get(i);
@@ -238,6 +260,40 @@ void CFileItemHandler::HandleFileItemList(const char *ID, bool allowFile, const
   delete thumbLoader;
 }
 
+bool CFileItemHandler::WriteFileItems(const char *ID, bool allowFile, const CFileItemList &items, const std::set<std::string> &fields, CJSONStreamWriter &writer)
+{
+  std::unique_ptr<CThumbLoader> thumbLoader(items.IsEmpty() ? NULL : CreateThumbLoader(items.Get(0)));
+
+  if (!writer.StartArray())
+    return false;
+
+  for (int i = 0; i < items.Size(); i++)
+  {
+    // only one item exists as CVariant at a time
+    CVariant object;
+    FillFileItem(ID, allowFile, items.Get(i), fields, object, thumbLoader.get());
+
+    if (!writer.Value(object))
+      return false;
+  }
+
+  return writer.EndArray();
+}
+
+CThumbLoader* CFileItemHandler::CreateThumbLoader(const CFileItemPtr &item)
+{
+  CThumbLoader *thumbLoader = NULL;
+  if (item->HasVideoInfoTag())
+    thumbLoader = new CVideoThumbLoader();
+  else if (item->HasMusicInfoTag())
+    thumbLoader = new CMusicThumbLoader();
+
+  if (thumbLoader != NULL)
+    thumbLoader->OnLoaderStart();
+
+  return thumbLoader;
+}
+
 void CFileItemHandler::HandleFileItem(const char *ID, bool allowFile, const char *resultname, CFileItemPtr item, const CVariant &parameterObject, const CVariant &validFields, CVariant &result, bool append /* = true */, CThumbLoader *thumbLoader /* = NULL */)
 {
   std::set<std::string> fields;
@@ -253,6 +309,19 @@ void CFileItemHandler::HandleFileItem(const char *ID, bool allowFile, const char
 void CFileItemHandler::HandleFileItem(const char *ID, bool allowFile, const char *resultname, CFileItemPtr item, const CVariant &parameterObject, const std::set<std::string> &validFields, CVariant &result, bool append /* = true */, CThumbLoader *thumbLoader /* = NULL */)
 {
   CVariant object;
+  FillFileItem(ID, allowFile, item, validFields, object, thumbLoader);
+
+  if (resultname)
+  {
+    if (append)
+      result[resultname].append(object);
+    else
+      result[resultname] = object;
+  }
+}
+
+void CFileItemHandler::FillFileItem(const char *ID, bool allowFile, const CFileItemPtr &item, const std::set<std::string> &validFields, CVariant &object, CThumbLoader *thumbLoader)
+{
   std::set<std::string> fields(validFields.begin(), validFields.end());
 
   if (item.get())
@@ -341,16 +410,8 @@ void CFileItemHandler::HandleFileItem(const char *ID, bool allowFile, const char
     bool deleteThumbloader = false;
     if (thumbLoader == NULL)
     {
-      if (item->HasVideoInfoTag())
-        thumbLoader = new CVideoThumbLoader();
-      else if (item->HasMusicInfoTag())
-        thumbLoader = new CMusicThumbLoader();
-
-      if (thumbLoader != NULL)
-      {
-        deleteThumbloader = true;
-        thumbLoader->OnLoaderStart();
-      }
+      thumbLoader = CreateThumbLoader(item);
+      deleteThumbloader = thumbLoader != NULL;
     }
 
     if (item->HasPVRChannelInfoTag())
@@ -377,14 +438,6 @@ void CFileItemHandler::HandleFileItem(const char *ID, bool allowFile, const char
   }
   else
     object = CVariant(CVariant::VariantTypeNull);
-
-  if (resultname)
-  {
-    if (append)
-      result[resultname].append(object);
-    else
-      result[resultname] = object;
-  }
 }
 
 bool CFileItemHandler::FillFileItemList(const CVariant &parameterObject, CFileItemList &list)
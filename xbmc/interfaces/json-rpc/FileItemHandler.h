@@ -14,6 +14,7 @@
 #include "JSONUtils.h"
 #include "FileItem.h"
 
+class CJSONStreamWriter;
 class CThumbLoader;
 class CVariant;
 
@@ -25,11 +26,22 @@ namespace JSONRPC
     static void FillDetails(const ISerializable *info, const CFileItemPtr &item, std::set<std::string> &fields, CVariant &result, CThumbLoader *thumbLoader = NULL);
     static void HandleFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result, bool sortLimit = true);
     static void HandleFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result, int size, bool sortLimit = true);
+    /*!
+     \brief Same as HandleFileItemList() but if called for the result of the executing method, the items
+     are serialized one by one while the response is written. The list member of the result must not be
+     accessed afterwards.
+     */
+    static void StreamFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result, bool sortLimit = true);
+    static void StreamFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result, int size, bool sortLimit = true);
     static void HandleFileItem(const char *ID, bool allowFile, const char *resultname, CFileItemPtr item, const CVariant &parameterObject, const CVariant &validFields, CVariant &result, bool append = true, CThumbLoader *thumbLoader = NULL);
     static void HandleFileItem(const char *ID, bool allowFile, const char *resultname, CFileItemPtr item, const CVariant &parameterObject, const std::set<std::string> &validFields, CVariant &result, bool append = true, CThumbLoader *thumbLoader = NULL);
 
     static bool FillFileItemList(const CVariant &parameterObject, CFileItemList &list);
   private:
+    static void HandleFileItems(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result, int size, bool sortLimit, bool stream);
+    static bool WriteFileItems(const char *ID, bool allowFile, const CFileItemList &items, const std::set<std::string> &fields, CJSONStreamWriter &writer);
+    static void FillFileItem(const char *ID, bool allowFile, const CFileItemPtr &item, const std::set<std::string> &validFields, CVariant &object, CThumbLoader *thumbLoader);
+    static CThumbLoader* CreateThumbLoader(const CFileItemPtr &item);
     static void Sort(CFileItemList &items, const CVariant& parameterObject);
     static bool GetField(const std::string &field, const CVariant &info, const CFileItemPtr &item, CVariant &result, bool &fetchedArt, CThumbLoader *thumbLoader = NULL);
   };
@@ -59,7 +59,7 @@ JSONRPC_STATUS CFileOperations::GetRootDirectory(const std::string &method, ITra
     param["properties"] = CVariant(CVariant::VariantTypeArray);
     param["properties"].append("file");
 
-    HandleFileItemList(NULL, true, "sources", items, param, result);
+    StreamFileItemList(NULL, true, "sources", items, param, result);
   }
 
   return OK;
@@ -153,7 +153,7 @@ JSONRPC_STATUS CFileOperations::GetDirectory(const std::string &method, ITranspo
       param["properties"].append("file");
     param["properties"].append("filetype");
 
-    HandleFileItemList("id", true, "files", filteredFiles, param, result);
+    StreamFileItemList("id", true, "files", filteredFiles, param, result);
 
     return OK;
   }
@@ -19,6 +19,7 @@
 #include "playlists/SmartPlayList.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/SettingsComponent.h"
+#include "utils/JSONStreamWriter.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
 #include "utils/Variant.h"
@@ -27,6 +28,18 @@
 
 using namespace JSONRPC;
 
+namespace
+{
+  struct MethodCallContext
+  {
+    const CVariant* result;
+    std::map<std::string, ResultWriter>* deferred;
+  };
+
+  // the method call being executed by the current thread
+  thread_local MethodCallContext* currentMethodCall = nullptr;
+}
+
 bool CJSONRPC::m_initialized = false;
 
 void CJSONRPC::Initialize()
@@ -226,6 +239,7 @@ JSONRPC_STATUS CJSONRPC::NotifyAll(const std::string &method, ITransportLayer *t
 std::string CJSONRPC::MethodCall(const std::string &inputString, ITransportLayer *transport, IClient *client)
 {
   CVariant inputroot, outputroot, result;
+  std::vector<DeferredResults> deferred;
   bool hasResponse = false;
 
   CLog::Log(LOGDEBUG, LOGJSONRPC, "JSONRPC: Incoming request: %s", inputString.c_str());
@@ -245,16 +259,21 @@ std::string CJSONRPC::MethodCall(const std::string &inputString, ITransportLayer
         for (CVariant::const_iterator_array itr = inputroot.begin_array(); itr != inputroot.end_array(); itr++)
         {
           CVariant response;
-          if (HandleMethodCall(*itr, response, transport, client))
+          DeferredResults responseDeferred;
+          if (HandleMethodCall(*itr, response, responseDeferred, transport, client))
           {
-            outputroot.append(response);
+            outputroot.append(std::move(response));
+            deferred.push_back(std::move(responseDeferred));
             hasResponse = true;
           }
         }
       }
     }
     else
-      hasResponse = HandleMethodCall(inputroot, outputroot, transport, client);
+    {
+      deferred.resize(1);
+      hasResponse = HandleMethodCall(inputroot, outputroot, deferred.front(), transport, client);
+    }
   }
   else
   {
@@ -265,12 +284,46 @@ std::string CJSONRPC::MethodCall(const std::string &inputString, ITransportLayer
 
   std::string str;
   if (hasResponse)
-    CJSONVariantWriter::Write(outputroot, str, CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_jsonOutputCompact);
+  {
+    CJSONStreamWriter writer(CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_jsonOutputCompact);
+
+    bool success = true;
+    if (outputroot.isArray())
+    {
+      success = writer.StartArray();
+      for (unsigned int index = 0; success && index < outputroot.size(); index++)
+        success = WriteResponse(writer, outputroot[index], deferred[index]);
+      success = success && writer.EndArray();
+    }
+    else if (deferred.empty())
+      success = writer.Value(outputroot);
+    else
+      success = WriteResponse(writer, outputroot, deferred.front());
+
+    if (success && writer.IsComplete())
+      str = writer.GetString();
+  }
 
   return str;
 }
 
-bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, ITransportLayer *transport, IClient *client)
+bool CJSONRPC::DeferResult(CVariant &result, const std::string &key, ResultWriter writer)
+{
+  // only the result object of the executing method is written to the response
+  if (currentMethodCall == nullptr || currentMethodCall->result != &result)
+    return false;
+
+  if (result.isNull())
+    result = CVariant(CVariant::VariantTypeObject);
+  else if (!result.isObject())
+    return false;
+
+  result.erase(key);
+  (*currentMethodCall->deferred)[key] = std::move(writer);
+  return true;
+}
+
+bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, DeferredResults& deferred, ITransportLayer *transport, IClient *client)
 {
   JSONRPC_STATUS errorCode = OK;
   CVariant result;
@@ -287,7 +340,15 @@ bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, ITr
     CVariant params;
 
     if ((errorCode = CJSONServiceDescription::CheckCall(methodName.c_str(), request["params"], transport, client, isNotification, method, params)) == OK)
+    {
+      MethodCallContext context = { &result, &deferred };
+      MethodCallContext* previousMethodCall = currentMethodCall;
+      currentMethodCall = &context;
+
       errorCode = method(methodName, transport, client, params, result);
+
+      currentMethodCall = previousMethodCall;
+    }
     else
       result = params;
   }
@@ -300,17 +361,71 @@ bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, ITr
     errorCode = InvalidRequest;
   }
 
-  BuildResponse(request, errorCode, result, response);
+  // deferred members are part of a successful result only
+  if (errorCode != OK)
+    deferred.clear();
+
+  BuildResponse(request, errorCode, std::move(result), response);
 
   return !isNotification;
 }
 
+bool CJSONRPC::WriteResponse(CJSONStreamWriter& writer, const CVariant& response, const DeferredResults& deferred)
+{
+  if (deferred.empty() || !response.isMember("result") || !response["result"].isObject())
+    return writer.Value(response);
+
+  if (!writer.StartObject())
+    return false;
+
+  for (CVariant::const_iterator_map member = response.begin_map(); member != response.end_map(); ++member)
+  {
+    if (!writer.Key(member->first))
+      return false;
+
+    if (member->first != "result")
+    {
+      if (!writer.Value(member->second))
+        return false;
+      continue;
+    }
+
+    // merge the deferred members into the result, ordered by name like the members of a CVariant
+    if (!writer.StartObject())
+      return false;
+
+    DeferredResults::const_iterator deferredMember = deferred.begin();
+    for (CVariant::const_iterator_map resultMember = member->second.begin_map(); resultMember != member->second.end_map(); ++resultMember)
+    {
+      for (; deferredMember != deferred.end() && deferredMember->first < resultMember->first; ++deferredMember)
+      {
+        if (!writer.Key(deferredMember->first) || !deferredMember->second(writer))
+          return false;
+      }
+
+      if (!writer.Key(resultMember->first) || !writer.Value(resultMember->second))
+        return false;
+    }
+
+    for (; deferredMember != deferred.end(); ++deferredMember)
+    {
+      if (!writer.Key(deferredMember->first) || !deferredMember->second(writer))
+        return false;
+    }
+
+    if (!writer.EndObject())
+      return false;
+  }
+
+  return writer.EndObject();
+}
+
 inline bool CJSONRPC::IsProperJSONRPC(const CVariant& inputroot)
 {
   return inputroot.isMember("jsonrpc") && inputroot["jsonrpc"].isString() && inputroot["jsonrpc"] == CVariant("2.0") && inputroot.isMember("method") && inputroot["method"].isString() && (!inputroot.isMember("params") || inputroot["params"].isArray() || inputroot["params"].isObject());
 }
 
-inline void CJSONRPC::BuildResponse(const CVariant& request, JSONRPC_STATUS code, const CVariant& result, CVariant& response)
+inline void CJSONRPC::BuildResponse(const CVariant& request, JSONRPC_STATUS code, CVariant result, CVariant& response)
 {
   response["jsonrpc"] = "2.0";
   response["id"] = request.isMember("id") ? request["id"] : CVariant();
@@ -318,7 +433,7 @@ inline void CJSONRPC::BuildResponse(const CVariant& request, JSONRPC_STATUS code
   switch (code)
   {
     case OK:
-      response["result"] = result;
+      response["result"] = std::move(result);
       break;
     case ACK:
       response["result"] = "OK";
@@ -16,6 +16,7 @@
 #include "JSONRPCUtils.h"
 #include "JSONServiceDescription.h"
 
+class CJSONStreamWriter;
 class CVariant;
 
 namespace JSONRPC
@@ -53,6 +54,20 @@ namespace JSONRPC
      */
     static std::string MethodCall(const std::string &inputString, ITransportLayer *transport, IClient *client);
 
+    /*
+     \brief Defers writing a member of the result of the executing method
+     \param result Result object of the executing method
+     \param key Name of the member
+     \param writer Function writing the value of the member
+     \return True if the member will be written by the given function, false
+     if the member has to be added to the result object instead
+
+     Allows methods returning large lists to serialize their items one by one
+     while the response is written, instead of building the whole list as
+     CVariant tree first. The function is only called if the method succeeds.
+     */
+    static bool DeferResult(CVariant &result, const std::string &key, ResultWriter writer);
+
     static JSONRPC_STATUS Introspect(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
     static JSONRPC_STATUS Version(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
     static JSONRPC_STATUS Permission(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
@@ -62,10 +77,13 @@ namespace JSONRPC
     static JSONRPC_STATUS NotifyAll(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
 
   private:
-    static bool HandleMethodCall(const CVariant& request, CVariant& response, ITransportLayer *transport, IClient *client);
+    typedef std::map<std::string, ResultWriter> DeferredResults;
+
+    static bool HandleMethodCall(const CVariant& request, CVariant& response, DeferredResults& deferred, ITransportLayer *transport, IClient *client);
     static inline bool IsProperJSONRPC(const CVariant& inputroot);
 
-    inline static void BuildResponse(const CVariant& request, JSONRPC_STATUS code, const CVariant& result, CVariant& response);
+    inline static void BuildResponse(const CVariant& request, JSONRPC_STATUS code, CVariant result, CVariant& response);
+    static bool WriteResponse(CJSONStreamWriter& writer, const CVariant& response, const DeferredResults& deferred);
 
     static bool m_initialized;
   };
@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include "IClient.h"
 #include "ITransportLayer.h"
 #include "FileItem.h"
@@ -16,6 +18,7 @@
 #include "guilib/GUIComponent.h"
 #include "guilib/GUIWindowManager.h"
 
+class CJSONStreamWriter;
 class CVariant;
 
 namespace JSONRPC
@@ -44,6 +47,12 @@ namespace JSONRPC
    */
   typedef JSONRPC_STATUS (*MethodCall) (const std::string &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
 
+  /*!
+   \brief Function writing the value of a result member straight
+   to the response, see CJSONRPC::DeferResult()
+   */
+  typedef std::function<bool (CJSONStreamWriter &writer)> ResultWriter;
+
   /*!
    \ingroup jsonrpc
    \brief Permission categories for json rpc methods
@@ -188,6 +188,7 @@ JsonRpcMethodMap CJSONServiceDescription::m_methodMaps[] = {
 
 // System operations
   { "System.GetProperties",                         CSystemOperations::GetProperties },
+  { "System.GetMemoryUsage",                        CSystemOperations::GetMemoryUsage },
   { "System.EjectOpticalDrive",                     CSystemOperations::EjectOpticalDrive },
   { "System.Shutdown",                              CSystemOperations::Shutdown },
   { "System.Suspend",                               CSystemOperations::Suspend },
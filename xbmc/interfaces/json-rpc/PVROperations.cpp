@@ -116,7 +116,7 @@ JSONRPC_STATUS CPVROperations::GetChannels(const std::string &method, ITransport
   if (channelGroup->GetMembers(channels) < 0)
     return InvalidParams;
 
-  HandleFileItemList("channelid", false, "channels", channels, parameterObject, result, true);
+  StreamFileItemList("channelid", false, "channels", channels, parameterObject, result, true);
 
   return OK;
 }
@@ -164,7 +164,7 @@ JSONRPC_STATUS CPVROperations::GetBroadcasts(const std::string &method, ITranspo
     programFull.Add(std::make_shared<CFileItem>(tag));
   }
 
-  HandleFileItemList("broadcastid", false, "broadcasts", programFull, parameterObject, result, programFull.Size(), true);
+  StreamFileItemList("broadcastid", false, "broadcasts", programFull, parameterObject, result, programFull.Size(), true);
 
   return OK;
 }
@@ -300,7 +300,7 @@ JSONRPC_STATUS CPVROperations::GetTimers(const std::string &method, ITransportLa
   CFileItemList timerList;
   timers->GetAll(timerList);
 
-  HandleFileItemList("timerid", false, "timers", timerList, parameterObject, result, true);
+  StreamFileItemList("timerid", false, "timers", timerList, parameterObject, result, true);
 
   return OK;
 }
@@ -415,7 +415,7 @@ JSONRPC_STATUS CPVROperations::GetRecordings(const std::string &method, ITranspo
   CFileItemList recordingsList;
   recordings->GetAll(recordingsList);
 
-  HandleFileItemList("recordingid", true, "recordings", recordingsList, parameterObject, result, true);
+  StreamFileItemList("recordingid", true, "recordings", recordingsList, parameterObject, result, true);
 
   return OK;
 }
@@ -9,6 +9,7 @@
 #include "SystemOperations.h"
 #include "messaging/ApplicationMessenger.h"
 #include "interfaces/builtins/Builtins.h"
+#include "utils/MemoryBudget.h"
 #include "utils/Variant.h"
 #include "powermanagement/PowerManager.h"
 #include "ServiceBroker.h"
@@ -35,6 +36,41 @@ JSONRPC_STATUS CSystemOperations::GetProperties(const std::string &method, ITran
   return OK;
 }
 
+JSONRPC_STATUS CSystemOperations::GetMemoryUsage(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  std::shared_ptr<const MemoryBudgetUsage> usage = CMemoryBudget::GetInstance().GetUsage();
+
+  result = CVariant(CVariant::VariantTypeObject);
+  result["memorylimit"] = usage->memoryLimit;
+  result["memoryused"] = usage->memoryUsed;
+  result["cachelimit"] = usage->cacheLimit;
+  result["cacheused"] = usage->cacheUsed;
+  result["trimmed"] = usage->trimmed;
+  result["caches"] = CVariant(CVariant::VariantTypeArray);
+  for (const MemoryConsumerUsage& consumer : usage->consumers)
+  {
+    CVariant cache(CVariant::VariantTypeObject);
+    cache["name"] = consumer.name;
+    switch (consumer.priority)
+    {
+      case MEMORY_PRIORITY_LOW:
+        cache["priority"] = "low";
+        break;
+      case MEMORY_PRIORITY_HIGH:
+        cache["priority"] = "high";
+        break;
+      default:
+        cache["priority"] = "normal";
+        break;
+    }
+    cache["used"] = consumer.used;
+    cache["trimmed"] = consumer.trimmed;
+    result["caches"].push_back(cache);
+  }
+
+  return OK;
+}
+
 JSONRPC_STATUS CSystemOperations::EjectOpticalDrive(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
 {
   return CBuiltins::GetInstance().Execute("EjectTray") == 0 ? ACK : FailedToExecute;
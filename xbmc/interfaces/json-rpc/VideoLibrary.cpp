@@ -103,7 +103,7 @@ JSONRPC_STATUS CVideoLibrary::GetMovieSets(const std::string &method, ITransport
   if (!videodatabase.GetSetsNav("videodb://movies/sets/", items, VIDEODB_CONTENT_MOVIES))
     return InternalError;
 
-  HandleFileItemList("setid", false, "sets", items, parameterObject, result);
+  StreamFileItemList("setid", false, "sets", items, parameterObject, result);
   return OK;
 }
 
@@ -206,7 +206,7 @@ JSONRPC_STATUS CVideoLibrary::GetSeasons(const std::string &method, ITransportLa
   if (!videodatabase.GetSeasonsNav(strPath, items, -1, -1, -1, -1, tvshowID, false))
     return InternalError;
 
-  HandleFileItemList("seasonid", false, "seasons", items, parameterObject, result);
+  StreamFileItemList("seasonid", false, "seasons", items, parameterObject, result);
   return OK;
 }
 
@@ -462,7 +462,7 @@ JSONRPC_STATUS CVideoLibrary::GetGenres(const std::string &method, ITransportLay
   for (unsigned int i = 0; i < (unsigned int)items.Size(); i++)
     items[i]->GetVideoInfoTag()->m_strTitle = items[i]->GetLabel();
 
-  HandleFileItemList("genreid", false, "genres", items, parameterObject, result);
+  StreamFileItemList("genreid", false, "genres", items, parameterObject, result);
   return OK;
 }
 
@@ -503,7 +503,7 @@ JSONRPC_STATUS CVideoLibrary::GetTags(const std::string &method, ITransportLayer
   for (int i = 0; i < items.Size(); i++)
     items[i]->GetVideoInfoTag()->m_strTitle = items[i]->GetLabel();
 
-  HandleFileItemList("tagid", false, "tags", items, parameterObject, result);
+  StreamFileItemList("tagid", false, "tags", items, parameterObject, result);
   return OK;
 }
 
@@ -1021,7 +1021,7 @@ JSONRPC_STATUS CVideoLibrary::HandleItems(const char *idProperty, const char *re
   int size = items.Size();
   if (!limit && items.HasProperty("total") && items.GetProperty("total").asInteger() > size)
     size = (int)items.GetProperty("total").asInteger();
-  HandleFileItemList(idProperty, true, resultName, items, parameterObject, result, size, limit);
+  StreamFileItemList(idProperty, true, resultName, items, parameterObject, result, size, limit);
 
   return OK;
 }
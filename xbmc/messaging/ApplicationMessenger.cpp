@@ -8,6 +8,7 @@
 
 #include "ApplicationMessenger.h"
 
+#include <deque>
 #include <memory>
 #include <utility>
 
@@ -48,13 +49,132 @@ void CDelayedMessage::Process()
 }
 
 
+/*!
+ * \brief Bounded multi-producer/multi-consumer queue of messages
+ *
+ * Messages are moved into and out of the slots of a ring, so the slots act as a pool of message
+ * objects and queueing takes neither a lock nor an allocation. Each slot carries a sequence number
+ * telling producers and consumers whether it's free or filled for the current round.
+ *
+ * Messages that don't fit into the ring go to an overflow queue. While the overflow queue has
+ * messages, new messages are added there as well to keep the order of the messages of a thread.
+ */
+class CApplicationMessenger::CMessageQueue
+{
+public:
+  static const size_t RING_SIZE = 1024; // has to be a power of two
+
+  CMessageQueue() : m_slots(new Slot[RING_SIZE])
+  {
+    for (size_t i = 0; i < RING_SIZE; i++)
+      m_slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  void Push(ThreadMessage&& msg)
+  {
+    if (m_overflowSize.load() == 0 && PushRing(msg))
+      return;
+
+    CSingleLock lock(m_overflowSection);
+    m_overflow.push_back(std::move(msg));
+    m_overflowSize++;
+  }
+
+  bool Pop(ThreadMessage& msg)
+  {
+    if (PopRing(msg))
+      return true;
+
+    if (m_overflowSize.load() == 0)
+      return false;
+
+    CSingleLock lock(m_overflowSection);
+    if (m_overflow.empty())
+      return false;
+
+    msg = std::move(m_overflow.front());
+    m_overflow.pop_front();
+    m_overflowSize--;
+    return true;
+  }
+
+private:
+  struct Slot
+  {
+    std::atomic<size_t> sequence;
+    ThreadMessage msg;
+  };
+
+  bool PushRing(ThreadMessage& msg)
+  {
+    size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true)
+    {
+      slot = &m_slots[pos & (RING_SIZE - 1)];
+      const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+      if (diff == 0)
+      {
+        if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      }
+      else if (diff < 0)
+        return false; // the slot wasn't consumed yet, we're full
+      else
+        pos = m_enqueuePos.load(std::memory_order_relaxed);
+    }
+
+    slot->msg = std::move(msg);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool PopRing(ThreadMessage& msg)
+  {
+    size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true)
+    {
+      slot = &m_slots[pos & (RING_SIZE - 1)];
+      const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0)
+      {
+        if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      }
+      else if (diff < 0)
+        return false; // nothing queued
+      else
+        pos = m_dequeuePos.load(std::memory_order_relaxed);
+    }
+
+    msg = std::move(slot->msg);
+    slot->sequence.store(pos + RING_SIZE, std::memory_order_release);
+    return true;
+  }
+
+  std::unique_ptr<Slot[]> m_slots;
+  std::atomic<size_t> m_enqueuePos{0};
+  std::atomic<size_t> m_dequeuePos{0};
+
+  CCriticalSection m_overflowSection;
+  std::deque<ThreadMessage> m_overflow;
+  std::atomic<size_t> m_overflowSize{0};
+};
+
 CApplicationMessenger& CApplicationMessenger::GetInstance()
 {
   static CApplicationMessenger appMessenger;
   return appMessenger;
 }
 
-CApplicationMessenger::CApplicationMessenger() = default;
+CApplicationMessenger::CApplicationMessenger()
+  : m_messages(new CMessageQueue),
+    m_windowMessages(new CMessageQueue)
+{
+}
 
 CApplicationMessenger::~CApplicationMessenger()
 {
@@ -63,85 +183,64 @@ CApplicationMessenger::~CApplicationMessenger()
 
 void CApplicationMessenger::Cleanup()
 {
-  CSingleLock lock (m_critSection);
-
-  while (!m_vecMessages.empty())
-  {
-    ThreadMessage* pMsg = m_vecMessages.front();
-
-    if (pMsg->waitEvent)
-      pMsg->waitEvent->Set();
-
-    delete pMsg;
-    m_vecMessages.pop();
-  }
-
-  while (!m_vecWindowMessages.empty())
+  ThreadMessage msg;
+  for (CMessageQueue* queue : { m_messages.get(), m_windowMessages.get() })
   {
-    ThreadMessage* pMsg = m_vecWindowMessages.front();
-
-    if (pMsg->waitEvent)
-      pMsg->waitEvent->Set();
-
-    delete pMsg;
-    m_vecWindowMessages.pop();
+    while (queue->Pop(msg))
+    {
+      if (msg.result)
+        msg.result->promise.set_value(-1);
+    }
   }
 }
 
 int CApplicationMessenger::SendMsg(ThreadMessage&& message, bool wait)
 {
-  std::shared_ptr<CEvent> waitEvent;
-  std::shared_ptr<int> result;
+  if (!wait)
+  {
+    QueueMsg(std::move(message));
+    return -1;
+  }
 
-  if (wait)
+  // check that we're not being called from our application thread, else we'll be waiting
+  // forever!
+  if (CThread::IsCurrentThread(m_guiThreadId))
   {
     //Initialize result here as it's not needed for posted messages
-    message.result = std::make_shared<int>(-1);
-    // check that we're not being called from our application thread, else we'll be waiting
-    // forever!
-    if (!CThread::IsCurrentThread(m_guiThreadId))
-    {
-      message.waitEvent.reset(new CEvent(true));
-      waitEvent = message.waitEvent;
-      result = message.result;
-    }
-    else
-    {
-      //OutputDebugString("Attempting to wait on a SendMessage() from our application thread will cause lockup!\n");
-      //OutputDebugString("Sending immediately\n");
-      ProcessMessage(&message);
-      return *message.result;
-    }
+    message.result = std::make_shared<ThreadMessage::Result>();
+    ProcessMessage(&message);
+    return message.result->value;
   }
 
+  std::future<int> result = PostMsgWithResult(std::move(message));
 
-  if (m_bStop)
-    return -1;
+  // ensure the thread doesn't hold the graphics lock
+  CSingleExit exit(CServiceBroker::GetWinSystem()->GetGfxContext());
+  return result.get();
+}
 
-  ThreadMessage* msg = new ThreadMessage(std::move(message));
+std::future<int> CApplicationMessenger::PostMsgWithResult(ThreadMessage&& message)
+{
+  message.result = std::make_shared<ThreadMessage::Result>();
+  std::shared_ptr<ThreadMessage::Result> result = message.result;
+  std::future<int> future = result->promise.get_future();
 
-  CSingleLock lock (m_critSection);
+  if (!QueueMsg(std::move(message)))
+    result->promise.set_value(-1);
 
-  if (msg->dwMessage == TMSG_GUI_MESSAGE)
-    m_vecWindowMessages.push(msg);
-  else
-    m_vecMessages.push(msg);
-  lock.Leave();  // this releases the lock on the vec of messages and
-                 //   allows the ProcessMessage to execute and therefore
-                 //   delete the message itself. Therefore any access
-                 //   of the message itself after this point constitutes
-                 //   a race condition (yarc - "yet another race condition")
-                 //
-  if (waitEvent) // ... it just so happens we have a spare reference to the
-                 //  waitEvent ... just for such contingencies :)
-  {
-    // ensure the thread doesn't hold the graphics lock
-    CSingleExit exit(CServiceBroker::GetWinSystem()->GetGfxContext());
-    waitEvent->Wait();
-    return *result;
-  }
+  return future;
+}
+
+bool CApplicationMessenger::QueueMsg(ThreadMessage&& message)
+{
+  if (m_bStop)
+    return false;
 
-  return -1;
+  if (message.dwMessage == TMSG_GUI_MESSAGE)
+    m_windowMessages->Push(std::move(message));
+  else
+    m_messages->Push(std::move(message));
+  return true;
 }
 
 int CApplicationMessenger::SendMsg(uint32_t messageId)
@@ -189,29 +288,36 @@ void CApplicationMessenger::PostMsg(uint32_t messageId, int param1, int param2,
   SendMsg(ThreadMessage{ messageId, param1, param2, payload, strParam, params }, false);
 }
 
-void CApplicationMessenger::ProcessMessages()
+std::future<int> CApplicationMessenger::PostMsgWithResult(uint32_t messageId)
 {
-  // process threadmessages
-  CSingleLock lock (m_critSection);
-  while (!m_vecMessages.empty())
-  {
-    ThreadMessage* pMsg = m_vecMessages.front();
-    //first remove the message from the queue, else the message could be processed more then once
-    m_vecMessages.pop();
-
-    //Leave here as the message might make another
-    //thread call processmessages or sendmessage
+  return PostMsgWithResult(ThreadMessage{ messageId });
+}
 
-    std::shared_ptr<CEvent> waitEvent = pMsg->waitEvent;
-    lock.Leave(); // <- see the large comment in SendMessage ^
+std::future<int> CApplicationMessenger::PostMsgWithResult(uint32_t messageId, int param1, int param2, void* payload)
+{
+  return PostMsgWithResult(ThreadMessage{ messageId, param1, param2, payload });
+}
 
-    ProcessMessage(pMsg);
+std::future<int> CApplicationMessenger::PostMsgWithResult(uint32_t messageId, int param1, int param2, void* payload, std::string strParam, std::vector<std::string> params)
+{
+  return PostMsgWithResult(ThreadMessage{ messageId, param1, param2, payload, strParam, params });
+}
 
-    if (waitEvent)
-      waitEvent->Set();
-    delete pMsg;
+void CApplicationMessenger::ProcessMessages()
+{
+  ProcessMessages(*m_messages);
+}
 
-    lock.Enter();
+void CApplicationMessenger::ProcessMessages(CMessageQueue& queue)
+{
+  // the message is removed from the queue before it's processed, so it's processed only once
+  // even if the message makes another thread call ProcessMessages
+  ThreadMessage msg;
+  while (queue.Pop(msg))
+  {
+    ProcessMessage(&msg);
+    if (msg.result)
+      msg.result->promise.set_value(msg.result->value);
   }
 }
 
@@ -238,26 +344,7 @@ void CApplicationMessenger::ProcessMessage(ThreadMessage *pMsg)
 
 void CApplicationMessenger::ProcessWindowMessages()
 {
-  CSingleLock lock (m_critSection);
-  //message type is window, process window messages
-  while (!m_vecWindowMessages.empty())
-  {
-    ThreadMessage* pMsg = m_vecWindowMessages.front();
-    //first remove the message from the queue, else the message could be processed more then once
-    m_vecWindowMessages.pop();
-
-    // leave here in case we make more thread messages from this one
-
-    std::shared_ptr<CEvent> waitEvent = pMsg->waitEvent;
-    lock.Leave(); // <- see the large comment in SendMessage ^
-
-    ProcessMessage(pMsg);
-    if (waitEvent)
-      waitEvent->Set();
-    delete pMsg;
-
-    lock.Enter();
-  }
+  ProcessMessages(*m_windowMessages);
 }
 
 void CApplicationMessenger::SendGUIMessage(const CGUIMessage &message, int windowID, bool waitResult)
@@ -12,9 +12,10 @@
 #include "threads/Thread.h"
 #include "messaging/ThreadMessage.h"
 
+#include <atomic>
+#include <future>
 #include <map>
 #include <memory>
-#include <queue>
 #include <string>
 #include <vector>
 
@@ -155,6 +156,7 @@ struct ThreadMessageCallback
  * For most users that wants to send message go to the documentation for these
  * \sa CApplicationMessenger::SendMsg
  * \sa CApplicationMessenger::PostMsg
+ * \sa CApplicationMessenger::PostMsgWithResult
  *
  * For anyone wanting to implement a message receiver, go to the documentation for
  * \sa IMessageTarget
@@ -173,10 +175,10 @@ struct ThreadMessageCallback
  * and call the receiver directly
  *
  * Calling SendMsg with a message type that require marshalling to a specific thread when not on that thread
- * will add a message to the queue with a an event, it will then block the calling thread waiting on this event
- * to be signaled.
- * The message will be processed by the correct thread in it's message pump and the event will be signaled, unblocking
- * the calling thread
+ * will add a message to the queue with a promise for the result, it will then block the calling thread waiting
+ * on the future of this promise.
+ * The message will be processed by the correct thread in it's message pump and the promise will be fulfilled,
+ * unblocking the calling thread. PostMsgWithResult does the same without blocking and hands the future to the caller.
  *
  * Calling SendMsg with a message type that require marshalling to a specific thread when already on that thread
  * will behave as scenario one, it will bypass the queue and call the receiver directly.
@@ -206,7 +208,10 @@ struct ThreadMessageCallback
  *
  * The above methods are backed by two messages queues, one for each type of message. If more types are added
  * this might need to be redesigned to simplify the lookup of the correct message queue but currently they're implemented
- * as two member variables
+ * as two member variables.
+ * The queues are bounded lock-free rings whose slots are reused for the messages, so queueing a message neither
+ * takes a lock nor allocates. When a ring is full, messages go to an overflow queue guarded by a lock until the
+ * ring has been drained.
  *
  * The design is meant to be very encapsulated and easy to extend without altering the public interface.
  * e.g. If GUI messages should be handled on another thread, call \sa CApplicationMessenger::ProcessWindowMessage() on that
@@ -368,6 +373,49 @@ public:
    */
   void PostMsg(uint32_t messageId, int param1, int param2, void* payload, std::string strParam, std::vector<std::string> params);
 
+  /*!
+   * \brief Send a non-blocking message and return a future for the response
+   *
+   * If and what the response is depends entirely on the message being sent and
+   * should be documented on the message. The future is ready once the message has been
+   * processed, it returns -1 if the message couldn't be processed.
+   *
+   * Don't wait for the future on the thread processing the message, e.g. the UI thread
+   * for UI messages, as the message will never be processed.
+   *
+   * \param [in] messageId defined further up in this file
+   * \return future for the response of the message
+   */
+  std::future<int> PostMsgWithResult(uint32_t messageId);
+
+  /*!
+   * \brief Send a non-blocking message and return a future for the response
+   *
+   * \param [in] messageId defined further up in this file
+   * \param [in] param1 value depends on the message being sent
+   * \param [in] param2 value depends on the message being sent, defaults to -1
+   * \param [in] payload this is a void pointer that is meant to send larger objects to the receiver
+   *             what to send depends on the message
+   * \return future for the response of the message
+   * \sa PostMsgWithResult(uint32_t)
+   */
+  std::future<int> PostMsgWithResult(uint32_t messageId, int param1, int param2 = -1, void* payload = nullptr);
+
+  /*!
+   * \brief Send a non-blocking message and return a future for the response
+   *
+   * \param [in] messageId defined further up in this file
+   * \param [in] param1 value depends on the message being sent
+   * \param [in] param2 value depends on the message being sent
+   * \param [in,out] payload this is a void pointer that is meant to send larger objects to the receiver
+   *             what to send depends on the message
+   * \param [in] strParam value depends on the message being sent
+   * \param [in] params value depends on the message being sent
+   * \return future for the response of the message
+   * \sa PostMsgWithResult(uint32_t)
+   */
+  std::future<int> PostMsgWithResult(uint32_t messageId, int param1, int param2, void* payload, std::string strParam, std::vector<std::string> params);
+
   /*!
    * \brief Called from any thread to dispatch messages
    */
@@ -414,15 +462,20 @@ private:
   CApplicationMessenger const& operator=(CApplicationMessenger const&) = delete;
   ~CApplicationMessenger();
 
+  class CMessageQueue;
+
   int SendMsg(ThreadMessage&& msg, bool wait);
+  std::future<int> PostMsgWithResult(ThreadMessage&& msg);
+  bool QueueMsg(ThreadMessage&& msg);
+  void ProcessMessages(CMessageQueue& queue);
   void ProcessMessage(ThreadMessage *pMsg);
 
-  std::queue<ThreadMessage*> m_vecMessages; /*!< queue for regular messages */
-  std::queue<ThreadMessage*> m_vecWindowMessages; /*!< queue for UI messages */
+  std::unique_ptr<CMessageQueue> m_messages; /*!< queue for regular messages */
+  std::unique_ptr<CMessageQueue> m_windowMessages; /*!< queue for UI messages */
   std::map<int, IMessageTarget*> m_mapTargets; /*!< a map of registered receivers indexed on the message mask*/
   CCriticalSection m_critSection;
   ThreadIdentifier m_guiThreadId{0};
-  bool m_bStop{ false };
+  std::atomic<bool> m_bStop{ false };
 };
 }
 }
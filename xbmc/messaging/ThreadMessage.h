@@ -8,12 +8,11 @@
 
 #pragma once
 
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
 
-class CEvent;
-
 namespace KODI
 {
 namespace MESSAGING
@@ -68,7 +67,6 @@ public:
     lpVoid(other.lpVoid),
     strParam(other.strParam),
     params(other.params),
-    waitEvent(other.waitEvent),
     result(other.result)
   {
   }
@@ -81,7 +79,6 @@ public:
     lpVoid(other.lpVoid),
     strParam(std::move(other.strParam)),
     params(std::move(other.params)),
-    waitEvent(std::move(other.waitEvent)),
     result(std::move(other.result))
   {
   }
@@ -97,7 +94,6 @@ public:
     lpVoid = other.lpVoid;
     strParam = other.strParam;
     params = other.params;
-    waitEvent = other.waitEvent;
     result = other.result;
     return *this;
   }
@@ -113,7 +109,6 @@ public:
     lpVoid = other.lpVoid;
     strParam = std::move(other.strParam);
     params = std::move(other.params);
-    waitEvent = std::move(other.waitEvent);
     result = std::move(other.result);
     return *this;
   }
@@ -137,11 +132,16 @@ public:
     //retrieve the response we silently ignore this to let message
     //handlers not have to worry about it
     if (result)
-      *result = res;
+      result->value = res;
   }
 protected:
-  std::shared_ptr<CEvent> waitEvent;
-  std::shared_ptr<int> result;
+  struct Result
+  {
+    int value = -1;
+    std::promise<int> promise; //!< fulfilled with value once the message is processed
+  };
+
+  std::shared_ptr<Result> result;
 };
 }
 }
@@ -0,0 +1,200 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "messaging/ApplicationMessenger.h"
+#include "messaging/IMessageTarget.h"
+
+#include "gtest/gtest.h"
+
+using namespace KODI::MESSAGING;
+
+namespace
+{
+
+// not used by any receiver of the application
+const int TMSG_MASK_TEST = 1 << 20;
+const uint32_t TMSG_TEST_DOUBLE = TMSG_MASK_TEST + 0;
+const uint32_t TMSG_TEST_RECORD = TMSG_MASK_TEST + 1;
+
+const int BENCHMARK_PRODUCERS = 4;
+const int BENCHMARK_MESSAGES = 100000;
+const int BENCHMARK_ROUNDTRIPS = 10000;
+
+class CTestMessageTarget : public IMessageTarget
+{
+public:
+  int GetMessageMask() override { return TMSG_MASK_TEST; }
+
+  void OnApplicationMessage(ThreadMessage* msg) override
+  {
+    if (msg->dwMessage == TMSG_TEST_DOUBLE)
+      msg->SetResult(msg->param1 * 2);
+    else if (msg->dwMessage == TMSG_TEST_RECORD)
+      recorded.push_back(msg->param1);
+  }
+
+  std::vector<int> recorded;
+};
+
+CTestMessageTarget& GetTarget()
+{
+  // the messenger keeps the receiver for the rest of the process
+  static CTestMessageTarget* target = nullptr;
+  if (!target)
+  {
+    target = new CTestMessageTarget;
+    CApplicationMessenger::GetInstance().RegisterReceiver(target);
+  }
+  return *target;
+}
+
+void CountMessage(void* counter)
+{
+  (*static_cast<std::atomic<int>*>(counter))++;
+}
+
+//! Drives the message pump like the main loop of the application does every frame
+class CMessagePump
+{
+public:
+  CMessagePump()
+  : m_thread([this]() {
+      while (!m_stop)
+      {
+        CApplicationMessenger::GetInstance().ProcessMessages();
+        std::this_thread::yield();
+      }
+      CApplicationMessenger::GetInstance().ProcessMessages();
+    })
+  {
+  }
+
+  ~CMessagePump()
+  {
+    m_stop = true;
+    m_thread.join();
+  }
+
+private:
+  std::atomic<bool> m_stop{false};
+  std::thread m_thread;
+};
+
+//! Posts callbacks from several threads at once and returns how many of them were processed
+int PostFromThreads(int producerCount, int messages, std::chrono::steady_clock::duration& duration)
+{
+  std::atomic<int> processed(0);
+  ThreadMessageCallback callback{ CountMessage, &processed };
+
+  CMessagePump pump;
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> producers;
+  for (int i = 0; i < producerCount; i++)
+  {
+    producers.emplace_back([messages, &callback]() {
+      for (int message = 0; message < messages; message++)
+        CApplicationMessenger::GetInstance().PostMsg(TMSG_CALLBACK, -1, -1, static_cast<void*>(&callback));
+    });
+  }
+  for (auto& producer : producers)
+    producer.join();
+
+  const auto timeout = start + std::chrono::seconds(30);
+  while (processed < producerCount * messages && std::chrono::steady_clock::now() < timeout)
+    std::this_thread::yield();
+  duration = std::chrono::steady_clock::now() - start;
+  return processed;
+}
+
+}
+
+TEST(TestApplicationMessenger, PostMsgWithResult)
+{
+  GetTarget();
+  CMessagePump pump;
+
+  std::future<int> result = CApplicationMessenger::GetInstance().PostMsgWithResult(TMSG_TEST_DOUBLE, 21);
+  ASSERT_EQ(std::future_status::ready, result.wait_for(std::chrono::seconds(10)));
+  EXPECT_EQ(42, result.get());
+}
+
+TEST(TestApplicationMessenger, CleanupReleasesWaiters)
+{
+  GetTarget();
+
+  std::future<int> result = CApplicationMessenger::GetInstance().PostMsgWithResult(TMSG_TEST_DOUBLE, 21);
+  CApplicationMessenger::GetInstance().Cleanup();
+  ASSERT_EQ(std::future_status::ready, result.wait_for(std::chrono::seconds(0)));
+  EXPECT_EQ(-1, result.get());
+}
+
+TEST(TestApplicationMessenger, KeepsOrderBeyondRingSize)
+{
+  CTestMessageTarget& target = GetTarget();
+  target.recorded.clear();
+
+  // more messages than the ring holds, the rest has to be queued behind them
+  const int messages = 5000;
+  for (int i = 0; i < messages; i++)
+    CApplicationMessenger::GetInstance().PostMsg(TMSG_TEST_RECORD, i);
+  std::future<int> last = CApplicationMessenger::GetInstance().PostMsgWithResult(TMSG_TEST_DOUBLE, messages);
+
+  CApplicationMessenger::GetInstance().ProcessMessages();
+  ASSERT_EQ(std::future_status::ready, last.wait_for(std::chrono::seconds(0)));
+  EXPECT_EQ(2 * messages, last.get());
+
+  ASSERT_EQ(static_cast<size_t>(messages), target.recorded.size());
+  for (int i = 0; i < messages; i++)
+    ASSERT_EQ(i, target.recorded[i]);
+}
+
+TEST(TestApplicationMessenger, PostMsgFromThreads)
+{
+  std::chrono::steady_clock::duration duration;
+  EXPECT_EQ(BENCHMARK_PRODUCERS * 2000, PostFromThreads(BENCHMARK_PRODUCERS, 2000, duration));
+}
+
+TEST(TestApplicationMessenger, DISABLED_BenchmarkThroughput)
+{
+  std::chrono::steady_clock::duration duration;
+  const int processed = PostFromThreads(BENCHMARK_PRODUCERS, BENCHMARK_MESSAGES, duration);
+
+  const double seconds = std::chrono::duration<double>(duration).count();
+  printf("%d producers, %d messages each: %.2f ms, %.0f messages/s\n",
+         BENCHMARK_PRODUCERS, BENCHMARK_MESSAGES, seconds * 1000,
+         BENCHMARK_PRODUCERS * BENCHMARK_MESSAGES / seconds);
+  EXPECT_EQ(BENCHMARK_PRODUCERS * BENCHMARK_MESSAGES, processed);
+}
+
+TEST(TestApplicationMessenger, DISABLED_BenchmarkRoundTrip)
+{
+  GetTarget();
+  CMessagePump pump;
+
+  std::vector<double> latencies;
+  latencies.reserve(BENCHMARK_ROUNDTRIPS);
+  for (int i = 0; i < BENCHMARK_ROUNDTRIPS; i++)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_EQ(2 * i, CApplicationMessenger::GetInstance().PostMsgWithResult(TMSG_TEST_DOUBLE, i).get());
+    latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  printf("%d round trips: median %.1f us, 99th percentile %.1f us\n",
+         BENCHMARK_ROUNDTRIPS, latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100]);
+}
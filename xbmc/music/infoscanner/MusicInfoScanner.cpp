@@ -46,7 +46,6 @@
 #include "TextureCache.h"
 #include "threads/SystemClock.h"
 #include "Util.h"
-#include "utils/Digest.h"
 #include "utils/FileExtensionProvider.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
@@ -58,7 +57,6 @@ using namespace XFILE;
 using namespace MUSICDATABASEDIRECTORY;
 using namespace MUSIC_GRABBER;
 using namespace ADDON;
-using KODI::UTILITY::CDigest;
 
 CMusicInfoScanner::CMusicInfoScanner()
 : m_fileCountReader(this, "MusicFileCounter")
@@ -489,7 +487,19 @@ bool CMusicInfoScanner::DoScan(const std::string& strDirectory)
 
   // check whether we need to rescan or not
   std::string dbHash;
-  if ((m_flags & SCAN_RESCAN) || !m_musicDatabase.GetPathHash(strDirectory, dbHash) || !StringUtils::EqualsNoCase(dbHash, hash))
+  bool hasDbHash = m_musicDatabase.GetPathHash(strDirectory, dbHash);
+  if (hasDbHash && !(m_flags & SCAN_RESCAN) && IsLegacyPathHash(dbHash))
+  { // hashed by an older version, keep the path if it is unchanged
+    std::string legacyHash;
+    GetPathHash(items, legacyHash, true);
+    if (StringUtils::EqualsNoCase(dbHash, legacyHash))
+    {
+      m_musicDatabase.SetPathHash(strDirectory, hash);
+      dbHash = hash;
+    }
+  }
+
+  if ((m_flags & SCAN_RESCAN) || !hasDbHash || !StringUtils::EqualsNoCase(dbHash, hash))
   { // path has changed - rescan
     if (dbHash.empty())
       CLog::Log(LOGDEBUG, "%s Scanning dir '%s' as not in the database", __FUNCTION__, CURL::GetRedacted(strDirectory).c_str());
@@ -1221,11 +1231,11 @@ void MUSIC_INFO::CMusicInfoScanner::RetrieveLocalArt()
   }
 }
 
-int CMusicInfoScanner::GetPathHash(const CFileItemList &items, std::string &hash)
+int CMusicInfoScanner::GetPathHash(const CFileItemList &items, std::string &hash, bool legacy /* = false */)
 {
   // Create a hash based on the filenames, filesize and filedate.  Also count the number of files
   if (0 == items.Size()) return 0;
-  CDigest digest{CDigest::Type::MD5};
+  CPathHash digest(legacy);
   int count = 0;
   for (int i = 0; i < items.Size(); ++i)
   {
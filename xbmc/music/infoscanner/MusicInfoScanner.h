@@ -215,7 +215,13 @@ protected:
    \param scannedItems [in] list to populate with the scannedItems
    */
   INFO_RET ScanTags(const CFileItemList& items, CFileItemList& scannedItems);
-  int GetPathHash(const CFileItemList &items, std::string &hash);
+  /*! \brief Hash the files of a path to detect changes
+   \param items files of the path
+   \param hash [out] the hash
+   \param legacy true to compute the MD5 hash older versions stored, see IsLegacyPathHash()
+   \return number of audio files
+   */
+  int GetPathHash(const CFileItemList &items, std::string &hash, bool legacy = false);
   void GetAlbumArtwork(long id, const CAlbum &artist);
 
   void Run() override;
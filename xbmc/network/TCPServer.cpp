@@ -7,17 +7,22 @@
  */
 
 #include "TCPServer.h"
+#include <algorithm>
 #include <stdio.h>
 #include <stdlib.h>
 #include <memory.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#if !defined(TARGET_WINDOWS)
+#include <fcntl.h>
+#endif
 
 #include "settings/AdvancedSettings.h"
 #include "settings/SettingsComponent.h"
 #include "interfaces/json-rpc/JSONRPC.h"
 #include "interfaces/AnnouncementManager.h"
 #include "utils/log.h"
+#include "utils/StringUtils.h"
 #include "utils/Variant.h"
 #include "threads/SingleLock.h"
 #include "websocket/WebSocketManager.h"
@@ -50,6 +55,111 @@ using namespace JSONRPC;
 
 #define RECEIVEBUFFER 1024
 
+// notifications queued for a client that does not read them are dropped beyond this
+#define MAX_PENDING_NOTIFICATIONS 10000
+
+namespace
+{
+  // notifications describing a state, only the latest one per item is of interest
+  struct CoalescedNotification
+  {
+    ANNOUNCEMENT::AnnouncementFlag flag;
+    const char *message;
+    unsigned int window; // minimum time between two notifications in milliseconds
+  };
+
+  const CoalescedNotification COALESCED_NOTIFICATIONS[] = {
+    { ANNOUNCEMENT::VideoLibrary, "OnUpdate", 0 },
+    { ANNOUNCEMENT::AudioLibrary, "OnUpdate", 0 },
+    { ANNOUNCEMENT::Player, "OnSeek", 250 },
+    { ANNOUNCEMENT::Application, "OnVolumeChanged", 0 }
+  };
+
+  bool SetNonBlocking(SOCKET socket)
+  {
+#ifdef TARGET_WINDOWS
+    u_long nonblocking = 1;
+    return ioctlsocket(socket, FIONBIO, &nonblocking) == 0;
+#else
+    return fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK) == 0;
+#endif
+  }
+
+  bool WouldBlock()
+  {
+#ifdef TARGET_WINDOWS
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+  }
+
+  // a loopback datagram socket connected to itself, writing to it wakes up a select() reading from it
+  SOCKET CreateWakeSocket()
+  {
+    SOCKET sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock == INVALID_SOCKET)
+      return INVALID_SOCKET;
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrlen = sizeof(addr);
+    if (bind(sock, (sockaddr*)&addr, sizeof(addr)) != 0 ||
+        getsockname(sock, (sockaddr*)&addr, &addrlen) != 0 ||
+        connect(sock, (sockaddr*)&addr, sizeof(addr)) != 0 ||
+        !SetNonBlocking(sock))
+    {
+      closesocket(sock);
+      return INVALID_SOCKET;
+    }
+
+    return sock;
+  }
+
+  std::string GetItemKey(const CVariant &item)
+  {
+    if (item["id"].isInteger() && item["id"].asInteger() > 0)
+      return StringUtils::Format("%s:%" PRId64, item["type"].asString().c_str(), item["id"].asInteger());
+
+    return item["type"].asString() + ":" + item["title"].asString();
+  }
+
+  std::string GetCoalescingKey(ANNOUNCEMENT::AnnouncementFlag flag, const char *message, const CVariant &data, unsigned int &window)
+  {
+    for (const auto& coalesced : COALESCED_NOTIFICATIONS)
+    {
+      if (coalesced.flag != flag || strcmp(coalesced.message, message) != 0)
+        continue;
+
+      window = coalesced.window;
+      std::string key = std::string(ANNOUNCEMENT::AnnouncementFlagToString(flag)) + "." + message;
+
+      if (strcmp(message, "OnUpdate") == 0)
+      {
+        // the item is either described by the data itself or by its item member
+        const CVariant &item = data.isMember("item") ? data["item"] : data;
+        if (!item["id"].isInteger() || item["id"].asInteger() <= 0)
+          return "";
+
+        // updates telling different things about the item are kept apart
+        key += "/" + GetItemKey(item);
+        for (const char *member : { "added", "playcount", "transaction" })
+        {
+          if (data.isMember(member))
+            key += std::string("/") + member;
+        }
+      }
+      else if (data.isMember("item"))
+        key += StringUtils::Format("/%" PRId64 "/", data["player"]["playerid"].asInteger()) + GetItemKey(data["item"]);
+
+      return key;
+    }
+
+    return "";
+  }
+}
+
 CTCPServer *CTCPServer::ServerInstance = NULL;
 
 bool CTCPServer::StartServer(int port, bool nonlocal)
@@ -73,6 +183,7 @@ bool CTCPServer::StartServer(int port, bool nonlocal)
   CLog::Log(LOGDEBUG, "CTCPServer: increasing thread stack to %zu", thread_stacksize);
 #endif
     ServerInstance->Create(false, thread_stacksize);
+    ServerInstance->m_notificationSender.Start();
     return true;
   }
   else
@@ -100,11 +211,31 @@ bool CTCPServer::IsRunning()
   return ((CThread*)ServerInstance)->IsRunning();
 }
 
-CTCPServer::CTCPServer(int port, bool nonlocal) : CThread("TCPServer")
+CTCPServer::CTCPServer(int port, bool nonlocal) : CThread("TCPServer"),
+  m_notificationSender(*this)
 {
   m_port = port;
   m_nonlocal = nonlocal;
   m_sdpd = NULL;
+
+  m_wakeSocket = CreateWakeSocket();
+  if (m_wakeSocket == INVALID_SOCKET)
+    CLog::Log(LOGERROR, "JSONRPC Server: Failed to create the wake up socket, pending output is only sent once per second");
+}
+
+CTCPServer::~CTCPServer()
+{
+  // the notification sender may still wake the server thread until it is stopped
+  m_notificationSender.Stop();
+
+  if (m_wakeSocket != INVALID_SOCKET)
+    closesocket(m_wakeSocket);
+}
+
+void CTCPServer::WakeServer()
+{
+  if (m_wakeSocket != INVALID_SOCKET)
+    send(m_wakeSocket, "", 1, 0);
 }
 
 void CTCPServer::Process()
@@ -114,9 +245,16 @@ void CTCPServer::Process()
   while (!m_bStop)
   {
     SOCKET          max_fd = 0;
-    fd_set          rfds;
+    fd_set          rfds, wfds;
     struct timeval  to     = {1, 0};
     FD_ZERO(&rfds);
+    FD_ZERO(&wfds);
+
+    if (m_wakeSocket != INVALID_SOCKET)
+    {
+      FD_SET(m_wakeSocket, &rfds);
+      max_fd = m_wakeSocket;
+    }
 
     for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); ++it)
     {
@@ -128,11 +266,14 @@ void CTCPServer::Process()
     for (unsigned int i = 0; i < m_connections.size(); i++)
     {
       FD_SET(m_connections[i]->m_socket, &rfds);
+      // whatever the socket did not take right away is sent once it is writable again
+      if (m_connections[i]->HasPendingOutput())
+        FD_SET(m_connections[i]->m_socket, &wfds);
       if ((intptr_t)m_connections[i]->m_socket > (intptr_t)max_fd)
         max_fd = m_connections[i]->m_socket;
     }
 
-    int res = select((intptr_t)max_fd+1, &rfds, NULL, NULL, &to);
+    int res = select((intptr_t)max_fd+1, &rfds, &wfds, NULL, &to);
     if (res < 0)
     {
       CLog::Log(LOGERROR, "JSONRPC Server: Select failed");
@@ -141,6 +282,20 @@ void CTCPServer::Process()
     }
     else if (res > 0)
     {
+      if (m_wakeSocket != INVALID_SOCKET && FD_ISSET(m_wakeSocket, &rfds))
+      {
+        char buffer[64];
+        while (recv(m_wakeSocket, buffer, sizeof(buffer), 0) > 0)
+          ;
+      }
+
+      for (unsigned int i = 0; i < m_connections.size(); i++)
+      {
+        // queued notifications wait for the pending output to be out
+        if (FD_ISSET(m_connections[i]->m_socket, &wfds) && m_connections[i]->Flush())
+          m_notificationSender.Wake();
+      }
+
       for (int i = m_connections.size() - 1; i >= 0; i--)
       {
         int socket = m_connections[i]->m_socket;
@@ -162,11 +317,13 @@ void CTCPServer::Process()
 
               if (websocket != NULL)
               {
-                // Replace the CTCPClient with a CWebSocketClient
-                CWebSocketClient *websocketClient = new CWebSocketClient(websocket, *(m_connections[i]));
-                delete m_connections[i];
-                m_connections.erase(m_connections.begin() + i);
-                m_connections.insert(m_connections.begin() + i, websocketClient);
+                // Replace the CTCPClient with a CWebSocketClient, the notification sender may still
+                // hold on to the old one
+                std::shared_ptr<CTCPClient> client = m_connections[i];
+                CSingleLock lock(m_connectionsCritSection);
+                CSingleLock clientLock(client->m_critSection);
+                m_connections[i] = std::make_shared<CWebSocketClient>(websocket, *client);
+                client->Detach();
               }
             }
 
@@ -181,8 +338,8 @@ void CTCPServer::Process()
           if (close)
           {
             CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
+            CSingleLock lock(m_connectionsCritSection);
             m_connections[i]->Disconnect();
-            delete m_connections[i];
             m_connections.erase(m_connections.begin() + i);
           }
         }
@@ -193,7 +350,7 @@ void CTCPServer::Process()
         if (FD_ISSET(*it, &rfds))
         {
           CLog::Log(LOGDEBUG, "JSONRPC Server: New connection detected");
-          CTCPClient *newconnection = new CTCPClient();
+          std::shared_ptr<CTCPClient> newconnection = std::make_shared<CTCPClient>();
           newconnection->m_socket = accept(*it, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
 
           if (newconnection->m_socket == INVALID_SOCKET)
@@ -206,9 +363,15 @@ void CTCPServer::Process()
               break;
             }
           }
+          else if (!SetNonBlocking(newconnection->m_socket))
+          {
+            CLog::Log(LOGERROR, "JSONRPC Server: Failed to make the new connection non-blocking");
+            closesocket(newconnection->m_socket);
+          }
           else
           {
             CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
+            CSingleLock lock(m_connectionsCritSection);
             m_connections.push_back(newconnection);
           }
         }
@@ -236,18 +399,54 @@ int CTCPServer::GetCapabilities()
 
 void CTCPServer::Announce(ANNOUNCEMENT::AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
 {
-  std::string str = IJSONRPCAnnouncer::AnnouncementToJSONRPC(flag, sender, message, data, CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_jsonOutputCompact);
+  unsigned int window = 0;
+  const std::string key = GetCoalescingKey(flag, message, data, window);
+
+  // serialized once for all clients, sending is left to the notification sender
+  std::shared_ptr<const std::string> notification;
 
-  for (unsigned int i = 0; i < m_connections.size(); i++)
   {
+    CSingleLock lock(m_connectionsCritSection);
+    for (unsigned int i = 0; i < m_connections.size(); i++)
     {
-      CSingleLock lock (m_connections[i]->m_critSection);
       if ((m_connections[i]->GetAnnouncementFlags() & flag) == 0)
         continue;
+
+      if (!notification)
+        notification = std::make_shared<const std::string>(IJSONRPCAnnouncer::AnnouncementToJSONRPC(flag, sender, message, data, CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_jsonOutputCompact));
+
+      m_connections[i]->QueueNotification(notification, key, window);
     }
+  }
+
+  if (notification)
+    m_notificationSender.Wake();
+}
+
+unsigned int CTCPServer::SendNotifications()
+{
+  unsigned int wait = XbmcThreads::EndTime::InfiniteValue;
 
-    m_connections[i]->Send(str.c_str(), str.size());
+  // the copy keeps removed clients alive until they were handled, without holding the connections
+  // lock while sending
+  std::vector<std::shared_ptr<CTCPClient>> connections;
+  {
+    CSingleLock lock(m_connectionsCritSection);
+    connections = m_connections;
   }
+
+  bool pendingOutput = false;
+  for (const auto& client : connections)
+  {
+    wait = std::min(wait, client->SendNotifications());
+    pendingOutput |= client->HasPendingOutput();
+  }
+
+  // the server thread only watches the sockets of clients with pending output
+  if (pendingOutput)
+    WakeServer();
+
+  return wait;
 }
 
 bool CTCPServer::Initialize()
@@ -474,13 +673,13 @@ bool CTCPServer::InitializeTCP()
 
 void CTCPServer::Deinitialize()
 {
-  for (unsigned int i = 0; i < m_connections.size(); i++)
   {
-    m_connections[i]->Disconnect();
-    delete m_connections[i];
-  }
+    CSingleLock lock(m_connectionsCritSection);
+    for (unsigned int i = 0; i < m_connections.size(); i++)
+      m_connections[i]->Disconnect();
 
-  m_connections.clear();
+    m_connections.clear();
+  }
 
   for (unsigned int i = 0; i < m_servers.size(); i++)
     closesocket(m_servers[i]);
@@ -505,6 +704,7 @@ CTCPServer::CTCPClient::CTCPClient()
   m_endBrackets = 0;
   m_beginChar = 0;
   m_endChar = 0;
+  m_outputSent = 0;
 
   m_addrlen = sizeof(m_cliaddr);
 }
@@ -527,23 +727,136 @@ int CTCPServer::CTCPClient::GetPermissionFlags()
 
 int CTCPServer::CTCPClient::GetAnnouncementFlags()
 {
+  CSingleLock lock(m_notificationsCritSection);
   return m_announcementflags;
 }
 
 bool CTCPServer::CTCPClient::SetAnnouncementFlags(int flags)
 {
+  CSingleLock lock(m_notificationsCritSection);
   m_announcementflags = flags;
   return true;
 }
 
 void CTCPServer::CTCPClient::Send(const char *data, unsigned int size)
 {
-  unsigned int sent = 0;
-  do
+  // responses and notifications are sent from different threads, don't mix them up
+  CSingleLock lock (m_critSection);
+  if (m_socket == INVALID_SOCKET)
+    return;
+
+  m_output.append(data, size);
+  Flush();
+}
+
+bool CTCPServer::CTCPClient::Flush()
+{
+  CSingleLock lock (m_critSection);
+
+  while (m_outputSent < m_output.size() && m_socket != INVALID_SOCKET)
   {
-    CSingleLock lock (m_critSection);
-    sent += send(m_socket, data + sent, size - sent, 0);
-  } while (sent < size);
+    int result = send(m_socket, m_output.c_str() + m_outputSent, m_output.size() - m_outputSent, 0);
+    if (result > 0)
+      m_outputSent += result;
+    else if (result < 0 && errno == EINTR)
+      continue;
+    else if (result < 0 && WouldBlock())
+      return false;
+    else
+      break; // the connection is gone, the server thread notices it when reading
+  }
+
+  m_output.clear();
+  m_outputSent = 0;
+  return true;
+}
+
+bool CTCPServer::CTCPClient::HasPendingOutput()
+{
+  CSingleLock lock (m_critSection);
+  return m_outputSent < m_output.size();
+}
+
+void CTCPServer::CTCPClient::Detach()
+{
+  CSingleLock lock (m_critSection);
+  m_socket = INVALID_SOCKET;
+  m_output.clear();
+  m_outputSent = 0;
+
+  CSingleLock notificationsLock(m_notificationsCritSection);
+  m_notifications.clear();
+}
+
+void CTCPServer::CTCPClient::QueueNotification(const std::shared_ptr<const std::string> &notification, const std::string &key, unsigned int window)
+{
+  CSingleLock lock(m_notificationsCritSection);
+
+  if (!key.empty())
+  {
+    for (auto& pending : m_notifications)
+    {
+      if (pending.key == key)
+      {
+        pending.data = notification;
+        return;
+      }
+    }
+  }
+
+  if (m_notifications.size() >= MAX_PENDING_NOTIFICATIONS)
+  {
+    CLog::Log(LOGDEBUG, "JSONRPC Server: Client does not keep up with notifications, dropping the oldest one");
+    m_notifications.pop_front();
+  }
+
+  m_notifications.push_back({ notification, key, window });
+}
+
+unsigned int CTCPServer::CTCPClient::SendNotifications()
+{
+  CSingleLock sendLock (m_critSection);
+
+  while (true)
+  {
+    // a notification is only started once the previous output is out, the server thread flushes
+    // the rest once the socket is writable and wakes the sender up again
+    if (!Flush())
+      return XbmcThreads::EndTime::InfiniteValue;
+
+    std::shared_ptr<const std::string> notification;
+    {
+      CSingleLock lock(m_notificationsCritSection);
+
+      for (auto it = m_notificationWindows.begin(); it != m_notificationWindows.end();)
+      {
+        if (it->second.IsTimePast())
+          it = m_notificationWindows.erase(it);
+        else
+          ++it;
+      }
+
+      if (m_notifications.empty())
+        return XbmcThreads::EndTime::InfiniteValue;
+
+      const Notification &next = m_notifications.front();
+      if (next.window > 0)
+      {
+        // only held back as long as nothing else is queued after it, newer notifications with
+        // the same key replace it in the meantime
+        auto window = m_notificationWindows.find(next.key);
+        if (window != m_notificationWindows.end() && m_notifications.size() == 1)
+          return window->second.MillisLeft();
+
+        m_notificationWindows[next.key].Set(next.window);
+      }
+
+      notification = next.data;
+      m_notifications.pop_front();
+    }
+
+    Send(notification->c_str(), notification->size());
+  }
 }
 
 void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
@@ -631,16 +944,20 @@ void CTCPServer::CTCPClient::Disconnect()
 
 void CTCPServer::CTCPClient::Copy(const CTCPClient& client)
 {
-  m_new               = client.m_new;
-  m_socket            = client.m_socket;
-  m_cliaddr           = client.m_cliaddr;
-  m_addrlen           = client.m_addrlen;
-  m_announcementflags = client.m_announcementflags;
-  m_beginBrackets     = client.m_beginBrackets;
-  m_endBrackets       = client.m_endBrackets;
-  m_beginChar         = client.m_beginChar;
-  m_endChar           = client.m_endChar;
-  m_buffer            = client.m_buffer;
+  m_new                 = client.m_new;
+  m_socket              = client.m_socket;
+  m_cliaddr             = client.m_cliaddr;
+  m_addrlen             = client.m_addrlen;
+  m_announcementflags   = client.m_announcementflags;
+  m_beginBrackets       = client.m_beginBrackets;
+  m_endBrackets         = client.m_endBrackets;
+  m_beginChar           = client.m_beginChar;
+  m_endChar             = client.m_endChar;
+  m_buffer              = client.m_buffer;
+  m_output              = client.m_output;
+  m_outputSent          = client.m_outputSent;
+  m_notifications       = client.m_notifications;
+  m_notificationWindows = client.m_notificationWindows;
 }
 
 CTCPServer::CWebSocketClient::CWebSocketClient(CWebSocket *websocket)
@@ -680,9 +997,13 @@ void CTCPServer::CWebSocketClient::Send(const char *data, unsigned int size)
   if (msg == NULL || !msg->IsComplete())
     return;
 
+  // the frames of a message are passed on at once so that no other message ends up between them
+  std::string frameData;
   std::vector<const CWebSocketFrame *> frames = msg->GetFrames();
   for (unsigned int index = 0; index < frames.size(); index++)
-    CTCPClient::Send(frames.at(index)->GetFrameData(), (unsigned int)frames.at(index)->GetFrameLength());
+    frameData.append(frames.at(index)->GetFrameData(), frames.at(index)->GetFrameLength());
+
+  CTCPClient::Send(frameData.c_str(), (unsigned int)frameData.size());
 }
 
 void CTCPServer::CWebSocketClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
@@ -731,3 +1052,37 @@ void CTCPServer::CWebSocketClient::Disconnect()
   }
 }
 
+CTCPServer::CNotificationSender::CNotificationSender(CTCPServer &server)
+  : CThread("TCPServerNotifications"),
+    m_server(server)
+{
+}
+
+CTCPServer::CNotificationSender::~CNotificationSender()
+{
+  Stop();
+}
+
+void CTCPServer::CNotificationSender::Stop()
+{
+  m_bStop = true;
+  m_event.Set();
+  StopThread();
+}
+
+void CTCPServer::CNotificationSender::Start()
+{
+  Create();
+}
+
+void CTCPServer::CNotificationSender::Process()
+{
+  while (!m_bStop)
+  {
+    unsigned int wait = m_server.SendNotifications();
+    if (wait == XbmcThreads::EndTime::InfiniteValue)
+      m_event.Wait();
+    else
+      m_event.WaitMSec(wait);
+  }
+}
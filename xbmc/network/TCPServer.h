@@ -8,6 +8,10 @@
 
 #pragma once
 
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
 #include <vector>
 #include <sys/socket.h>
 
@@ -16,6 +20,8 @@
 #include "interfaces/json-rpc/IJSONRPCAnnouncer.h"
 #include "interfaces/json-rpc/ITransportLayer.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/SystemClock.h"
 #include "threads/Thread.h"
 #include "websocket/WebSocket.h"
 
@@ -39,10 +45,35 @@ namespace JSONRPC
     void Process() override;
   private:
     CTCPServer(int port, bool nonlocal);
+    ~CTCPServer() override;
     bool Initialize();
     bool InitializeBlue();
     bool InitializeTCP();
     void Deinitialize();
+    unsigned int SendNotifications();
+    void WakeServer();
+
+    /*!
+     * Sends the queued notifications, so that announcing does not wait for a client. Whatever the
+     * client sockets did not take right away is sent by the server thread once they are writable.
+     */
+    class CNotificationSender : public CThread
+    {
+    public:
+      explicit CNotificationSender(CTCPServer &server);
+      ~CNotificationSender() override;
+
+      void Start();
+      void Stop();
+      void Wake() { m_event.Set(); }
+
+    protected:
+      void Process() override;
+
+    private:
+      CTCPServer &m_server;
+      CEvent m_event;
+    };
 
     class CTCPClient : public IClient
     {
@@ -58,7 +89,40 @@ namespace JSONRPC
       int GetAnnouncementFlags() override;
       bool SetAnnouncementFlags(int flags) override;
 
+      /*!
+       * @brief Send data to the client without blocking.
+       * Whatever the socket does not take right away is kept as pending output and sent by Flush().
+       */
       virtual void Send(const char *data, unsigned int size);
+
+      /*!
+       * @brief Send as much of the pending output as the socket takes without blocking.
+       * @return true if there is no pending output left.
+       */
+      bool Flush();
+      bool HasPendingOutput();
+
+      /*!
+       * @brief Stop using the socket after it was handed over to another client object.
+       */
+      void Detach();
+
+      /*!
+       * @brief Queue a notification for the client.
+       * @param notification The serialized notification, shared by all clients.
+       * @param key Pending notifications with the same non-empty key are replaced by the newer one.
+       * @param window Minimum time in milliseconds between two sent notifications with the same key.
+       */
+      void QueueNotification(const std::shared_ptr<const std::string> &notification, const std::string &key, unsigned int window);
+
+      /*!
+       * @brief Send the queued notifications, in order, until one has to be held back or the socket
+       * does not take more data.
+       * @return The time in milliseconds until a held back notification is due or
+       * XbmcThreads::EndTime::InfiniteValue if there is nothing to send before the client is
+       * woken up again.
+       */
+      unsigned int SendNotifications();
       virtual void PushBuffer(CTCPServer *host, const char *buffer, int length);
       virtual void Disconnect();
 
@@ -73,11 +137,23 @@ namespace JSONRPC
     protected:
       void Copy(const CTCPClient& client);
     private:
+      struct Notification
+      {
+        std::shared_ptr<const std::string> data;
+        std::string key;
+        unsigned int window;
+      };
+
       bool m_new;
       int m_announcementflags;
       int m_beginBrackets, m_endBrackets;
       char m_beginChar, m_endChar;
       std::string m_buffer;
+      std::string m_output; // guarded by m_critSection
+      size_t m_outputSent;
+      CCriticalSection m_notificationsCritSection;
+      std::deque<Notification> m_notifications;
+      std::map<std::string, XbmcThreads::EndTime> m_notificationWindows;
     };
 
     class CWebSocketClient : public CTCPClient
@@ -100,11 +176,14 @@ namespace JSONRPC
       CWebSocket *m_websocket;
     };
 
-    std::vector<CTCPClient*> m_connections;
+    CCriticalSection m_connectionsCritSection;
+    std::vector<std::shared_ptr<CTCPClient>> m_connections;
     std::vector<SOCKET> m_servers;
     int m_port;
     bool m_nonlocal;
     void* m_sdpd;
+    SOCKET m_wakeSocket;
+    CNotificationSender m_notificationSender;
 
     static CTCPServer *ServerInstance;
   };
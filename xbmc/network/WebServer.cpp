@@ -14,10 +14,14 @@
 #include <utility>
 
 #if defined(TARGET_POSIX)
+#include <fcntl.h>
 #include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
 #include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
 #include "network/httprequesthandler/HTTPRequestHandlerUtils.h"
 #include "network/httprequesthandler/IHTTPRequestHandler.h"
 #include "settings/AdvancedSettings.h"
@@ -25,7 +29,9 @@
 #include "settings/SettingsComponent.h"
 #include "ServiceBroker.h"
 #include "threads/SingleLock.h"
+#include "threads/Thread.h"
 #include "Util.h"
+#include "utils/JobManager.h"
 #include "utils/FileUtils.h"
 #include "utils/log.h"
 #include "utils/Mime.h"
@@ -86,6 +92,40 @@ static MHD_Response* create_response(size_t size, const void* data, int free, in
   return MHD_create_response_from_buffer(size, const_cast<void*>(data), mode);
 }
 
+static MHD_Response* create_response_from_local_file(const std::string& filePath, uint64_t offset, uint64_t length)
+{
+#if defined(TARGET_POSIX) && (MHD_VERSION >= 0x00094300)
+  // only plain files on a local filesystem can be handed to libmicrohttpd, which sends them
+  // using sendfile() without copying the data through our own buffers
+  if (!URIUtils::IsHD(filePath) || URIUtils::IsStack(filePath) || URIUtils::IsInArchive(filePath))
+    return nullptr;
+
+  const std::string localPath = CSpecialProtocol::TranslatePath(filePath);
+  if (localPath.empty() || localPath[0] != '/')
+    return nullptr;
+
+  int fd = open(localPath.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return nullptr;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || static_cast<uint64_t>(st.st_size) < offset + length)
+  {
+    close(fd);
+    return nullptr;
+  }
+
+  // the file descriptor is closed by libmicrohttpd when the response is destroyed
+  MHD_Response* response = MHD_create_response_from_fd_at_offset64(length, fd, offset);
+  if (response == nullptr)
+    close(fd);
+
+  return response;
+#else
+  return nullptr;
+#endif
+}
+
 int CWebServer::AskForAuthentication(const HTTPRequest& request) const
 {
   struct MHD_Response *response = create_response(0, nullptr, MHD_NO, MHD_NO);
@@ -167,6 +207,16 @@ int CWebServer::HandlePartialRequest(struct MHD_Connection *connection, Connecti
 {
   std::unique_ptr<ConnectionHandler> conHandler(connectionHandler);
 
+  // the request has been handled outside of the web server's threads, send the response it created
+  if (conHandler->isAsync)
+  {
+    *con_cls = nullptr;
+    if (conHandler->asyncResponse == nullptr)
+      return conHandler->asyncResult;
+
+    return SendResponse(request, conHandler->asyncResponseStatus, conHandler->asyncResponse);
+  }
+
   // remember if the request was new
   bool isNewRequest = conHandler->isNew;
   // because now it isn't anymore
@@ -181,52 +231,27 @@ int CWebServer::HandlePartialRequest(struct MHD_Connection *connection, Connecti
   // check if this is the first call to AnswerToConnection for this request
   if (isNewRequest)
   {
+    // with a thread pool, don't let slow request handlers block one of the pool's threads
+    if (m_threadPoolSize > 0 && request.method != POST)
+    {
+      const IHTTPRequestHandler* prototype = FindRequestHandlerPrototype(request);
+      if (prototype != nullptr && prototype->IsBlocking())
+      {
+        HandleRequestAsync(request, conHandler.get());
+
+        // as ownership of the connection handler has been passed to libmicrohttpd we must not destroy it
+        *con_cls = conHandler.release();
+
+        return MHD_YES;
+      }
+    }
+
     // look for a IHTTPRequestHandler which can take care of the current request
     auto handler = FindRequestHandler(request);
     if (handler != nullptr)
     {
-      // if we got a GET request we need to check if it should be cached
-      if (request.method == GET)
-      {
-        if (handler->CanBeCached())
-        {
-          bool cacheable = IsRequestCacheable(request);
-
-          CDateTime lastModified;
-          if (handler->GetLastModifiedDate(lastModified) && lastModified.IsValid())
-          {
-            // handle If-Modified-Since or If-Unmodified-Since
-            std::string ifModifiedSince = HTTPRequestHandlerUtils::GetRequestHeaderValue(connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_IF_MODIFIED_SINCE);
-            std::string ifUnmodifiedSince = HTTPRequestHandlerUtils::GetRequestHeaderValue(connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_IF_UNMODIFIED_SINCE);
-
-            CDateTime ifModifiedSinceDate;
-            CDateTime ifUnmodifiedSinceDate;
-            // handle If-Modified-Since (but only if the response is cacheable)
-            if (cacheable &&
-              ifModifiedSinceDate.SetFromRFC1123DateTime(ifModifiedSince) &&
-              lastModified.GetAsUTCDateTime() <= ifModifiedSinceDate)
-            {
-              struct MHD_Response *response = create_response(0, nullptr, MHD_NO, MHD_NO);
-              if (response == nullptr)
-              {
-                CLog::Log(LOGERROR, "CWebServer[%hu]: failed to create a HTTP 304 response", m_port);
-                return MHD_NO;
-              }
-
-              return FinalizeRequest(handler, MHD_HTTP_NOT_MODIFIED, response);
-            }
-            // handle If-Unmodified-Since
-            else if (ifUnmodifiedSinceDate.SetFromRFC1123DateTime(ifUnmodifiedSince) &&
-              lastModified.GetAsUTCDateTime() > ifUnmodifiedSinceDate)
-              return SendErrorResponse(request, MHD_HTTP_PRECONDITION_FAILED, request.method);
-          }
-
-          // pass the requested ranges on to the request handler
-          handler->SetRequestRanged(IsRequestRanged(request, lastModified));
-        }
-      }
       // if we got a POST request we need to take care of the POST data
-      else if (request.method == POST)
+      if (request.method == POST)
       {
         // as ownership of the connection handler is passed to libmicrohttpd we must not destroy it
         SetupPostDataProcessing(request, conHandler.get(), handler, con_cls);
@@ -237,7 +262,7 @@ int CWebServer::HandlePartialRequest(struct MHD_Connection *connection, Connecti
         return MHD_YES;
       }
 
-      return HandleRequest(handler);
+      return HandleNewRequest(request, handler);
     }
   }
   // this is a subsequent call to AnswerToConnection for this request
@@ -276,6 +301,93 @@ int CWebServer::HandlePartialRequest(struct MHD_Connection *connection, Connecti
   return SendErrorResponse(request, MHD_HTTP_NOT_FOUND, request.method);
 }
 
+int CWebServer::HandleNewRequest(const HTTPRequest& request, const std::shared_ptr<IHTTPRequestHandler>& handler)
+{
+  // if we got a GET request we need to check if it should be cached
+  if (request.method == GET && handler->CanBeCached())
+  {
+    bool cacheable = IsRequestCacheable(request);
+
+    CDateTime lastModified;
+    if (handler->GetLastModifiedDate(lastModified) && lastModified.IsValid())
+    {
+      // handle If-Modified-Since or If-Unmodified-Since
+      std::string ifModifiedSince = HTTPRequestHandlerUtils::GetRequestHeaderValue(request.connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_IF_MODIFIED_SINCE);
+      std::string ifUnmodifiedSince = HTTPRequestHandlerUtils::GetRequestHeaderValue(request.connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_IF_UNMODIFIED_SINCE);
+
+      CDateTime ifModifiedSinceDate;
+      CDateTime ifUnmodifiedSinceDate;
+      // handle If-Modified-Since (but only if the response is cacheable)
+      if (cacheable &&
+        ifModifiedSinceDate.SetFromRFC1123DateTime(ifModifiedSince) &&
+        lastModified.GetAsUTCDateTime() <= ifModifiedSinceDate)
+      {
+        struct MHD_Response *response = create_response(0, nullptr, MHD_NO, MHD_NO);
+        if (response == nullptr)
+        {
+          CLog::Log(LOGERROR, "CWebServer[%hu]: failed to create a HTTP 304 response", m_port);
+          return MHD_NO;
+        }
+
+        return FinalizeRequest(handler, MHD_HTTP_NOT_MODIFIED, response);
+      }
+      // handle If-Unmodified-Since
+      else if (ifUnmodifiedSinceDate.SetFromRFC1123DateTime(ifUnmodifiedSince) &&
+        lastModified.GetAsUTCDateTime() > ifUnmodifiedSinceDate)
+        return SendErrorResponse(request, MHD_HTTP_PRECONDITION_FAILED, request.method);
+    }
+
+    // pass the requested ranges on to the request handler
+    handler->SetRequestRanged(IsRequestRanged(request, lastModified));
+  }
+
+  return HandleRequest(handler);
+}
+
+void CWebServer::HandleRequestAsync(const HTTPRequest& request, ConnectionHandler* connectionHandler)
+{
+  connectionHandler->isAsync = true;
+
+  {
+    CSingleLock lock(m_asyncCritSection);
+    m_asyncConnections.insert(std::make_pair(request.connection, connectionHandler));
+  }
+
+  // libmicrohttpd calls AnswerToConnection again once the connection has been resumed
+  MHD_suspend_connection(request.connection);
+
+  CJobManager::GetInstance().Submit([this, request, connectionHandler]()
+  {
+    int ret;
+    auto handler = FindRequestHandler(request);
+    if (handler != nullptr)
+      ret = HandleNewRequest(request, handler);
+    else
+    {
+      CLog::Log(LOGERROR, "CWebServer[%hu]: couldn't find any request handler for %s", m_port, request.pathUrl.c_str());
+      ret = SendErrorResponse(request, MHD_HTTP_NOT_FOUND, request.method);
+    }
+
+    CSingleLock lock(m_asyncCritSection);
+    connectionHandler->asyncResult = ret;
+    MHD_resume_connection(request.connection);
+    m_asyncConnections.erase(request.connection);
+  });
+}
+
+bool CWebServer::DeferResponse(const HTTPRequest& request, int responseStatus, struct MHD_Response *response) const
+{
+  // responses of asynchronously handled requests can only be queued once the connection has been resumed
+  CSingleLock lock(m_asyncCritSection);
+  const auto it = m_asyncConnections.find(request.connection);
+  if (it == m_asyncConnections.end())
+    return false;
+
+  it->second->asyncResponseStatus = responseStatus;
+  it->second->asyncResponse = response;
+  return true;
+}
+
 int CWebServer::HandlePostField(void *cls, enum MHD_ValueKind kind, const char *key,
                                 const char *filename, const char *content_type,
                                 const char *transfer_encoding, const char *data, uint64_t off,
@@ -416,7 +528,7 @@ int CWebServer::FinalizeRequest(const std::shared_ptr<IHTTPRequestHandler>& hand
   return SendResponse(request, responseStatus, response);
 }
 
-std::shared_ptr<IHTTPRequestHandler> CWebServer::FindRequestHandler(const HTTPRequest& request) const
+const IHTTPRequestHandler* CWebServer::FindRequestHandlerPrototype(const HTTPRequest& request) const
 {
   // look for a IHTTPRequestHandler which can take care of the current request
   auto requestHandlerIt = std::find_if(m_requestHandlers.cbegin(), m_requestHandlers.cend(),
@@ -425,9 +537,18 @@ std::shared_ptr<IHTTPRequestHandler> CWebServer::FindRequestHandler(const HTTPRe
       return requestHandler->CanHandleRequest(request);
     });
 
-  // we found a matching IHTTPRequestHandler so let's get a new instance for this request
   if (requestHandlerIt != m_requestHandlers.cend())
-    return std::shared_ptr<IHTTPRequestHandler>((*requestHandlerIt)->Create(request));
+    return *requestHandlerIt;
+
+  return nullptr;
+}
+
+std::shared_ptr<IHTTPRequestHandler> CWebServer::FindRequestHandler(const HTTPRequest& request) const
+{
+  // we found a matching IHTTPRequestHandler so let's get a new instance for this request
+  const IHTTPRequestHandler* requestHandler = FindRequestHandlerPrototype(request);
+  if (requestHandler != nullptr)
+    return std::shared_ptr<IHTTPRequestHandler>(requestHandler->Create(request));
 
   return nullptr;
 }
@@ -814,18 +935,25 @@ int CWebServer::CreateFileDownloadResponse(const std::shared_ptr<IHTTPRequestHan
     // set the initial write position
     context->ranges.GetFirstPosition(context->writePosition);
 
-    // create the response object
-    response = MHD_create_response_from_callback(totalLength, 2048,
-                                                  &CWebServer::ContentReaderCallback,
-                                                  context.get(),
-                                                  &CWebServer::ContentReaderFreeCallback);
+    // a single range of a local file can be sent directly from the file descriptor
+    if (context->rangeCountTotal == 1)
+      response = create_response_from_local_file(filePath, context->writePosition, totalLength);
+
+    // otherwise the response is filled through the VFS
     if (response == nullptr)
     {
-      CLog::Log(LOGERROR, "CWebServer[%hu]: failed to create a HTTP response for %s to be filled from %s", m_port, request.pathUrl.c_str(), filePath.c_str());
-      return MHD_NO;
-    }
+      response = MHD_create_response_from_callback(totalLength, 2048,
+                                                    &CWebServer::ContentReaderCallback,
+                                                    context.get(),
+                                                    &CWebServer::ContentReaderFreeCallback);
+      if (response == nullptr)
+      {
+        CLog::Log(LOGERROR, "CWebServer[%hu]: failed to create a HTTP response for %s to be filled from %s", m_port, request.pathUrl.c_str(), filePath.c_str());
+        return MHD_NO;
+      }
 
-    context.release(); // ownership was passed to mhd
+      context.release(); // ownership was passed to mhd
+    }
 
     // add Content-Range header
     if (ranged)
@@ -895,6 +1023,9 @@ int CWebServer::CreateMemoryDownloadResponse(struct MHD_Connection *connection,
 
 int CWebServer::SendResponse(const HTTPRequest& request, int responseStatus, MHD_Response *response) const
 {
+  if (DeferResponse(request, responseStatus, response))
+    return MHD_YES;
+
   LogResponse(request, responseStatus);
 
   int ret = MHD_queue_response(request.connection, responseStatus, response);
@@ -1106,19 +1237,31 @@ struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
 
   MHD_set_panic_func(&panicHandlerForMHD, nullptr);
 
+  if (m_threadPoolSize > 0)
+  {
+    // a fixed pool of threads polling all connections, blocking requests are suspended and handled by jobs
+    flags |= MHD_USE_SELECT_INTERNALLY | MHD_USE_SUSPEND_RESUME;
+    if (MHD_is_feature_supported(MHD_FEATURE_EPOLL) == MHD_YES)
+      flags |= MHD_USE_EPOLL_LINUX_ONLY;
+  }
+  else
+  {
+    // one thread per connection
+    // WARNING: set MHD_OPTION_CONNECTION_TIMEOUT to something higher than 1
+    // otherwise on libmicrohttpd 0.4.4-1 it spins a busy loop
+    flags |= MHD_USE_THREAD_PER_CONNECTION
+#if (MHD_VERSION >= 0x00095207)
+             | MHD_USE_INTERNAL_POLLING_THREAD /* MHD_USE_THREAD_PER_CONNECTION must be used only with MHD_USE_INTERNAL_POLLING_THREAD since 0.9.54 */
+#endif
+             ;
+  }
+
   if (CServiceBroker::GetSettingsComponent()->GetSettings()->GetBool(CSettings::SETTING_SERVICES_WEBSERVERSSL) &&
       MHD_is_feature_supported(MHD_FEATURE_SSL) == MHD_YES &&
       LoadCert(m_key, m_cert))
     // SSL enabled
     return MHD_start_daemon(flags |
-                          // one thread per connection
-                          // WARNING: set MHD_OPTION_CONNECTION_TIMEOUT to something higher than 1
-                          // otherwise on libmicrohttpd 0.4.4-1 it spins a busy loop
-                          MHD_USE_THREAD_PER_CONNECTION
-#if (MHD_VERSION >= 0x00095207)
-                          | MHD_USE_INTERNAL_POLLING_THREAD /* MHD_USE_THREAD_PER_CONNECTION must be used only with MHD_USE_INTERNAL_POLLING_THREAD since 0.9.54 */
-#endif
-                          | MHD_USE_DEBUG /* Print MHD error messages to log */
+                          MHD_USE_DEBUG /* Print MHD error messages to log */
                           | MHD_USE_SSL
                           ,
                           port,
@@ -1132,6 +1275,7 @@ struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
                           MHD_OPTION_URI_LOG_CALLBACK, &CWebServer::UriRequestLogger, this,
                           MHD_OPTION_EXTERNAL_LOGGER, &logFromMHD, 0,
                           MHD_OPTION_THREAD_STACK_SIZE, m_thread_stacksize,
+                          MHD_OPTION_THREAD_POOL_SIZE, m_threadPoolSize,
                           MHD_OPTION_HTTPS_MEM_KEY, m_key.c_str(),
                           MHD_OPTION_HTTPS_MEM_CERT, m_cert.c_str(),
                           MHD_OPTION_HTTPS_PRIORITIES, ciphers,
@@ -1139,14 +1283,7 @@ struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
 
   // No SSL
   return MHD_start_daemon(flags |
-                          // one thread per connection
-                          // WARNING: set MHD_OPTION_CONNECTION_TIMEOUT to something higher than 1
-                          // otherwise on libmicrohttpd 0.4.4-1 it spins a busy loop
-                          MHD_USE_THREAD_PER_CONNECTION
-#if (MHD_VERSION >= 0x00095207)
-                          | MHD_USE_INTERNAL_POLLING_THREAD /* MHD_USE_THREAD_PER_CONNECTION must be used only with MHD_USE_INTERNAL_POLLING_THREAD since 0.9.54 */
-#endif
-                          | MHD_USE_DEBUG /* Print MHD error messages to log */
+                          MHD_USE_DEBUG /* Print MHD error messages to log */
                           ,
                           port,
                           0,
@@ -1159,6 +1296,7 @@ struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
                           MHD_OPTION_URI_LOG_CALLBACK, &CWebServer::UriRequestLogger, this,
                           MHD_OPTION_EXTERNAL_LOGGER, &logFromMHD, 0,
                           MHD_OPTION_THREAD_STACK_SIZE, m_thread_stacksize,
+                          MHD_OPTION_THREAD_POOL_SIZE, m_threadPoolSize,
                           MHD_OPTION_END);
 }
 
@@ -1167,6 +1305,8 @@ bool CWebServer::Start(uint16_t port, const std::string &username, const std::st
   SetCredentials(username, password);
   if (!m_running)
   {
+    m_threadPoolSize = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_webserverThreadPoolSize;
+
     int v6testSock;
     if ((v6testSock = socket(AF_INET6, SOCK_STREAM, 0)) >= 0)
     {
@@ -1193,6 +1333,17 @@ bool CWebServer::Stop()
   if (!m_running)
     return true;
 
+  // libmicrohttpd must not be stopped with suspended connections, wait for asynchronously handled requests
+  while (true)
+  {
+    {
+      CSingleLock lock(m_asyncCritSection);
+      if (m_asyncConnections.empty())
+        break;
+    }
+    XbmcThreads::ThreadSleep(10);
+  }
+
   if (m_daemon_ip6 != nullptr)
     MHD_stop_daemon(m_daemon_ip6);
 
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -44,6 +45,10 @@ protected:
     std::shared_ptr<IHTTPRequestHandler> requestHandler;
     struct MHD_PostProcessor *postprocessor;
     int errorStatus;
+    bool isAsync;                   // handled outside of the web server's threads
+    int asyncResult;
+    int asyncResponseStatus;
+    struct MHD_Response *asyncResponse;
 
     explicit ConnectionHandler(const std::string& uri)
       : fullUri(uri)
@@ -51,6 +56,10 @@ protected:
       , requestHandler(nullptr)
       , postprocessor(nullptr)
       , errorStatus(MHD_HTTP_OK)
+      , isAsync(false)
+      , asyncResult(MHD_NO)
+      , asyncResponseStatus(MHD_HTTP_OK)
+      , asyncResponse(nullptr)
     { }
   } ConnectionHandler;
 
@@ -64,8 +73,13 @@ protected:
 private:
   struct MHD_Daemon* StartMHD(unsigned int flags, int port);
 
+  const IHTTPRequestHandler* FindRequestHandlerPrototype(const HTTPRequest& request) const;
   std::shared_ptr<IHTTPRequestHandler> FindRequestHandler(const HTTPRequest& request) const;
 
+  int HandleNewRequest(const HTTPRequest& request, const std::shared_ptr<IHTTPRequestHandler>& handler);
+  void HandleRequestAsync(const HTTPRequest& request, ConnectionHandler* connectionHandler);
+  bool DeferResponse(const HTTPRequest& request, int responseStatus, struct MHD_Response *response) const;
+
   int AskForAuthentication(const HTTPRequest& request) const;
   bool IsAuthenticated(const HTTPRequest& request) const;
 
@@ -116,6 +130,7 @@ private:
   struct MHD_Daemon *m_daemon_ip4 = nullptr;
   bool m_running = false;
   size_t m_thread_stacksize = 0;
+  unsigned int m_threadPoolSize = 0;
   bool m_authenticationRequired = false;
   std::string m_authenticationUsername;
   std::string m_authenticationPassword;
@@ -123,4 +138,6 @@ private:
   std::string m_cert;
   mutable CCriticalSection m_critSection;
   std::vector<IHTTPRequestHandler *> m_requestHandlers;
+  mutable CCriticalSection m_asyncCritSection;
+  std::map<struct MHD_Connection*, ConnectionHandler*> m_asyncConnections; // suspended while handled asynchronously
 };
@@ -25,6 +25,7 @@ public:
 
   int HandleRequest() override;
 
+  bool IsBlocking() const override { return true; }
   bool CanHandleRanges() const override { return true; }
   bool CanBeCached() const override { return true; }
   bool GetLastModifiedDate(CDateTime &lastModified) const override;
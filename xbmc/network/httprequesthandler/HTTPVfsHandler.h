@@ -21,6 +21,8 @@ public:
   IHTTPRequestHandler* Create(const HTTPRequest &request) const override { return new CHTTPVfsHandler(request); }
   bool CanHandleRequest(const HTTPRequest &request) const override;
 
+  bool IsBlocking() const override { return true; }
+
   int GetPriority() const override { return 5; }
 
 protected:
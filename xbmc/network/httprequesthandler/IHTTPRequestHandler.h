@@ -116,6 +116,16 @@ public:
    */
   virtual int HandleRequest() = 0;
 
+  /*!
+   * \brief Whether creating the HTTP request handler or handling the request
+   * may block for a longer time, e.g. because of file system access or image
+   * processing.
+   *
+   * \details If the web server uses a thread pool, such requests are handled
+   * outside of the pool's threads so they don't delay other requests.
+   */
+  virtual bool IsBlocking() const { return false; }
+
   /*!
    * \brief Whether the HTTP response could also be provided in ranges.
    */
@@ -0,0 +1,299 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "ServiceBroker.h"
+#include "interfaces/AnnouncementManager.h"
+#include "network/TCPServer.h"
+#include "threads/Event.h"
+#include "utils/Variant.h"
+
+using namespace ANNOUNCEMENT;
+
+namespace
+{
+
+const unsigned int SCAN_CLIENTS = 20;
+const int SCAN_UPDATES = 5000;
+const int SCAN_ITEMS = 500; // every item is updated several times during the scan
+const unsigned int FUNCTIONAL_SCAN_CLIENTS = 4;
+const int FUNCTIONAL_SCAN_UPDATES = 500;
+const int FUNCTIONAL_SCAN_ITEMS = 50;
+const int LARGE_NOTIFICATIONS = 200;
+const size_t LARGE_NOTIFICATION_SIZE = 64 * 1024; // together far more than a socket buffers
+
+// registered after the TCP server, so it is called once the server handled an announcement
+class CAnnouncementProbe : public IAnnouncer
+{
+public:
+  void Announce(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data) override
+  {
+    if (flag == VideoLibrary && strcmp(message, "OnScanFinished") == 0)
+    {
+      finished = std::chrono::steady_clock::now();
+      finishedEvent.Set();
+    }
+  }
+
+  std::chrono::steady_clock::time_point finished;
+  CEvent finishedEvent;
+};
+
+size_t CountOccurrences(const std::string &data, const std::string &pattern)
+{
+  size_t count = 0;
+  for (size_t pos = data.find(pattern); pos != std::string::npos; pos = data.find(pattern, pos + pattern.size()))
+    count++;
+  return count;
+}
+
+} // unnamed namespace
+
+/*!
+ * Announces notifications to connected JSON-RPC clients, some of which don't read while the
+ * notifications are announced. The scan benchmark reports how long the announcing thread was busy
+ * and how many notifications reached the clients.
+ */
+class TestTCPServer : public testing::Test
+{
+protected:
+  TestTCPServer()
+  {
+    std::random_device rd;
+    std::mt19937 mt(rd());
+    std::uniform_int_distribution<uint16_t> dist(49152, 65535);
+    port = dist(mt);
+  }
+
+  void SetUp() override
+  {
+    if (!CServiceBroker::GetAnnouncementManager())
+    {
+      m_announcementManager = std::make_shared<CAnnouncementManager>();
+      m_announcementManager->Start();
+      CServiceBroker::RegisterAnnouncementManager(m_announcementManager);
+    }
+  }
+
+  void TearDown() override
+  {
+    for (int socket : clients)
+      close(socket);
+
+    JSONRPC::CTCPServer::StopServer(true);
+    CServiceBroker::GetAnnouncementManager()->RemoveAnnouncer(&probe);
+
+    if (m_announcementManager)
+    {
+      CServiceBroker::UnregisterAnnouncementManager();
+      m_announcementManager->Deinitialize();
+    }
+  }
+
+  int Connect()
+  {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0)
+      return -1;
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+      close(sock);
+      return -1;
+    }
+
+    timeval timeout = { 10, 0 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    // once the server answered a request, it accepted the connection and announces to it
+    const std::string request = "{ \"jsonrpc\": \"2.0\", \"method\": \"JSONRPC.Ping\", \"id\": 1 }";
+    if (send(sock, request.c_str(), request.size(), 0) != static_cast<ssize_t>(request.size()) ||
+        ReadUntil(sock, "\"jsonrpc\"").find("\"jsonrpc\"") == std::string::npos)
+    {
+      close(sock);
+      return -1;
+    }
+
+    return sock;
+  }
+
+  static std::string ReadUntil(int socket, const std::string &pattern)
+  {
+    std::string data;
+    char buffer[4096];
+    while (data.find(pattern) == std::string::npos)
+    {
+      ssize_t read = recv(socket, buffer, sizeof(buffer), 0);
+      if (read <= 0)
+        break;
+      data.append(buffer, read);
+    }
+    return data;
+  }
+
+  // announces a scan to clients that only start reading once the announcing thread is done
+  void AnnounceScan(unsigned int clientCount, int updates, int items,
+                    double &announceMs, std::vector<std::string> &received)
+  {
+    ASSERT_TRUE(JSONRPC::CTCPServer::StartServer(port, false));
+    CServiceBroker::GetAnnouncementManager()->AddAnnouncer(&probe);
+
+    for (unsigned int i = 0; i < clientCount; i++)
+    {
+      int socket = Connect();
+      ASSERT_GE(socket, 0);
+      clients.push_back(socket);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < updates; i++)
+    {
+      CVariant data;
+      data["type"] = "movie";
+      data["id"] = i % items + 1;
+      data["transaction"] = true;
+      CServiceBroker::GetAnnouncementManager()->Announce(VideoLibrary, "xbmc", "OnUpdate", data);
+    }
+    CServiceBroker::GetAnnouncementManager()->Announce(VideoLibrary, "xbmc", "OnScanFinished");
+
+    ASSERT_TRUE(probe.finishedEvent.WaitMSec(30000));
+    announceMs = std::chrono::duration<double, std::milli>(probe.finished - start).count();
+
+    // only start reading now, all notifications have to arrive, in order
+    received.assign(clients.size(), std::string());
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < clients.size(); i++)
+      readers.emplace_back([this, i, &received]() { received[i] = ReadUntil(clients[i], "VideoLibrary.OnScanFinished"); });
+    for (auto& reader : readers)
+      reader.join();
+  }
+
+  uint16_t port;
+  std::vector<int> clients;
+  CAnnouncementProbe probe;
+
+private:
+  std::shared_ptr<CAnnouncementManager> m_announcementManager;
+};
+
+TEST_F(TestTCPServer, ScanWithNonReadingClients)
+{
+  double announceMs = 0.0;
+  std::vector<std::string> received;
+  ASSERT_NO_FATAL_FAILURE(AnnounceScan(FUNCTIONAL_SCAN_CLIENTS, FUNCTIONAL_SCAN_UPDATES,
+                                       FUNCTIONAL_SCAN_ITEMS, announceMs, received));
+
+  for (const auto& data : received)
+  {
+    EXPECT_NE(std::string::npos, data.find("VideoLibrary.OnScanFinished"));
+    EXPECT_GE(CountOccurrences(data, "VideoLibrary.OnUpdate"), static_cast<size_t>(FUNCTIONAL_SCAN_ITEMS));
+  }
+
+  // without reading clients, announcing is not allowed to wait for them
+  EXPECT_LT(announceMs, 10000.0);
+}
+
+TEST_F(TestTCPServer, DISABLED_BenchmarkScanWithNonReadingClients)
+{
+  double announceMs = 0.0;
+  std::vector<std::string> received;
+  ASSERT_NO_FATAL_FAILURE(AnnounceScan(SCAN_CLIENTS, SCAN_UPDATES, SCAN_ITEMS, announceMs, received));
+
+  size_t minUpdates = SCAN_UPDATES;
+  size_t maxUpdates = 0;
+  for (const auto& data : received)
+  {
+    EXPECT_NE(std::string::npos, data.find("VideoLibrary.OnScanFinished"));
+    const size_t updates = CountOccurrences(data, "VideoLibrary.OnUpdate");
+    EXPECT_GE(updates, static_cast<size_t>(SCAN_ITEMS));
+    minUpdates = std::min(minUpdates, updates);
+    maxUpdates = std::max(maxUpdates, updates);
+  }
+
+  printf("%u clients, %d updates of %d items: announcing took %.2f ms, clients received %zu to %zu updates\n",
+         SCAN_CLIENTS, SCAN_UPDATES, SCAN_ITEMS, announceMs, minUpdates, maxUpdates);
+  RecordProperty("announce_us", static_cast<int>(announceMs * 1000));
+  RecordProperty("max_updates", static_cast<int>(maxUpdates));
+
+  EXPECT_LT(announceMs, 10000.0);
+}
+
+TEST_F(TestTCPServer, NonReadingClientDoesNotStallOthers)
+{
+  ASSERT_TRUE(JSONRPC::CTCPServer::StartServer(port, false));
+
+  int stalled = Connect();
+  ASSERT_GE(stalled, 0);
+  clients.push_back(stalled);
+  int reading = Connect();
+  ASSERT_GE(reading, 0);
+  clients.push_back(reading);
+
+  CVariant data;
+  data["payload"] = std::string(LARGE_NOTIFICATION_SIZE, 'x');
+  for (int i = 0; i < LARGE_NOTIFICATIONS; i++)
+    CServiceBroker::GetAnnouncementManager()->Announce(VideoLibrary, "xbmc", "OnScanStarted", data);
+  CServiceBroker::GetAnnouncementManager()->Announce(VideoLibrary, "xbmc", "OnScanFinished");
+
+  // the stalled client's socket is full long before, everything has to reach the other one anyway
+  const std::string received = ReadUntil(reading, "VideoLibrary.OnScanFinished");
+  EXPECT_NE(std::string::npos, received.find("VideoLibrary.OnScanFinished"));
+  EXPECT_EQ(static_cast<size_t>(LARGE_NOTIFICATIONS), CountOccurrences(received, "VideoLibrary.OnScanStarted"));
+}
+
+TEST_F(TestTCPServer, SeekDoesNotHoldBackLaterNotifications)
+{
+  ASSERT_TRUE(JSONRPC::CTCPServer::StartServer(port, false));
+
+  int socket = Connect();
+  ASSERT_GE(socket, 0);
+  clients.push_back(socket);
+
+  CVariant data;
+  data["item"]["type"] = "movie";
+  data["item"]["id"] = 1;
+  data["player"]["playerid"] = 1;
+  for (const char *seek : { "seek-1", "seek-2", "seek-3" })
+  {
+    data["player"]["time"] = seek;
+    CServiceBroker::GetAnnouncementManager()->Announce(Player, "xbmc", "OnSeek", data);
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  CServiceBroker::GetAnnouncementManager()->Announce(Player, "xbmc", "OnStop", data);
+
+  const std::string received = ReadUntil(socket, "Player.OnStop");
+  const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  // the seek in between is replaced by the latest one, which is sent before the stop
+  const size_t stop = received.find("Player.OnStop");
+  ASSERT_NE(std::string::npos, stop);
+  EXPECT_EQ(std::string::npos, received.find("seek-2"));
+  EXPECT_LT(received.find("seek-3"), stop);
+
+  // the stop does not wait for the seek window to end
+  EXPECT_LT(elapsedMs, 250.0);
+}
@@ -0,0 +1,243 @@
+/*
+ *  Copyright (C) 2015-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "ServiceBroker.h"
+#include "URL.h"
+#include "filesystem/CurlFile.h"
+#include "interfaces/json-rpc/JSONRPC.h"
+#include "network/WebServer.h"
+#include "network/httprequesthandler/HTTPJsonRpcHandler.h"
+#include "network/httprequesthandler/HTTPVfsHandler.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/MediaSourceSettings.h"
+#include "settings/SettingsComponent.h"
+#include "test/TestUtils.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+using namespace XFILE;
+
+namespace
+{
+
+const unsigned int LOAD_CLIENTS = 32;
+const unsigned int LOAD_REQUESTS_PER_CLIENT = 25;
+const unsigned int FUNCTIONAL_CLIENTS = 16;
+const unsigned int FUNCTIONAL_REQUESTS_PER_CLIENT = 2;
+const unsigned int THREAD_POOL_SIZE = 4;
+
+struct LoadResult
+{
+  unsigned int failed = 0;
+  double p50 = 0.0; // ms
+  double p99 = 0.0; // ms
+  int peakThreads = 0;
+};
+
+int GetThreadCount()
+{
+  // only available on Linux, reported as 0 elsewhere
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line))
+  {
+    if (StringUtils::StartsWith(line, "Threads:"))
+      return atoi(line.substr(8).c_str());
+  }
+  return 0;
+}
+
+} // unnamed namespace
+
+/*!
+ * Drives concurrent requests against the web server in both threading modes. The benchmarks report
+ * the latency percentiles and the peak number of threads of the process, the numbers are meant to
+ * be compared between runs and modes.
+ */
+class TestWebServerLoad : public testing::Test
+{
+protected:
+  TestWebServerLoad()
+    : sourcePath(XBMC_REF_FILE_PATH("xbmc/network/test/data/webserver/"))
+  {
+    std::random_device rd;
+    std::mt19937 mt(rd());
+    std::uniform_int_distribution<uint16_t> dist(49152, 65535);
+    webserverPort = dist(mt);
+    baseUrl = StringUtils::Format("http://localhost:%u", webserverPort);
+  }
+
+  void SetUp() override
+  {
+    CMediaSource source;
+    source.strName = "WebServer Share";
+    source.strPath = sourcePath;
+    source.vecPaths.push_back(sourcePath);
+    source.m_allowSharing = true;
+    source.m_iDriveType = CMediaSource::SOURCE_TYPE_LOCAL;
+    source.m_iLockMode = LOCK_MODE_EVERYONE;
+    source.m_ignore = true;
+    CMediaSourceSettings::GetInstance().AddShare("videos", source);
+
+    m_threadPoolSize = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_webserverThreadPoolSize;
+  }
+
+  void TearDown() override
+  {
+    if (webserver.IsStarted())
+      webserver.Stop();
+
+    webserver.UnregisterRequestHandler(&m_vfsHandler);
+    webserver.UnregisterRequestHandler(&m_jsonRpcHandler);
+
+    CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_webserverThreadPoolSize = m_threadPoolSize;
+    CMediaSourceSettings::GetInstance().Clear();
+  }
+
+  void StartWebServer(unsigned int threadPoolSize)
+  {
+    CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_webserverThreadPoolSize = threadPoolSize;
+    ASSERT_TRUE(webserver.Start(webserverPort, "", ""));
+    webserver.RegisterRequestHandler(&m_jsonRpcHandler);
+    webserver.RegisterRequestHandler(&m_vfsHandler);
+  }
+
+  LoadResult RunLoad(unsigned int clientCount, unsigned int requestsPerClient)
+  {
+    std::string vfsUrl = URIUtils::AddFileToFolder(sourcePath, "test.png");
+    vfsUrl = URIUtils::AddFileToFolder(baseUrl, URIUtils::AddFileToFolder("vfs", CURL::Encode(vfsUrl)));
+    const std::string jsonRpcUrl = URIUtils::AddFileToFolder(baseUrl, "jsonrpc?request=" +
+      CURL::Encode("{ \"jsonrpc\": \"2.0\", \"method\": \"JSONRPC.Version\", \"id\": 1 }"));
+
+    std::atomic<bool> running(true);
+    std::atomic<int> peakThreads(GetThreadCount());
+    std::thread sampler([&running, &peakThreads]()
+    {
+      while (running)
+      {
+        peakThreads = std::max(peakThreads.load(), GetThreadCount());
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      }
+    });
+
+    std::atomic<unsigned int> failed(0);
+    std::vector<std::vector<double>> latencies(clientCount);
+    std::vector<std::thread> clients;
+    for (unsigned int client = 0; client < clientCount; ++client)
+    {
+      clients.emplace_back([&, client]()
+      {
+        for (unsigned int i = 0; i < requestsPerClient; ++i)
+        {
+          // mix fast in-memory responses with file system backed ones
+          const std::string& url = (i % 2) ? jsonRpcUrl : vfsUrl;
+
+          std::string result;
+          CCurlFile curl;
+          const auto start = std::chrono::steady_clock::now();
+          if (!curl.Get(url, result) || result.empty())
+            ++failed;
+          const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+          latencies[client].push_back(duration.count());
+        }
+      });
+    }
+
+    for (auto& client : clients)
+      client.join();
+
+    running = false;
+    sampler.join();
+
+    std::vector<double> all;
+    for (const auto& clientLatencies : latencies)
+      all.insert(all.end(), clientLatencies.begin(), clientLatencies.end());
+    std::sort(all.begin(), all.end());
+
+    LoadResult result;
+    result.failed = failed;
+    result.peakThreads = peakThreads;
+    if (!all.empty())
+    {
+      result.p50 = all[all.size() * 50 / 100];
+      result.p99 = all[std::min(all.size() - 1, all.size() * 99 / 100)];
+    }
+    return result;
+  }
+
+  void Report(const char* mode, const LoadResult& result)
+  {
+    printf("%s: %u clients x %u requests, %u failed, p50 %.2f ms, p99 %.2f ms, peak threads %d\n",
+           mode, LOAD_CLIENTS, LOAD_REQUESTS_PER_CLIENT, result.failed, result.p50, result.p99, result.peakThreads);
+    RecordProperty("p50_us", static_cast<int>(result.p50 * 1000));
+    RecordProperty("p99_us", static_cast<int>(result.p99 * 1000));
+    RecordProperty("peak_threads", result.peakThreads);
+  }
+
+  CWebServer webserver;
+  CHTTPJsonRpcHandler m_jsonRpcHandler;
+  CHTTPVfsHandler m_vfsHandler;
+  std::string baseUrl;
+  std::string sourcePath;
+  uint16_t webserverPort;
+  unsigned int m_threadPoolSize = 0;
+};
+
+TEST_F(TestWebServerLoad, ThreadPerConnection)
+{
+  StartWebServer(0);
+
+  LoadResult result = RunLoad(FUNCTIONAL_CLIENTS, FUNCTIONAL_REQUESTS_PER_CLIENT);
+
+  EXPECT_EQ(0U, result.failed);
+}
+
+TEST_F(TestWebServerLoad, ThreadPool)
+{
+  StartWebServer(THREAD_POOL_SIZE);
+
+  const int threadsBefore = GetThreadCount();
+  LoadResult result = RunLoad(FUNCTIONAL_CLIENTS, FUNCTIONAL_REQUESTS_PER_CLIENT);
+
+  EXPECT_EQ(0U, result.failed);
+  // the clients and the sampler are threads of this process as well. on top of those and the pool,
+  // only a few job workers may be added, but not one thread per connection
+  if (threadsBefore > 0)
+    EXPECT_LT(result.peakThreads - threadsBefore,
+              static_cast<int>(FUNCTIONAL_CLIENTS + 1 + THREAD_POOL_SIZE + FUNCTIONAL_CLIENTS / 2));
+}
+
+TEST_F(TestWebServerLoad, DISABLED_BenchmarkThreadPerConnection)
+{
+  StartWebServer(0);
+
+  LoadResult result = RunLoad(LOAD_CLIENTS, LOAD_REQUESTS_PER_CLIENT);
+  Report("thread per connection", result);
+
+  EXPECT_EQ(0U, result.failed);
+}
+
+TEST_F(TestWebServerLoad, DISABLED_BenchmarkThreadPool)
+{
+  StartWebServer(THREAD_POOL_SIZE);
+
+  LoadResult result = RunLoad(LOAD_CLIENTS, LOAD_REQUESTS_PER_CLIENT);
+  Report("thread pool", result);
+
+  EXPECT_EQ(0U, result.failed);
+}
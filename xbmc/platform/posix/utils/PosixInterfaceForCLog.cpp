@@ -59,18 +59,25 @@ void CPosixInterfaceForCLog::CloseLogFile()
   }
 }
 
-bool CPosixInterfaceForCLog::WriteStringToLog(const std::string &logString)
+bool CPosixInterfaceForCLog::WriteStringToLog(const std::string &logString, bool flush /* = true */)
 {
   if (!m_file)
     return false;
 
   const bool ret = (fwrite(logString.data(), logString.size(), 1, m_file) == 1) &&
                    (fwrite("\n", 1, 1, m_file) == 1);
-  (void)fflush(m_file);
+  if (flush)
+    (void)fflush(m_file);
 
   return ret;
 }
 
+void CPosixInterfaceForCLog::FlushLogFile()
+{
+  if (m_file)
+    (void)fflush(m_file);
+}
+
 void CPosixInterfaceForCLog::PrintDebugString(const std::string &debugString)
 {
 #ifdef _DEBUG
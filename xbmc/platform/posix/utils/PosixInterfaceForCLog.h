@@ -19,7 +19,8 @@ public:
   ~CPosixInterfaceForCLog();
   bool OpenLogFile(const std::string& logFilename, const std::string& backupOldLogToFilename);
   void CloseLogFile(void);
-  bool WriteStringToLog(const std::string& logString);
+  bool WriteStringToLog(const std::string& logString, bool flush = true);
+  void FlushLogFile(void);
   void PrintDebugString(const std::string& debugString);
   static void GetCurrentLocalTime(int& year, int& month, int& day, int& hour, int& minute, int& second, double& millisecond);
 private:
@@ -76,7 +76,7 @@ void CWin32InterfaceForCLog::CloseLogFile(void)
   }
 }
 
-bool CWin32InterfaceForCLog::WriteStringToLog(const std::string& logString)
+bool CWin32InterfaceForCLog::WriteStringToLog(const std::string& logString, bool flush /* = true */)
 {
   if (m_hFile == INVALID_HANDLE_VALUE)
     return false;
@@ -85,12 +85,17 @@ bool CWin32InterfaceForCLog::WriteStringToLog(const std::string& logString)
   StringUtils::Replace(strData, "\n", "\r\n");
   strData += "\r\n";
 
+  // WriteFile() isn't buffered by us, there's nothing to flush
   DWORD written;
   const bool ret = (WriteFile(m_hFile, strData.c_str(), strData.length(), &written, NULL) != 0) && written == strData.length();
 
   return ret;
 }
 
+void CWin32InterfaceForCLog::FlushLogFile()
+{
+}
+
 void CWin32InterfaceForCLog::PrintDebugString(const std::string& debugString)
 {
 #ifdef _DEBUG
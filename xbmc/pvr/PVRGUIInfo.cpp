@@ -23,7 +23,6 @@
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "settings/SettingsComponent.h"
-#include "threads/SingleLock.h"
 #include "utils/StringUtils.h"
 
 #include "pvr/PVRGUIActions.h"
@@ -52,37 +51,15 @@ CPVRGUIInfo::~CPVRGUIInfo(void)
 
 void CPVRGUIInfo::ResetProperties(void)
 {
-  CSingleLock lock(m_critSection);
-
   m_anyTimersInfo.ResetProperties();
   m_tvTimersInfo.ResetProperties();
   m_radioTimersInfo.ResetProperties();
   m_timesInfo.Reset();
-  m_bHasTVRecordings            = false;
-  m_bHasRadioRecordings         = false;
-  m_iCurrentActiveClient        = 0;
-  m_strPlayingClientName        .clear();
-  m_strBackendName              .clear();
-  m_strBackendVersion           .clear();
-  m_strBackendHost              .clear();
-  m_strBackendTimers            .clear();
-  m_strBackendRecordings        .clear();
-  m_strBackendDeletedRecordings .clear();
-  m_strBackendChannels          .clear();
-  m_iBackendDiskTotal           = 0;
-  m_iBackendDiskUsed            = 0;
-  m_bIsPlayingTV                = false;
-  m_bIsPlayingRadio             = false;
-  m_bIsPlayingRecording         = false;
-  m_bIsPlayingEpgTag            = false;
-  m_bIsPlayingEncryptedStream   = false;
-  m_bIsRecordingPlayingChannel  = false;
-  m_bCanRecordPlayingChannel    = false;
-  m_bHasTVChannels              = false;
-  m_bHasRadioChannels           = false;
-
-  ClearQualityInfo(m_qualityInfo);
-  ClearDescrambleInfo(m_descrambleInfo);
+
+  std::shared_ptr<SState> state = std::make_shared<SState>();
+  ClearQualityInfo(state->qualityInfo);
+  ClearDescrambleInfo(state->descrambleInfo);
+  m_state.Publish(std::move(state));
 
   m_updateBackendCacheRequested = false;
   m_bRegistered = false;
@@ -200,7 +177,7 @@ void CPVRGUIInfo::UpdateQualityData(void)
       CServiceBroker::GetPVRManager().Clients()->GetCreatedClient(CServiceBroker::GetPVRManager().GetPlayingClientID(), client);
       if (client && client->SignalQuality(qualityInfo) == PVR_ERROR_NO_ERROR)
       {
-        m_qualityInfo = qualityInfo;
+        m_state.Update([&qualityInfo](SState& state) { state.qualityInfo = qualityInfo; });
       }
     }
   }
@@ -218,7 +195,7 @@ void CPVRGUIInfo::UpdateDescrambleData(void)
     CServiceBroker::GetPVRManager().Clients()->GetCreatedClient(CServiceBroker::GetPVRManager().GetPlayingClientID(), client);
     if (client && client->GetDescrambleInfo(descrambleInfo) == PVR_ERROR_NO_ERROR)
     {
-      m_descrambleInfo = descrambleInfo;
+      m_state.Update([&descrambleInfo](SState& state) { state.descrambleInfo = descrambleInfo; });
     }
   }
 }
@@ -242,21 +219,23 @@ void CPVRGUIInfo::UpdateMisc(void)
   std::string strPlayingTVGroup        = (bStarted && bIsPlayingTV) ? CServiceBroker::GetPVRManager().GetPlayingGroup(false)->GroupName() : "";
   std::string strPlayingRadioGroup     = (bStarted && bIsPlayingRadio) ? CServiceBroker::GetPVRManager().GetPlayingGroup(true)->GroupName() : "";
 
-  CSingleLock lock(m_critSection);
-  m_strPlayingClientName      = strPlayingClientName;
-  m_bHasTVRecordings          = bHasTVRecordings;
-  m_bHasRadioRecordings       = bHasRadioRecordings;
-  m_bIsPlayingTV              = bIsPlayingTV;
-  m_bIsPlayingRadio           = bIsPlayingRadio;
-  m_bIsPlayingRecording       = bIsPlayingRecording;
-  m_bIsPlayingEpgTag          = bIsPlayingEpgTag;
-  m_bIsPlayingEncryptedStream = bIsPlayingEncryptedStream;
-  m_bHasTVChannels            = bHasTVChannels;
-  m_bHasRadioChannels         = bHasRadioChannels;
-  m_strPlayingTVGroup         = strPlayingTVGroup;
-  m_strPlayingRadioGroup      = strPlayingRadioGroup;
-  m_bCanRecordPlayingChannel  = bCanRecordPlayingChannel;
-  m_bIsRecordingPlayingChannel = bIsRecordingPlayingChannel;
+  m_state.Update([&](SState& state)
+  {
+    state.strPlayingClientName       = strPlayingClientName;
+    state.bHasTVRecordings           = bHasTVRecordings;
+    state.bHasRadioRecordings        = bHasRadioRecordings;
+    state.bIsPlayingTV               = bIsPlayingTV;
+    state.bIsPlayingRadio            = bIsPlayingRadio;
+    state.bIsPlayingRecording        = bIsPlayingRecording;
+    state.bIsPlayingEpgTag           = bIsPlayingEpgTag;
+    state.bIsPlayingEncryptedStream  = bIsPlayingEncryptedStream;
+    state.bHasTVChannels             = bHasTVChannels;
+    state.bHasRadioChannels          = bHasRadioChannels;
+    state.strPlayingTVGroup          = strPlayingTVGroup;
+    state.strPlayingRadioGroup       = strPlayingRadioGroup;
+    state.bCanRecordPlayingChannel   = bCanRecordPlayingChannel;
+    state.bIsRecordingPlayingChannel = bIsRecordingPlayingChannel;
+  });
 }
 
 void CPVRGUIInfo::UpdateTimeshiftData(void)
@@ -414,8 +393,8 @@ bool CPVRGUIInfo::GetListItemAndPlayerLabel(const CFileItem *item, const CGUIInf
       }
       case VIDEOPLAYER_CHANNEL_GROUP:
       {
-        CSingleLock lock(m_critSection);
-        strValue = recording->IsRadio() ? m_strPlayingRadioGroup : m_strPlayingTVGroup;
+        const std::shared_ptr<const SState> state = m_state.Get();
+        strValue = recording->IsRadio() ? state->strPlayingRadioGroup : state->strPlayingTVGroup;
         return true;
       }
     }
@@ -648,8 +627,8 @@ bool CPVRGUIInfo::GetListItemAndPlayerLabel(const CFileItem *item, const CGUIInf
       case MUSICPLAYER_CHANNEL_GROUP:
       case VIDEOPLAYER_CHANNEL_GROUP:
       {
-        CSingleLock lock(m_critSection);
-        strValue = channel->IsRadio() ? m_strPlayingRadioGroup : m_strPlayingTVGroup;
+        const std::shared_ptr<const SState> state = m_state.Get();
+        strValue = channel->IsRadio() ? state->strPlayingRadioGroup : state->strPlayingTVGroup;
         return true;
       }
     }
@@ -660,7 +639,7 @@ bool CPVRGUIInfo::GetListItemAndPlayerLabel(const CFileItem *item, const CGUIInf
 
 bool CPVRGUIInfo::GetPVRLabel(const CFileItem *item, const CGUIInfo &info, std::string &strValue) const
 {
-  CSingleLock lock(m_critSection);
+  const std::shared_ptr<const SState> state = m_state.Get();
 
   switch (info.m_info)
   {
@@ -798,67 +777,67 @@ bool CPVRGUIInfo::GetPVRLabel(const CFileItem *item, const CGUIInfo &info, std::
       strValue = m_anyTimersInfo.GetNextTimer();
       return true;
     case PVR_ACTUAL_STREAM_SIG:
-      CharInfoSignal(strValue);
+      CharInfoSignal(*state, strValue);
       return true;
     case PVR_ACTUAL_STREAM_SNR:
-      CharInfoSNR(strValue);
+      CharInfoSNR(*state, strValue);
       return true;
     case PVR_ACTUAL_STREAM_BER:
-      CharInfoBER(strValue);
+      CharInfoBER(*state, strValue);
       return true;
     case PVR_ACTUAL_STREAM_UNC:
-      CharInfoUNC(strValue);
+      CharInfoUNC(*state, strValue);
       return true;
     case PVR_ACTUAL_STREAM_CLIENT:
-      CharInfoPlayingClientName(strValue);
+      CharInfoPlayingClientName(*state, strValue);
       return true;
     case PVR_ACTUAL_STREAM_DEVICE:
-      CharInfoFrontendName(strValue);
+      CharInfoFrontendName(*state, strValue);
       return true;
     case PVR_ACTUAL_STREAM_STATUS:
-      CharInfoFrontendStatus(strValue);
+      CharInfoFrontendStatus(*state, strValue);
       return true;
     case PVR_ACTUAL_STREAM_CRYPTION:
-      CharInfoEncryption(strValue);
+      CharInfoEncryption(*state, strValue);
       return true;
     case PVR_ACTUAL_STREAM_SERVICE:
-      CharInfoService(strValue);
+      CharInfoService(*state, strValue);
       return true;
     case PVR_ACTUAL_STREAM_MUX:
-      CharInfoMux(strValue);
+      CharInfoMux(*state, strValue);
       return true;
     case PVR_ACTUAL_STREAM_PROVIDER:
-      CharInfoProvider(strValue);
+      CharInfoProvider(*state, strValue);
       return true;
     case PVR_BACKEND_NAME:
-      CharInfoBackendName(strValue);
+      CharInfoBackendName(*state, strValue);
       return true;
     case PVR_BACKEND_VERSION:
-      CharInfoBackendVersion(strValue);
+      CharInfoBackendVersion(*state, strValue);
       return true;
     case PVR_BACKEND_HOST:
-      CharInfoBackendHost(strValue);
+      CharInfoBackendHost(*state, strValue);
       return true;
     case PVR_BACKEND_DISKSPACE:
-      CharInfoBackendDiskspace(strValue);
+      CharInfoBackendDiskspace(*state, strValue);
       return true;
     case PVR_BACKEND_CHANNELS:
-      CharInfoBackendChannels(strValue);
+      CharInfoBackendChannels(*state, strValue);
       return true;
     case PVR_BACKEND_TIMERS:
-      CharInfoBackendTimers(strValue);
+      CharInfoBackendTimers(*state, strValue);
       return true;
     case PVR_BACKEND_RECORDINGS:
-      CharInfoBackendRecordings(strValue);
+      CharInfoBackendRecordings(*state, strValue);
       return true;
     case PVR_BACKEND_DELETED_RECORDINGS:
-      CharInfoBackendDeletedRecordings(strValue);
+      CharInfoBackendDeletedRecordings(*state, strValue);
       return true;
     case PVR_BACKEND_NUMBER:
-      CharInfoBackendNumber(strValue);
+      CharInfoBackendNumber(*state, strValue);
       return true;
     case PVR_TOTAL_DISKSPACE:
-      CharInfoTotalDiskSpace(strValue);
+      CharInfoTotalDiskSpace(*state, strValue);
       return true;
     case PVR_CHANNEL_NUMBER_INPUT:
       strValue = CServiceBroker::GetPVRManager().GUIActions()->GetChannelNumberInputHandler().GetChannelNumberLabel();
@@ -1039,7 +1018,7 @@ bool CPVRGUIInfo::GetListItemAndPlayerInt(const CFileItem *item, const CGUIInfo
 
 bool CPVRGUIInfo::GetPVRInt(const CFileItem *item, const CGUIInfo &info, int& iValue) const
 {
-  CSingleLock lock(m_critSection);
+  const std::shared_ptr<const SState> state = m_state.Get();
 
   switch (info.m_info)
   {
@@ -1077,14 +1056,14 @@ bool CPVRGUIInfo::GetPVRInt(const CFileItem *item, const CGUIInfo &info, int& iV
       iValue = m_timesInfo.GetTimeshiftProgressBufferEnd();
       return true;
     case PVR_ACTUAL_STREAM_SIG_PROGR:
-      iValue = std::lrintf(static_cast<float>(m_qualityInfo.iSignal) / 0xFFFF * 100);
+      iValue = std::lrintf(static_cast<float>(state->qualityInfo.iSignal) / 0xFFFF * 100);
       return true;
     case PVR_ACTUAL_STREAM_SNR_PROGR:
-      iValue = std::lrintf(static_cast<float>(m_qualityInfo.iSNR) / 0xFFFF * 100);
+      iValue = std::lrintf(static_cast<float>(state->qualityInfo.iSNR) / 0xFFFF * 100);
       return true;
     case PVR_BACKEND_DISKSPACE_PROGR:
-      if (m_iBackendDiskTotal > 0)
-        iValue = std::lrintf(static_cast<float>(m_iBackendDiskUsed) / m_iBackendDiskTotal * 100);
+      if (state->iBackendDiskTotal > 0)
+        iValue = std::lrintf(static_cast<float>(state->iBackendDiskUsed) / state->iBackendDiskTotal * 100);
       else
         iValue = 0xFF;
       return true;
@@ -1260,7 +1239,7 @@ bool CPVRGUIInfo::GetListItemAndPlayerBool(const CFileItem *item, const CGUIInfo
 
 bool CPVRGUIInfo::GetPVRBool(const CFileItem *item, const CGUIInfo &info, bool& bValue) const
 {
-  CSingleLock lock(m_critSection);
+  const std::shared_ptr<const SState> state = m_state.Get();
 
   switch (info.m_info)
   {
@@ -1283,10 +1262,10 @@ bool CPVRGUIInfo::GetPVRBool(const CFileItem *item, const CGUIInfo &info, bool&
       bValue = m_radioTimersInfo.HasTimers();
       return true;
     case PVR_HAS_TV_CHANNELS:
-      bValue = m_bHasTVChannels;
+      bValue = state->bHasTVChannels;
       return true;
     case PVR_HAS_RADIO_CHANNELS:
-      bValue = m_bHasRadioChannels;
+      bValue = state->bHasRadioChannels;
       return true;
     case PVR_HAS_NONRECORDING_TIMER:
       bValue = m_anyTimersInfo.HasNonRecordingTimers();
@@ -1298,28 +1277,28 @@ bool CPVRGUIInfo::GetPVRBool(const CFileItem *item, const CGUIInfo &info, bool&
       bValue = m_radioTimersInfo.HasNonRecordingTimers();
       return true;
     case PVR_IS_PLAYING_TV:
-      bValue = m_bIsPlayingTV;
+      bValue = state->bIsPlayingTV;
       return true;
     case PVR_IS_PLAYING_RADIO:
-      bValue = m_bIsPlayingRadio;
+      bValue = state->bIsPlayingRadio;
       return true;
     case PVR_IS_PLAYING_RECORDING:
-      bValue = m_bIsPlayingRecording;
+      bValue = state->bIsPlayingRecording;
       return true;
     case PVR_IS_PLAYING_EPGTAG:
-      bValue = m_bIsPlayingEpgTag;
+      bValue = state->bIsPlayingEpgTag;
       return true;
     case PVR_ACTUAL_STREAM_ENCRYPTED:
-      bValue = m_bIsPlayingEncryptedStream;
+      bValue = state->bIsPlayingEncryptedStream;
       return true;
     case PVR_IS_TIMESHIFTING:
       bValue = m_timesInfo.IsTimeshifting();
       return true;
     case PVR_CAN_RECORD_PLAYING_CHANNEL:
-      bValue = m_bCanRecordPlayingChannel;
+      bValue = state->bCanRecordPlayingChannel;
       return true;
     case PVR_IS_RECORDING_PLAYING_CHANNEL:
-      bValue = m_bIsRecordingPlayingChannel;
+      bValue = state->bIsRecordingPlayingChannel;
       return true;
   }
   return false;
@@ -1360,81 +1339,81 @@ bool CPVRGUIInfo::GetRadioRDSBool(const CFileItem *item, const CGUIInfo &info, b
   return false;
 }
 
-void CPVRGUIInfo::CharInfoBackendNumber(std::string &strValue) const
+void CPVRGUIInfo::CharInfoBackendNumber(const SState& state, std::string &strValue) const
 {
-  size_t numBackends = m_backendProperties.size();
+  size_t numBackends = state.backendProperties.size();
 
   if (numBackends > 0)
-    strValue = StringUtils::Format("{0} {1} {2}", m_iCurrentActiveClient + 1, g_localizeStrings.Get(20163).c_str(), numBackends);
+    strValue = StringUtils::Format("{0} {1} {2}", state.iCurrentActiveClient + 1, g_localizeStrings.Get(20163).c_str(), numBackends);
   else
     strValue = g_localizeStrings.Get(14023);
 }
 
-void CPVRGUIInfo::CharInfoTotalDiskSpace(std::string &strValue) const
+void CPVRGUIInfo::CharInfoTotalDiskSpace(const SState& state, std::string &strValue) const
 {
-  strValue = StringUtils::SizeToString(m_iBackendDiskTotal).c_str();
+  strValue = StringUtils::SizeToString(state.iBackendDiskTotal).c_str();
 }
 
-void CPVRGUIInfo::CharInfoSignal(std::string &strValue) const
+void CPVRGUIInfo::CharInfoSignal(const SState& state, std::string &strValue) const
 {
-  strValue = StringUtils::Format("%d %%", m_qualityInfo.iSignal / 655);
+  strValue = StringUtils::Format("%d %%", state.qualityInfo.iSignal / 655);
 }
 
-void CPVRGUIInfo::CharInfoSNR(std::string &strValue) const
+void CPVRGUIInfo::CharInfoSNR(const SState& state, std::string &strValue) const
 {
-  strValue = StringUtils::Format("%d %%", m_qualityInfo.iSNR / 655);
+  strValue = StringUtils::Format("%d %%", state.qualityInfo.iSNR / 655);
 }
 
-void CPVRGUIInfo::CharInfoBER(std::string &strValue) const
+void CPVRGUIInfo::CharInfoBER(const SState& state, std::string &strValue) const
 {
-  strValue = StringUtils::Format("%08lX", m_qualityInfo.iBER);
+  strValue = StringUtils::Format("%08lX", state.qualityInfo.iBER);
 }
 
-void CPVRGUIInfo::CharInfoUNC(std::string &strValue) const
+void CPVRGUIInfo::CharInfoUNC(const SState& state, std::string &strValue) const
 {
-  strValue = StringUtils::Format("%08lX", m_qualityInfo.iUNC);
+  strValue = StringUtils::Format("%08lX", state.qualityInfo.iUNC);
 }
 
-void CPVRGUIInfo::CharInfoFrontendName(std::string &strValue) const
+void CPVRGUIInfo::CharInfoFrontendName(const SState& state, std::string &strValue) const
 {
-  if (!strlen(m_qualityInfo.strAdapterName))
+  if (!strlen(state.qualityInfo.strAdapterName))
     strValue = g_localizeStrings.Get(13205);
   else
-    strValue = m_qualityInfo.strAdapterName;
+    strValue = state.qualityInfo.strAdapterName;
 }
 
-void CPVRGUIInfo::CharInfoFrontendStatus(std::string &strValue) const
+void CPVRGUIInfo::CharInfoFrontendStatus(const SState& state, std::string &strValue) const
 {
-  if (!strlen(m_qualityInfo.strAdapterStatus))
+  if (!strlen(state.qualityInfo.strAdapterStatus))
     strValue = g_localizeStrings.Get(13205);
   else
-    strValue = m_qualityInfo.strAdapterStatus;
+    strValue = state.qualityInfo.strAdapterStatus;
 }
 
-void CPVRGUIInfo::CharInfoBackendName(std::string &strValue) const
+void CPVRGUIInfo::CharInfoBackendName(const SState& state, std::string &strValue) const
 {
   m_updateBackendCacheRequested = true;
-  strValue = m_strBackendName;
+  strValue = state.strBackendName;
 }
 
-void CPVRGUIInfo::CharInfoBackendVersion(std::string &strValue) const
+void CPVRGUIInfo::CharInfoBackendVersion(const SState& state, std::string &strValue) const
 {
   m_updateBackendCacheRequested = true;
-  strValue = m_strBackendVersion;
+  strValue = state.strBackendVersion;
 }
 
-void CPVRGUIInfo::CharInfoBackendHost(std::string &strValue) const
+void CPVRGUIInfo::CharInfoBackendHost(const SState& state, std::string &strValue) const
 {
   m_updateBackendCacheRequested = true;
-  strValue = m_strBackendHost;
+  strValue = state.strBackendHost;
 }
 
-void CPVRGUIInfo::CharInfoBackendDiskspace(std::string &strValue) const
+void CPVRGUIInfo::CharInfoBackendDiskspace(const SState& state, std::string &strValue) const
 {
   m_updateBackendCacheRequested = true;
 
-  auto diskTotal = m_iBackendDiskTotal;
-  auto diskUsed = m_iBackendDiskUsed;
+  auto diskTotal = state.iBackendDiskTotal;
+  auto diskUsed = state.iBackendDiskUsed;
 
   if (diskTotal > 0)
   {
@@ -1446,44 +1425,44 @@ void CPVRGUIInfo::CharInfoBackendDiskspace(std::string &strValue) const
     strValue = g_localizeStrings.Get(13205);
 }
 
-void CPVRGUIInfo::CharInfoBackendChannels(std::string &strValue) const
+void CPVRGUIInfo::CharInfoBackendChannels(const SState& state, std::string &strValue) const
 {
   m_updateBackendCacheRequested = true;
-  strValue = m_strBackendChannels;
+  strValue = state.strBackendChannels;
 }
 
-void CPVRGUIInfo::CharInfoBackendTimers(std::string &strValue) const
+void CPVRGUIInfo::CharInfoBackendTimers(const SState& state, std::string &strValue) const
 {
   m_updateBackendCacheRequested = true;
-  strValue = m_strBackendTimers;
+  strValue = state.strBackendTimers;
 }
 
-void CPVRGUIInfo::CharInfoBackendRecordings(std::string &strValue) const
+void CPVRGUIInfo::CharInfoBackendRecordings(const SState& state, std::string &strValue) const
 {
   m_updateBackendCacheRequested = true;
-  strValue = m_strBackendRecordings;
+  strValue = state.strBackendRecordings;
 }
 
-void CPVRGUIInfo::CharInfoBackendDeletedRecordings(std::string &strValue) const
+void CPVRGUIInfo::CharInfoBackendDeletedRecordings(const SState& state, std::string &strValue) const
 {
   m_updateBackendCacheRequested = true;
-  strValue = m_strBackendDeletedRecordings;
+  strValue = state.strBackendDeletedRecordings;
 }
 
-void CPVRGUIInfo::CharInfoPlayingClientName(std::string &strValue) const
+void CPVRGUIInfo::CharInfoPlayingClientName(const SState& state, std::string &strValue) const
 {
-  if (m_strPlayingClientName.empty())
+  if (state.strPlayingClientName.empty())
     strValue = g_localizeStrings.Get(13205);
   else
-    strValue = m_strPlayingClientName;
+    strValue = state.strPlayingClientName;
 }
 
-void CPVRGUIInfo::CharInfoEncryption(std::string &strValue) const
+void CPVRGUIInfo::CharInfoEncryption(const SState& state, std::string &strValue) const
 {
-  if (m_descrambleInfo.iCaid != PVR_DESCRAMBLE_INFO_NOT_AVAILABLE)
+  if (state.descrambleInfo.iCaid != PVR_DESCRAMBLE_INFO_NOT_AVAILABLE)
   {
     // prefer dynamically updated info, if available
-    strValue = CPVRChannel::GetEncryptionName(m_descrambleInfo.iCaid);
+    strValue = CPVRChannel::GetEncryptionName(state.descrambleInfo.iCaid);
     return;
   }
   else
@@ -1499,87 +1478,87 @@ void CPVRGUIInfo::CharInfoEncryption(std::string &strValue) const
   strValue.clear();
 }
 
-void CPVRGUIInfo::CharInfoService(std::string &strValue) const
+void CPVRGUIInfo::CharInfoService(const SState& state, std::string &strValue) const
 {
-  if (!strlen(m_qualityInfo.strServiceName))
+  if (!strlen(state.qualityInfo.strServiceName))
     strValue = g_localizeStrings.Get(13205);
   else
-    strValue = m_qualityInfo.strServiceName;
+    strValue = state.qualityInfo.strServiceName;
 }
 
-void CPVRGUIInfo::CharInfoMux(std::string &strValue) const
+void CPVRGUIInfo::CharInfoMux(const SState& state, std::string &strValue) const
 {
-  if (!strlen(m_qualityInfo.strMuxName))
+  if (!strlen(state.qualityInfo.strMuxName))
     strValue = g_localizeStrings.Get(13205);
   else
-    strValue = m_qualityInfo.strMuxName;
+    strValue = state.qualityInfo.strMuxName;
 }
 
-void CPVRGUIInfo::CharInfoProvider(std::string &strValue) const
+void CPVRGUIInfo::CharInfoProvider(const SState& state, std::string &strValue) const
 {
-  if (!strlen(m_qualityInfo.strProviderName))
+  if (!strlen(state.qualityInfo.strProviderName))
     strValue = g_localizeStrings.Get(13205);
   else
-    strValue = m_qualityInfo.strProviderName;
+    strValue = state.qualityInfo.strProviderName;
 }
 
 void CPVRGUIInfo::UpdateBackendCache(void)
 {
-  CSingleLock lock(m_critSection);
-
   // Update the backend information for all backends if
   // an update has been requested
-  if (m_iCurrentActiveClient == 0 && m_updateBackendCacheRequested)
+  std::vector<SBackend> backendProperties;
+  const bool bUpdateBackendProperties = m_state.Get()->iCurrentActiveClient == 0 && m_updateBackendCacheRequested;
+  if (bUpdateBackendProperties)
   {
-    std::vector<SBackend> backendProperties;
-    {
-      CSingleExit exit(m_critSection);
-      backendProperties = CServiceBroker::GetPVRManager().Clients()->GetBackendProperties();
-    }
-
-    m_backendProperties = backendProperties;
+    backendProperties = CServiceBroker::GetPVRManager().Clients()->GetBackendProperties();
     m_updateBackendCacheRequested = false;
   }
 
-  // Store some defaults
-  m_strBackendName = g_localizeStrings.Get(13205);
-  m_strBackendVersion = g_localizeStrings.Get(13205);
-  m_strBackendHost = g_localizeStrings.Get(13205);
-  m_strBackendChannels = g_localizeStrings.Get(13205);
-  m_strBackendTimers = g_localizeStrings.Get(13205);
-  m_strBackendRecordings = g_localizeStrings.Get(13205);
-  m_strBackendDeletedRecordings = g_localizeStrings.Get(13205);
-  m_iBackendDiskTotal = 0;
-  m_iBackendDiskUsed = 0;
-
-  // Update with values from the current client when we have at least one
-  if (!m_backendProperties.empty())
+  m_state.Update([&](SState& state)
   {
-    const auto &backend = m_backendProperties[m_iCurrentActiveClient];
+    if (bUpdateBackendProperties)
+      state.backendProperties = std::move(backendProperties);
+
+    // Store some defaults
+    state.strBackendName = g_localizeStrings.Get(13205);
+    state.strBackendVersion = g_localizeStrings.Get(13205);
+    state.strBackendHost = g_localizeStrings.Get(13205);
+    state.strBackendChannels = g_localizeStrings.Get(13205);
+    state.strBackendTimers = g_localizeStrings.Get(13205);
+    state.strBackendRecordings = g_localizeStrings.Get(13205);
+    state.strBackendDeletedRecordings = g_localizeStrings.Get(13205);
+    state.iBackendDiskTotal = 0;
+    state.iBackendDiskUsed = 0;
+
+    // Update with values from the current client when we have at least one
+    if (!state.backendProperties.empty())
+    {
+      const auto &backend = state.backendProperties[state.iCurrentActiveClient];
 
-    m_strBackendName = backend.name;
-    m_strBackendVersion = backend.version;
-    m_strBackendHost = backend.host;
+      state.strBackendName = backend.name;
+      state.strBackendVersion = backend.version;
+      state.strBackendHost = backend.host;
 
-    if (backend.numChannels >= 0)
-      m_strBackendChannels = StringUtils::Format("%i", backend.numChannels);
+      if (backend.numChannels >= 0)
+        state.strBackendChannels = StringUtils::Format("%i", backend.numChannels);
 
-    if (backend.numTimers >= 0)
-      m_strBackendTimers = StringUtils::Format("%i", backend.numTimers);
+      if (backend.numTimers >= 0)
+        state.strBackendTimers = StringUtils::Format("%i", backend.numTimers);
 
-    if (backend.numRecordings >= 0)
-      m_strBackendRecordings = StringUtils::Format("%i", backend.numRecordings);
+      if (backend.numRecordings >= 0)
+        state.strBackendRecordings = StringUtils::Format("%i", backend.numRecordings);
 
-    if (backend.numDeletedRecordings >= 0)
-      m_strBackendDeletedRecordings = StringUtils::Format("%i", backend.numDeletedRecordings);
+      if (backend.numDeletedRecordings >= 0)
+        state.strBackendDeletedRecordings = StringUtils::Format("%i", backend.numDeletedRecordings);
 
-    m_iBackendDiskTotal = backend.diskTotal;
-    m_iBackendDiskUsed = backend.diskUsed;
-  }
+      state.iBackendDiskTotal = backend.diskTotal;
+      state.iBackendDiskUsed = backend.diskUsed;
+    }
 
-  // Update the current active client, eventually wrapping around
-  if (++m_iCurrentActiveClient >= m_backendProperties.size())
-    m_iCurrentActiveClient = 0;
+    // Update the current active client, eventually wrapping around
+    if (++state.iCurrentActiveClient >= state.backendProperties.size())
+      state.iCurrentActiveClient = 0;
+  });
 }
 
 void CPVRGUIInfo::UpdateTimersCache(void)
@@ -14,7 +14,7 @@
 
 #include "addons/kodi-addon-dev-kit/include/kodi/xbmc_pvr_types.h"
 #include "guilib/guiinfo/GUIInfoProvider.h"
-#include "threads/CriticalSection.h"
+#include "threads/Snapshot.h"
 #include "threads/Thread.h"
 #include "utils/Observer.h"
 
@@ -54,6 +54,43 @@ namespace PVR
     bool GetBool(bool& value, const CGUIListItem *item, int contextWindow, const KODI::GUILIB::GUIINFO::CGUIInfo &info) const override;
 
   private:
+    /*!
+     * @brief The values shown by the GUI. Only written by the info thread,
+     * which publishes every update as a whole, so that the GUI can read them
+     * without waiting for the info thread.
+     */
+    struct SState
+    {
+      bool                  bHasTVRecordings = false;
+      bool                  bHasRadioRecordings = false;
+      unsigned int          iCurrentActiveClient = 0;
+      std::string           strPlayingClientName;
+      std::string           strBackendName;
+      std::string           strBackendVersion;
+      std::string           strBackendHost;
+      std::string           strBackendTimers;
+      std::string           strBackendRecordings;
+      std::string           strBackendDeletedRecordings;
+      std::string           strBackendChannels;
+      long long             iBackendDiskTotal = 0;
+      long long             iBackendDiskUsed = 0;
+      bool                  bIsPlayingTV = false;
+      bool                  bIsPlayingRadio = false;
+      bool                  bIsPlayingRecording = false;
+      bool                  bIsPlayingEpgTag = false;
+      bool                  bIsPlayingEncryptedStream = false;
+      bool                  bHasTVChannels = false;
+      bool                  bHasRadioChannels = false;
+      bool                  bCanRecordPlayingChannel = false;
+      bool                  bIsRecordingPlayingChannel = false;
+      std::string           strPlayingTVGroup;
+      std::string           strPlayingRadioGroup;
+
+      PVR_SIGNAL_STATUS     qualityInfo = {};    /*!< stream quality information */
+      PVR_DESCRAMBLE_INFO   descrambleInfo = {}; /*!< stream descramble information */
+      std::vector<SBackend> backendProperties;
+    };
+
     void ResetProperties(void);
     void ClearQualityInfo(PVR_SIGNAL_STATUS &qualityInfo);
     void ClearDescrambleInfo(PVR_DESCRAMBLE_INFO &descrambleInfo);
@@ -82,27 +119,27 @@ namespace PVR
     bool GetPVRBool(const CFileItem *item, const KODI::GUILIB::GUIINFO::CGUIInfo &info, bool& bValue) const;
     bool GetRadioRDSBool(const CFileItem *item, const KODI::GUILIB::GUIINFO::CGUIInfo &info, bool &bValue) const;
 
-    void CharInfoBackendNumber(std::string &strValue) const;
-    void CharInfoTotalDiskSpace(std::string &strValue) const;
-    void CharInfoSignal(std::string &strValue) const;
-    void CharInfoSNR(std::string &strValue) const;
-    void CharInfoBER(std::string &strValue) const;
-    void CharInfoUNC(std::string &strValue) const;
-    void CharInfoFrontendName(std::string &strValue) const;
-    void CharInfoFrontendStatus(std::string &strValue) const;
-    void CharInfoBackendName(std::string &strValue) const;
-    void CharInfoBackendVersion(std::string &strValue) const;
-    void CharInfoBackendHost(std::string &strValue) const;
-    void CharInfoBackendDiskspace(std::string &strValue) const;
-    void CharInfoBackendChannels(std::string &strValue) const;
-    void CharInfoBackendTimers(std::string &strValue) const;
-    void CharInfoBackendRecordings(std::string &strValue) const;
-    void CharInfoBackendDeletedRecordings(std::string &strValue) const;
-    void CharInfoPlayingClientName(std::string &strValue) const;
-    void CharInfoEncryption(std::string &strValue) const;
-    void CharInfoService(std::string &strValue) const;
-    void CharInfoMux(std::string &strValue) const;
-    void CharInfoProvider(std::string &strValue) const;
+    void CharInfoBackendNumber(const SState& state, std::string &strValue) const;
+    void CharInfoTotalDiskSpace(const SState& state, std::string &strValue) const;
+    void CharInfoSignal(const SState& state, std::string &strValue) const;
+    void CharInfoSNR(const SState& state, std::string &strValue) const;
+    void CharInfoBER(const SState& state, std::string &strValue) const;
+    void CharInfoUNC(const SState& state, std::string &strValue) const;
+    void CharInfoFrontendName(const SState& state, std::string &strValue) const;
+    void CharInfoFrontendStatus(const SState& state, std::string &strValue) const;
+    void CharInfoBackendName(const SState& state, std::string &strValue) const;
+    void CharInfoBackendVersion(const SState& state, std::string &strValue) const;
+    void CharInfoBackendHost(const SState& state, std::string &strValue) const;
+    void CharInfoBackendDiskspace(const SState& state, std::string &strValue) const;
+    void CharInfoBackendChannels(const SState& state, std::string &strValue) const;
+    void CharInfoBackendTimers(const SState& state, std::string &strValue) const;
+    void CharInfoBackendRecordings(const SState& state, std::string &strValue) const;
+    void CharInfoBackendDeletedRecordings(const SState& state, std::string &strValue) const;
+    void CharInfoPlayingClientName(const SState& state, std::string &strValue) const;
+    void CharInfoEncryption(const SState& state, std::string &strValue) const;
+    void CharInfoService(const SState& state, std::string &strValue) const;
+    void CharInfoMux(const SState& state, std::string &strValue) const;
+    void CharInfoProvider(const SState& state, std::string &strValue) const;
 
     /** @name PVRGUIInfo data */
     //@{
@@ -112,39 +149,9 @@ namespace PVR
 
     CPVRGUITimesInfo m_timesInfo;
 
-    bool                            m_bHasTVRecordings;
-    bool                            m_bHasRadioRecordings;
-    unsigned int                    m_iCurrentActiveClient;
-    std::string                     m_strPlayingClientName;
-    std::string                     m_strBackendName;
-    std::string                     m_strBackendVersion;
-    std::string                     m_strBackendHost;
-    std::string                     m_strBackendTimers;
-    std::string                     m_strBackendRecordings;
-    std::string                     m_strBackendDeletedRecordings;
-    std::string                     m_strBackendChannels;
-    long long                       m_iBackendDiskTotal;
-    long long                       m_iBackendDiskUsed;
-    bool                            m_bIsPlayingTV;
-    bool                            m_bIsPlayingRadio;
-    bool                            m_bIsPlayingRecording;
-    bool                            m_bIsPlayingEpgTag;
-    bool                            m_bIsPlayingEncryptedStream;
-    bool                            m_bHasTVChannels;
-    bool                            m_bHasRadioChannels;
-    bool                            m_bCanRecordPlayingChannel;
-    bool                            m_bIsRecordingPlayingChannel;
-    std::string                     m_strPlayingTVGroup;
-    std::string                     m_strPlayingRadioGroup;
-
+    CSnapshot<SState> m_state;
     //@}
 
-    PVR_SIGNAL_STATUS               m_qualityInfo;       /*!< stream quality information */
-    PVR_DESCRAMBLE_INFO             m_descrambleInfo;    /*!< stream descramble information */
-    std::vector<SBackend>           m_backendProperties;
-
-    mutable CCriticalSection m_critSection;
-
     /**
      * The various backend-related fields will only be updated when this
      * flag is set. This is done to limit the amount of unnecessary
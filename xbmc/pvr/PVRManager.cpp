@@ -12,6 +12,7 @@
 
 #include "ServiceBroker.h"
 #include "addons/PVRClient.h"
+#include "cores/DataCacheCore.h"
 #include "guilib/LocalizeStrings.h"
 #include "interfaces/AnnouncementManager.h"
 #include "messaging/ApplicationMessenger.h"
@@ -240,6 +241,12 @@ CPVREpgContainer& CPVRManager::EpgContainer()
   return m_epgContainer;
 }
 
+CPVRZapAhead& CPVRManager::ZapAhead()
+{
+  // note: m_zapAhead lives as long as the manager and locks its own state. no need for a lock here.
+  return m_zapAhead;
+}
+
 void CPVRManager::Clear(void)
 {
   m_pendingUpdates.Clear();
@@ -326,6 +333,7 @@ void CPVRManager::Stop(void)
   m_pendingUpdates.Stop();
   m_epgContainer.Stop();
   m_guiInfo->Stop();
+  m_zapAhead.Stop();
 
   StopThread();
 
@@ -658,6 +666,19 @@ bool CPVRManager::MatchPlayingChannel(int iClientID, int iUniqueChannelID) const
   return false;
 }
 
+CDateTime CPVRManager::GetPlaybackTime(int iClientID, int iUniqueChannelID) const
+{
+  if (MatchPlayingChannel(iClientID, iUniqueChannelID))
+  {
+    // start time valid?
+    time_t startTime = CServiceBroker::GetDataCacheCore().GetStartTime();
+    if (startTime > 0)
+      return CDateTime(startTime + CServiceBroker::GetDataCacheCore().GetPlayTime() / 1000);
+  }
+
+  return CDateTime::GetUTCDateTime();
+}
+
 CPVRChannelPtr CPVRManager::GetPlayingChannel(void) const
 {
   return m_playingChannel;
@@ -809,6 +830,7 @@ void CPVRManager::OnPlaybackStarted(const CFileItemPtr item)
     m_playingClientId = m_playingChannel->ClientID();
 
     SetPlayingGroup(channel);
+    m_zapAhead.OnPlaybackStarted(channel, GetPlayingGroup(channel->IsRadio()));
 
     int iLastWatchedDelay = m_settings.GetIntValue(CSettings::SETTING_PVRPLAYBACK_DELAYMARKLASTWATCHED) * 1000;
     if (iLastWatchedDelay > 0)
@@ -837,6 +859,9 @@ void CPVRManager::OnPlaybackStarted(const CFileItemPtr item)
     m_playingClientId = m_playingEpgTag->ClientID();
   }
 
+  if (!m_playingChannel)
+    m_zapAhead.Stop();
+
   if (m_playingClientId != -1)
   {
     const CPVRClientPtr client = GetClient(m_playingClientId);
@@ -876,6 +901,8 @@ void CPVRManager::OnPlaybackStopped(const CFileItemPtr item)
     SetChanged();
     NotifyObservers(ObservableMessageChannelPlaybackStopped);
 
+    m_zapAhead.Stop();
+
     m_playingChannel.reset();
     m_playingClientId = -1;
     m_strPlayingClientName.clear();
@@ -956,7 +983,8 @@ bool CPVRManager::FillStreamFileItem(CFileItem &fileItem)
   if (client)
   {
     if (fileItem.IsPVRChannel())
-      return client->FillChannelStreamFileItem(fileItem) == PVR_ERROR_NO_ERROR;
+      return m_zapAhead.FillStreamFileItem(fileItem) ||
+             client->FillChannelStreamFileItem(fileItem) == PVR_ERROR_NO_ERROR;
     else if (fileItem.IsPVRRecording())
       return client->FillRecordingStreamFileItem(fileItem) == PVR_ERROR_NO_ERROR;
     else if (fileItem.IsEPG())
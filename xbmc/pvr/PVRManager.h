@@ -25,6 +25,7 @@
 #include "pvr/PVRActionListener.h"
 #include "pvr/PVRSettings.h"
 #include "pvr/PVRTypes.h"
+#include "pvr/PVRZapAhead.h"
 #include "pvr/epg/EpgContainer.h"
 #include "pvr/recordings/PVRRecording.h"
 
@@ -136,6 +137,12 @@ namespace PVR
      */
     CPVREpgContainer& EpgContainer();
 
+    /*!
+     * @brief Get access to the channels prepared for fast switching.
+     * @return The zap-ahead handler.
+     */
+    CPVRZapAhead& ZapAhead();
+
     /*!
      * @brief Init PVRManager.
      */
@@ -247,6 +254,14 @@ namespace PVR
      */
     bool MatchPlayingChannel(int iClientID, int iUniqueChannelID) const;
 
+    /*!
+     * @brief Get the current time for the given channel, taking timeshifting into account.
+     * @param iClientID The client id.
+     * @param iUniqueChannelID The channel uid.
+     * @return The playing time if the channel is playing, the current time otherwise.
+     */
+    CDateTime GetPlaybackTime(int iClientID, int iUniqueChannelID) const;
+
     /*!
      * @brief Return the channel that is currently playing.
      * @return The channel or NULL if none is playing.
@@ -535,6 +550,7 @@ namespace PVR
     std::unique_ptr<CPVRGUIInfo>   m_guiInfo;                     /*!< pointer to the guiinfo data */
     CPVRGUIActionsPtr              m_guiActions;                  /*!< pointer to the pvr gui actions */
     CPVREpgContainer               m_epgContainer;                /*!< the epg container */
+    CPVRZapAhead                   m_zapAhead;                    /*!< the channels prepared for fast switching */
     //@}
 
     CPVRManagerJobQueue             m_pendingUpdates;              /*!< vector of pending pvr updates */
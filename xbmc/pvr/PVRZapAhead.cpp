@@ -0,0 +1,257 @@
+/*
+ *  Copyright (C) 2012-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "PVRZapAhead.h"
+
+#include <algorithm>
+
+#include "ServiceBroker.h"
+#include "filesystem/File.h"
+#include "filesystem/IFile.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/SettingsComponent.h"
+#include "threads/SingleLock.h"
+#include "utils/JobManager.h"
+#include "utils/URIUtils.h"
+#include "utils/log.h"
+
+#include "pvr/PVRManager.h"
+#include "pvr/addons/PVRClients.h"
+#include "pvr/channels/PVRChannel.h"
+#include "pvr/channels/PVRChannelGroup.h"
+
+using namespace PVR;
+using namespace XFILE;
+
+namespace
+{
+  const size_t ZAPAHEAD_READ_SIZE = 32 * 1024;
+  const size_t ZAPAHEAD_MAX_BUFFER_SIZE = 16 * 1024 * 1024; // enough for a few seconds of HD video
+}
+
+CPVRZapAheadStream::CPVRZapAheadStream(const CPVRChannelPtr& channel)
+: CThread("PVRZapAheadStream"),
+  m_channel(channel),
+  m_buffer(ZAPAHEAD_MAX_BUFFER_SIZE)
+{
+}
+
+CPVRZapAheadStream::~CPVRZapAheadStream()
+{
+  StopThread(true);
+}
+
+void CPVRZapAheadStream::Start()
+{
+  Create();
+}
+
+std::string CPVRZapAheadStream::GetStreamURL() const
+{
+  CSingleLock lock(m_critSection);
+  return m_bOpen ? m_item.GetDynPath() : "";
+}
+
+bool CPVRZapAheadStream::FillStreamFileItem(CFileItem& item) const
+{
+  CSingleLock lock(m_critSection);
+  if (!m_bOpen)
+    return false;
+
+  item.SetDynPath(m_item.GetDynPath());
+  item.SetMimeType(m_item.GetMimeType());
+  item.SetContentLookup(false);
+  item.AppendProperties(m_item);
+  return true;
+}
+
+std::unique_ptr<CFile> CPVRZapAheadStream::TakeOver(std::vector<uint8_t>& data)
+{
+  // waits for the pending read, which returns quickly as long as the stream is alive
+  StopThread(true);
+
+  CSingleLock lock(m_critSection);
+  if (!m_bOpen)
+    return {};
+
+  m_bOpen = false;
+  data = m_buffer.GetData();
+  return std::move(m_file);
+}
+
+void CPVRZapAheadStream::Process()
+{
+  CFileItem item(m_channel);
+  const CPVRClientPtr client = CServiceBroker::GetPVRManager().GetClient(item);
+  if (!client || client->FillChannelStreamFileItem(item) != PVR_ERROR_NO_ERROR)
+    return;
+
+  // streams read through the client can't be prepared, it only serves one live stream at a time
+  const std::string strURL = item.GetDynPath();
+  if (!URIUtils::IsProtocol(strURL, "http") && !URIUtils::IsProtocol(strURL, "https"))
+  {
+    CLog::LogFC(LOGDEBUG, LOGPVR, "Not preparing channel '%s', the client does not provide a stream url", m_channel->ChannelName().c_str());
+    return;
+  }
+
+  std::unique_ptr<CFile> file(new CFile);
+  if (!file->Open(strURL, READ_TRUNCATED | READ_BITRATE | READ_CHUNKED | READ_AUDIO_VIDEO | READ_NO_CACHE))
+  {
+    CLog::LogF(LOGERROR, "Unable to open stream of channel '%s'", m_channel->ChannelName().c_str());
+    return;
+  }
+
+  // no need to look up the mime type again when playing
+  if (item.GetMimeType().empty() && file->GetImplementation())
+    item.SetMimeType(file->GetImplementation()->GetProperty(FILE_PROPERTY_MIME_TYPE));
+  item.SetContentLookup(false);
+
+  {
+    CSingleLock lock(m_critSection);
+    m_item = item;
+    m_file = std::move(file);
+    m_bOpen = true;
+  }
+
+  CLog::LogFC(LOGDEBUG, LOGPVR, "Prepared channel '%s'", m_channel->ChannelName().c_str());
+
+  bool bFailed = false;
+  std::vector<uint8_t> buffer(ZAPAHEAD_READ_SIZE);
+  while (!m_bStop && !bFailed)
+  {
+    const ssize_t iRead = m_file->Read(buffer.data(), buffer.size());
+
+    CSingleLock lock(m_critSection);
+    if (iRead <= 0)
+    {
+      CLog::LogFC(LOGDEBUG, LOGPVR, "Stream of prepared channel '%s' ended", m_channel->ChannelName().c_str());
+      bFailed = true;
+    }
+    else if (!m_buffer.Write(buffer.data(), iRead))
+    {
+      CLog::LogFC(LOGDEBUG, LOGPVR, "Stream of channel '%s' is no MPEG transport stream", m_channel->ChannelName().c_str());
+      bFailed = true;
+    }
+  }
+
+  if (bFailed)
+  {
+    CSingleLock lock(m_critSection);
+    m_bOpen = false;
+    m_file.reset();
+  }
+}
+
+void CPVRZapAhead::OnPlaybackStarted(const CPVRChannelPtr& channel, const CPVRChannelGroupPtr& group)
+{
+  if (!CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_bPVRZapAhead || !group)
+  {
+    Stop();
+    return;
+  }
+
+  std::vector<CPVRChannelPtr> channels;
+  for (const CFileItemPtr& item : {group->GetPreviousChannel(channel), group->GetNextChannel(channel)})
+  {
+    if (item && item->HasPVRChannelInfoTag())
+    {
+      const CPVRChannelPtr neighbour = item->GetPVRChannelInfoTag();
+      if (neighbour != channel && std::find(channels.begin(), channels.end(), neighbour) == channels.end())
+        channels.emplace_back(neighbour);
+    }
+  }
+
+  std::vector<std::shared_ptr<CPVRZapAheadStream>> obsolete;
+  {
+    CSingleLock lock(m_critSection);
+
+    std::vector<std::shared_ptr<CPVRZapAheadStream>> streams;
+    for (const auto& stream : m_streams)
+    {
+      const auto it = std::find(channels.begin(), channels.end(), stream->GetChannel());
+      if (it != channels.end())
+      {
+        streams.emplace_back(stream);
+        channels.erase(it);
+      }
+      else
+      {
+        obsolete.emplace_back(stream);
+      }
+    }
+
+    for (const auto& neighbour : channels)
+    {
+      const std::shared_ptr<CPVRZapAheadStream> stream = std::make_shared<CPVRZapAheadStream>(neighbour);
+      stream->Start();
+      streams.emplace_back(stream);
+    }
+
+    m_streams = std::move(streams);
+  }
+
+  Release(std::move(obsolete));
+}
+
+void CPVRZapAhead::Stop()
+{
+  std::vector<std::shared_ptr<CPVRZapAheadStream>> streams;
+  {
+    CSingleLock lock(m_critSection);
+    streams.swap(m_streams);
+  }
+
+  Release(std::move(streams));
+}
+
+void CPVRZapAhead::Release(std::vector<std::shared_ptr<CPVRZapAheadStream>> streams)
+{
+  if (streams.empty())
+    return;
+
+  // closing waits for pending reads, don't block the caller
+  CJobManager::GetInstance().Submit([streams]() mutable {
+    streams.clear();
+  });
+}
+
+bool CPVRZapAhead::FillStreamFileItem(CFileItem& item) const
+{
+  const CPVRChannelPtr channel = item.GetPVRChannelInfoTag();
+
+  CSingleLock lock(m_critSection);
+  for (const auto& stream : m_streams)
+  {
+    if (stream->GetChannel() == channel)
+      return stream->FillStreamFileItem(item);
+  }
+  return false;
+}
+
+std::unique_ptr<CFile> CPVRZapAhead::TakeStream(const CFileItem& item, std::vector<uint8_t>& data)
+{
+  const CPVRChannelPtr channel = item.GetPVRChannelInfoTag();
+
+  std::shared_ptr<CPVRZapAheadStream> stream;
+  {
+    CSingleLock lock(m_critSection);
+    const auto it = std::find_if(m_streams.begin(), m_streams.end(),
+                                 [&channel](const std::shared_ptr<CPVRZapAheadStream>& s) { return s->GetChannel() == channel; });
+    if (it == m_streams.end() || (*it)->GetStreamURL() != item.GetDynPath())
+      return {};
+
+    stream = *it;
+    m_streams.erase(it);
+  }
+
+  std::unique_ptr<CFile> file = stream->TakeOver(data);
+  if (file)
+    CLog::LogFC(LOGDEBUG, LOGPVR, "Switching to prepared channel '%s' with %zu buffered bytes", channel->ChannelName().c_str(), data.size());
+
+  return file;
+}
@@ -0,0 +1,126 @@
+/*
+ *  Copyright (C) 2012-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FileItem.h"
+#include "threads/CriticalSection.h"
+#include "threads/Thread.h"
+
+#include "pvr/PVRTypes.h"
+#include "pvr/PVRZapAheadBuffer.h"
+
+namespace XFILE
+{
+  class CFile;
+}
+
+namespace PVR
+{
+  /*!
+   * A channel stream that is opened and buffered in the background, ready to be handed over to the player.
+   */
+  class CPVRZapAheadStream : private CThread
+  {
+  public:
+    explicit CPVRZapAheadStream(const CPVRChannelPtr& channel);
+    ~CPVRZapAheadStream() override;
+
+    /*!
+     * @brief Start obtaining the stream url from the client, opening and buffering the stream.
+     */
+    void Start();
+
+    const CPVRChannelPtr& GetChannel() const { return m_channel; }
+
+    /*!
+     * @brief Get the url of the stream.
+     * @return The url or an empty string if the stream is not open.
+     */
+    std::string GetStreamURL() const;
+
+    /*!
+     * @brief Fill the stream url and properties obtained from the client into the given item.
+     * @param item The item.
+     * @return True if the stream is open and the item was filled, false otherwise.
+     */
+    bool FillStreamFileItem(CFileItem& item) const;
+
+    /*!
+     * @brief Stop buffering and hand over the connection.
+     * @param data Receives the buffered data, starting at the latest keyframe if there was one.
+     * @return The opened stream to continue reading from or nullptr if the stream is not open.
+     */
+    std::unique_ptr<XFILE::CFile> TakeOver(std::vector<uint8_t>& data);
+
+  private:
+    CPVRZapAheadStream(const CPVRZapAheadStream&) = delete;
+    CPVRZapAheadStream& operator=(const CPVRZapAheadStream&) = delete;
+
+    void Process() override;
+
+    const CPVRChannelPtr m_channel;
+    mutable CCriticalSection m_critSection;
+    CFileItem m_item;
+    std::unique_ptr<XFILE::CFile> m_file;
+    CPVRZapAheadBuffer m_buffer;
+    bool m_bOpen = false;
+  };
+
+  /*!
+   * Keeps the channels next to the playing channel opened, so that switching to them does not need
+   * to wait for the client, the connection and the next keyframe. Only applies to channels streamed
+   * from a url provided by the client as MPEG transport stream.
+   */
+  class CPVRZapAhead
+  {
+  public:
+    CPVRZapAhead() = default;
+
+    /*!
+     * @brief Inform zap-ahead that playback of a channel started, to prepare its neighbours.
+     * @param channel The playing channel.
+     * @param group The group the channel is playing from.
+     */
+    void OnPlaybackStarted(const CPVRChannelPtr& channel, const CPVRChannelGroupPtr& group);
+
+    /*!
+     * @brief Close all prepared channels.
+     */
+    void Stop();
+
+    /*!
+     * @brief Fill the stream url and properties of a prepared channel into the given item.
+     * @param item The channel item.
+     * @return True if the channel is prepared and the item was filled, false otherwise.
+     */
+    bool FillStreamFileItem(CFileItem& item) const;
+
+    /*!
+     * @brief Take the prepared stream for the given item.
+     * @param item The channel item, filled with the stream url.
+     * @param data Receives the buffered data.
+     * @return The opened stream or nullptr if the channel was not prepared for this url.
+     */
+    std::unique_ptr<XFILE::CFile> TakeStream(const CFileItem& item, std::vector<uint8_t>& data);
+
+  private:
+    CPVRZapAhead(const CPVRZapAhead&) = delete;
+    CPVRZapAhead& operator=(const CPVRZapAhead&) = delete;
+
+    static void Release(std::vector<std::shared_ptr<CPVRZapAheadStream>> streams);
+
+    mutable CCriticalSection m_critSection;
+    std::vector<std::shared_ptr<CPVRZapAheadStream>> m_streams;
+  };
+}
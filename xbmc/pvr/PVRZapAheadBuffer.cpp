@@ -0,0 +1,159 @@
+/*
+ *  Copyright (C) 2012-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "PVRZapAheadBuffer.h"
+
+#include <algorithm>
+
+namespace
+{
+  const uint8_t TS_SYNC_BYTE = 0x47;
+  const uint16_t TS_PID_PAT = 0x0000;
+  const size_t TS_MAX_UNSYNCED_BYTES = 10 * PVR::CPVRZapAheadBuffer::TS_PACKET_SIZE;
+}
+
+using namespace PVR;
+
+const size_t CPVRZapAheadBuffer::TS_PACKET_SIZE;
+
+CPVRZapAheadBuffer::CPVRZapAheadBuffer(size_t iMaxSize)
+: m_iMaxSize(iMaxSize)
+{
+}
+
+bool CPVRZapAheadBuffer::Write(const uint8_t* data, size_t iSize)
+{
+  if (m_bInvalid)
+    return false;
+
+  m_pending.insert(m_pending.end(), data, data + iSize);
+
+  size_t iPos = 0;
+  // until synced, a packet is only accepted if the next one starts with a sync byte as well
+  while (m_pending.size() - iPos >= (m_bSynced ? 1 : 2) * TS_PACKET_SIZE)
+  {
+    // a packet starts at a sync byte, and so does the next one, if we have it already
+    if (m_pending[iPos] != TS_SYNC_BYTE ||
+        (m_pending.size() - iPos >= 2 * TS_PACKET_SIZE && m_pending[iPos + TS_PACKET_SIZE] != TS_SYNC_BYTE))
+    {
+      iPos++;
+      if (!m_bSynced && ++m_iUnsyncedBytes > TS_MAX_UNSYNCED_BYTES)
+      {
+        m_bInvalid = true;
+        m_pending.clear();
+        return false;
+      }
+      continue;
+    }
+
+    m_bSynced = true;
+    ProcessPacket(&m_pending[iPos]);
+    iPos += TS_PACKET_SIZE;
+  }
+
+  m_pending.erase(m_pending.begin(), m_pending.begin() + iPos);
+  return true;
+}
+
+void CPVRZapAheadBuffer::ProcessPacket(const uint8_t* packet)
+{
+  const uint16_t iPid = ((packet[1] & 0x1F) << 8) | packet[2];
+  const bool bPayloadStart = (packet[1] & 0x40) != 0;
+  const uint8_t iAdaptationControl = (packet[3] >> 4) & 0x03;
+
+  size_t iPayload = 4;
+  bool bRandomAccess = false;
+  if (iAdaptationControl & 0x02)
+  {
+    const uint8_t iAdaptationLength = packet[4];
+    if (iAdaptationLength > 0)
+      bRandomAccess = (packet[5] & 0x40) != 0;
+    iPayload = 5 + iAdaptationLength;
+  }
+  const bool bHasPayload = (iAdaptationControl & 0x01) && iPayload < TS_PACKET_SIZE;
+
+  if (bPayloadStart && bHasPayload)
+  {
+    if (iPid == TS_PID_PAT)
+    {
+      m_pat.assign(packet, packet + TS_PACKET_SIZE);
+      const size_t iPointer = packet[iPayload];
+      if (iPayload + 1 + iPointer < TS_PACKET_SIZE)
+        ParsePat(packet + iPayload + 1 + iPointer, TS_PACKET_SIZE - iPayload - 1 - iPointer);
+    }
+    else if (m_pmtPids.find(iPid) != m_pmtPids.end())
+    {
+      m_pmts[iPid].assign(packet, packet + TS_PACKET_SIZE);
+    }
+    else if (bRandomAccess &&
+             TS_PACKET_SIZE - iPayload >= 4 &&
+             packet[iPayload] == 0x00 && packet[iPayload + 1] == 0x00 && packet[iPayload + 2] == 0x01 &&
+             (packet[iPayload + 3] & 0xF0) == 0xE0)
+    {
+      // random access point starting a video PES packet: everything before is not needed any more
+      m_packets.clear();
+      m_bHasKeyframe = true;
+    }
+  }
+
+  m_packets.insert(m_packets.end(), packet, packet + TS_PACKET_SIZE);
+  if (m_packets.size() > m_iMaxSize)
+  {
+    // keyframe interval too long for the buffer. start over with the next keyframe
+    m_packets.clear();
+    m_bHasKeyframe = false;
+  }
+}
+
+void CPVRZapAheadBuffer::ParsePat(const uint8_t* section, size_t iSize)
+{
+  // table id, section length, transport stream id, version, section numbers, then 4 byte entries and a CRC
+  if (iSize < 12 || section[0] != 0x00)
+    return;
+
+  const size_t iSectionLength = ((section[1] & 0x0F) << 8) | section[2];
+  const size_t iEnd = std::min(3 + iSectionLength, iSize);
+  if (iEnd < 12)
+    return;
+
+  m_pmtPids.clear();
+  for (size_t i = 8; i + 4 <= iEnd - 4; i += 4)
+  {
+    const uint16_t iProgram = (section[i] << 8) | section[i + 1];
+    const uint16_t iPid = ((section[i + 2] & 0x1F) << 8) | section[i + 3];
+    if (iProgram != 0) // 0 is the network PID
+      m_pmtPids.insert(iPid);
+  }
+
+  for (auto it = m_pmts.begin(); it != m_pmts.end();)
+  {
+    if (m_pmtPids.find(it->first) == m_pmtPids.end())
+      it = m_pmts.erase(it);
+    else
+      ++it;
+  }
+}
+
+size_t CPVRZapAheadBuffer::Size() const
+{
+  size_t iSize = m_pat.size() + m_packets.size();
+  for (const auto& pmt : m_pmts)
+    iSize += pmt.second.size();
+  return iSize;
+}
+
+std::vector<uint8_t> CPVRZapAheadBuffer::GetData() const
+{
+  std::vector<uint8_t> data;
+  data.reserve(Size());
+  data.insert(data.end(), m_pat.begin(), m_pat.end());
+  for (const auto& pmt : m_pmts)
+    data.insert(data.end(), pmt.second.begin(), pmt.second.end());
+  data.insert(data.end(), m_packets.begin(), m_packets.end());
+  return data;
+}
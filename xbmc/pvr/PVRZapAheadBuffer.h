@@ -0,0 +1,78 @@
+/*
+ *  Copyright (C) 2012-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace PVR
+{
+  /*!
+   * Buffer for a live MPEG transport stream that is received, but not played yet. Only the packets
+   * since the latest video keyframe are kept, plus the latest PAT and PMT packets, so that playback
+   * of the buffered data can start without waiting for the next keyframe. Not thread safe.
+   */
+  class CPVRZapAheadBuffer
+  {
+  public:
+    static const size_t TS_PACKET_SIZE = 188;
+
+    /*!
+     * @brief Create a buffer.
+     * @param iMaxSize The maximum number of bytes to keep since the latest keyframe. If a keyframe
+     * interval exceeds this size, the data is dropped until the next keyframe.
+     */
+    explicit CPVRZapAheadBuffer(size_t iMaxSize);
+
+    /*!
+     * @brief Add data received from the stream.
+     * @param data The data.
+     * @param iSize The size of the data.
+     * @return False if the data does not look like a transport stream, true otherwise.
+     */
+    bool Write(const uint8_t* data, size_t iSize);
+
+    /*!
+     * @brief Check whether a video keyframe was received.
+     * @return True if the buffered data starts with a keyframe, false otherwise.
+     */
+    bool HasKeyframe() const { return m_bHasKeyframe; }
+
+    /*!
+     * @brief Get the size of the data returned by GetData().
+     * @return The size in bytes.
+     */
+    size_t Size() const;
+
+    /*!
+     * @brief Get the buffered data: the latest PAT and PMT packets, followed by the packets since
+     * the latest keyframe.
+     * @return The data.
+     */
+    std::vector<uint8_t> GetData() const;
+
+  private:
+    void ProcessPacket(const uint8_t* packet);
+    void ParsePat(const uint8_t* section, size_t iSize);
+
+    const size_t m_iMaxSize;
+    std::vector<uint8_t> m_pending; /*!< received bytes not forming a complete packet yet */
+    std::vector<uint8_t> m_packets; /*!< complete packets since the latest keyframe */
+    std::vector<uint8_t> m_pat;
+    std::map<uint16_t, std::vector<uint8_t>> m_pmts; /*!< latest PMT packet by PID */
+    std::set<uint16_t> m_pmtPids;
+    size_t m_iUnsyncedBytes = 0;
+    bool m_bSynced = false;
+    bool m_bInvalid = false;
+    bool m_bHasKeyframe = false;
+  };
+}
@@ -31,7 +31,8 @@ CPVREpg::CPVREpg(int iEpgID, const std::string& strName, const std::string& strS
   m_iEpgID(iEpgID),
   m_strName(strName),
   m_strScraperName(strScraperName),
-  m_channelData(new CPVREpgChannelData)
+  m_channelData(new CPVREpgChannelData),
+  m_tags(m_channelData, m_iEpgID)
 {
 }
 
@@ -40,7 +41,8 @@ CPVREpg::CPVREpg(int iEpgID, const std::string& strName, const std::string& strS
   m_iEpgID(iEpgID),
   m_strName(strName),
   m_strScraperName(strScraperName),
-  m_channelData(channelData)
+  m_channelData(channelData),
+  m_tags(m_channelData, m_iEpgID)
 {
 }
 
@@ -64,14 +66,14 @@ bool CPVREpg::HasValidEntries(void) const
 {
   CSingleLock lock(m_critSection);
   return (m_iEpgID > 0 && /* valid EPG ID */
-          !m_tags.empty() && /* contains at least 1 tag */
-          m_tags.rbegin()->second->EndAsUTC() >= CDateTime::GetCurrentDateTime().GetAsUTCDateTime()); /* the last end time hasn't passed yet */
+          !m_tags.IsEmpty() && /* contains at least 1 tag */
+          m_tags.EndAsUTC(m_tags.Size() - 1) >= CDateTime::GetCurrentDateTime().GetAsUTCDateTime()); /* the last end time hasn't passed yet */
 }
 
 void CPVREpg::Clear(void)
 {
   CSingleLock lock(m_critSection);
-  m_tags.clear();
+  m_tags.Clear();
 }
 
 void CPVREpg::Cleanup(int iPastDays)
@@ -82,21 +84,38 @@ void CPVREpg::Cleanup(int iPastDays)
 
 void CPVREpg::Cleanup(const CDateTime &time)
 {
+  time_t cleanupTime = 0;
+  time.GetAsTime(cleanupTime);
+
+  bool bErased = false;
   CSingleLock lock(m_critSection);
-  for (auto it = m_tags.begin(); it != m_tags.end();)
+  for (size_t i = 0; i < m_tags.Size();)
   {
-    if (it->second->EndAsUTC() < time)
+    if (m_tags.End(i) < cleanupTime)
     {
-      if (m_nowActiveStart == it->first)
+      if (m_nowActiveStart == m_tags.StartAsUTC(i))
         m_nowActiveStart.SetValid(false);
 
-      it = m_tags.erase(it);
+      m_tags.Erase(i);
+      bErased = true;
     }
     else
     {
-      ++it;
+      ++i;
     }
   }
+
+  if (bErased)
+  {
+    SetChanged();
+    lock.Leave();
+    NotifyObservers(ObservableMessageEpg);
+  }
+}
+
+CDateTime CPVREpg::GetCurrentPlayingTime() const
+{
+  return CServiceBroker::GetPVRManager().GetPlaybackTime(m_channelData->ClientId(), m_channelData->UniqueClientChannelId());
 }
 
 CPVREpgInfoTagPtr CPVREpg::GetTagNow(bool bUpdateIfNeeded /* = true */) const
@@ -104,31 +123,39 @@ CPVREpgInfoTagPtr CPVREpg::GetTagNow(bool bUpdateIfNeeded /* = true */) const
   CSingleLock lock(m_critSection);
   if (m_nowActiveStart.IsValid())
   {
-    const auto it = m_tags.find(m_nowActiveStart);
-    if (it != m_tags.end() && it->second->IsActive())
-      return it->second;
+    const size_t i = m_tags.Find(m_nowActiveStart);
+    if (i != CPVREpgTagStore::npos)
+    {
+      const CPVREpgInfoTagPtr tag = m_tags.Get(i);
+      if (tag->IsActive())
+        return tag;
+    }
   }
 
-  if (bUpdateIfNeeded)
+  if (bUpdateIfNeeded && !m_tags.IsEmpty())
   {
-    CPVREpgInfoTagPtr lastActiveTag;
+    time_t now = 0;
+    GetCurrentPlayingTime().GetAsTime(now);
 
-    /* one of the first items will always match if the list is sorted */
-    for (const auto& tag : m_tags)
+    /* tags are sorted by start time, so the active tag is the last one starting before now */
+    size_t i = m_tags.LowerBound(CDateTime(now));
+    if (i < m_tags.Size() && m_tags.Start(i) == now)
+      ++i;
+
+    if (i > 0)
     {
-      if (tag.second->IsActive())
+      --i;
+      if (m_tags.End(i) > now)
       {
-        m_nowActiveStart = tag.first;
-        return tag.second;
+        m_nowActiveStart = m_tags.StartAsUTC(i);
+        return m_tags.Get(i);
       }
-      else if (tag.second->WasActive())
-        lastActiveTag = tag.second;
-    }
 
-    /* there might be a gap between the last and next event. return the last if found and it ended not more than 5 minutes ago */
-    if (lastActiveTag &&
-        lastActiveTag->EndAsUTC() + CDateTimeSpan(0, 0, 5, 0) >= CDateTime::GetUTCDateTime())
-      return lastActiveTag;
+      /* there might be a gap between the last and next event. return the last if found and it ended not more than 5 minutes ago */
+      if (m_tags.End(i) < now &&
+          m_tags.EndAsUTC(i) + CDateTimeSpan(0, 0, 5, 0) >= CDateTime::GetUTCDateTime())
+        return m_tags.Get(i);
+    }
   }
 
   return CPVREpgInfoTagPtr();
@@ -137,20 +164,24 @@ CPVREpgInfoTagPtr CPVREpg::GetTagNow(bool bUpdateIfNeeded /* = true */) const
 CPVREpgInfoTagPtr CPVREpg::GetTagNext() const
 {
   const CPVREpgInfoTagPtr nowTag = GetTagNow();
+
+  CSingleLock lock(m_critSection);
   if (nowTag)
   {
-    CSingleLock lock(m_critSection);
-    auto it = m_tags.find(nowTag->StartAsUTC());
-    if (it != m_tags.end() && ++it != m_tags.end())
-      return it->second;
+    const size_t i = m_tags.Find(nowTag->StartAsUTC());
+    if (i != CPVREpgTagStore::npos && i + 1 < m_tags.Size())
+      return m_tags.Get(i + 1);
   }
-  else if (m_tags.size() > 0)
+  else if (!m_tags.IsEmpty())
   {
     /* return the first event that is in the future */
-    for (const auto& tag : m_tags)
+    time_t now = 0;
+    GetCurrentPlayingTime().GetAsTime(now);
+
+    for (size_t i = 0; i < m_tags.Size(); ++i)
     {
-      if (tag.second->IsUpcoming())
-        return tag.second;
+      if (m_tags.Start(i) > now)
+        return m_tags.Get(i);
     }
   }
 
@@ -160,23 +191,24 @@ CPVREpgInfoTagPtr CPVREpg::GetTagNext() const
 CPVREpgInfoTagPtr CPVREpg::GetTagPrevious() const
 {
   const CPVREpgInfoTagPtr nowTag = GetTagNow();
+
+  CSingleLock lock(m_critSection);
   if (nowTag)
   {
-    CSingleLock lock(m_critSection);
-    auto it = m_tags.find(nowTag->StartAsUTC());
-    if (it != m_tags.end() && it != m_tags.begin())
-    {
-      --it;
-      return it->second;
-    }
+    const size_t i = m_tags.Find(nowTag->StartAsUTC());
+    if (i != CPVREpgTagStore::npos && i > 0)
+      return m_tags.Get(i - 1);
   }
-  else if (m_tags.size() > 0)
+  else if (!m_tags.IsEmpty())
   {
     /* return the first event that is in the past */
-    for (auto it = m_tags.rbegin(); it != m_tags.rend(); ++it)
+    time_t now = 0;
+    GetCurrentPlayingTime().GetAsTime(now);
+
+    for (size_t i = m_tags.Size(); i > 0; --i)
     {
-      if (it->second->WasActive())
-        return it->second;
+      if (m_tags.End(i - 1) < now)
+        return m_tags.Get(i - 1);
     }
   }
 
@@ -203,10 +235,10 @@ CPVREpgInfoTagPtr CPVREpg::GetTagByBroadcastId(unsigned int iUniqueBroadcastId)
   if (iUniqueBroadcastId != EPG_TAG_INVALID_UID)
   {
     CSingleLock lock(m_critSection);
-    for (const auto &infoTag : m_tags)
+    for (size_t i = 0; i < m_tags.Size(); ++i)
     {
-      if (infoTag.second->UniqueBroadcastID() == iUniqueBroadcastId)
-        return infoTag.second;
+      if (m_tags.UniqueBroadcastID(i) == iUniqueBroadcastId)
+        return m_tags.Get(i);
     }
   }
   return CPVREpgInfoTagPtr();
@@ -217,11 +249,11 @@ CPVREpgInfoTagPtr CPVREpg::GetTagBetween(const CDateTime &beginTime, const CDate
   CPVREpgInfoTagPtr tag;
 
   CSingleLock lock(m_critSection);
-  for (const auto& epgTag : m_tags)
+  for (size_t i = m_tags.LowerBound(beginTime); i < m_tags.Size() && m_tags.StartAsUTC(i) <= endTime; ++i)
   {
-    if (epgTag.second->StartAsUTC() >= beginTime && epgTag.second->EndAsUTC() <= endTime)
+    if (m_tags.EndAsUTC(i) <= endTime)
     {
-      tag = epgTag.second;
+      tag = m_tags.Get(i);
       break;
     }
   }
@@ -240,7 +272,7 @@ CPVREpgInfoTagPtr CPVREpg::GetTagBetween(const CDateTime &beginTime, const CDate
 
     if (tag)
     {
-      m_tags.insert(std::make_pair(tag->StartAsUTC(), tag));
+      m_tags.Set(tag);
       UpdateEntry(tag, !CServiceBroker::GetSettingsComponent()->GetSettings()->GetBool(CSettings::SETTING_EPG_IGNOREDBFORCLIENT));
     }
   }
@@ -248,22 +280,33 @@ CPVREpgInfoTagPtr CPVREpg::GetTagBetween(const CDateTime &beginTime, const CDate
   return tag;
 }
 
+std::vector<std::shared_ptr<CPVREpgInfoTag>> CPVREpg::GetTagsBetween(const CDateTime& beginTime, const CDateTime& endTime) const
+{
+  std::vector<std::shared_ptr<CPVREpgInfoTag>> tags;
+
+  CSingleLock lock(m_critSection);
+  const auto range = m_tags.GetRange(beginTime, endTime);
+  tags.reserve(range.second - range.first);
+  for (size_t i = range.first; i < range.second; ++i)
+    tags.emplace_back(m_tags.Get(i));
+
+  return tags;
+}
+
 void CPVREpg::AddEntry(const CPVREpgInfoTag &tag)
 {
   CPVREpgInfoTagPtr newTag;
 
   CSingleLock lock(m_critSection);
-  const auto it = m_tags.find(tag.StartAsUTC());
-  if (it != m_tags.end())
-    newTag = it->second;
+  const size_t i = m_tags.Find(tag.StartAsUTC());
+  if (i != CPVREpgTagStore::npos)
+    newTag = m_tags.Get(i);
   else
-  {
     newTag = std::make_shared<CPVREpgInfoTag>(m_channelData, m_iEpgID);
-    m_tags.insert(std::make_pair(tag.StartAsUTC(), newTag));
-  }
 
   newTag->Update(tag);
   newTag->SetEpgID(m_iEpgID);
+  m_tags.Set(newTag);
 }
 
 bool CPVREpg::Load(const std::shared_ptr<CPVREpgDatabase>& database)
@@ -309,8 +352,8 @@ bool CPVREpg::UpdateEntries(const CPVREpg &epg, bool bStoreInDb /* = true */)
 {
   CSingleLock lock(m_critSection);
   /* copy over tags */
-  for (const auto& tag : epg.m_tags)
-    UpdateEntry(tag.second, bStoreInDb);
+  for (size_t i = 0; i < epg.m_tags.Size(); ++i)
+    UpdateEntry(epg.m_tags.Get(i), bStoreInDb);
 
   FixOverlappingEvents(bStoreInDb);
 
@@ -340,22 +383,25 @@ bool CPVREpg::UpdateEntry(const CPVREpgInfoTagPtr &tag, bool bUpdateDatabase)
   CPVREpgInfoTagPtr infoTag;
 
   CSingleLock lock(m_critSection);
-  const auto it = m_tags.find(tag->StartAsUTC());
+  const size_t i = m_tags.Find(tag->StartAsUTC());
   bool bNewTag = false;
-  if (it != m_tags.end())
+  if (i != CPVREpgTagStore::npos)
   {
-    infoTag = it->second;
+    infoTag = m_tags.Get(i);
   }
   else
   {
     infoTag = std::make_shared<CPVREpgInfoTag>(m_channelData, m_iEpgID);
     infoTag->SetUniqueBroadcastID(tag->UniqueBroadcastID());
-    m_tags.insert(std::make_pair(tag->StartAsUTC(), infoTag));
     bNewTag = true;
   }
 
-  infoTag->Update(*tag, bNewTag);
+  // only write tags that are new or differ from what we have already
+  if (!infoTag->Update(*tag, bNewTag) && !bNewTag)
+    return true;
+
   infoTag->SetEpgID(m_iEpgID);
+  m_tags.Set(infoTag);
 
   if (bUpdateDatabase)
     m_changedTags.insert(std::make_pair(infoTag->UniqueBroadcastID(), infoTag));
@@ -375,14 +421,14 @@ bool CPVREpg::UpdateEntry(const CPVREpgInfoTagPtr &tag, EPG_EVENT_STATE newState
   else if (newState == EPG_EVENT_DELETED)
   {
     CSingleLock lock(m_critSection);
-    auto it = m_tags.begin();
-    for (; it != m_tags.end(); ++it)
+    size_t i = 0;
+    for (; i < m_tags.Size(); ++i)
     {
-      if (it->second->UniqueBroadcastID() == tag->UniqueBroadcastID())
+      if (m_tags.UniqueBroadcastID(i) == tag->UniqueBroadcastID())
         break;
     }
 
-    if (it == m_tags.end())
+    if (i == m_tags.Size())
     {
       bRet = false;
     }
@@ -391,12 +437,12 @@ bool CPVREpg::UpdateEntry(const CPVREpgInfoTagPtr &tag, EPG_EVENT_STATE newState
       // Respect epg linger time.
       int iPastDays = CServiceBroker::GetSettingsComponent()->GetSettings()->GetInt(CSettings::SETTING_EPG_PAST_DAYSTODISPLAY);
       const CDateTime cleanupTime(CDateTime::GetUTCDateTime() - CDateTimeSpan(iPastDays, 0, 0, 0));
-      if (it->second->EndAsUTC() < cleanupTime)
+      if (m_tags.EndAsUTC(i) < cleanupTime)
       {
         if (bUpdateDatabase)
-          m_deletedTags.insert(std::make_pair(it->second->UniqueBroadcastID(), it->second));
+          m_deletedTags.insert(std::make_pair(m_tags.UniqueBroadcastID(i), m_tags.Get(i)));
 
-        m_tags.erase(it);
+        m_tags.Erase(i);
       }
       else
       {
@@ -430,15 +476,18 @@ bool CPVREpg::Update(time_t start,
   bool bUpdate = false;
 
   /* load the entries from the db first */
-  if (!m_bLoaded && database)
-    Load(database);
+  if (!m_bLoaded && database && Load(database))
+  {
+    SetChanged();
+    NotifyObservers(ObservableMessageEpg);
+  }
 
   /* clean up if needed */
   if (m_bLoaded)
     Cleanup(iPastDays);
 
   /* enforce advanced settings update interval override for channels with no EPG data */
-  if (m_tags.empty() && !bUpdate && ChannelID() > 0)
+  if (m_tags.IsEmpty() && !bUpdate && ChannelID() > 0)
     iUpdateTime = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_iEpgUpdateEmptyTagsInterval;
 
   if (!bForceUpdate)
@@ -472,8 +521,9 @@ std::vector<std::shared_ptr<CPVREpgInfoTag>> CPVREpg::GetTags() const
   std::vector<std::shared_ptr<CPVREpgInfoTag>> tags;
 
   CSingleLock lock(m_critSection);
-  for (const auto& tag : m_tags)
-    tags.emplace_back(tag.second);
+  tags.reserve(m_tags.Size());
+  for (size_t i = 0; i < m_tags.Size(); ++i)
+    tags.emplace_back(m_tags.Get(i));
 
   return tags;
 }
@@ -486,6 +536,9 @@ bool CPVREpg::Persist(const std::shared_ptr<CPVREpgDatabase>& database)
     return false;
   }
 
+  std::vector<std::shared_ptr<CPVREpgInfoTag>> changedTags;
+  std::vector<std::shared_ptr<CPVREpgInfoTag>> deletedTags;
+
   database->Lock();
 
   {
@@ -501,20 +554,19 @@ bool CPVREpg::Persist(const std::shared_ptr<CPVREpgDatabase>& database)
       }
     }
 
-    for (const auto& tag : m_deletedTags)
-      database->Delete(*tag.second);
-
-    for (const auto& tag : m_changedTags)
-      tag.second->Persist(database, false);
-
     if (m_bUpdateLastScanTime)
       database->PersistLastEpgScanTime(m_iEpgID, m_lastScanTime, true);
 
     if (bEpgIdChanged)
-    {
-      for (const auto& tag : m_tags)
-        tag.second->SetEpgID(m_iEpgID);
-    }
+      m_tags.SetEpgID(m_iEpgID);
+
+    deletedTags.reserve(m_deletedTags.size());
+    for (const auto& tag : m_deletedTags)
+      deletedTags.emplace_back(tag.second);
+
+    changedTags.reserve(m_changedTags.size());
+    for (const auto& tag : m_changedTags)
+      changedTags.emplace_back(tag.second);
 
     m_deletedTags.clear();
     m_changedTags.clear();
@@ -526,6 +578,18 @@ bool CPVREpg::Persist(const std::shared_ptr<CPVREpgDatabase>& database)
   bool bRet = database->CommitInsertQueries();
 
   database->Unlock();
+
+  // written in chunks outside of the locks, so neither the database nor this table are blocked
+  // for the whole time
+  if (!deletedTags.empty())
+    bRet &= database->Delete(deletedTags);
+  if (!changedTags.empty())
+    bRet &= database->Persist(changedTags);
+
+  if (!changedTags.empty() || !deletedTags.empty())
+    CLog::LogFC(LOGDEBUG, LOGEPG, "Persisted %zu changed and %zu deleted tags of table '%s'",
+                changedTags.size(), deletedTags.size(), m_strName.c_str());
+
   return bRet;
 }
 
@@ -534,8 +598,8 @@ CDateTime CPVREpg::GetFirstDate(void) const
   CDateTime first;
 
   CSingleLock lock(m_critSection);
-  if (!m_tags.empty())
-    first = m_tags.begin()->second->StartAsUTC();
+  if (!m_tags.IsEmpty())
+    first = m_tags.StartAsUTC(0);
 
   return first;
 }
@@ -545,8 +609,8 @@ CDateTime CPVREpg::GetLastDate(void) const
   CDateTime last;
 
   CSingleLock lock(m_critSection);
-  if (!m_tags.empty())
-    last = m_tags.rbegin()->second->StartAsUTC();
+  if (!m_tags.IsEmpty())
+    last = m_tags.StartAsUTC(m_tags.Size() - 1);
 
   return last;
 }
@@ -554,39 +618,40 @@ CDateTime CPVREpg::GetLastDate(void) const
 bool CPVREpg::FixOverlappingEvents(bool bUpdateDb /* = false */)
 {
   bool bReturn = true;
-  CPVREpgInfoTagPtr previousTag, currentTag;
+  size_t iPrevious = CPVREpgTagStore::npos;
 
-  for (auto it = m_tags.begin(); it != m_tags.end(); it != m_tags.end() ? it++ : it)
+  for (size_t i = 0; i < m_tags.Size();)
   {
-    if (!previousTag)
+    if (iPrevious == CPVREpgTagStore::npos)
     {
-      previousTag = it->second;
+      iPrevious = i++;
       continue;
     }
-    currentTag = it->second;
 
-    if (previousTag->EndAsUTC() >= currentTag->EndAsUTC())
+    if (m_tags.End(iPrevious) >= m_tags.End(i))
     {
       // delete the current tag. it's completely overlapped
       if (bUpdateDb)
-        m_deletedTags.insert(std::make_pair(currentTag->UniqueBroadcastID(), currentTag));
+        m_deletedTags.insert(std::make_pair(m_tags.UniqueBroadcastID(i), m_tags.Get(i)));
 
-      if (m_nowActiveStart == it->first)
+      if (m_nowActiveStart == m_tags.StartAsUTC(i))
         m_nowActiveStart.SetValid(false);
 
-      m_tags.erase(it++);
+      m_tags.Erase(i);
     }
-    else if (previousTag->EndAsUTC() > currentTag->StartAsUTC())
+    else if (m_tags.End(iPrevious) > m_tags.Start(i))
     {
-      previousTag->SetEndFromUTC(currentTag->StartAsUTC());
+      const CPVREpgInfoTagPtr previousTag = m_tags.Get(iPrevious);
+      previousTag->SetEndFromUTC(m_tags.StartAsUTC(i));
+      m_tags.Set(previousTag);
       if (bUpdateDb)
         m_changedTags.insert(std::make_pair(previousTag->UniqueBroadcastID(), previousTag));
 
-      previousTag = it->second;
+      iPrevious = i++;
     }
     else
     {
-      previousTag = it->second;
+      iPrevious = i++;
     }
   }
 
@@ -713,9 +778,7 @@ void CPVREpg::SetChannelData(const std::shared_ptr<CPVREpgChannelData>& data)
 {
   CSingleLock lock(m_critSection);
   m_channelData = data;
-
-  for (const auto& tag : m_tags)
-    tag.second->SetChannelData(data);
+  m_tags.SetChannelData(data);
 }
 
 int CPVREpg::ChannelID(void) const
@@ -762,3 +825,9 @@ bool CPVREpg::IsValid(void) const
 
   return true;
 }
+
+size_t CPVREpg::GetMemoryUsage(void) const
+{
+  CSingleLock lock(m_critSection);
+  return m_tags.GetMemoryUsage();
+}
@@ -17,6 +17,7 @@
 
 #include "pvr/PVRTypes.h"
 #include "pvr/epg/EpgInfoTag.h"
+#include "pvr/epg/EpgTagStore.h"
 
 /** EPG container for CPVREpgInfoTag instances */
 namespace PVR
@@ -111,7 +112,7 @@ namespace PVR
     bool HasValidEntries(void) const;
 
     /*!
-     * @brief Remove all entries from this EPG that finished before the given time.
+     * @brief Remove all entries from this EPG that finished before the given time. Observers are notified if entries were removed.
      * @param time Delete entries with an end time before this time in UTC.
      */
     void Cleanup(const CDateTime &time);
@@ -148,6 +149,14 @@ namespace PVR
      */
     CPVREpgInfoTagPtr GetTagBetween(const CDateTime &beginTime, const CDateTime &endTime, bool bUpdateFromClient = false);
 
+    /*!
+     * @brief Get all events overlapping the given period.
+     * @param beginTime The start of the period in UTC.
+     * @param endTime The end of the period in UTC.
+     * @return The events, sorted by start time.
+     */
+    std::vector<std::shared_ptr<CPVREpgInfoTag>> GetTagsBetween(const CDateTime& beginTime, const CDateTime& endTime) const;
+
     /*!
      * @brief Get the event matching the given unique broadcast id
      * @param iUniqueBroadcastId The uid to look up
@@ -244,6 +253,12 @@ namespace PVR
      */
     bool IsValid(void) const;
 
+    /*!
+     * @brief Get the approximate amount of memory used by the tags of this EPG.
+     * @return The size in bytes.
+     */
+    size_t GetMemoryUsage(void) const;
+
   private:
     CPVREpg(void) = delete;
     CPVREpg(const CPVREpg&) = delete;
@@ -295,7 +310,12 @@ namespace PVR
      */
     void Cleanup(int iPastDays);
 
-    std::map<CDateTime, CPVREpgInfoTagPtr> m_tags;
+    /*!
+     * @brief Get current time, taking timeshifting into account.
+     * @return The playing time.
+     */
+    CDateTime GetCurrentPlayingTime() const;
+
     std::map<int, CPVREpgInfoTagPtr>       m_changedTags;
     std::map<int, CPVREpgInfoTagPtr>       m_deletedTags;
     bool                                m_bChanged = false;        /*!< true if anything changed that needs to be persisted, false otherwise */
@@ -311,5 +331,6 @@ namespace PVR
     bool                                m_bUpdateLastScanTime = false;
 
     std::shared_ptr<CPVREpgChannelData> m_channelData;
+    CPVREpgTagStore                     m_tags;            /*!< the tags of this table, sorted by start time */
   };
 }
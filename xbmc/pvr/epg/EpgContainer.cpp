@@ -8,12 +8,19 @@
 
 #include "EpgContainer.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <memory>
+
 #include "ServiceBroker.h"
 #include "guilib/LocalizeStrings.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "settings/SettingsComponent.h"
 #include "settings/lib/Setting.h"
+#include "threads/IRunnable.h"
 #include "threads/SingleLock.h"
 #include "threads/SystemClock.h"
 #include "utils/log.h"
@@ -23,6 +30,7 @@
 #include "pvr/epg/Epg.h"
 #include "pvr/epg/EpgChannelData.h"
 #include "pvr/epg/EpgSearchFilter.h"
+#include "pvr/epg/EpgTagStore.h"
 
 namespace PVR
 {
@@ -104,10 +112,12 @@ CPVREpgContainer::CPVREpgContainer(void) :
 {
   m_bStop = true; // base class member
   m_updateEvent.Reset();
+  CMemoryBudget::GetInstance().RegisterConsumer(this, "epg", MEMORY_PRIORITY_HIGH);
 }
 
 CPVREpgContainer::~CPVREpgContainer(void)
 {
+  CMemoryBudget::GetInstance().UnregisterConsumer(this);
   Stop();
   Clear();
 }
@@ -142,9 +152,12 @@ void CPVREpgContainer::Clear()
 
   {
     CSingleLock lock(m_critSection);
-    /* clear all epg tables and remove pointers to epg tables on channels */
+    /* clear all epg tables and remove pointers to epg tables on channels. tables recreated with the same id must not match cached data. */
     for (const auto &epgEntry : m_epgIdToEpgMap)
+    {
       epgEntry.second->UnregisterObserver(this);
+      m_epgRevisions[epgEntry.first] = ++m_iLastEpgRevision;
+    }
 
     m_epgIdToEpgMap.clear();
     m_channelUidToEpgMap.clear();
@@ -179,6 +192,55 @@ public:
   }
 };
 
+class CPVREpgContainerPersistJob : public CJob
+{
+public:
+  explicit CPVREpgContainerPersistJob(CPVREpgContainer& container) : m_container(container) {}
+  ~CPVREpgContainerPersistJob(void) override = default;
+
+  const char* GetType() const override { return "pvr-epg-persist"; }
+
+  bool operator==(const CJob* job) const override
+  {
+    return strcmp(job->GetType(), GetType()) == 0;
+  }
+
+  bool DoWork() override
+  {
+    return m_container.PersistAll();
+  }
+
+private:
+  CPVREpgContainer& m_container;
+};
+
+/*!
+ * Updates the tables of one client. Several workers may share the tables, each taking the next one
+ * that is not being updated yet.
+ */
+class CPVREpgUpdateWorker : public IRunnable
+{
+public:
+  CPVREpgUpdateWorker(const std::vector<CPVREpgPtr>& tables,
+                      std::atomic<size_t>& nextTable,
+                      const std::function<bool(const CPVREpgPtr&)>& updateTable)
+  : m_tables(tables), m_nextTable(nextTable), m_updateTable(updateTable) {}
+
+  void Run() override
+  {
+    for (size_t iTable = m_nextTable++; iTable < m_tables.size(); iTable = m_nextTable++)
+    {
+      if (!m_updateTable(m_tables[iTable]))
+        break;
+    }
+  }
+
+private:
+  const std::vector<CPVREpgPtr>& m_tables;
+  std::atomic<size_t>& m_nextTable;
+  const std::function<bool(const CPVREpgPtr&)>& m_updateTable;
+};
+
 void CPVREpgContainer::Start(bool bAsync)
 {
   if (bAsync)
@@ -194,6 +256,10 @@ void CPVREpgContainer::Start(bool bAsync)
     CSingleLock lock(m_critSection);
 
     m_database->Open();
+    {
+      CSingleLock persistLock(m_persistLock);
+      m_bPersistStopped = false;
+    }
 
     m_bIsInitialising = true;
     m_bStop = false;
@@ -231,6 +297,14 @@ void CPVREpgContainer::Stop(void)
 {
   StopThread();
 
+  // the final write happened on thread exit. drop pending writes, wait for a
+  // running one and keep jobs that didn't get the lock yet from writing.
+  m_persistQueue.CancelJobs();
+  {
+    CSingleLock lock(m_persistLock);
+    m_bPersistStopped = true;
+  }
+
   m_database->Close();
 
   CSingleLock lock(m_critSection);
@@ -239,6 +313,16 @@ void CPVREpgContainer::Stop(void)
 
 void CPVREpgContainer::Notify(const Observable &obs, const ObservableMessage msg)
 {
+  if (msg == ObservableMessageEpg || msg == ObservableMessageEpgItemUpdate)
+  {
+    const CPVREpg* epg = dynamic_cast<const CPVREpg*>(&obs);
+    if (epg)
+    {
+      CSingleLock lock(m_critSection);
+      m_epgRevisions[epg->EpgID()] = ++m_iLastEpgRevision;
+    }
+  }
+
   if (msg == ObservableMessageEpgItemUpdate)
   {
     // there can be many of these notifications during short time period. Thus, announce async and not every event.
@@ -302,6 +386,10 @@ bool CPVREpgContainer::PersistAll(void)
 
   if (!bReturn)
   {
+    CSingleLock persistLock(m_persistLock);
+    if (m_bPersistStopped)
+      return false;
+
     m_critSection.lock();
     const auto epgs = m_epgIdToEpgMap;
     m_critSection.unlock();
@@ -318,6 +406,12 @@ bool CPVREpgContainer::PersistAll(void)
   return bReturn;
 }
 
+void CPVREpgContainer::PersistAllAsync(void)
+{
+  if (!IgnoreDB())
+    m_persistQueue.AddJob(new CPVREpgContainerPersistJob(*this));
+}
+
 void CPVREpgContainer::Process(void)
 {
   time_t iNow = 0;
@@ -423,7 +517,7 @@ void CPVREpgContainer::Process(void)
     /* check for changes that need to be saved every 60 seconds */
     if (iNow - iLastSave > 60)
     {
-      PersistAll();
+      PersistAllAsync();
       iLastSave = iNow;
     }
 
@@ -488,6 +582,17 @@ std::shared_ptr<CPVREpgInfoTag> CPVREpgContainer::GetTagById(const std::shared_p
   return retval;
 }
 
+size_t CPVREpgContainer::GetMemoryUsage() const
+{
+  size_t iSize = CPVREpgTagStore::GetStringPoolMemoryUsage();
+
+  CSingleLock lock(m_critSection);
+  for (const auto& epgEntry : m_epgIdToEpgMap)
+    iSize += epgEntry.second->GetMemoryUsage();
+
+  return iSize;
+}
+
 std::vector<std::shared_ptr<CPVREpgInfoTag>> CPVREpgContainer::GetAllTags() const
 {
   std::vector<std::shared_ptr<CPVREpgInfoTag>> allTags;
@@ -671,38 +776,93 @@ bool CPVREpgContainer::UpdateEPG(bool bOnlyPending /* = false */)
   if (bShowProgress && !bOnlyPending)
     progressHandler = new CPVRGUIProgressHandler(g_localizeStrings.Get(19004)); // Importing guide from clients
 
+  m_critSection.lock();
+  const auto epgs = m_epgIdToEpgMap;
+  m_critSection.unlock();
+
   /* load or update all EPG tables */
   unsigned int iCounter = 0;
+  CCriticalSection resultLock;
   const std::shared_ptr<CPVREpgDatabase> database = IgnoreDB() ? nullptr : GetEpgDatabase();
-  for (const auto& epgEntry : m_epgIdToEpgMap)
+  const int iUpdateTime = m_settings.GetIntValue(CSettings::SETTING_EPG_EPGUPDATE) * 60;
+  const int iPastDays = m_settings.GetIntValue(CSettings::SETTING_EPG_PAST_DAYSTODISPLAY);
+
+  // returns false if the update has been interrupted
+  const std::function<bool(const CPVREpgPtr&)> updateTable = [&](const CPVREpgPtr& epg)
   {
     if (InterruptUpdate())
     {
+      CSingleLock lock(resultLock);
       bInterrupted = true;
-      break;
+      return false;
     }
 
-    const CPVREpgPtr epg = epgEntry.second;
-    if (!epg)
-      continue;
-
     if (bShowProgress && !bOnlyPending)
-      progressHandler->UpdateProgress(epg->Name(), ++iCounter, m_epgIdToEpgMap.size());
+    {
+      CSingleLock lock(resultLock);
+      progressHandler->UpdateProgress(epg->Name(), ++iCounter, epgs.size());
+    }
 
+    // tables announce changes of their data, which bumps their revision. updates that were not due change nothing.
+    const unsigned int iEpgRevision = GetEpgRevision(epg->EpgID());
     if ((!bOnlyPending || epg->UpdatePending()) &&
-        epg->Update(start,
-                    end,
-                    m_settings.GetIntValue(CSettings::SETTING_EPG_EPGUPDATE) * 60,
-                    m_settings.GetIntValue(CSettings::SETTING_EPG_PAST_DAYSTODISPLAY),
-                    database,
-                    bOnlyPending))
+        epg->Update(start, end, iUpdateTime, iPastDays, database, bOnlyPending))
     {
-      iUpdatedTables++;
+      if (GetEpgRevision(epg->EpgID()) != iEpgRevision)
+      {
+        CSingleLock lock(resultLock);
+        iUpdatedTables++;
+      }
     }
     else if (!epg->IsValid())
     {
+      CSingleLock lock(resultLock);
       invalidTables.push_back(epg);
     }
+    return true;
+  };
+
+  const int iClientConcurrency = advancedSettings->m_iEpgUpdateClientConcurrency;
+  if (iClientConcurrency <= 0)
+  {
+    for (const auto& epgEntry : epgs)
+    {
+      if (epgEntry.second && !updateTable(epgEntry.second))
+        break;
+    }
+  }
+  else
+  {
+    /* one slow backend should not hold up the others, so clients are updated in parallel. addons differ in
+       thread safety, so the number of concurrent requests to a single client is limited. */
+    std::map<int, std::vector<CPVREpgPtr>> clientEpgs;
+    for (const auto& epgEntry : epgs)
+    {
+      if (epgEntry.second)
+        clientEpgs[epgEntry.second->GetChannelData()->ClientId()].emplace_back(epgEntry.second);
+    }
+
+    std::vector<std::unique_ptr<CPVREpgUpdateWorker>> runnables;
+    std::vector<std::unique_ptr<CThread>> workers;
+    std::vector<std::unique_ptr<std::atomic<size_t>>> nextTables;
+    for (const auto& client : clientEpgs)
+    {
+      const std::vector<CPVREpgPtr>& tables = client.second;
+      nextTables.emplace_back(new std::atomic<size_t>(0));
+      std::atomic<size_t>& nextTable = *nextTables.back();
+
+      const size_t iWorkers = std::min(static_cast<size_t>(iClientConcurrency), tables.size());
+      for (size_t i = 0; i < iWorkers; ++i)
+      {
+        runnables.emplace_back(new CPVREpgUpdateWorker(tables, nextTable, updateTable));
+        workers.emplace_back(new CThread(runnables.back().get(), "EPGClientUpdater", XbmcThreads::THREAD_CLASS_BACKGROUND_IO));
+        workers.back()->Create();
+      }
+    }
+
+    // the workers don't look at the stop flag, this waits for them to finish their tables
+    for (auto& worker : workers)
+      worker->StopThread();
   }
 
   if (bShowProgress && !bOnlyPending)
@@ -711,6 +871,10 @@ bool CPVREpgContainer::UpdateEPG(bool bOnlyPending /* = false */)
   for (const auto& epg : invalidTables)
     DeleteEpg(epg, true);
 
+  /* write the changes of all tables in one go */
+  if (iUpdatedTables > 0)
+    PersistAllAsync();
+
   if (bInterrupted)
   {
     /* the update has been interrupted. try again later */
@@ -852,6 +1016,13 @@ int CPVREpgContainer::GetFutureDaysToDisplay() const
   return m_settings.GetIntValue(CSettings::SETTING_EPG_FUTURE_DAYSTODISPLAY);
 }
 
+unsigned int CPVREpgContainer::GetEpgRevision(int iEpgId) const
+{
+  CSingleLock lock(m_critSection);
+  const auto it = m_epgRevisions.find(iEpgId);
+  return it != m_epgRevisions.end() ? it->second : 0;
+}
+
 void CPVREpgContainer::OnPlaybackStarted(const CFileItemPtr &item)
 {
   CSingleLock lock(m_critSection);
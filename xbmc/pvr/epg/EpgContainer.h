@@ -16,6 +16,8 @@
 #include "XBDateTime.h"
 #include "threads/CriticalSection.h"
 #include "threads/Thread.h"
+#include "utils/JobManager.h"
+#include "utils/MemoryBudget.h"
 #include "utils/Observer.h"
 
 #include "pvr/PVRSettings.h"
@@ -31,9 +33,10 @@ namespace PVR
   class CEpgUpdateRequest;
   class CEpgTagStateChange;
 
-  class CPVREpgContainer : public Observer, public Observable, private CThread
+  class CPVREpgContainer : public Observer, public Observable, private CThread, public IMemoryConsumer
   {
     friend class CPVREpgDatabase;
+    friend class CPVREpgContainerPersistJob;
 
   public:
     /*!
@@ -89,6 +92,19 @@ namespace PVR
      */
     void Notify(const Observable &obs, const ObservableMessage msg) override;
 
+    /*!
+     * @brief Get the approximate amount of memory used by the tags of all EPGs.
+     * @return The size in bytes.
+     */
+    size_t GetMemoryUsage() const override;
+
+    /*!
+     * @brief EPG data is only reported to the memory budget, it is not reloaded on demand.
+     * @return Always 0.
+     */
+    size_t GetTrimmableMemory() const override { return 0; }
+    size_t TrimMemory(size_t bytes) override { return 0; }
+
     /*!
      * @brief Create the EPg for a given channel.
      * @param iEpgId The EPG id.
@@ -177,6 +193,13 @@ namespace PVR
      */
     int GetFutureDaysToDisplay() const;
 
+    /*!
+     * @brief Get the revision of an EPG table. It changes whenever the table notifies its observers about changed tags.
+     * @param iEpgId The id of the table.
+     * @return The revision, 0 if the table did not announce any change yet.
+     */
+    unsigned int GetEpgRevision(int iEpgId) const;
+
     /*!
      * @brief Inform the epg container that playback of an item just started.
      * @param item The item that started to play.
@@ -213,6 +236,11 @@ namespace PVR
      */
     bool PersistAll(void);
 
+    /*!
+     * @brief Persist the tables in the background with low priority. Postponed while playing.
+     */
+    void PersistAllAsync(void);
+
     /*!
      * @brief Remove old EPG entries.
      * @return True if the old entries were removed successfully, false otherwise.
@@ -275,6 +303,13 @@ namespace PVR
     CCriticalSection m_epgTagChangesLock;          /*!< protect changed epg tags list */
 
     bool m_bUpdateNotificationPending = false; /*!< true while an epg updated notification to observers is pending. */
+
+    std::map<int, unsigned int> m_epgRevisions; /*!< the revision of each table that announced changes. maps epg ids to revisions */
+    unsigned int m_iLastEpgRevision = 0;        /*!< the last revision given to a table */
+
+    CJobQueue m_persistQueue{false, 1, CJob::PRIORITY_LOW_PAUSABLE}; /*!< background writer for changed tables */
+    CCriticalSection m_persistLock;                /*!< serializes writing the tables to the database */
+    bool m_bPersistStopped = true;                 /*!< true while the database is closed. protected by m_persistLock */
     CPVRSettings m_settings;
   };
 }
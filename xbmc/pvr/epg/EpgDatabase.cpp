@@ -8,7 +8,9 @@
 
 #include "EpgDatabase.h"
 
+#include <algorithm>
 #include <cstdlib>
+#include <map>
 
 #include "ServiceBroker.h"
 #include "addons/kodi-addon-dev-kit/include/kodi/xbmc_pvr_types.h"
@@ -355,62 +357,64 @@ int CPVREpgDatabase::Persist(const CPVREpg &epg, bool bQueueWrite /* = false */)
   return iReturn;
 }
 
-int CPVREpgDatabase::Persist(const CPVREpgInfoTag &tag, bool bSingleUpdate /* = true */)
+namespace
 {
-  int iReturn(-1);
-
-  if (tag.EpgID() <= 0)
-  {
-    CLog::LogF(LOGERROR, "Tag '%s' does not have a valid table", tag.Title().c_str());
-    return iReturn;
-  }
+  const char EPGTAGS_COLUMNS[] = "idEpg, iStartTime, "
+      "iEndTime, sTitle, sPlotOutline, sPlot, sOriginalTitle, sCast, sDirector, sWriter, iYear, sIMDBNumber, "
+      "sIconPath, iGenreType, iGenreSubType, sGenre, iFirstAired, iParentalRating, iStarRating, bNotify, iSeriesId, "
+      "iEpisodeId, iEpisodePart, sEpisodeName, iFlags, sSeriesLink, iBroadcastUid";
+
+  // rows per statement and statements per transaction for bulk writes
+  const size_t BULK_ROWS_PER_QUERY = 100;
+  const size_t BULK_QUERIES_PER_TRANSACTION = 5;
+}
 
+std::string CPVREpgDatabase::GetTagValues(const CPVREpgInfoTag& tag, bool bWithDatabaseId)
+{
   time_t iStartTime, iEndTime, iFirstAired;
   tag.StartAsUTC().GetAsTime(iStartTime);
   tag.EndAsUTC().GetAsTime(iEndTime);
   tag.FirstAiredAsUTC().GetAsTime(iFirstAired);
 
-  int iBroadcastId = tag.DatabaseID();
-  std::string strQuery;
-
   /* Only store the genre string when needed */
   std::string strGenre = (tag.GenreType() == EPG_GENRE_USE_STRING) ? tag.DeTokenize(tag.Genre()) : "";
 
-  CSingleLock lock(m_critSection);
+  std::string strValues = PrepareSQL("(%u, %u, %u, '%s', '%s', '%s', '%s', '%s', '%s', '%s', %i, '%s', '%s', %i, %i, '%s', %u, %i, %i, %i, %i, %i, %i, '%s', %i, '%s', %i",
+      tag.EpgID(), static_cast<unsigned int>(iStartTime), static_cast<unsigned int>(iEndTime),
+      tag.Title().c_str(), tag.PlotOutline().c_str(), tag.Plot().c_str(),
+      tag.OriginalTitle().c_str(), tag.DeTokenize(tag.Cast()).c_str(), tag.DeTokenize(tag.Directors()).c_str(),
+      tag.DeTokenize(tag.Writers()).c_str(), tag.Year(), tag.IMDBNumber().c_str(),
+      tag.Icon().c_str(), tag.GenreType(), tag.GenreSubType(), strGenre.c_str(),
+      static_cast<unsigned int>(iFirstAired), tag.ParentalRating(), tag.StarRating(), tag.Notify(),
+      tag.SeriesNumber(), tag.EpisodeNumber(), tag.EpisodePart(), tag.EpisodeName().c_str(), tag.Flags(), tag.SeriesLink().c_str(),
+      tag.UniqueBroadcastID());
+
+  if (bWithDatabaseId)
+    strValues += PrepareSQL(", %i", tag.DatabaseID());
+
+  strValues += ")";
+  return strValues;
+}
 
-  if (iBroadcastId < 0)
-  {
-    strQuery = PrepareSQL("REPLACE INTO epgtags (idEpg, iStartTime, "
-        "iEndTime, sTitle, sPlotOutline, sPlot, sOriginalTitle, sCast, sDirector, sWriter, iYear, sIMDBNumber, "
-        "sIconPath, iGenreType, iGenreSubType, sGenre, iFirstAired, iParentalRating, iStarRating, bNotify, iSeriesId, "
-        "iEpisodeId, iEpisodePart, sEpisodeName, iFlags, sSeriesLink, iBroadcastUid) "
-        "VALUES (%u, %u, %u, '%s', '%s', '%s', '%s', '%s', '%s', '%s', %i, '%s', '%s', %i, %i, '%s', %u, %i, %i, %i, %i, %i, %i, '%s', %i, '%s', %i);",
-        tag.EpgID(), static_cast<unsigned int>(iStartTime), static_cast<unsigned int>(iEndTime),
-        tag.Title().c_str(), tag.PlotOutline().c_str(), tag.Plot().c_str(),
-        tag.OriginalTitle().c_str(), tag.DeTokenize(tag.Cast()).c_str(), tag.DeTokenize(tag.Directors()).c_str(),
-        tag.DeTokenize(tag.Writers()).c_str(), tag.Year(), tag.IMDBNumber().c_str(),
-        tag.Icon().c_str(), tag.GenreType(), tag.GenreSubType(), strGenre.c_str(),
-        static_cast<unsigned int>(iFirstAired), tag.ParentalRating(), tag.StarRating(), tag.Notify(),
-        tag.SeriesNumber(), tag.EpisodeNumber(), tag.EpisodePart(), tag.EpisodeName().c_str(), tag.Flags(), tag.SeriesLink().c_str(),
-        tag.UniqueBroadcastID());
-  }
-  else
+int CPVREpgDatabase::Persist(const CPVREpgInfoTag &tag, bool bSingleUpdate /* = true */)
+{
+  int iReturn(-1);
+
+  if (tag.EpgID() <= 0)
   {
-    strQuery = PrepareSQL("REPLACE INTO epgtags (idEpg, iStartTime, "
-        "iEndTime, sTitle, sPlotOutline, sPlot, sOriginalTitle, sCast, sDirector, sWriter, iYear, sIMDBNumber, "
-        "sIconPath, iGenreType, iGenreSubType, sGenre, iFirstAired, iParentalRating, iStarRating, bNotify, iSeriesId, "
-        "iEpisodeId, iEpisodePart, sEpisodeName, iFlags, sSeriesLink, iBroadcastUid, idBroadcast) "
-        "VALUES (%u, %u, %u, '%s', '%s', '%s', '%s', '%s', '%s', '%s', %i, '%s', '%s', %i, %i, '%s', %u, %i, %i, %i, %i, %i, %i, '%s', %i, '%s', %i, %i);",
-        tag.EpgID(), static_cast<unsigned int>(iStartTime), static_cast<unsigned int>(iEndTime),
-        tag.Title().c_str(), tag.PlotOutline().c_str(), tag.Plot().c_str(),
-        tag.OriginalTitle().c_str(), tag.DeTokenize(tag.Cast()).c_str(), tag.DeTokenize(tag.Directors()).c_str(),
-        tag.DeTokenize(tag.Writers()).c_str(), tag.Year(), tag.IMDBNumber().c_str(),
-        tag.Icon().c_str(), tag.GenreType(), tag.GenreSubType(), strGenre.c_str(),
-        static_cast<unsigned int>(iFirstAired), tag.ParentalRating(), tag.StarRating(), tag.Notify(),
-        tag.SeriesNumber(), tag.EpisodeNumber(), tag.EpisodePart(), tag.EpisodeName().c_str(), tag.Flags(), tag.SeriesLink().c_str(),
-        tag.UniqueBroadcastID(), iBroadcastId);
+    CLog::LogF(LOGERROR, "Tag '%s' does not have a valid table", tag.Title().c_str());
+    return iReturn;
   }
 
+  const bool bWithDatabaseId = tag.DatabaseID() >= 0;
+
+  CSingleLock lock(m_critSection);
+
+  std::string strQuery = StringUtils::Format("REPLACE INTO epgtags (%s%s) VALUES ",
+                                             EPGTAGS_COLUMNS, bWithDatabaseId ? ", idBroadcast" : "");
+  strQuery += GetTagValues(tag, bWithDatabaseId);
+  strQuery += ";";
+
   if (bSingleUpdate)
   {
     if (ExecuteQuery(strQuery))
@@ -425,6 +429,107 @@ int CPVREpgDatabase::Persist(const CPVREpgInfoTag &tag, bool bSingleUpdate /* =
   return iReturn;
 }
 
+bool CPVREpgDatabase::Persist(const std::vector<std::shared_ptr<CPVREpgInfoTag>>& tags)
+{
+  std::vector<std::string> queries;
+  std::string strQuery[2];
+  size_t iRows[2] = {0, 0};
+
+  CSingleLock lock(m_critSection);
+  for (const auto& tag : tags)
+  {
+    if (tag->EpgID() <= 0)
+    {
+      CLog::LogF(LOGERROR, "Tag '%s' does not have a valid table", tag->Title().c_str());
+      continue;
+    }
+
+    // rows with and without known database id need different column lists
+    const int iWithDatabaseId = tag->DatabaseID() >= 0 ? 1 : 0;
+    if (iRows[iWithDatabaseId] == 0)
+      strQuery[iWithDatabaseId] = StringUtils::Format("REPLACE INTO epgtags (%s%s) VALUES ",
+                                                      EPGTAGS_COLUMNS, iWithDatabaseId ? ", idBroadcast" : "");
+    else
+      strQuery[iWithDatabaseId] += ", ";
+
+    strQuery[iWithDatabaseId] += GetTagValues(*tag, iWithDatabaseId == 1);
+
+    if (++iRows[iWithDatabaseId] == BULK_ROWS_PER_QUERY)
+    {
+      queries.emplace_back(strQuery[iWithDatabaseId] + ";");
+      iRows[iWithDatabaseId] = 0;
+    }
+  }
+  lock.Leave();
+
+  for (int i = 0; i < 2; ++i)
+  {
+    if (iRows[i] > 0)
+      queries.emplace_back(strQuery[i] + ";");
+  }
+
+  return ExecuteInTransactions(queries);
+}
+
+bool CPVREpgDatabase::Delete(const std::vector<std::shared_ptr<CPVREpgInfoTag>>& tags)
+{
+  // tags that have not been loaded from the database do not know their database id, but
+  // (idEpg, iStartTime) is unique
+  std::map<int, std::vector<unsigned int>> startTimes;
+  for (const auto& tag : tags)
+  {
+    if (tag->EpgID() <= 0)
+      continue;
+
+    time_t iStartTime;
+    tag->StartAsUTC().GetAsTime(iStartTime);
+    startTimes[tag->EpgID()].emplace_back(static_cast<unsigned int>(iStartTime));
+  }
+
+  std::vector<std::string> queries;
+
+  CSingleLock lock(m_critSection);
+  for (const auto& epg : startTimes)
+  {
+    for (size_t i = 0; i < epg.second.size(); i += BULK_ROWS_PER_QUERY)
+    {
+      std::string strQuery = PrepareSQL("DELETE FROM epgtags WHERE idEpg = %u AND iStartTime IN (", epg.first);
+      for (size_t j = i; j < std::min(i + BULK_ROWS_PER_QUERY, epg.second.size()); ++j)
+      {
+        if (j > i)
+          strQuery += ", ";
+        strQuery += PrepareSQL("%u", epg.second[j]);
+      }
+      strQuery += ");";
+      queries.emplace_back(strQuery);
+    }
+  }
+  lock.Leave();
+
+  return ExecuteInTransactions(queries);
+}
+
+bool CPVREpgDatabase::ExecuteInTransactions(const std::vector<std::string>& queries)
+{
+  for (size_t i = 0; i < queries.size(); i += BULK_QUERIES_PER_TRANSACTION)
+  {
+    CSingleLock lock(m_critSection);
+    BeginTransaction();
+    for (size_t j = i; j < std::min(i + BULK_QUERIES_PER_TRANSACTION, queries.size()); ++j)
+    {
+      if (!ExecuteQuery(queries[j]))
+      {
+        RollbackTransaction();
+        return false;
+      }
+    }
+    if (!CommitTransaction())
+      return false;
+  }
+
+  return true;
+}
+
 int CPVREpgDatabase::GetLastEPGId(void)
 {
   CSingleLock lock(m_critSection);
@@ -96,6 +96,14 @@ namespace PVR
      */
     bool Delete(const CPVREpgInfoTag &tag);
 
+    /*!
+     * @brief Remove EPG entries, identified by their table and start time. Large sets are
+     * removed in several transactions, so other users of the database are not blocked meanwhile.
+     * @param tags The entries to remove.
+     * @return True if they were removed successfully, false otherwise.
+     */
+    bool Delete(const std::vector<std::shared_ptr<CPVREpgInfoTag>>& tags);
+
     /*!
      * @brief Get all EPG tables from the database. Does not get the EPG tables' entries.
      * @return The entries.
@@ -142,6 +150,14 @@ namespace PVR
      */
     int Persist(const CPVREpgInfoTag &tag, bool bSingleUpdate = true);
 
+    /*!
+     * @brief Persist infotags using multi-row statements. Large sets are written in several
+     * transactions, so other users of the database are not blocked meanwhile.
+     * @param tags The tags to persist.
+     * @return True if all tags were persisted successfully, false otherwise.
+     */
+    bool Persist(const std::vector<std::shared_ptr<CPVREpgInfoTag>>& tags);
+
     /*!
      * @return Last EPG id in the database
      */
@@ -168,6 +184,21 @@ namespace PVR
 
     int GetMinSchemaVersion() const override { return 4; }
 
+    /*!
+     * @brief Get the values of the epgtags row for a tag, ready to be used in an INSERT or REPLACE statement.
+     * @param tag The tag.
+     * @param bWithDatabaseId True to include the idBroadcast column.
+     * @return The values, including the enclosing parentheses.
+     */
+    std::string GetTagValues(const CPVREpgInfoTag& tag, bool bWithDatabaseId);
+
+    /*!
+     * @brief Execute the given queries, a few at a time in separate transactions.
+     * @param queries The queries.
+     * @return True if all queries were executed successfully, false otherwise.
+     */
+    bool ExecuteInTransactions(const std::vector<std::string>& queries);
+
     CCriticalSection m_critSection;
   };
 }
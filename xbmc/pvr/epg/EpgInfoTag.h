@@ -30,6 +30,7 @@ namespace PVR
   {
     friend class CPVREpg;
     friend class CPVREpgDatabase;
+    friend class CPVREpgTagStore;
 
   public:
     /*!
@@ -0,0 +1,479 @@
+/*
+ *  Copyright (C) 2012-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "EpgTagStore.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+#include "utils/StringUtils.h"
+
+#include "pvr/epg/EpgInfoTag.h"
+
+namespace PVR
+{
+  /*!
+   * Reference counted strings shared by all EPG tag stores. Titles, genres, icons and the like
+   * repeat across channels and days, so each distinct string is only kept once.
+   */
+  class CPVREpgStringPool
+  {
+  public:
+    static std::shared_ptr<CPVREpgStringPool> GetInstance()
+    {
+      static std::shared_ptr<CPVREpgStringPool> instance = std::make_shared<CPVREpgStringPool>();
+      return instance;
+    }
+
+    unsigned int Acquire(const std::string& str)
+    {
+      if (str.empty())
+        return 0;
+
+      const size_t hash = std::hash<std::string>()(str);
+
+      CSingleLock lock(m_critSection);
+      const auto range = m_lookup.equal_range(hash);
+      for (auto it = range.first; it != range.second; ++it)
+      {
+        Item& item = m_items[it->second - 1];
+        if (item.str == str)
+        {
+          item.iRefCount++;
+          return it->second;
+        }
+      }
+
+      unsigned int id;
+      if (!m_freeIds.empty())
+      {
+        id = m_freeIds.back();
+        m_freeIds.pop_back();
+      }
+      else
+      {
+        m_items.emplace_back();
+        id = static_cast<unsigned int>(m_items.size());
+      }
+
+      Item& item = m_items[id - 1];
+      item.str = str;
+      item.hash = hash;
+      item.iRefCount = 1;
+      m_lookup.emplace(hash, id);
+      return id;
+    }
+
+    void Release(unsigned int id)
+    {
+      if (id == 0)
+        return;
+
+      CSingleLock lock(m_critSection);
+      Item& item = m_items[id - 1];
+      if (--item.iRefCount > 0)
+        return;
+
+      const auto range = m_lookup.equal_range(item.hash);
+      for (auto it = range.first; it != range.second; ++it)
+      {
+        if (it->second == id)
+        {
+          m_lookup.erase(it);
+          break;
+        }
+      }
+
+      std::string().swap(item.str);
+      m_freeIds.emplace_back(id);
+    }
+
+    //! Caller must hold GetLock() as long as the returned reference is used.
+    const std::string& Get(unsigned int id) const
+    {
+      static const std::string empty;
+      return id == 0 ? empty : m_items[id - 1].str;
+    }
+
+    CCriticalSection& GetLock() const { return m_critSection; }
+
+    size_t GetMemoryUsage() const
+    {
+      CSingleLock lock(m_critSection);
+      size_t iSize = m_items.capacity() * sizeof(Item) + m_freeIds.capacity() * sizeof(unsigned int) +
+                     m_lookup.bucket_count() * sizeof(void*) +
+                     m_lookup.size() * (sizeof(std::pair<size_t, unsigned int>) + 2 * sizeof(void*));
+      for (const auto& item : m_items)
+      {
+        if (item.str.capacity() >= sizeof(std::string))
+          iSize += item.str.capacity() + 1;
+      }
+      return iSize;
+    }
+
+  private:
+    struct Item
+    {
+      std::string str;
+      size_t hash = 0;
+      unsigned int iRefCount = 0;
+    };
+
+    mutable CCriticalSection m_critSection;
+    std::vector<Item> m_items; // id n is stored at n - 1, 0 is the empty string
+    std::vector<unsigned int> m_freeIds;
+    std::unordered_multimap<size_t, unsigned int> m_lookup;
+  };
+}
+
+using namespace PVR;
+
+namespace
+{
+  const time_t INVALID_TIME = std::numeric_limits<time_t>::min();
+  const char LIST_SEPARATOR[] = "\x1f";
+
+  time_t ToTime(const CDateTime& dateTime)
+  {
+    if (!dateTime.IsValid())
+      return INVALID_TIME;
+
+    time_t time = 0;
+    dateTime.GetAsTime(time);
+    return time;
+  }
+
+  CDateTime FromTime(time_t time)
+  {
+    if (time == INVALID_TIME)
+    {
+      CDateTime dateTime;
+      dateTime.SetValid(false);
+      return dateTime;
+    }
+    return CDateTime(time);
+  }
+}
+
+const size_t CPVREpgTagStore::npos;
+
+CPVREpgTagStore::CPVREpgTagStore(const std::shared_ptr<CPVREpgChannelData>& channelData, int iEpgID)
+: m_strings(CPVREpgStringPool::GetInstance()),
+  m_channelData(channelData),
+  m_iEpgID(iEpgID)
+{
+}
+
+CPVREpgTagStore::~CPVREpgTagStore()
+{
+  Clear();
+}
+
+void CPVREpgTagStore::SetChannelData(const std::shared_ptr<CPVREpgChannelData>& channelData)
+{
+  m_channelData = channelData;
+
+  for (const auto& liveTag : m_liveTags)
+  {
+    const std::shared_ptr<CPVREpgInfoTag> tag = liveTag.second.lock();
+    if (tag)
+      tag->SetChannelData(channelData);
+  }
+}
+
+void CPVREpgTagStore::SetEpgID(int iEpgID)
+{
+  m_iEpgID = iEpgID;
+
+  for (const auto& liveTag : m_liveTags)
+  {
+    const std::shared_ptr<CPVREpgInfoTag> tag = liveTag.second.lock();
+    if (tag)
+      tag->SetEpgID(iEpgID);
+  }
+}
+
+void CPVREpgTagStore::Clear()
+{
+  CSingleLock lock(m_strings->GetLock());
+  for (auto& entry : m_entries)
+    Release(entry);
+  lock.Leave();
+
+  m_entries.clear();
+  m_liveTags.clear();
+  m_index.clear();
+  m_bIndexValid = false;
+}
+
+std::shared_ptr<CPVREpgInfoTag> CPVREpgTagStore::Get(size_t iIndex) const
+{
+  const Entry& entry = m_entries[iIndex];
+
+  auto it = m_liveTags.find(entry.start);
+  if (it != m_liveTags.end())
+  {
+    std::shared_ptr<CPVREpgInfoTag> tag = it->second.lock();
+    if (tag)
+      return tag;
+  }
+
+  const std::shared_ptr<CPVREpgInfoTag> tag = Create(entry);
+
+  if (it != m_liveTags.end())
+    it->second = tag;
+  else
+    AddLiveTag(entry.start, tag);
+
+  return tag;
+}
+
+void CPVREpgTagStore::AddLiveTag(time_t start, const std::shared_ptr<CPVREpgInfoTag>& tag) const
+{
+  // expired entries keep the memory of tags created with make_shared, so do not let them pile up
+  if (m_liveTags.size() >= m_iLiveTagsPruneSize)
+  {
+    for (auto it = m_liveTags.begin(); it != m_liveTags.end();)
+    {
+      if (it->second.expired())
+        it = m_liveTags.erase(it);
+      else
+        ++it;
+    }
+    m_iLiveTagsPruneSize = std::max<size_t>(64, m_liveTags.size() * 2);
+  }
+
+  m_liveTags[start] = tag;
+}
+
+size_t CPVREpgTagStore::Find(const CDateTime& start) const
+{
+  const time_t time = ToTime(start);
+  const size_t iIndex = LowerBound(start);
+  if (iIndex < m_entries.size() && m_entries[iIndex].start == time)
+    return iIndex;
+
+  return npos;
+}
+
+size_t CPVREpgTagStore::LowerBound(const CDateTime& start) const
+{
+  const time_t time = ToTime(start);
+  const auto compare = [](const Entry& entry, time_t t) { return entry.start < t; };
+
+  if (m_entries.empty() || time <= m_entries.front().start)
+    return 0;
+  if (time > m_entries.back().start)
+    return m_entries.size();
+
+  UpdateIndex();
+
+  auto first = m_entries.begin();
+  auto last = m_entries.end();
+  if (!m_index.empty())
+  {
+    const size_t iBucket = static_cast<size_t>((time - m_indexBase) / INDEX_BUCKET_SIZE);
+    first = m_entries.begin() + m_index[iBucket];
+    if (iBucket + 1 < m_index.size())
+      last = m_entries.begin() + m_index[iBucket + 1];
+  }
+
+  return std::lower_bound(first, last, time, compare) - m_entries.begin();
+}
+
+std::pair<size_t, size_t> CPVREpgTagStore::GetRange(const CDateTime& begin, const CDateTime& end) const
+{
+  const time_t beginTime = ToTime(begin);
+
+  size_t iFirst = LowerBound(begin);
+  const size_t iLast = LowerBound(end);
+
+  // tags do not overlap each other (see CPVREpg::FixOverlappingEvents), so only the tags right
+  // before the first one starting in the period can still be running at its beginning.
+  while (iFirst > 0 && m_entries[iFirst - 1].end > beginTime)
+    --iFirst;
+
+  return std::make_pair(iFirst, std::max(iFirst, iLast));
+}
+
+size_t CPVREpgTagStore::Set(const std::shared_ptr<CPVREpgInfoTag>& tag)
+{
+  const time_t start = ToTime(tag->StartAsUTC());
+
+  size_t iIndex;
+  if (!m_entries.empty() && m_entries.back().start < start)
+  {
+    // guide data usually arrives in chronological order
+    iIndex = m_entries.size();
+  }
+  else
+  {
+    iIndex = LowerBound(tag->StartAsUTC());
+  }
+
+  if (iIndex < m_entries.size() && m_entries[iIndex].start == start)
+  {
+    Entry previous = m_entries[iIndex];
+    Assign(m_entries[iIndex], *tag);
+    Release(previous);
+  }
+  else
+  {
+    Entry entry = {};
+    Assign(entry, *tag);
+    m_entries.insert(m_entries.begin() + iIndex, entry);
+    m_bIndexValid = false;
+  }
+
+  AddLiveTag(start, tag);
+  return iIndex;
+}
+
+void CPVREpgTagStore::Erase(size_t iIndex)
+{
+  m_liveTags.erase(m_entries[iIndex].start);
+  Release(m_entries[iIndex]);
+  m_entries.erase(m_entries.begin() + iIndex);
+  m_bIndexValid = false;
+}
+
+size_t CPVREpgTagStore::GetMemoryUsage() const
+{
+  return sizeof(*this) + m_entries.capacity() * sizeof(Entry) +
+         m_index.capacity() * sizeof(unsigned int) +
+         m_liveTags.size() * (sizeof(std::pair<const time_t, std::weak_ptr<CPVREpgInfoTag>>) + 4 * sizeof(void*));
+}
+
+size_t CPVREpgTagStore::GetStringPoolMemoryUsage()
+{
+  return CPVREpgStringPool::GetInstance()->GetMemoryUsage();
+}
+
+void CPVREpgTagStore::Assign(Entry& entry, const CPVREpgInfoTag& tag)
+{
+  CSingleLock tagLock(tag.m_critSection);
+
+  entry.start = ToTime(tag.m_startTime);
+  entry.end = ToTime(tag.m_endTime);
+  entry.firstAired = ToTime(tag.m_firstAired);
+  entry.iUniqueBroadcastID = tag.m_iUniqueBroadcastID;
+  entry.iFlags = tag.m_iFlags;
+  entry.iDatabaseID = tag.m_iDatabaseID;
+  entry.iGenreType = tag.m_iGenreType;
+  entry.iGenreSubType = tag.m_iGenreSubType;
+  entry.iParentalRating = tag.m_iParentalRating;
+  entry.iStarRating = tag.m_iStarRating;
+  entry.iSeriesNumber = tag.m_iSeriesNumber;
+  entry.iEpisodeNumber = tag.m_iEpisodeNumber;
+  entry.iEpisodePart = tag.m_iEpisodePart;
+  entry.iYear = tag.m_iYear;
+  entry.bNotify = tag.m_bNotify;
+
+  CSingleLock lock(m_strings->GetLock());
+  entry.title = m_strings->Acquire(tag.m_strTitle);
+  entry.plotOutline = m_strings->Acquire(tag.m_strPlotOutline);
+  entry.plot = m_strings->Acquire(tag.m_strPlot);
+  entry.originalTitle = m_strings->Acquire(tag.m_strOriginalTitle);
+  entry.cast = m_strings->Acquire(StringUtils::Join(tag.m_cast, LIST_SEPARATOR));
+  entry.directors = m_strings->Acquire(StringUtils::Join(tag.m_directors, LIST_SEPARATOR));
+  entry.writers = m_strings->Acquire(StringUtils::Join(tag.m_writers, LIST_SEPARATOR));
+  entry.imdbNumber = m_strings->Acquire(tag.m_strIMDBNumber);
+  entry.genre = m_strings->Acquire(StringUtils::Join(tag.m_genre, LIST_SEPARATOR));
+  entry.episodeName = m_strings->Acquire(tag.m_strEpisodeName);
+  entry.iconPath = m_strings->Acquire(tag.m_strIconPath);
+  entry.seriesLink = m_strings->Acquire(tag.m_strSeriesLink);
+}
+
+void CPVREpgTagStore::Release(Entry& entry)
+{
+  CSingleLock lock(m_strings->GetLock());
+  for (StringId* id : {&entry.title, &entry.plotOutline, &entry.plot, &entry.originalTitle, &entry.cast,
+                       &entry.directors, &entry.writers, &entry.imdbNumber, &entry.genre,
+                       &entry.episodeName, &entry.iconPath, &entry.seriesLink})
+  {
+    m_strings->Release(*id);
+    *id = 0;
+  }
+}
+
+std::shared_ptr<CPVREpgInfoTag> CPVREpgTagStore::Create(const Entry& entry) const
+{
+  const std::shared_ptr<CPVREpgInfoTag> tag(new CPVREpgInfoTag(m_channelData, m_iEpgID));
+
+  tag->m_startTime = FromTime(entry.start);
+  tag->m_endTime = FromTime(entry.end);
+  tag->m_firstAired = FromTime(entry.firstAired);
+  tag->m_iUniqueBroadcastID = entry.iUniqueBroadcastID;
+  tag->m_iFlags = entry.iFlags;
+  tag->m_iDatabaseID = entry.iDatabaseID;
+  tag->m_iGenreType = entry.iGenreType;
+  tag->m_iGenreSubType = entry.iGenreSubType;
+  tag->m_iParentalRating = entry.iParentalRating;
+  tag->m_iStarRating = entry.iStarRating;
+  tag->m_iSeriesNumber = entry.iSeriesNumber;
+  tag->m_iEpisodeNumber = entry.iEpisodeNumber;
+  tag->m_iEpisodePart = entry.iEpisodePart;
+  tag->m_iYear = entry.iYear;
+  tag->m_bNotify = entry.bNotify;
+
+  {
+    CSingleLock lock(m_strings->GetLock());
+    tag->m_strTitle = m_strings->Get(entry.title);
+    tag->m_strPlotOutline = m_strings->Get(entry.plotOutline);
+    tag->m_strPlot = m_strings->Get(entry.plot);
+    tag->m_strOriginalTitle = m_strings->Get(entry.originalTitle);
+    tag->m_cast = StringUtils::Split(m_strings->Get(entry.cast), LIST_SEPARATOR);
+    tag->m_directors = StringUtils::Split(m_strings->Get(entry.directors), LIST_SEPARATOR);
+    tag->m_writers = StringUtils::Split(m_strings->Get(entry.writers), LIST_SEPARATOR);
+    tag->m_strIMDBNumber = m_strings->Get(entry.imdbNumber);
+    tag->m_genre = StringUtils::Split(m_strings->Get(entry.genre), LIST_SEPARATOR);
+    tag->m_strEpisodeName = m_strings->Get(entry.episodeName);
+    tag->m_strIconPath = m_strings->Get(entry.iconPath);
+    tag->m_strSeriesLink = m_strings->Get(entry.seriesLink);
+  }
+
+  tag->UpdatePath();
+  return tag;
+}
+
+void CPVREpgTagStore::UpdateIndex() const
+{
+  if (m_bIndexValid)
+    return;
+
+  m_bIndexValid = true;
+  m_index.clear();
+
+  if (m_entries.empty())
+    return;
+
+  // Bail out on bogus guide data spanning years; binary search over all entries works as well.
+  static const time_t MAX_INDEX_BUCKETS = 24 * 366;
+
+  const time_t first = m_entries.front().start;
+  const time_t last = m_entries.back().start;
+  m_indexBase = first - ((first % INDEX_BUCKET_SIZE) + INDEX_BUCKET_SIZE) % INDEX_BUCKET_SIZE;
+
+  const time_t iBuckets = (last - m_indexBase) / INDEX_BUCKET_SIZE + 1;
+  if (iBuckets > MAX_INDEX_BUCKETS)
+    return;
+
+  m_index.resize(static_cast<size_t>(iBuckets));
+  size_t iEntry = 0;
+  for (size_t iBucket = 0; iBucket < m_index.size(); ++iBucket)
+  {
+    const time_t bucketStart = m_indexBase + static_cast<time_t>(iBucket) * INDEX_BUCKET_SIZE;
+    while (iEntry < m_entries.size() && m_entries[iEntry].start < bucketStart)
+      ++iEntry;
+    m_index[iBucket] = static_cast<unsigned int>(iEntry);
+  }
+}
@@ -0,0 +1,177 @@
+/*
+ *  Copyright (C) 2012-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <ctime>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "XBDateTime.h"
+
+namespace PVR
+{
+  class CPVREpgChannelData;
+  class CPVREpgInfoTag;
+  class CPVREpgStringPool;
+
+  /*!
+   * Compact storage for the tags of one EPG, sorted by start time. Strings are shared between all
+   * stores and CPVREpgInfoTag instances are only created when requested. Not thread safe; the
+   * owning CPVREpg serializes access.
+   */
+  class CPVREpgTagStore
+  {
+  public:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    CPVREpgTagStore(const std::shared_ptr<CPVREpgChannelData>& channelData, int iEpgID);
+    ~CPVREpgTagStore();
+
+    /*!
+     * @brief Set the channel data of the tags, including tags already handed out.
+     * @param channelData The channel data.
+     */
+    void SetChannelData(const std::shared_ptr<CPVREpgChannelData>& channelData);
+
+    /*!
+     * @brief Set the EPG id of the tags, including tags already handed out.
+     * @param iEpgID The EPG id.
+     */
+    void SetEpgID(int iEpgID);
+
+    bool IsEmpty() const { return m_entries.empty(); }
+    size_t Size() const { return m_entries.size(); }
+
+    /*!
+     * @brief Remove all tags.
+     */
+    void Clear();
+
+    /*!
+     * @brief Get the tag at the given position. Tags are created on demand; as long as a tag
+     * is referenced elsewhere the same instance is returned.
+     * @param iIndex The position of the tag.
+     * @return The tag.
+     */
+    std::shared_ptr<CPVREpgInfoTag> Get(size_t iIndex) const;
+
+    /*!
+     * @brief Find the tag starting at the given time.
+     * @param start The start time in UTC.
+     * @return The position of the tag or npos if not found.
+     */
+    size_t Find(const CDateTime& start) const;
+
+    /*!
+     * @brief Find the first tag starting at or after the given time.
+     * @param start The start time in UTC.
+     * @return The position of the tag or Size() if there is none.
+     */
+    size_t LowerBound(const CDateTime& start) const;
+
+    /*!
+     * @brief Get the range of tags overlapping the given period.
+     * @param begin The start of the period in UTC.
+     * @param end The end of the period in UTC.
+     * @return The first and one past the last position of the tags.
+     */
+    std::pair<size_t, size_t> GetRange(const CDateTime& begin, const CDateTime& end) const;
+
+    /*!
+     * @brief Store the given tag, replacing the tag with the same start time if there is one.
+     * Subsequent calls to Get() for this position return the given instance while it is alive.
+     * @param tag The tag.
+     * @return The position of the tag.
+     */
+    size_t Set(const std::shared_ptr<CPVREpgInfoTag>& tag);
+
+    /*!
+     * @brief Remove the tag at the given position.
+     * @param iIndex The position of the tag.
+     */
+    void Erase(size_t iIndex);
+
+    CDateTime StartAsUTC(size_t iIndex) const { return CDateTime(m_entries[iIndex].start); }
+    CDateTime EndAsUTC(size_t iIndex) const { return CDateTime(m_entries[iIndex].end); }
+    time_t Start(size_t iIndex) const { return m_entries[iIndex].start; }
+    time_t End(size_t iIndex) const { return m_entries[iIndex].end; }
+    unsigned int UniqueBroadcastID(size_t iIndex) const { return m_entries[iIndex].iUniqueBroadcastID; }
+
+    /*!
+     * @brief Get the approximate amount of memory used by this store, not counting shared strings.
+     * @return The size in bytes.
+     */
+    size_t GetMemoryUsage() const;
+
+    /*!
+     * @brief Get the approximate amount of memory used by the strings shared by all stores.
+     * @return The size in bytes.
+     */
+    static size_t GetStringPoolMemoryUsage();
+
+  private:
+    CPVREpgTagStore(const CPVREpgTagStore&) = delete;
+    CPVREpgTagStore& operator=(const CPVREpgTagStore&) = delete;
+
+    using StringId = unsigned int;
+
+    struct Entry
+    {
+      time_t start;
+      time_t end;
+      time_t firstAired;
+      unsigned int iUniqueBroadcastID;
+      unsigned int iFlags;
+      int iDatabaseID;
+      int iGenreType;
+      int iGenreSubType;
+      int iParentalRating;
+      int iStarRating;
+      int iSeriesNumber;
+      int iEpisodeNumber;
+      int iEpisodePart;
+      int iYear;
+      bool bNotify;
+      StringId title;
+      StringId plotOutline;
+      StringId plot;
+      StringId originalTitle;
+      StringId cast;
+      StringId directors;
+      StringId writers;
+      StringId imdbNumber;
+      StringId genre;
+      StringId episodeName;
+      StringId iconPath;
+      StringId seriesLink;
+    };
+
+    void Assign(Entry& entry, const CPVREpgInfoTag& tag);
+    void Release(Entry& entry);
+    std::shared_ptr<CPVREpgInfoTag> Create(const Entry& entry) const;
+    void AddLiveTag(time_t start, const std::shared_ptr<CPVREpgInfoTag>& tag) const;
+    void UpdateIndex() const;
+
+    std::shared_ptr<CPVREpgStringPool> m_strings;
+    std::vector<Entry> m_entries;
+    std::shared_ptr<CPVREpgChannelData> m_channelData;
+    int m_iEpgID;
+
+    static const time_t INDEX_BUCKET_SIZE = 60 * 60;
+    mutable std::vector<unsigned int> m_index; /*!< first entry of each hour, starting at the hour of the first entry */
+    mutable time_t m_indexBase = 0;
+    mutable bool m_bIndexValid = false;
+
+    mutable std::map<time_t, std::weak_ptr<CPVREpgInfoTag>> m_liveTags; /*!< tags handed out, by start time */
+    mutable size_t m_iLiveTagsPruneSize = 64;
+  };
+}
@@ -0,0 +1,196 @@
+/*
+ *  Copyright (C) 2005-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "addons/kodi-addon-dev-kit/include/kodi/xbmc_epg_types.h"
+#include "pvr/epg/EpgChannelData.h"
+#include "pvr/epg/EpgInfoTag.h"
+#include "pvr/epg/EpgTagStore.h"
+#include "utils/StringUtils.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace PVR;
+
+namespace
+{
+
+const time_t GUIDE_START = 1546300800; // 2019-01-01 00:00:00 UTC
+
+std::shared_ptr<CPVREpgInfoTag> CreateTag(const std::shared_ptr<CPVREpgChannelData>& channelData,
+                                          unsigned int iUid, time_t start, time_t end,
+                                          const std::string& title, const std::string& plot)
+{
+  EPG_TAG data = {};
+  data.iUniqueBroadcastId = iUid;
+  data.iUniqueChannelId = channelData->UniqueClientChannelId();
+  data.startTime = start;
+  data.endTime = end;
+  data.strTitle = title.c_str();
+  data.strPlot = plot.c_str();
+  data.strCast = "Actor A,Actor B";
+  data.iGenreType = EPG_GENRE_USE_STRING;
+  data.strGenreDescription = "Drama,Crime";
+  data.iSeriesNumber = 2;
+  data.iEpisodeNumber = 7;
+  return std::make_shared<CPVREpgInfoTag>(data, channelData->ClientId(), channelData, 1);
+}
+
+}
+
+TEST(TestEpgTagStore, RoundTrip)
+{
+  const std::shared_ptr<CPVREpgChannelData> channelData = std::make_shared<CPVREpgChannelData>(1, 42);
+  CPVREpgTagStore store(channelData, 1);
+
+  {
+    const std::shared_ptr<CPVREpgInfoTag> tag = CreateTag(channelData, 5, GUIDE_START, GUIDE_START + 1800, "News", "Today's news");
+    EXPECT_EQ(0u, store.Set(tag));
+    EXPECT_EQ(tag, store.Get(0));
+  }
+
+  // the original instance is gone, so this one is created from the stored data
+  const std::shared_ptr<CPVREpgInfoTag> tag = store.Get(0);
+  EXPECT_EQ(5u, tag->UniqueBroadcastID());
+  EXPECT_EQ(CDateTime(GUIDE_START), tag->StartAsUTC());
+  EXPECT_EQ(CDateTime(GUIDE_START + 1800), tag->EndAsUTC());
+  EXPECT_EQ("News", tag->Title());
+  EXPECT_EQ("Today's news", tag->Plot());
+  EXPECT_EQ(std::vector<std::string>({"Actor A", "Actor B"}), tag->Cast());
+  EXPECT_EQ(std::vector<std::string>({"Drama", "Crime"}), tag->Genre());
+  EXPECT_EQ(2, tag->SeriesNumber());
+  EXPECT_EQ(7, tag->EpisodeNumber());
+  EXPECT_EQ(1, tag->EpgID());
+  EXPECT_EQ(42, tag->UniqueChannelID());
+  EXPECT_EQ(tag, store.Get(0));
+}
+
+TEST(TestEpgTagStore, Lookup)
+{
+  const std::shared_ptr<CPVREpgChannelData> channelData = std::make_shared<CPVREpgChannelData>(1, 42);
+  CPVREpgTagStore store(channelData, 1);
+
+  // insert in reverse order, with 45 minute programmes
+  for (unsigned int i = 100; i > 0; i--)
+  {
+    const time_t start = GUIDE_START + (i - 1) * 2700;
+    store.Set(CreateTag(channelData, i, start, start + 2700, "Title", ""));
+  }
+
+  ASSERT_EQ(100u, store.Size());
+  for (size_t i = 0; i < store.Size(); i++)
+    EXPECT_EQ(i + 1, store.UniqueBroadcastID(i));
+
+  EXPECT_EQ(10u, store.Find(CDateTime(GUIDE_START + 10 * 2700)));
+  EXPECT_EQ(CPVREpgTagStore::npos, store.Find(CDateTime(GUIDE_START + 10 * 2700 + 1)));
+  EXPECT_EQ(11u, store.LowerBound(CDateTime(GUIDE_START + 10 * 2700 + 1)));
+  EXPECT_EQ(0u, store.LowerBound(CDateTime(GUIDE_START - 1)));
+  EXPECT_EQ(100u, store.LowerBound(CDateTime(GUIDE_START + 100 * 2700)));
+
+  // 10:00 - 12:00 overlaps 9:45 - 10:30, ..., 11:15 - 12:00
+  const auto range = store.GetRange(CDateTime(GUIDE_START + 36000), CDateTime(GUIDE_START + 43200));
+  EXPECT_EQ(13u, range.first);
+  EXPECT_EQ(16u, range.second);
+
+  store.Erase(13);
+  EXPECT_EQ(99u, store.Size());
+  EXPECT_EQ(CPVREpgTagStore::npos, store.Find(CDateTime(GUIDE_START + 13 * 2700)));
+  EXPECT_EQ(13u, store.Find(CDateTime(GUIDE_START + 14 * 2700)));
+}
+
+TEST(TestEpgTagStore, DISABLED_Benchmark)
+{
+  const unsigned int iChannels = 600;
+  const unsigned int iDays = 14;
+  const unsigned int iTitles = 2000;
+
+  std::vector<std::string> titles;
+  std::vector<std::string> plots;
+  for (unsigned int i = 0; i < iTitles; i++)
+  {
+    titles.emplace_back(StringUtils::Format("Programme %u", i));
+    plots.emplace_back(StringUtils::Format("Plot of programme %u, which is long enough to not fit into a small string buffer.", i));
+  }
+
+  std::mt19937 random(1);
+  std::uniform_int_distribution<unsigned int> titleDist(0, iTitles - 1);
+  std::uniform_int_distribution<int> durationDist(1, 8);
+
+  std::vector<std::unique_ptr<CPVREpgTagStore>> stores;
+  size_t iTags = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned int iChannel = 0; iChannel < iChannels; iChannel++)
+  {
+    const std::shared_ptr<CPVREpgChannelData> channelData = std::make_shared<CPVREpgChannelData>(1, iChannel);
+    stores.emplace_back(new CPVREpgTagStore(channelData, iChannel + 1));
+
+    time_t time = GUIDE_START;
+    unsigned int iUid = 1;
+    while (time < GUIDE_START + iDays * 24 * 60 * 60)
+    {
+      const time_t end = time + durationDist(random) * 15 * 60;
+      const unsigned int iTitle = titleDist(random);
+      stores.back()->Set(CreateTag(channelData, iUid++, time, end, titles[iTitle], plots[iTitle]));
+      time = end;
+      iTags++;
+    }
+  }
+  auto loaded = std::chrono::steady_clock::now();
+
+  size_t iStoreSize = 0;
+  for (const auto& store : stores)
+    iStoreSize += store->GetMemoryUsage();
+  const size_t iPoolSize = CPVREpgTagStore::GetStringPoolMemoryUsage();
+
+  printf("%zu tags: load %.1f ms, %.1f MB (%zu bytes/tag, strings %.1f MB), tag object alone %zu bytes\n",
+         iTags, std::chrono::duration<double, std::milli>(loaded - start).count(),
+         (iStoreSize + iPoolSize) / (1024.0 * 1024.0), iStoreSize / iTags, iPoolSize / (1024.0 * 1024.0),
+         sizeof(CPVREpgInfoTag));
+
+  // grid sized queries: 3 hours on every channel at a random time
+  const unsigned int iQueries = 100;
+  std::uniform_int_distribution<time_t> timeDist(GUIDE_START, GUIDE_START + iDays * 24 * 60 * 60);
+  size_t iFound = 0;
+  double fRangeTime = 0.0;
+  double fMaterializeTime = 0.0;
+  for (unsigned int i = 0; i < iQueries; i++)
+  {
+    const CDateTime begin(timeDist(random));
+    const CDateTime end = begin + CDateTimeSpan(0, 3, 0, 0);
+
+    std::vector<std::pair<size_t, size_t>> ranges;
+    ranges.reserve(stores.size());
+
+    auto queryStart = std::chrono::steady_clock::now();
+    for (const auto& store : stores)
+      ranges.emplace_back(store->GetRange(begin, end));
+    auto queryEnd = std::chrono::steady_clock::now();
+
+    std::vector<std::shared_ptr<CPVREpgInfoTag>> tags;
+    for (size_t iStore = 0; iStore < stores.size(); iStore++)
+    {
+      for (size_t iTag = ranges[iStore].first; iTag < ranges[iStore].second; iTag++)
+        tags.emplace_back(stores[iStore]->Get(iTag));
+    }
+    auto materializeEnd = std::chrono::steady_clock::now();
+
+    iFound += tags.size();
+    fRangeTime += std::chrono::duration<double, std::micro>(queryEnd - queryStart).count();
+    fMaterializeTime += std::chrono::duration<double, std::micro>(materializeEnd - queryEnd).count();
+  }
+
+  printf("%u x %u channel range queries: %.1f us lookup, %.1f us to create %zu tags per query\n",
+         iQueries, iChannels, fRangeTime / iQueries, fMaterializeTime / iQueries, iFound / iQueries);
+}
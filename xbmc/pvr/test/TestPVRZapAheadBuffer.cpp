@@ -0,0 +1,134 @@
+/*
+ *  Copyright (C) 2005-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "pvr/PVRZapAheadBuffer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace PVR;
+
+namespace
+{
+
+const size_t PACKET_SIZE = CPVRZapAheadBuffer::TS_PACKET_SIZE;
+const uint16_t PID_PMT = 0x100;
+const uint16_t PID_VIDEO = 0x101;
+
+std::vector<uint8_t> CreatePacket(uint16_t iPid, bool bPayloadStart, uint8_t iFill)
+{
+  std::vector<uint8_t> packet(PACKET_SIZE, iFill);
+  packet[0] = 0x47;
+  packet[1] = (bPayloadStart ? 0x40 : 0x00) | ((iPid >> 8) & 0x1F);
+  packet[2] = iPid & 0xFF;
+  packet[3] = 0x10; // payload only
+  return packet;
+}
+
+std::vector<uint8_t> CreatePat()
+{
+  std::vector<uint8_t> packet = CreatePacket(0x0000, true, 0xFF);
+  const uint8_t section[] = {
+    0x00,             // pointer field
+    0x00, 0xB0, 0x0D, // table id, section length 13
+    0x00, 0x01, 0xC1, 0x00, 0x00, // transport stream id, version, section numbers
+    0x00, 0x01, static_cast<uint8_t>(0xE0 | (PID_PMT >> 8)), PID_PMT & 0xFF, // program 1
+    0x00, 0x00, 0x00, 0x00 // CRC, not checked
+  };
+  std::copy(std::begin(section), std::end(section), packet.begin() + 4);
+  return packet;
+}
+
+std::vector<uint8_t> CreateKeyframe(uint8_t iFill)
+{
+  std::vector<uint8_t> packet = CreatePacket(PID_VIDEO, true, iFill);
+  packet[3] = 0x30; // adaptation field and payload
+  packet[4] = 1; // adaptation field length
+  packet[5] = 0x40; // random access indicator
+  packet[6] = 0x00;
+  packet[7] = 0x00;
+  packet[8] = 0x01;
+  packet[9] = 0xE0; // video stream id
+  return packet;
+}
+
+void Append(std::vector<uint8_t>& stream, const std::vector<uint8_t>& packet)
+{
+  stream.insert(stream.end(), packet.begin(), packet.end());
+}
+
+} // unnamed namespace
+
+TEST(TestPVRZapAheadBuffer, KeepsDataSinceKeyframe)
+{
+  std::vector<uint8_t> stream;
+  Append(stream, CreatePat());
+  Append(stream, CreatePacket(PID_PMT, true, 0x11));
+  Append(stream, CreatePacket(PID_VIDEO, false, 0x01));
+  Append(stream, CreateKeyframe(0x02));
+  Append(stream, CreatePacket(PID_VIDEO, false, 0x03));
+
+  CPVRZapAheadBuffer buffer(1024 * 1024);
+  EXPECT_TRUE(buffer.Write(stream.data(), stream.size()));
+  EXPECT_TRUE(buffer.HasKeyframe());
+
+  // PAT, PMT, keyframe and the packet after it
+  std::vector<uint8_t> expected;
+  Append(expected, CreatePat());
+  Append(expected, CreatePacket(PID_PMT, true, 0x11));
+  Append(expected, CreateKeyframe(0x02));
+  Append(expected, CreatePacket(PID_VIDEO, false, 0x03));
+
+  EXPECT_EQ(expected.size(), buffer.Size());
+  EXPECT_EQ(expected, buffer.GetData());
+}
+
+TEST(TestPVRZapAheadBuffer, SyncsOnSplitAndMisalignedWrites)
+{
+  std::vector<uint8_t> stream = {0x00, 0x12, 0x47, 0x34}; // garbage before the first packet
+  Append(stream, CreateKeyframe(0x02));
+  Append(stream, CreatePacket(PID_VIDEO, false, 0x03));
+  Append(stream, CreatePacket(PID_VIDEO, false, 0x04));
+
+  CPVRZapAheadBuffer buffer(1024 * 1024);
+  for (size_t i = 0; i < stream.size(); i += 100)
+    EXPECT_TRUE(buffer.Write(stream.data() + i, std::min<size_t>(100, stream.size() - i)));
+
+  EXPECT_TRUE(buffer.HasKeyframe());
+  EXPECT_EQ(3 * PACKET_SIZE, buffer.Size());
+}
+
+TEST(TestPVRZapAheadBuffer, RejectsOtherData)
+{
+  const std::vector<uint8_t> data(20 * PACKET_SIZE, 0x00);
+
+  CPVRZapAheadBuffer buffer(1024 * 1024);
+  EXPECT_FALSE(buffer.Write(data.data(), data.size()));
+  EXPECT_EQ(0u, buffer.Size());
+}
+
+TEST(TestPVRZapAheadBuffer, DropsKeyframeOnOverflow)
+{
+  std::vector<uint8_t> stream;
+  Append(stream, CreateKeyframe(0x02));
+  for (int i = 0; i < 10; ++i)
+    Append(stream, CreatePacket(PID_VIDEO, false, 0x03));
+
+  CPVRZapAheadBuffer buffer(5 * PACKET_SIZE);
+  EXPECT_TRUE(buffer.Write(stream.data(), stream.size()));
+  EXPECT_FALSE(buffer.HasKeyframe());
+  EXPECT_LE(buffer.Size(), 5 * PACKET_SIZE);
+
+  const std::vector<uint8_t> keyframe = CreateKeyframe(0x05);
+  EXPECT_TRUE(buffer.Write(keyframe.data(), keyframe.size()));
+  EXPECT_TRUE(buffer.HasKeyframe());
+  EXPECT_EQ(PACKET_SIZE, buffer.Size());
+}
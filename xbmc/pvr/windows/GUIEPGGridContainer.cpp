@@ -1709,6 +1709,8 @@ void CGUIEPGGridContainer::GoToMostRight()
 
 void CGUIEPGGridContainer::SetTimelineItems(const std::unique_ptr<CFileItemList> &items, const CDateTime &gridStart, const CDateTime &gridEnd)
 {
+  int iFirstChannel;
+  int iChannelsPerPage;
   int iRulerUnit;
   int iBlocksPerPage;
   float fBlockSize;
@@ -1716,6 +1718,8 @@ void CGUIEPGGridContainer::SetTimelineItems(const std::unique_ptr<CFileItemList>
     CSingleLock lock(m_critSection);
 
     UpdateLayout();
+    iFirstChannel = m_channelOffset;
+    iChannelsPerPage = m_channelsPerPage;
     iRulerUnit = m_rulerUnit;
     iBlocksPerPage = m_blocksPerPage;
     fBlockSize = m_blockSize;
@@ -1724,7 +1728,7 @@ void CGUIEPGGridContainer::SetTimelineItems(const std::unique_ptr<CFileItemList>
   std::unique_ptr<CGUIEPGGridContainerModel> oldUpdatedGridModel;
   std::unique_ptr<CGUIEPGGridContainerModel> newUpdatedGridModel(new CGUIEPGGridContainerModel);
   // can be very expensive. never call with lock acquired.
-  newUpdatedGridModel->Initialize(items, gridStart, gridEnd, iRulerUnit, iBlocksPerPage, fBlockSize);
+  newUpdatedGridModel->Initialize(items, gridStart, gridEnd, iFirstChannel, iChannelsPerPage, iRulerUnit, iBlocksPerPage, fBlockSize);
 
   {
     CSingleLock lock(m_critSection);
@@ -8,6 +8,7 @@
 
 #include "GUIEPGGridContainerModel.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "FileItem.h"
@@ -51,7 +52,7 @@ std::shared_ptr<CFileItem> CGUIEPGGridContainerModel::CreateGapItem(int iChannel
   return std::make_shared<CFileItem>(gapTag);
 }
 
-void CGUIEPGGridContainerModel::Initialize(const std::unique_ptr<CFileItemList> &items, const CDateTime &gridStart, const CDateTime &gridEnd, int iRulerUnit, int iBlocksPerPage, float fBlockSize)
+void CGUIEPGGridContainerModel::Initialize(const std::unique_ptr<CFileItemList> &items, const CDateTime &gridStart, const CDateTime &gridEnd, int iFirstChannel, int iChannelsPerPage, int iRulerUnit, int iBlocksPerPage, float fBlockSize)
 {
   if (!m_channelItems.empty())
   {
@@ -76,6 +77,10 @@ void CGUIEPGGridContainerModel::Initialize(const std::unique_ptr<CFileItemList>
 
     m_programmeItems.emplace_back(fileItem);
 
+    // items of unchanged channels are reused from the previous model. don't touch them again.
+    if (!fileItem->HasProperty("GenreType"))
+      fileItem->SetProperty("GenreType", fileItem->GetEPGInfoTag()->GenreType());
+
     int iCurrentChannelUID = fileItem->GetEPGInfoTag()->UniqueChannelID();
     int iCurrentClientUID = fileItem->GetEPGInfoTag()->ClientID();
     if (iCurrentChannelUID != iLastChannelUID || iCurrentClientUID != iLastClientUID)
@@ -156,113 +161,119 @@ void CGUIEPGGridContainerModel::Initialize(const std::unique_ptr<CFileItemList>
   else if (m_blocks < iBlocksPerPage)
     m_blocks = iBlocksPerPage;
 
-  m_gridIndex.reserve(m_channelItems.size());
-  const std::vector<GridItem> blocks(m_blocks);
+  m_blockSize = fBlockSize;
+  m_gridIndex.resize(m_channelItems.size());
 
-  for (size_t channel = 0; channel < m_channelItems.size(); ++channel)
-  {
-    m_gridIndex.emplace_back(blocks);
-
-    CDateTime gridCursor(m_gridStart); //reset cursor for new channel
-    unsigned long progIdx = m_epgItemsPtr[channel].start;
-    unsigned long lastIdx = m_epgItemsPtr[channel].stop;
-    int iEpgId            = m_programmeItems[progIdx]->GetEPGInfoTag()->EpgID();
-    int itemSize          = 1; // size of the programme in blocks
-    int savedBlock        = 0;
-    CFileItemPtr item;
-    CPVREpgInfoTagPtr tag;
+  // only create the rows around the page to be displayed now, the others follow on demand.
+  const int iFirst = std::max(iFirstChannel - iChannelsPerPage, 0);
+  const int iLast = std::min(iFirstChannel + 2 * iChannelsPerPage, ChannelItemsSize());
+  for (int channel = iFirst; channel < iLast; ++channel)
+    CreateGridRow(channel);
+}
 
-    for (int block = 0; block < m_blocks; ++block)
-    {
-      while (progIdx <= lastIdx)
-      {
-        item = m_programmeItems[progIdx];
-        tag = item->GetEPGInfoTag();
+std::vector<GridItem> &CGUIEPGGridContainerModel::GetGridRow(int iChannel) const
+{
+  if (m_gridIndex[iChannel].empty())
+    CreateGridRow(iChannel);
 
-        // Note: Start block of an event is start-time-based calculated block + 1,
-        //       unless start times matches exactly the begin of a block.
+  return m_gridIndex[iChannel];
+}
 
-        if (tag->EpgID() != iEpgId || gridCursor < tag->StartAsUTC() || m_gridEnd <= tag->StartAsUTC())
-          break;
+void CGUIEPGGridContainerModel::CreateGridRow(int iChannel) const
+{
+  const size_t channel = iChannel;
+  const CDateTimeSpan blockDuration(0, 0, MINSPERBLOCK, 0);
+  const float fBlockSize = m_blockSize;
 
-        if (gridCursor < tag->EndAsUTC())
-        {
-          m_gridIndex[channel][block].item = item;
-          m_gridIndex[channel][block].progIndex = progIdx;
-          break;
-        }
+  m_gridIndex[channel].resize(m_blocks);
 
-        progIdx++;
-      }
+  CDateTime gridCursor(m_gridStart);
+  unsigned long progIdx = m_epgItemsPtr[channel].start;
+  unsigned long lastIdx = m_epgItemsPtr[channel].stop;
+  int iEpgId            = m_programmeItems[progIdx]->GetEPGInfoTag()->EpgID();
+  int itemSize          = 1; // size of the programme in blocks
+  int savedBlock        = 0;
+  CFileItemPtr item;
+  CPVREpgInfoTagPtr tag;
 
-      gridCursor += blockDuration;
+  for (int block = 0; block < m_blocks; ++block)
+  {
+    while (progIdx <= lastIdx)
+    {
+      item = m_programmeItems[progIdx];
+      tag = item->GetEPGInfoTag();
 
-      if (block == 0)
-        continue;
+      // Note: Start block of an event is start-time-based calculated block + 1,
+      //       unless start times matches exactly the begin of a block.
 
-      const CFileItemPtr prevItem(m_gridIndex[channel][block - 1].item);
-      const CFileItemPtr currItem(m_gridIndex[channel][block].item);
+      if (tag->EpgID() != iEpgId || gridCursor < tag->StartAsUTC() || m_gridEnd <= tag->StartAsUTC())
+        break;
 
-      if (block == m_blocks - 1 || prevItem != currItem)
+      if (gridCursor < tag->EndAsUTC())
       {
-        // special handling for last block.
-        int blockDelta = -1;
-        int sizeDelta = 0;
-        if (block == m_blocks - 1 && prevItem == currItem)
-        {
-          itemSize++;
-          blockDelta = 0;
-          sizeDelta = 1;
-        }
+        m_gridIndex[channel][block].item = item;
+        m_gridIndex[channel][block].progIndex = progIdx;
+        break;
+      }
 
-        if (prevItem)
-        {
-          m_gridIndex[channel][savedBlock].item->SetProperty("GenreType", prevItem->GetEPGInfoTag()->GenreType());
-        }
-        else
-        {
-          const std::shared_ptr<CFileItem> gapItem = CreateGapItem(channel);
-          for (int i = block + blockDelta; i >= block - itemSize + sizeDelta; --i)
-          {
-            m_gridIndex[channel][i].item = gapItem;
-          }
-        }
+      progIdx++;
+    }
 
-        float fItemWidth = itemSize * fBlockSize;
-        m_gridIndex[channel][savedBlock].originWidth = fItemWidth;
-        m_gridIndex[channel][savedBlock].width = fItemWidth;
+    gridCursor += blockDuration;
+
+    if (block == 0)
+      continue;
 
-        itemSize = 1;
-        savedBlock = block;
+    const CFileItemPtr prevItem(m_gridIndex[channel][block - 1].item);
+    const CFileItemPtr currItem(m_gridIndex[channel][block].item);
+
+    if (block == m_blocks - 1 || prevItem != currItem)
+    {
+      // special handling for last block.
+      int blockDelta = -1;
+      int sizeDelta = 0;
+      if (block == m_blocks - 1 && prevItem == currItem)
+      {
+        itemSize++;
+        blockDelta = 0;
+        sizeDelta = 1;
+      }
 
-        // special handling for last block.
-        if (block == m_blocks - 1 && prevItem != currItem)
+      if (!prevItem)
+      {
+        const std::shared_ptr<CFileItem> gapItem = CreateGapItem(channel);
+        for (int i = block + blockDelta; i >= block - itemSize + sizeDelta; --i)
         {
-          if (currItem)
-          {
-            m_gridIndex[channel][savedBlock].item->SetProperty("GenreType", currItem->GetEPGInfoTag()->GenreType());
-          }
-          else
-          {
-            m_gridIndex[channel][block].item = CreateGapItem(channel);
-          }
-
-          m_gridIndex[channel][savedBlock].originWidth = fBlockSize; // size always 1 block here
-          m_gridIndex[channel][savedBlock].width = fBlockSize;
+          m_gridIndex[channel][i].item = gapItem;
         }
       }
-      else
+
+      float fItemWidth = itemSize * fBlockSize;
+      m_gridIndex[channel][savedBlock].originWidth = fItemWidth;
+      m_gridIndex[channel][savedBlock].width = fItemWidth;
+
+      itemSize = 1;
+      savedBlock = block;
+
+      // special handling for last block.
+      if (block == m_blocks - 1 && prevItem != currItem)
       {
-        itemSize++;
+        if (!currItem)
+          m_gridIndex[channel][block].item = CreateGapItem(channel);
+
+        m_gridIndex[channel][savedBlock].originWidth = fBlockSize; // size always 1 block here
+        m_gridIndex[channel][savedBlock].width = fBlockSize;
       }
     }
+    else
+    {
+      itemSize++;
+    }
   }
 }
 
 void CGUIEPGGridContainerModel::FindChannelAndBlockIndex(int channelUid, unsigned int broadcastUid, int eventOffset, int &newChannelIndex, int &newBlockIndex) const
 {
-  const CDateTimeSpan blockDuration(0, 0, MINSPERBLOCK, 0);
-
   newChannelIndex = INVALID_INDEX;
   newBlockIndex = INVALID_INDEX;
 
@@ -278,35 +289,28 @@ void CGUIEPGGridContainerModel::FindChannelAndBlockIndex(int channelUid, unsigne
     iCurrentChannel++;
   }
 
-  if (newChannelIndex != INVALID_INDEX)
+  if (newChannelIndex != INVALID_INDEX && broadcastUid > 0)
   {
-    // find the block
-    CDateTime gridCursor(m_gridStart); //reset cursor for new channel
+    // find the tag within the channel's programmes and map its start to a block, like the grid rows do
     unsigned long progIdx = m_epgItemsPtr[newChannelIndex].start;
     unsigned long lastIdx = m_epgItemsPtr[newChannelIndex].stop;
     int iEpgId = m_programmeItems[progIdx]->GetEPGInfoTag()->EpgID();
     CPVREpgInfoTagPtr tag;
-    for (int block = 0; block < m_blocks; ++block)
+    for (; progIdx <= lastIdx; ++progIdx)
     {
-      while (progIdx <= lastIdx)
-      {
-        tag = m_programmeItems[progIdx]->GetEPGInfoTag();
+      tag = m_programmeItems[progIdx]->GetEPGInfoTag();
 
-        if (tag->EpgID() != iEpgId || gridCursor < tag->StartAsUTC() || m_gridEnd <= tag->StartAsUTC())
-          break; // next block
+      if (tag->EpgID() != iEpgId || m_gridEnd <= tag->StartAsUTC())
+        break;
 
-        if (gridCursor < tag->EndAsUTC())
-        {
-          if (broadcastUid > 0 && tag->UniqueBroadcastID() == broadcastUid)
-          {
-            newBlockIndex = block + eventOffset;
-            return; // done.
-          }
-          break; // next block
-        }
-        progIdx++;
+      if (tag->UniqueBroadcastID() == broadcastUid)
+      {
+        const int block = std::max(GetFirstEventBlock(tag), 0);
+        if (block < m_blocks && GetStartTimeForBlock(block) < tag->EndAsUTC())
+          newBlockIndex = block + eventOffset;
+
+        return; // done.
       }
-      gridCursor += blockDuration;
     }
   }
 }
@@ -327,53 +331,78 @@ void CGUIEPGGridContainerModel::FreeChannelMemory(int keepStart, int keepEnd)
   {
     // remove before keepStart and after keepEnd
     for (int i = 0; i < keepStart && i < ChannelItemsSize(); ++i)
-      m_channelItems[i]->FreeMemory();
+      FreeChannel(i);
     for (int i = keepEnd + 1; i < ChannelItemsSize(); ++i)
-      m_channelItems[i]->FreeMemory();
+      FreeChannel(i);
   }
   else
   {
     // wrapping
     for (int i = keepEnd + 1; i < keepStart && i < ChannelItemsSize(); ++i)
-      m_channelItems[i]->FreeMemory();
+      FreeChannel(i);
+  }
+}
+
+void CGUIEPGGridContainerModel::FreeChannel(int iChannel)
+{
+  m_channelItems[iChannel]->FreeMemory();
+
+  // the grid row is cheap to create again, release it together with its items' layouts
+  std::vector<GridItem> &row = m_gridIndex[iChannel];
+  if (row.empty())
+    return;
+
+  CGUIListItemPtr last;
+  for (const auto &gridItem : row)
+  {
+    if (gridItem.item && gridItem.item != last)
+    {
+      gridItem.item->FreeMemory();
+      last = gridItem.item;
+    }
   }
+  std::vector<GridItem>().swap(row);
 }
 
 void CGUIEPGGridContainerModel::FreeProgrammeMemory(int channel, int keepStart, int keepEnd)
 {
+  std::vector<GridItem> &row = m_gridIndex[channel];
+  if (row.empty())
+    return;
+
   if (keepStart < keepEnd)
   {
     // remove before keepStart and after keepEnd
     if (keepStart > 0 && keepStart < m_blocks)
     {
       // if item exist and block is not part of visible item
-      CGUIListItemPtr last(m_gridIndex[channel][keepStart].item);
+      CGUIListItemPtr last(row[keepStart].item);
       for (int i = keepStart - 1; i > 0; --i)
       {
-        if (m_gridIndex[channel][i].item && m_gridIndex[channel][i].item != last)
+        if (row[i].item && row[i].item != last)
         {
-          m_gridIndex[channel][i].item->FreeMemory();
+          row[i].item->FreeMemory();
           // FreeMemory() is smart enough to not cause any problems when called multiple times on same item
           // but we can make use of condition needed to not call FreeMemory() on item that is partially visible
           // to avoid calling FreeMemory() multiple times on item that occupy few blocks in a row
-          last = m_gridIndex[channel][i].item;
+          last = row[i].item;
         }
       }
     }
 
     if (keepEnd > 0 && keepEnd < m_blocks)
     {
-      CGUIListItemPtr last(m_gridIndex[channel][keepEnd].item);
+      CGUIListItemPtr last(row[keepEnd].item);
       for (int i = keepEnd + 1; i < m_blocks; ++i)
       {
         // if item exist and block is not part of visible item
-        if (m_gridIndex[channel][i].item && m_gridIndex[channel][i].item != last)
+        if (row[i].item && row[i].item != last)
         {
-          m_gridIndex[channel][i].item->FreeMemory();
+          row[i].item->FreeMemory();
           // FreeMemory() is smart enough to not cause any problems when called multiple times on same item
           // but we can make use of condition needed to not call FreeMemory() on item that is partially visible
           // to avoid calling FreeMemory() multiple times on item that occupy few blocks in a row
-          last = m_gridIndex[channel][i].item;
+          last = row[i].item;
         }
       }
     }
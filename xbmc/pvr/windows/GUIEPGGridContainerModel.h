@@ -39,7 +39,19 @@ namespace PVR
     CGUIEPGGridContainerModel() = default;
     virtual ~CGUIEPGGridContainerModel() = default;
 
-    void Initialize(const std::unique_ptr<CFileItemList> &items, const CDateTime &gridStart, const CDateTime &gridEnd, int iRulerUnit, int iBlocksPerPage, float fBlockSize);
+    /*!
+     * @brief Set up the model for the given programmes. Grid rows are only created for the channels
+     * around the given page; rows of other channels are created when they are accessed.
+     * @param items The programmes, grouped by channel and sorted by start time.
+     * @param gridStart The requested start of the grid.
+     * @param gridEnd The requested end of the grid.
+     * @param iFirstChannel The index of the first channel on the page that will be displayed.
+     * @param iChannelsPerPage The number of channels per page.
+     * @param iRulerUnit The number of blocks per ruler item.
+     * @param iBlocksPerPage The number of blocks per page.
+     * @param fBlockSize The width of a block.
+     */
+    void Initialize(const std::unique_ptr<CFileItemList> &items, const CDateTime &gridStart, const CDateTime &gridEnd, int iFirstChannel, int iChannelsPerPage, int iRulerUnit, int iBlocksPerPage, float fBlockSize);
     void SetInvalid();
 
     static const int INVALID_INDEX = -1;
@@ -62,12 +74,12 @@ namespace PVR
 
     int GetBlockCount() const { return m_blocks; }
     bool HasGridItems() const { return !m_gridIndex.empty(); }
-    GridItem *GetGridItemPtr(int iChannel, int iBlock) { return &m_gridIndex[iChannel][iBlock]; }
-    CFileItemPtr GetGridItem(int iChannel, int iBlock) const { return m_gridIndex[iChannel][iBlock].item; }
-    float GetGridItemWidth(int iChannel, int iBlock) const { return m_gridIndex[iChannel][iBlock].width; }
-    float GetGridItemOriginWidth(int iChannel, int iBlock) const { return m_gridIndex[iChannel][iBlock].originWidth; }
-    int GetGridItemIndex(int iChannel, int iBlock) const { return m_gridIndex[iChannel][iBlock].progIndex; }
-    void SetGridItemWidth(int iChannel, int iBlock, float fWidth) { m_gridIndex[iChannel][iBlock].width = fWidth; }
+    GridItem *GetGridItemPtr(int iChannel, int iBlock) { return &GetGridRow(iChannel)[iBlock]; }
+    CFileItemPtr GetGridItem(int iChannel, int iBlock) const { return GetGridRow(iChannel)[iBlock].item; }
+    float GetGridItemWidth(int iChannel, int iBlock) const { return GetGridRow(iChannel)[iBlock].width; }
+    float GetGridItemOriginWidth(int iChannel, int iBlock) const { return GetGridRow(iChannel)[iBlock].originWidth; }
+    int GetGridItemIndex(int iChannel, int iBlock) const { return GetGridRow(iChannel)[iBlock].progIndex; }
+    void SetGridItemWidth(int iChannel, int iBlock, float fWidth) { GetGridRow(iChannel)[iBlock].width = fWidth; }
 
     bool IsZeroGridDuration() const { return (m_gridEnd - m_gridStart) == CDateTimeSpan(0, 0, 0, 0); }
     const CDateTime &GetGridStart() const { return m_gridStart; }
@@ -84,8 +96,12 @@ namespace PVR
 
   private:
     void FreeItemsMemory();
+    void FreeChannel(int iChannel);
     std::shared_ptr<CFileItem> CreateGapItem(int iChannel) const;
 
+    std::vector<GridItem> &GetGridRow(int iChannel) const;
+    void CreateGridRow(int iChannel) const;
+
     struct ItemsPtr
     {
       long start;
@@ -99,8 +115,9 @@ namespace PVR
     std::vector<CFileItemPtr> m_channelItems;
     std::vector<CFileItemPtr> m_rulerItems;
     std::vector<ItemsPtr> m_epgItemsPtr;
-    std::vector<std::vector<GridItem> > m_gridIndex;
+    mutable std::vector<std::vector<GridItem> > m_gridIndex; //! block to programme index per channel, empty until the row is accessed
 
     int m_blocks = 0;
+    float m_blockSize = 0.0f;
   };
 }
@@ -42,6 +42,7 @@ CGUIWindowPVRGuideBase::CGUIWindowPVRGuideBase(bool bRadio, int id, const std::s
 {
   m_bRefreshTimelineItems = false;
   m_bSyncRefreshTimelineItems = false;
+  m_bClearTimelineCache = false;
   CServiceBroker::GetPVRManager().EpgContainer().RegisterObserver(this);
 }
 
@@ -81,6 +82,7 @@ void CGUIWindowPVRGuideBase::ClearData()
     m_cachedChannelGroup.reset();
     m_newTimeline.reset();
   }
+  m_bClearTimelineCache = true;
 
   CGUIWindowPVRBase::ClearData();
 }
@@ -135,6 +137,7 @@ void CGUIWindowPVRGuideBase::Notify(const Observable &obs, const ObservableMessa
       msg == ObservableMessageChannelGroupReset ||
       msg == ObservableMessageChannelGroup)
   {
+    // epg tables announce their changes, the timeline cache is checked against their revisions on refresh
     m_bRefreshTimelineItems = true;
     // no base class call => do async refresh
     return;
@@ -641,12 +644,56 @@ bool CGUIWindowPVRGuideBase::RefreshTimelineItems()
       }
       else
       {
+        if (m_bClearTimelineCache.exchange(false))
+          m_timelineCache.clear();
+
+        // only fetch the tags of channels whose epg changed since the last refresh, reuse the other items.
         // can be very expensive. never call with lock acquired.
-        const std::vector<std::shared_ptr<CPVREpgInfoTag>> tags = group->GetEPGAll(true);
-        for (const auto& tag : tags)
+        const CPVREpgContainer& epgContainer = CServiceBroker::GetPVRManager().EpgContainer();
+        std::map<int, TimelineCacheEntry> timelineCache;
+        const std::vector<PVRChannelGroupMember> groupMembers = group->GetMembers();
+        for (const auto& groupMember : groupMembers)
         {
-          timeline->Add(std::make_shared<CFileItem>(tag));
+          if (groupMember.channel->IsHidden())
+            continue;
+
+          const std::shared_ptr<CPVREpg> epg = groupMember.channel->GetEPG();
+          if (!epg)
+          {
+            // fake a channel without epg
+            const std::shared_ptr<CPVREpgInfoTag> gapTag
+              = std::make_shared<CPVREpgInfoTag>(std::make_shared<CPVREpgChannelData>(*(groupMember.channel)), -1);
+            timeline->Add(std::make_shared<CFileItem>(gapTag));
+            continue;
+          }
+
+          // get the revision first, so that a change while fetching the tags is not missed
+          const unsigned int iEpgRevision = epgContainer.GetEpgRevision(epg->EpgID());
+          TimelineCacheEntry& entry = timelineCache[epg->EpgID()];
+
+          const auto it = m_timelineCache.find(epg->EpgID());
+          if (it != m_timelineCache.end() && it->second.iEpgRevision == iEpgRevision)
+          {
+            entry = std::move(it->second);
+          }
+          else
+          {
+            entry.iEpgRevision = iEpgRevision;
+            for (const auto& tag : epg->GetTags())
+              entry.items.emplace_back(std::make_shared<CFileItem>(tag));
+
+            if (entry.items.empty())
+            {
+              // fake a channel without epg
+              const std::shared_ptr<CPVREpgInfoTag> gapTag = std::make_shared<CPVREpgInfoTag>(epg->GetChannelData(), epg->EpgID());
+              entry.items.emplace_back(std::make_shared<CFileItem>(gapTag));
+            }
+          }
+
+          for (const auto& item : entry.items)
+            timeline->Add(item);
         }
+        m_timelineCache = std::move(timelineCache);
       }
 
       CDateTime startDate(group->GetFirstEPGDate());
@@ -659,7 +706,7 @@ bool CGUIWindowPVRGuideBase::RefreshTimelineItems()
       if (!endDate.IsValid() || endDate < startDate)
         endDate = startDate;
 
-      CPVREpgContainer& epgContainer = CServiceBroker::GetPVRManager().EpgContainer();
+      const CPVREpgContainer& epgContainer = CServiceBroker::GetPVRManager().EpgContainer();
 
       // limit start to past days to display
       int iPastDays = epgContainer.GetPastDaysToDisplay();
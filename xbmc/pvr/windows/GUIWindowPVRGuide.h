@@ -9,7 +9,9 @@
 #pragma once
 
 #include <atomic>
+#include <map>
 #include <memory>
+#include <vector>
 
 #include "threads/Event.h"
 #include "threads/Thread.h"
@@ -77,6 +79,15 @@ namespace PVR
     CPVRChannelGroupPtr m_cachedChannelGroup;
     std::unique_ptr<CFileItemList> m_newTimeline;
 
+    struct TimelineCacheEntry
+    {
+      unsigned int iEpgRevision = 0;
+      std::vector<std::shared_ptr<CFileItem>> items;
+    };
+
+    std::map<int, TimelineCacheEntry> m_timelineCache; //! programme items of the last refresh by epg id, only accessed by the refresh thread
+    std::atomic_bool m_bClearTimelineCache;
+
     bool m_bChannelSelectionRestored;
     std::atomic_bool m_bFirstOpen;
   };
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "RenderSystemTypes.h"
+#include "guilib/DirtyRegion.h"
 #include "utils/Color.h"
 #include "utils/Geometry.h"
 #include <memory>
@@ -70,12 +71,31 @@ public:
   const std::string& GetRenderRenderer() const { return m_RenderRenderer; }
   const std::string& GetRenderVersionString() const { return m_RenderVersion; }
   virtual bool SupportsNPOT(bool dxt) const;
+  virtual bool SupportsDXT() const { return false; } ///< whether DXT1/DXT5 compressed textures can be uploaded directly
   virtual bool SupportsStereo(RENDER_STEREO_MODE mode) const;
   unsigned int GetMaxTextureSize() const { return m_maxTextureSize; }
   unsigned int GetMinDXTPitch() const { return m_minDXTPitch; }
 
   virtual void ShowSplash(const std::string& message);
 
+  /**
+   * Age of the back buffer in frames, 0 if its contents are undefined or -1
+   * if unknown in which case the default dirty region buffering is assumed
+   */
+  virtual int GetBufferAge() { return -1; }
+
+  /**
+   * Number of buffer swaps presented so far, buffer ages are counted in swaps
+   */
+  virtual unsigned int GetSwapCount() { return 0; }
+
+  /**
+   * Set the screen regions redrawn this frame. Render systems able to present
+   * partial updates limit the next present to them, an empty list means the
+   * whole screen.
+   */
+  void SetDamagedRegions(const CDirtyRegionList& regions) { m_damagedRegions = regions; }
+
 protected:
   bool                m_bRenderCreated;
   bool                m_bVSync;
@@ -90,6 +110,7 @@ protected:
   RENDER_STEREO_VIEW m_stereoView = RENDER_STEREO_VIEW_OFF;
   RENDER_STEREO_MODE m_stereoMode = RENDER_STEREO_MODE_OFF;
   bool m_limitedColorRange = false;
+  CDirtyRegionList m_damagedRegions;
 
   std::unique_ptr<CGUIImage> m_splashImage;
   std::unique_ptr<CGUITextLayout> m_splashMessageLayout;
@@ -280,6 +280,11 @@ bool CRenderSystemGL::SupportsNPOT(bool dxt) const
   return m_supportsNPOT;
 }
 
+bool CRenderSystemGL::SupportsDXT() const
+{
+  return IsExtSupported("GL_EXT_texture_compression_s3tc");
+}
+
 void CRenderSystemGL::PresentRender(bool rendered, bool videoLayer)
 {
   SetVSync(true);
@@ -62,6 +62,7 @@ public:
   void SetStereoMode(RENDER_STEREO_MODE mode, RENDER_STEREO_VIEW view) override;
   bool SupportsStereo(RENDER_STEREO_MODE mode) const override;
   bool SupportsNPOT(bool dxt) const override;
+  bool SupportsDXT() const override;
 
   void Project(float &x, float &y, float &z) override;
 
@@ -27,8 +27,10 @@
 #include "settings/Settings.h"
 #include "settings/SettingsComponent.h"
 #include "settings/SettingUtils.h"
+#include "threads/ThreadPolicy.h"
 #include "utils/LangCodeExpander.h"
 #include "utils/log.h"
+#include "utils/MemoryBudget.h"
 #include "utils/StringUtils.h"
 #include "utils/SystemInfo.h"
 #include "utils/URIUtils.h"
@@ -281,6 +283,7 @@ void CAdvancedSettings::Initialize()
   m_fanartRes = 1080;
   m_imageRes = 720;
   m_imageScalingAlgorithm = CPictureScalingAlgorithm::Default;
+  m_imageUseDDS = false;
 
   m_sambaclienttimeout = 30;
   m_sambadoscodepage = "";
@@ -347,6 +350,8 @@ void CAdvancedSettings::Initialize()
   m_bEpgDisplayUpdatePopup = true; /* Display a progress popup while updating EPG data from clients */
   m_bEpgDisplayIncrementalUpdatePopup = false; /* Display a progress popup while doing incremental EPG updates, but
                                                   only if 'displayupdatepopup' is also enabled. */
+  m_iEpgUpdateClientConcurrency = 1; /* Number of EPG tables updated at the same time per PVR client. Different clients
+                                        are always updated in parallel. 0 updates all tables one after another. */
 
   m_bEdlMergeShortCommBreaks = false;      // Off by default
   m_iEdlMaxCommBreakLength = 8 * 30 + 10;  // Just over 8 * 30 second commercial break.
@@ -403,6 +408,8 @@ void CAdvancedSettings::Initialize()
   m_iPVRNumericChannelSwitchTimeout = 2000;
   m_iPVRTimeshiftThreshold = 10;
   m_bPVRTimeshiftSimpleOSD = true;
+  m_iPVRLocalTimeshiftSize = 0;
+  m_bPVRZapAhead = false;
 
   m_cacheMemSize = 1024 * 1024 * 20;
   m_cacheBufferMode = CACHE_BUFFER_MODE_INTERNET; // Default (buffer all internet streams/filesystems)
@@ -415,12 +422,16 @@ void CAdvancedSettings::Initialize()
   m_jsonOutputCompact = true;
   m_jsonTcpPort = 9090;
 
+  m_webserverThreadPoolSize = 0;
+
   m_enableMultimediaKeys = false;
 
   m_canWindowed = true;
   m_guiVisualizeDirtyRegions = false;
   m_guiAlgorithmDirtyRegions = 3;
   m_guiSmartRedraw = false;
+  m_guiAsyncTextureLoading = false;
+  m_guiAsyncTextureUploads = 4;
   m_airTunesPort = 36666;
   m_airPlayPort = 36667;
 
@@ -449,6 +460,11 @@ void CAdvancedSettings::Initialize()
   m_logLevelHint = m_logLevel = LOG_LEVEL_NORMAL;
   m_extraLogEnabled = false;
   m_extraLogLevels = 0;
+  m_asyncLogging = false;
+
+  XbmcThreads::CThreadPolicies::Reset();
+
+  CMemoryBudget::GetInstance().SetLimits(0, 0);
 
   m_openGlDebugging = false;
 
@@ -873,6 +889,53 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetUInt(pElement, "tcpport", m_jsonTcpPort);
   }
 
+  pElement = pRootElement->FirstChildElement("webserver");
+  if (pElement)
+    XMLUtils::GetUInt(pElement, "threadpoolsize", m_webserverThreadPoolSize, 0, 64);
+
+  pElement = pRootElement->FirstChildElement("threadpolicies");
+  if (pElement)
+  {
+    using namespace XbmcThreads;
+
+    std::string cpuList;
+    std::vector<int> cpus;
+    if (XMLUtils::GetString(pElement, "isolatedcpus", cpuList))
+    {
+      if (CThreadPolicies::ParseCpuList(cpuList, cpus))
+        CThreadPolicies::SetIsolatedCpus(cpus);
+      else
+        CLog::Log(LOGERROR, "%s - invalid isolated cpus '%s'", __FUNCTION__, cpuList.c_str());
+    }
+
+    for (int i = THREAD_CLASS_DEFAULT; i < THREAD_CLASS_COUNT; i++)
+    {
+      const ThreadClass threadClass = static_cast<ThreadClass>(i);
+      const TiXmlElement* pPolicy = pElement->FirstChildElement(CThreadPolicies::GetName(threadClass));
+      if (!pPolicy)
+        continue;
+
+      ThreadPolicy policy = CThreadPolicies::Get(threadClass);
+      XMLUtils::GetInt(pPolicy, "nice", policy.nice, -20, 19);
+      XMLUtils::GetInt(pPolicy, "realtimepriority", policy.realtimePriority, 0, 99);
+      if (XMLUtils::GetString(pPolicy, "cpus", cpuList) && !CThreadPolicies::ParseCpuList(cpuList, policy.cpus))
+        CLog::Log(LOGERROR, "%s - invalid cpus '%s' for %s threads", __FUNCTION__, cpuList.c_str(), CThreadPolicies::GetName(threadClass));
+      XMLUtils::GetString(pPolicy, "cgroup", policy.cgroup);
+      CThreadPolicies::Set(threadClass, policy);
+    }
+  }
+
+  pElement = pRootElement->FirstChildElement("memorybudget");
+  if (pElement)
+  {
+    // in MB, 0 to detect
+    uint32_t memoryLimit = 0;
+    uint32_t cacheLimit = 0;
+    XMLUtils::GetUInt(pElement, "memorylimit", memoryLimit);
+    XMLUtils::GetUInt(pElement, "cachelimit", cacheLimit);
+    CMemoryBudget::GetInstance().SetLimits(static_cast<uint64_t>(memoryLimit) << 20, static_cast<uint64_t>(cacheLimit) << 20);
+  }
+
   pElement = pRootElement->FirstChildElement("samba");
   if (pElement)
   {
@@ -907,6 +970,9 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     CLog::SetLogLevel(m_logLevel);
   }
 
+  if (XMLUtils::GetBoolean(pRootElement, "asynclogging", m_asyncLogging))
+    CLog::SetAsyncLogging(m_asyncLogging);
+
   XMLUtils::GetString(pRootElement, "cddbaddress", m_cddbAddress);
   XMLUtils::GetBoolean(pRootElement, "addsourceontop", m_addSourceOnTop);
 
@@ -948,6 +1014,7 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetInt(pElement, "updateemptytagsinterval", m_iEpgUpdateEmptyTagsInterval);
     XMLUtils::GetBoolean(pElement, "displayupdatepopup", m_bEpgDisplayUpdatePopup);
     XMLUtils::GetBoolean(pElement, "displayincrementalupdatepopup", m_bEpgDisplayIncrementalUpdatePopup);
+    XMLUtils::GetInt(pElement, "updateclientconcurrency", m_iEpgUpdateClientConcurrency, 0, 16);
   }
 
   // EDL commercial break handling
@@ -1084,6 +1151,7 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
   XMLUtils::GetUInt(pRootElement, "imageres", m_imageRes, 0, 9999);
   if (XMLUtils::GetString(pRootElement, "imagescalingalgorithm", tmp))
     m_imageScalingAlgorithm = CPictureScalingAlgorithm::FromString(tmp);
+  XMLUtils::GetBoolean(pRootElement, "useddscache", m_imageUseDDS);
   XMLUtils::GetBoolean(pRootElement, "playlistasfolders", m_playlistAsFolders);
   XMLUtils::GetBoolean(pRootElement, "detectasudf", m_detectAsUdf);
 
@@ -1142,6 +1210,8 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetInt(pPVR, "numericchannelswitchtimeout", m_iPVRNumericChannelSwitchTimeout, 50, 60000);
     XMLUtils::GetInt(pPVR, "timeshiftthreshold", m_iPVRTimeshiftThreshold, 0, 60);
     XMLUtils::GetBoolean(pPVR, "timeshiftsimpleosd", m_bPVRTimeshiftSimpleOSD);
+    XMLUtils::GetInt(pPVR, "localtimeshiftsize", m_iPVRLocalTimeshiftSize, 0, 16384);
+    XMLUtils::GetBoolean(pPVR, "zapahead", m_bPVRZapAhead);
   }
 
   TiXmlElement* pDatabase = pRootElement->FirstChildElement("videodatabase");
@@ -1242,6 +1312,8 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetBoolean(pElement, "visualizedirtyregions", m_guiVisualizeDirtyRegions);
     XMLUtils::GetInt(pElement, "algorithmdirtyregions",     m_guiAlgorithmDirtyRegions);
     XMLUtils::GetBoolean(pElement, "smartredraw", m_guiSmartRedraw);
+    XMLUtils::GetBoolean(pElement, "asynctextureloading", m_guiAsyncTextureLoading);
+    XMLUtils::GetUInt(pElement, "asynctextureuploads", m_guiAsyncTextureUploads, 1, 64);
   }
 
   std::string seekSteps;
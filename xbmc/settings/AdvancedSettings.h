@@ -196,6 +196,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_logLevelHint;
     bool m_extraLogEnabled;
     int m_extraLogLevels;
+    bool m_asyncLogging; //!< Write the log file from a background thread
     std::string m_cddbAddress;
     bool m_addSourceOnTop; //!< True to put 'add source' buttons on top
 
@@ -233,6 +234,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     unsigned int m_fanartRes; ///< \brief the maximal resolution to cache fanart at (assumes 16x9)
     unsigned int m_imageRes;  ///< \brief the maximal resolution to cache images at (assumes 16x9)
     CPictureScalingAlgorithm::Algorithm m_imageScalingAlgorithm;
+    bool m_imageUseDDS;       ///< \brief also cache images as DXT compressed .dds textures for direct upload to the GPU
 
     int m_sambaclienttimeout;
     std::string m_sambadoscodepage;
@@ -285,6 +287,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_iEpgUpdateEmptyTagsInterval; // seconds
     bool m_bEpgDisplayUpdatePopup;
     bool m_bEpgDisplayIncrementalUpdatePopup;
+    int m_iEpgUpdateClientConcurrency;
 
     // EDL Commercial Break
     bool m_bEdlMergeShortCommBreaks;
@@ -334,6 +337,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_iPVRNumericChannelSwitchTimeout; /*!< @brief time in msecs after that a channel switch occurs after entering a channel number, if confirmchannelswitch is disabled */
     int m_iPVRTimeshiftThreshold; /*!< @brief time diff between current playing time and timeshift buffer end, in seconds, before a playing stream is displayed as timeshifting. */
     bool m_bPVRTimeshiftSimpleOSD; /*!< @brief use simple timeshift OSD (with progress only for the playing event instead of progress for the whole ts buffer). */
+    int m_iPVRLocalTimeshiftSize; /*!< @brief size in MB of the local timeshift buffer for channels whose client can neither pause nor seek. 0 disables local timeshift. */
+    bool m_bPVRZapAhead; /*!< @brief keep the previous and next channel of the playing channel opened in the background for fast switching. */
     DatabaseSettings m_databaseMusic; // advanced music database setup
     DatabaseSettings m_databaseVideo; // advanced video database setup
     DatabaseSettings m_databaseTV;    // advanced tv database setup
@@ -343,6 +348,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
     bool m_guiSmartRedraw;
+    bool m_guiAsyncTextureLoading;        /*!< @brief decode skin textures on job workers instead of the render thread */
+    unsigned int m_guiAsyncTextureUploads; /*!< @brief max number of decoded textures uploaded to the GPU per frame */
     unsigned int m_addonPackageFolderSize;
 
     unsigned int m_cacheMemSize;
@@ -352,6 +359,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_jsonOutputCompact;
     unsigned int m_jsonTcpPort;
 
+    unsigned int m_webserverThreadPoolSize; /*!< @brief number of web server threads polling all connections. 0 uses one thread per connection. */
+
     bool m_enableMultimediaKeys;
     std::vector<std::string> m_settingsFiles;
     void ParseSettingsFile(const std::string &file);
@@ -0,0 +1,71 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+
+/*!
+ \brief Publishes immutable versions of some state
+
+ Readers get the most recently published version without waiting for writers
+ and may keep using it for as long as they hold on to it, even when newer
+ versions are published meanwhile. Writers modify a copy of the current
+ version and publish it as a whole, so readers never see partial updates.
+
+ Meant for state that is read much more often than it is written, e.g. by the
+ render thread every frame while a background thread updates it every now and
+ then.
+ */
+template<typename T>
+class CSnapshot
+{
+public:
+  CSnapshot() : m_current(std::make_shared<const T>()) {}
+  explicit CSnapshot(std::shared_ptr<const T> state) : m_current(std::move(state)) {}
+
+  /*!
+   \brief Get the current version of the state
+   */
+  std::shared_ptr<const T> Get() const
+  {
+    return std::atomic_load(&m_current);
+  }
+
+  /*!
+   \brief Replace the state by the given version
+   */
+  void Publish(std::shared_ptr<const T> state)
+  {
+    std::atomic_store(&m_current, std::move(state));
+  }
+
+  /*!
+   \brief Publish a modified copy of the current version
+   \param modify called with the copy to modify. Concurrent updates are
+   serialized, so none of them gets lost.
+   */
+  template<typename F>
+  void Update(F modify)
+  {
+    CSingleLock lock(m_updateSection);
+    std::shared_ptr<T> state = std::make_shared<T>(*Get());
+    modify(*state);
+    Publish(std::move(state));
+  }
+
+private:
+  CSnapshot(const CSnapshot&) = delete;
+  CSnapshot& operator=(const CSnapshot&) = delete;
+
+  std::shared_ptr<const T> m_current;
+  CCriticalSection m_updateSection;
+};
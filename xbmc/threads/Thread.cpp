@@ -27,8 +27,8 @@ static thread_local CThread* currentThread;
 // Construction/Destruction
 //////////////////////////////////////////////////////////////////////
 
-CThread::CThread(const char* ThreadName)
-: m_StopEvent(true,true), m_TermEvent(true), m_StartEvent(true, true)
+CThread::CThread(const char* ThreadName, XbmcThreads::ThreadClass threadClass)
+: m_StopEvent(true,true), m_TermEvent(true), m_StartEvent(true, true), m_threadClass(threadClass)
 {
   m_bStop = false;
 
@@ -44,8 +44,8 @@ CThread::CThread(const char* ThreadName)
     m_ThreadName = ThreadName;
 }
 
-CThread::CThread(IRunnable* pRunnable, const char* ThreadName)
-: m_StopEvent(true, true), m_TermEvent(true), m_StartEvent(true, true)
+CThread::CThread(IRunnable* pRunnable, const char* ThreadName, XbmcThreads::ThreadClass threadClass)
+: m_StopEvent(true, true), m_TermEvent(true), m_StartEvent(true, true), m_threadClass(threadClass)
 {
   m_bStop = false;
 
@@ -107,6 +107,7 @@ THREADFUNC CThread::staticThread(void* data)
   autodelete = pThread->m_bAutoDelete;
 
   pThread->SetThreadInfo();
+  SetCurrentThreadClass(pThread->m_threadClass);
 
   CLog::Log(LOGDEBUG,"Thread %s start, auto delete: %s", name.c_str(), (autodelete ? "true" : "false"));
 
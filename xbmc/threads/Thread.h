@@ -17,6 +17,7 @@
 #include <stdint.h>
 #include "Event.h"
 #include "threads/ThreadImpl.h"
+#include "threads/ThreadPolicy.h"
 
 #ifdef TARGET_DARWIN
 #include <mach/mach.h>
@@ -32,10 +33,10 @@ namespace XbmcThreads { class ThreadSettings; }
 class CThread
 {
 protected:
-  explicit CThread(const char* ThreadName);
+  explicit CThread(const char* ThreadName, XbmcThreads::ThreadClass threadClass = XbmcThreads::THREAD_CLASS_DEFAULT);
 
 public:
-  CThread(IRunnable* pRunnable, const char* ThreadName);
+  CThread(IRunnable* pRunnable, const char* ThreadName, XbmcThreads::ThreadClass threadClass = XbmcThreads::THREAD_CLASS_DEFAULT);
   virtual ~CThread();
   void Create(bool bAutoDelete = false, unsigned stacksize = 0);
   void Sleep(unsigned int milliseconds);
@@ -44,6 +45,8 @@ public:
   bool IsAutoDelete() const;
   virtual void StopThread(bool bWait = true);
   bool IsRunning() const;
+  const std::string& GetName() const { return m_ThreadName; }
+  XbmcThreads::ThreadClass GetThreadClass() const { return m_threadClass; }
 
   // -----------------------------------------------------------------------------------
   // These are platform specific and can be found in ./platform/[platform]/ThreadImpl.cpp
@@ -57,6 +60,13 @@ public:
   bool WaitForThreadExit(unsigned int milliseconds);
   float GetRelativeUsage();  // returns the relative cpu usage of this thread since last call
   int64_t GetAbsoluteUsage();
+
+  /**
+   * Apply the policy of the given class to the calling thread, threads
+   *  started by CThread do this themselves. Meant for threads not started
+   *  by CThread, like the main thread.
+   */
+  static bool SetCurrentThreadClass(XbmcThreads::ThreadClass threadClass);
   // -----------------------------------------------------------------------------------
 
   static bool IsCurrentThread(const ThreadIdentifier tid);
@@ -114,4 +124,5 @@ private:
   float m_fLastUsage;
 
   std::string m_ThreadName;
+  XbmcThreads::ThreadClass m_threadClass;
 };
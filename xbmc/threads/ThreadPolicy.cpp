@@ -0,0 +1,174 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "ThreadPolicy.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+
+#include "threads/Snapshot.h"
+
+namespace XbmcThreads
+{
+
+namespace
+{
+
+// more than any cpu set of the kernel can hold, guards against absurd ranges
+const long MAX_CPUS = 4096;
+
+struct PolicyState
+{
+  ThreadPolicy policies[THREAD_CLASS_COUNT];
+  std::vector<int> isolatedCpus;
+};
+
+std::vector<int> GetKernelIsolatedCpus()
+{
+  std::vector<int> cpus;
+#if defined(TARGET_LINUX) || defined(TARGET_ANDROID)
+  std::ifstream file("/sys/devices/system/cpu/isolated");
+  std::string list;
+  if (std::getline(file, list))
+    CThreadPolicies::ParseCpuList(list, cpus);
+#endif
+  return cpus;
+}
+
+std::shared_ptr<PolicyState> GetDefaultState()
+{
+  std::shared_ptr<PolicyState> state = std::make_shared<PolicyState>();
+  // the priorities these threads used to set for themselves, GetMinPriority() of the job workers
+  // is one level below the application but THREAD_PRIORITY_IDLE on windows
+#if defined(TARGET_WINDOWS)
+  const int backgroundNice = 19;
+#else
+  const int backgroundNice = 1;
+#endif
+  state->policies[THREAD_CLASS_AUDIO].nice = -1;
+  state->policies[THREAD_CLASS_BACKGROUND_IO].nice = backgroundNice;
+  state->policies[THREAD_CLASS_BACKGROUND_COMPUTE].nice = backgroundNice;
+  state->isolatedCpus = GetKernelIsolatedCpus();
+  return state;
+}
+
+CSnapshot<PolicyState>& GetPolicies()
+{
+  static CSnapshot<PolicyState> policies(GetDefaultState());
+  return policies;
+}
+
+}
+
+ThreadPolicy CThreadPolicies::Get(ThreadClass threadClass)
+{
+  if (threadClass < 0 || threadClass >= THREAD_CLASS_COUNT)
+    return ThreadPolicy();
+  return GetPolicies().Get()->policies[threadClass];
+}
+
+void CThreadPolicies::Set(ThreadClass threadClass, const ThreadPolicy& policy)
+{
+  if (threadClass < 0 || threadClass >= THREAD_CLASS_COUNT)
+    return;
+  GetPolicies().Update([threadClass, &policy](PolicyState& state) {
+    state.policies[threadClass] = policy;
+  });
+}
+
+std::vector<int> CThreadPolicies::GetIsolatedCpus()
+{
+  return GetPolicies().Get()->isolatedCpus;
+}
+
+void CThreadPolicies::SetIsolatedCpus(const std::vector<int>& cpus)
+{
+  GetPolicies().Update([&cpus](PolicyState& state) {
+    state.isolatedCpus = cpus;
+  });
+}
+
+void CThreadPolicies::Reset()
+{
+  GetPolicies().Publish(GetDefaultState());
+}
+
+bool CThreadPolicies::IsBackground(ThreadClass threadClass)
+{
+  return threadClass == THREAD_CLASS_BACKGROUND_IO || threadClass == THREAD_CLASS_BACKGROUND_COMPUTE;
+}
+
+const char* CThreadPolicies::GetName(ThreadClass threadClass)
+{
+  switch (threadClass)
+  {
+    case THREAD_CLASS_DEFAULT:
+      return "default";
+    case THREAD_CLASS_AUDIO:
+      return "audio";
+    case THREAD_CLASS_VIDEO_DECODE:
+      return "videodecode";
+    case THREAD_CLASS_RENDER:
+      return "render";
+    case THREAD_CLASS_BACKGROUND_IO:
+      return "backgroundio";
+    case THREAD_CLASS_BACKGROUND_COMPUTE:
+      return "backgroundcompute";
+    default:
+      return "unknown";
+  }
+}
+
+bool CThreadPolicies::ParseCpuList(const std::string& list, std::vector<int>& cpus)
+{
+  std::vector<int> result;
+  const char* pos = list.c_str();
+  while (isspace(*pos))
+    pos++;
+  while (*pos)
+  {
+    char* end;
+    const long first = strtol(pos, &end, 10);
+    if (end == pos || first < 0 || first >= MAX_CPUS)
+      return false;
+    long last = first;
+    pos = end;
+    if (*pos == '-')
+    {
+      last = strtol(++pos, &end, 10);
+      if (end == pos || last < first || last >= MAX_CPUS)
+        return false;
+      pos = end;
+    }
+    for (long cpu = first; cpu <= last; cpu++)
+      result.push_back(static_cast<int>(cpu));
+
+    while (isspace(*pos))
+      pos++;
+    if (*pos == ',')
+    {
+      pos++;
+      while (isspace(*pos))
+        pos++;
+      if (!*pos)
+        return false;
+    }
+    else if (*pos)
+      return false;
+  }
+
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  cpus.swap(result);
+  return true;
+}
+
+}
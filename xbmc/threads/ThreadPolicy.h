@@ -0,0 +1,77 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace XbmcThreads
+{
+  /**
+   * What a thread does, decides the scheduling policy it runs with.
+   */
+  enum ThreadClass
+  {
+    THREAD_CLASS_DEFAULT = 0,
+    THREAD_CLASS_AUDIO,                //!< audio engine and audio output, must never starve
+    THREAD_CLASS_VIDEO_DECODE,         //!< demuxing and decoding threads of the player
+    THREAD_CLASS_RENDER,               //!< the thread rendering the GUI and the video
+    THREAD_CLASS_BACKGROUND_IO,        //!< long running background work, mostly waiting for I/O
+    THREAD_CLASS_BACKGROUND_COMPUTE,   //!< background work like library scans and jobs
+    THREAD_CLASS_COUNT
+  };
+
+  /**
+   * How the threads of a class are scheduled.
+   */
+  struct ThreadPolicy
+  {
+    int nice = 0;                 //!< nice level relative to the application, positive values lower the priority
+    int realtimePriority = 0;     //!< run with SCHED_FIFO at this priority if > 0, falls back to nice if not permitted
+    std::vector<int> cpus;        //!< cpus to run on, empty for any cpu
+    std::string cgroup;           //!< directory of a threaded cgroup (v2) to move the threads to, empty for none
+  };
+
+  /**
+   * The scheduling policies of all thread classes. Threads apply the policy
+   *  of their class when they start, so changes only affect threads started
+   *  afterwards.
+   *
+   * Background classes never run on isolated cpus, those are left to the
+   *  classes that list them explicitly. By default the cpus isolated by the
+   *  kernel (isolcpus) are considered isolated.
+   */
+  class CThreadPolicies
+  {
+  public:
+    static ThreadPolicy Get(ThreadClass threadClass);
+    static void Set(ThreadClass threadClass, const ThreadPolicy& policy);
+
+    static std::vector<int> GetIsolatedCpus();
+    static void SetIsolatedCpus(const std::vector<int>& cpus);
+
+    /**
+     * Restore the default policies and isolated cpus.
+     */
+    static void Reset();
+
+    static bool IsBackground(ThreadClass threadClass);
+
+    /**
+     * Name of the class as used in advancedsettings.xml, e.g. "backgroundcompute".
+     */
+    static const char* GetName(ThreadClass threadClass);
+
+    /**
+     * Parse a list of cpus in the format of the kernel, e.g. "0-2,5".
+     * \return false if the list is malformed, an empty list is valid.
+     */
+    static bool ParseCpuList(const std::string& list, std::vector<int>& cpus);
+  };
+}
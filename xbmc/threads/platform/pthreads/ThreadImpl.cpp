@@ -13,12 +13,16 @@
 #include <sys/syscall.h>
 #endif
 #include <sys/resource.h>
+#include <sched.h>
+#include <stdio.h>
 #include <string.h>
 #ifdef TARGET_FREEBSD
 #include <sys/param.h>
 #include <pthread_np.h>
 #endif
 
+#include <algorithm>
+#include <atomic>
 #include <signal.h>
 #include "utils/log.h"
 
@@ -51,6 +55,53 @@ namespace XbmcThreads
     return &recursiveAttr;
   }
   // ==========================================================
+
+#if defined(TARGET_LINUX) || defined(TARGET_ANDROID)
+  // the cpus the process may run on, taken before any thread narrowed down its own
+  static cpu_set_t processCpus;
+  static bool processCpusSet = sched_getaffinity(0, sizeof(processCpus), &processCpus) == 0;
+#endif
+
+  // the nice level of the application, taken before any thread changed its own. On Linux that
+  // includes the main thread, whose nice level is the one getpriority() reports for the process.
+  static int processNice = getpriority(PRIO_PROCESS, getpid());
+
+#ifdef RLIMIT_NICE
+  // the lowest nice level threads may set, below the one of the application it needs root
+  // or an entry in limits.conf
+  static int GetMinNice()
+  {
+    if (geteuid() == 0)
+      return -20;
+
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NICE, &limit) != 0)
+      return processNice;
+    if (limit.rlim_cur == RLIM_INFINITY)
+      return -20;
+    return std::min(processNice, std::max(-20, 20 - static_cast<int>(limit.rlim_cur)));
+  }
+#endif
+
+  static pid_t GetCurrentLwpId()
+  {
+#ifdef TARGET_FREEBSD
+    return pthread_getthreadid_np();
+#elif defined(TARGET_ANDROID)
+    return gettid();
+#else
+    return syscall(SYS_gettid);
+#endif
+  }
+
+  // warn only once per class, not for every thread started
+  static void WarnPolicy(ThreadClass threadClass, const std::string& what)
+  {
+    static std::atomic<bool> warned[THREAD_CLASS_COUNT];
+    if (!warned[threadClass].exchange(true))
+      CLog::Log(LOGWARNING, "CThread::SetCurrentThreadClass - failed to apply %s to %s threads: %s",
+                what.c_str(), CThreadPolicies::GetName(threadClass), strerror(errno));
+  }
 }
 void CThread::SpawnThread(unsigned stacksize)
 {
@@ -72,13 +123,7 @@ void CThread::TermHandler() { }
 
 void CThread::SetThreadInfo()
 {
-#ifdef TARGET_FREEBSD
-  m_ThreadOpaque.LwpId = pthread_getthreadid_np();
-#elif defined(TARGET_ANDROID)
-  m_ThreadOpaque.LwpId = gettid();
-#else
-  m_ThreadOpaque.LwpId = syscall(SYS_gettid);
-#endif
+  m_ThreadOpaque.LwpId = XbmcThreads::GetCurrentLwpId();
 
 #if defined(TARGET_DARWIN)
   pthread_setname_np(m_ThreadName.c_str());
@@ -107,13 +152,124 @@ void CThread::SetThreadInfo()
   if (userMaxPrio > 0)
   {
     // start thread with nice level of application
-    int appNice = getpriority(PRIO_PROCESS, getpid());
-    if (setpriority(PRIO_PROCESS, m_ThreadOpaque.LwpId, appNice) != 0)
+    if (setpriority(PRIO_PROCESS, m_ThreadOpaque.LwpId, XbmcThreads::processNice) != 0)
       CLog::Log(LOGERROR, "%s: error %s", __FUNCTION__, strerror(errno));
   }
 #endif
 }
 
+bool CThread::SetCurrentThreadClass(XbmcThreads::ThreadClass threadClass)
+{
+  using namespace XbmcThreads;
+
+  if (threadClass < 0 || threadClass >= THREAD_CLASS_COUNT)
+    return false;
+
+  const ThreadPolicy policy = CThreadPolicies::Get(threadClass);
+  const pid_t lwpId = GetCurrentLwpId();
+  bool result = true;
+
+  // threads inherit the scheduling policy of the thread starting them, go
+  // back to the default one unless the class asks for real time scheduling
+  bool realtime = false;
+  int schedPolicy;
+  sched_param param;
+  if (pthread_getschedparam(pthread_self(), &schedPolicy, &param) == 0)
+  {
+    if (policy.realtimePriority > 0)
+    {
+      param.sched_priority = std::max(sched_get_priority_min(SCHED_FIFO),
+                                      std::min(policy.realtimePriority, sched_get_priority_max(SCHED_FIFO)));
+      const int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+      realtime = error == 0;
+      if (!realtime)
+      {
+        errno = error;
+        WarnPolicy(threadClass, "real time scheduling");
+        result = false;
+      }
+    }
+    if (!realtime && schedPolicy != SCHED_OTHER)
+    {
+      param.sched_priority = 0;
+      pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+    }
+  }
+
+#ifdef RLIMIT_NICE
+  if (!realtime && policy.nice != 0)
+  {
+    // raising the priority above the one of the application needs an entry
+    // in limits.conf, without it the thread stays at the application's level
+    const int nice = std::max(GetMinNice(), std::min(19, processNice + policy.nice));
+    if (setpriority(PRIO_PROCESS, lwpId, nice) != 0)
+    {
+      WarnPolicy(threadClass, "nice level");
+      result = false;
+    }
+  }
+#endif
+
+#if defined(TARGET_LINUX) || defined(TARGET_ANDROID)
+  if (processCpusSet)
+  {
+    // threads inherit the affinity of the thread starting them as well, only
+    // configured cpus the process may run on are used
+    cpu_set_t cpus;
+    if (policy.cpus.empty())
+      cpus = processCpus;
+    else
+    {
+      CPU_ZERO(&cpus);
+      for (int cpu : policy.cpus)
+      {
+        if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &processCpus))
+          CPU_SET(cpu, &cpus);
+      }
+    }
+    if (CThreadPolicies::IsBackground(threadClass))
+    {
+      for (int cpu : CThreadPolicies::GetIsolatedCpus())
+      {
+        if (cpu < CPU_SETSIZE)
+          CPU_CLR(cpu, &cpus);
+      }
+    }
+    if (CPU_COUNT(&cpus) == 0)
+      cpus = processCpus;
+
+    cpu_set_t current;
+    if (sched_getaffinity(0, sizeof(current), &current) != 0 || !CPU_EQUAL(&current, &cpus))
+    {
+      if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0)
+      {
+        WarnPolicy(threadClass, "cpu affinity");
+        result = false;
+      }
+    }
+  }
+
+  if (!policy.cgroup.empty())
+  {
+    // the cgroup has to be a threaded one (cgroup v2) writable by the user
+    bool moved = false;
+    FILE* file = fopen((policy.cgroup + "/cgroup.threads").c_str(), "w");
+    if (file)
+    {
+      moved = fprintf(file, "%d\n", static_cast<int>(lwpId)) > 0;
+      moved = fclose(file) == 0 && moved;
+    }
+    if (!moved)
+    {
+      WarnPolicy(threadClass, "cgroup " + policy.cgroup);
+      result = false;
+    }
+  }
+#endif
+
+  return result;
+}
+
 ThreadIdentifier CThread::GetCurrentThreadId()
 {
   return pthread_self();
@@ -194,7 +350,7 @@ bool CThread::SetPriority(const int iPriority)
       prio = GetMinPriority();
 
     // nice level of application
-    int appNice = getpriority(PRIO_PROCESS, getpid());
+    const int appNice = XbmcThreads::processNice;
     if (prio)
       prio = prio > 0 ? appNice-1 : appNice+1;
 
@@ -217,7 +373,7 @@ int CThread::GetPriority()
 
   CSingleLock lock(m_CriticalSection);
 
-  int appNice = getpriority(PRIO_PROCESS, getpid());
+  int appNice = XbmcThreads::processNice;
   int prio = getpriority(PRIO_PROCESS, m_ThreadOpaque.LwpId);
   iReturn = appNice - prio;
 
@@ -80,6 +80,66 @@ bool CThread::IsCurrentThread(const ThreadIdentifier tid)
   return (::GetCurrentThreadId() == tid);
 }
 
+bool CThread::SetCurrentThreadClass(XbmcThreads::ThreadClass threadClass)
+{
+  using namespace XbmcThreads;
+
+  if (threadClass < 0 || threadClass >= THREAD_CLASS_COUNT)
+    return false;
+
+  const ThreadPolicy policy = CThreadPolicies::Get(threadClass);
+  bool result = true;
+
+  // map nice levels to the few priorities windows threads have
+  int priority = THREAD_PRIORITY_NORMAL;
+  if (policy.realtimePriority > 0)
+    priority = THREAD_PRIORITY_TIME_CRITICAL;
+  else if (policy.nice <= -5)
+    priority = THREAD_PRIORITY_HIGHEST;
+  else if (policy.nice < 0)
+    priority = THREAD_PRIORITY_ABOVE_NORMAL;
+  else if (policy.nice >= 19)
+    priority = THREAD_PRIORITY_IDLE;
+  else if (policy.nice >= 5)
+    priority = THREAD_PRIORITY_LOWEST;
+  else if (policy.nice > 0)
+    priority = THREAD_PRIORITY_BELOW_NORMAL;
+  if (!SetThreadPriority(::GetCurrentThread(), priority))
+    result = false;
+
+  DWORD_PTR processMask;
+  DWORD_PTR systemMask;
+  if (GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask))
+  {
+    DWORD_PTR mask = 0;
+    if (policy.cpus.empty())
+      mask = processMask;
+    for (int cpu : policy.cpus)
+    {
+      if (cpu < static_cast<int>(sizeof(DWORD_PTR) * 8))
+        mask |= static_cast<DWORD_PTR>(1) << cpu;
+    }
+    if (CThreadPolicies::IsBackground(threadClass))
+    {
+      for (int cpu : CThreadPolicies::GetIsolatedCpus())
+      {
+        if (cpu < static_cast<int>(sizeof(DWORD_PTR) * 8))
+          mask &= ~(static_cast<DWORD_PTR>(1) << cpu);
+      }
+    }
+    mask &= processMask;
+    if (!mask)
+      mask = processMask;
+    if (!SetThreadAffinityMask(::GetCurrentThread(), mask))
+      result = false;
+  }
+
+  if (!result)
+    CLog::Log(LOGDEBUG, "%s - failed to apply the policy of %s threads, error %d", __FUNCTION__,
+              CThreadPolicies::GetName(threadClass), GetLastError());
+  return result;
+}
+
 int CThread::GetMinPriority(void)
 {
   return(THREAD_PRIORITY_IDLE);
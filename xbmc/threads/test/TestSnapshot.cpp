@@ -0,0 +1,202 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+#include "threads/Snapshot.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+const int BENCHMARK_FRAMES = 500;
+const int BENCHMARK_READS_PER_FRAME = 50;
+const int BENCHMARK_FRAME_INTERVAL_US = 1000;
+const int BENCHMARK_ADDON_CALL_US = 300;
+const int BENCHMARK_UPDATE_INTERVAL_US = 500;
+
+// looks like the state of a GUI info provider
+struct State
+{
+  int counter = 0;
+  bool isPlaying = false;
+  std::string clientName;
+  std::string backendName;
+  std::string channelGroup;
+};
+
+void Modify(State& state, int i)
+{
+  state.counter = i;
+  state.isPlaying = i % 2 == 0;
+  state.clientName = "client " + std::to_string(i) + " with a name that is long enough to be allocated";
+  state.backendName = "backend " + std::to_string(i) + " with a name that is long enough to be allocated";
+  state.channelGroup = "All channels";
+}
+
+//! Counts how often and how long the calling thread waits for a lock held by another thread
+class CContentionCounter
+{
+public:
+  void Lock(CCriticalSection& section)
+  {
+    if (section.try_lock())
+      return;
+
+    const auto start = std::chrono::steady_clock::now();
+    section.lock();
+    m_waited += std::chrono::steady_clock::now() - start;
+    m_contended++;
+  }
+
+  int m_contended = 0;
+  std::chrono::steady_clock::duration m_waited = std::chrono::steady_clock::duration::zero();
+};
+
+double Microseconds(std::chrono::steady_clock::duration duration)
+{
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+// stands in for a call into a PVR add-on, which may have to ask the backend
+int FetchFromAddon(int i)
+{
+  std::this_thread::sleep_for(std::chrono::microseconds(BENCHMARK_ADDON_CALL_US));
+  return i;
+}
+
+//! Returns the sorted times the reads of each frame took
+template<typename F>
+std::vector<double> RenderFrames(F read)
+{
+  std::vector<double> frames;
+  frames.reserve(BENCHMARK_FRAMES);
+  for (int frame = 0; frame < BENCHMARK_FRAMES; frame++)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_READS_PER_FRAME; i++)
+      read();
+    frames.push_back(Microseconds(std::chrono::steady_clock::now() - start));
+    std::this_thread::sleep_for(std::chrono::microseconds(BENCHMARK_FRAME_INTERVAL_US));
+  }
+  std::sort(frames.begin(), frames.end());
+  return frames;
+}
+
+}
+
+TEST(TestSnapshot, Publish)
+{
+  CSnapshot<State> snapshot;
+  EXPECT_EQ(0, snapshot.Get()->counter);
+
+  std::shared_ptr<State> state = std::make_shared<State>();
+  state->counter = 1;
+  snapshot.Publish(state);
+  EXPECT_EQ(1, snapshot.Get()->counter);
+}
+
+TEST(TestSnapshot, ReadersKeepTheirVersion)
+{
+  CSnapshot<State> snapshot;
+  snapshot.Update([](State& state) { Modify(state, 1); });
+
+  const std::shared_ptr<const State> before = snapshot.Get();
+  snapshot.Update([](State& state) { Modify(state, 2); });
+
+  EXPECT_EQ(1, before->counter);
+  EXPECT_EQ(2, snapshot.Get()->counter);
+  EXPECT_NE(before->clientName, snapshot.Get()->clientName);
+}
+
+TEST(TestSnapshot, ConcurrentUpdates)
+{
+  const int threadCount = 4;
+  const int updates = 1000;
+  CSnapshot<State> snapshot;
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < threadCount; i++)
+  {
+    threads.emplace_back([&snapshot]() {
+      for (int update = 0; update < updates; update++)
+        snapshot.Update([](State& state) { state.counter++; });
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(threadCount * updates, snapshot.Get()->counter);
+}
+
+TEST(TestSnapshot, DISABLED_BenchmarkRenderThreadReads)
+{
+  // the render thread reading labels every frame while a background thread
+  // refreshes the provider state from slow add-on calls, first with the state
+  // behind a lock, then published as snapshots
+  std::atomic<bool> stop(false);
+  size_t length = 0;
+
+  CCriticalSection section;
+  State lockedState;
+  CContentionCounter counter;
+  std::thread lockedWriter([&]() {
+    for (int i = 0; !stop; i++)
+    {
+      {
+        CSingleLock lock(section);
+        const int value = FetchFromAddon(i);
+        Modify(lockedState, value);
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds(BENCHMARK_UPDATE_INTERVAL_US));
+    }
+  });
+
+  std::vector<double> lockedFrames = RenderFrames([&]() {
+    counter.Lock(section);
+    length += lockedState.clientName.size() + lockedState.backendName.size();
+    section.unlock();
+  });
+  stop = true;
+  lockedWriter.join();
+
+  stop = false;
+  CSnapshot<State> snapshot;
+  std::thread snapshotWriter([&]() {
+    for (int i = 0; !stop; i++)
+    {
+      const int value = FetchFromAddon(i);
+      snapshot.Update([value](State& state) { Modify(state, value); });
+      std::this_thread::sleep_for(std::chrono::microseconds(BENCHMARK_UPDATE_INTERVAL_US));
+    }
+  });
+
+  std::vector<double> snapshotFrames = RenderFrames([&]() {
+    const std::shared_ptr<const State> state = snapshot.Get();
+    length += state->clientName.size() + state->backendName.size();
+  });
+  stop = true;
+  snapshotWriter.join();
+
+  printf("%d frames, %d reads each: locked median %.1f us, worst %.1f us per frame, "
+         "%d of %d reads waited %.2f ms in total; snapshot median %.1f us, worst %.1f us per frame\n",
+         BENCHMARK_FRAMES, BENCHMARK_READS_PER_FRAME, lockedFrames[lockedFrames.size() / 2],
+         lockedFrames.back(), counter.m_contended, BENCHMARK_FRAMES * BENCHMARK_READS_PER_FRAME,
+         Microseconds(counter.m_waited) / 1000, snapshotFrames[snapshotFrames.size() / 2],
+         snapshotFrames.back());
+  EXPECT_NE(0u, length);
+}
@@ -0,0 +1,318 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#if defined(TARGET_LINUX)
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "threads/Thread.h"
+#include "threads/ThreadPolicy.h"
+
+#include "gtest/gtest.h"
+
+using namespace XbmcThreads;
+
+namespace
+{
+
+const int BENCHMARK_AUDIO_PERIOD_US = 2000;
+const int BENCHMARK_AUDIO_CALLBACKS = 1000;
+
+class CFunctionThread : public CThread
+{
+public:
+  CFunctionThread(ThreadClass threadClass, std::function<void()> function)
+  : CThread("TestThreadPolicy", threadClass), m_function(std::move(function))
+  {
+  }
+
+  ~CFunctionThread() override { StopThread(); }
+
+protected:
+  void Process() override { m_function(); }
+
+private:
+  std::function<void()> m_function;
+};
+
+void RunThread(ThreadClass threadClass, std::function<void()> function)
+{
+  CFunctionThread thread(threadClass, std::move(function));
+  thread.Create();
+  thread.WaitForThreadExit(10000);
+}
+
+//! Resets the policies when a test is done with them
+class CPolicyGuard
+{
+public:
+  ~CPolicyGuard() { CThreadPolicies::Reset(); }
+};
+
+}
+
+TEST(TestThreadPolicy, ParseCpuList)
+{
+  std::vector<int> cpus;
+  EXPECT_TRUE(CThreadPolicies::ParseCpuList("0-2,5, 7", cpus));
+  EXPECT_EQ(std::vector<int>({ 0, 1, 2, 5, 7 }), cpus);
+  EXPECT_TRUE(CThreadPolicies::ParseCpuList("3,1-2,2\n", cpus));
+  EXPECT_EQ(std::vector<int>({ 1, 2, 3 }), cpus);
+  EXPECT_TRUE(CThreadPolicies::ParseCpuList("", cpus));
+  EXPECT_TRUE(cpus.empty());
+
+  cpus = { 4 };
+  EXPECT_FALSE(CThreadPolicies::ParseCpuList("2-1", cpus));
+  EXPECT_FALSE(CThreadPolicies::ParseCpuList("1,", cpus));
+  EXPECT_FALSE(CThreadPolicies::ParseCpuList("a", cpus));
+  EXPECT_FALSE(CThreadPolicies::ParseCpuList("0-100000", cpus));
+  EXPECT_EQ(std::vector<int>({ 4 }), cpus);
+}
+
+TEST(TestThreadPolicy, SetAndReset)
+{
+  CPolicyGuard guard;
+  EXPECT_EQ(-1, CThreadPolicies::Get(THREAD_CLASS_AUDIO).nice);
+#if defined(TARGET_WINDOWS)
+  EXPECT_EQ(19, CThreadPolicies::Get(THREAD_CLASS_BACKGROUND_COMPUTE).nice);
+#else
+  EXPECT_EQ(1, CThreadPolicies::Get(THREAD_CLASS_BACKGROUND_COMPUTE).nice);
+#endif
+
+  ThreadPolicy policy;
+  policy.realtimePriority = 10;
+  policy.cpus = { 1 };
+  CThreadPolicies::Set(THREAD_CLASS_AUDIO, policy);
+  CThreadPolicies::SetIsolatedCpus({ 1 });
+  EXPECT_EQ(10, CThreadPolicies::Get(THREAD_CLASS_AUDIO).realtimePriority);
+  EXPECT_EQ(std::vector<int>({ 1 }), CThreadPolicies::Get(THREAD_CLASS_AUDIO).cpus);
+  EXPECT_EQ(std::vector<int>({ 1 }), CThreadPolicies::GetIsolatedCpus());
+
+  CThreadPolicies::Reset();
+  EXPECT_EQ(0, CThreadPolicies::Get(THREAD_CLASS_AUDIO).realtimePriority);
+  EXPECT_TRUE(CThreadPolicies::Get(THREAD_CLASS_AUDIO).cpus.empty());
+}
+
+#if defined(TARGET_LINUX)
+TEST(TestThreadPolicy, NiceLevel)
+{
+  CPolicyGuard guard;
+  ThreadPolicy policy;
+  policy.nice = 5;
+  CThreadPolicies::Set(THREAD_CLASS_BACKGROUND_COMPUTE, policy);
+
+  const int appNice = getpriority(PRIO_PROCESS, getpid());
+  int nice = appNice;
+  RunThread(THREAD_CLASS_BACKGROUND_COMPUTE, [&nice]() {
+    nice = getpriority(PRIO_PROCESS, syscall(SYS_gettid));
+  });
+  EXPECT_EQ(std::min(19, appNice + 5), nice);
+}
+
+TEST(TestThreadPolicy, NiceLevelRelativeToApplication)
+{
+  // the nice level of the main thread is the one reported for the process and can't be raised
+  // again, so the main thread of a child process gets the render policy
+  const int appNice = getpriority(PRIO_PROCESS, getpid());
+  const pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0)
+  {
+    // threads inherit the level of the main thread, going back below it needs permission
+    struct rlimit limit;
+    if (geteuid() != 0 && (getrlimit(RLIMIT_NICE, &limit) != 0 ||
+                           (limit.rlim_cur != RLIM_INFINITY && static_cast<int>(limit.rlim_cur) < 20 - (appNice + 1))))
+      _exit(0);
+
+    ThreadPolicy render;
+    render.nice = 2;
+    CThreadPolicies::Set(THREAD_CLASS_RENDER, render);
+    CThread::SetCurrentThreadClass(THREAD_CLASS_RENDER);
+
+    int nice = appNice;
+    RunThread(THREAD_CLASS_BACKGROUND_COMPUTE, [&nice]() {
+      nice = getpriority(PRIO_PROCESS, syscall(SYS_gettid));
+    });
+    _exit(nice == std::min(19, appNice + 1) ? 0 : 1);
+  }
+
+  int status = 0;
+  ASSERT_EQ(pid, waitpid(pid, &status, 0));
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(0, WEXITSTATUS(status));
+}
+
+TEST(TestThreadPolicy, NiceLevelNotRaisedWithoutPermission)
+{
+  // without an entry in limits.conf audio threads stay at the application's level
+  const int appNice = getpriority(PRIO_PROCESS, getpid());
+  const pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0)
+  {
+    struct rlimit limit = { 0, 0 };
+    if (setrlimit(RLIMIT_NICE, &limit) != 0)
+      _exit(2);
+
+    bool applied = false;
+    int nice = 20;
+    RunThread(THREAD_CLASS_DEFAULT, [&applied, &nice]() {
+      applied = CThread::SetCurrentThreadClass(THREAD_CLASS_AUDIO);
+      nice = getpriority(PRIO_PROCESS, syscall(SYS_gettid));
+    });
+    const int expected = geteuid() == 0 ? std::max(-20, appNice - 1) : appNice;
+    _exit(applied && nice == expected ? 0 : 1);
+  }
+
+  int status = 0;
+  ASSERT_EQ(pid, waitpid(pid, &status, 0));
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(0, WEXITSTATUS(status));
+}
+
+TEST(TestThreadPolicy, BackgroundAvoidsIsolatedCpus)
+{
+  CPolicyGuard guard;
+  cpu_set_t processCpus;
+  ASSERT_EQ(0, sched_getaffinity(0, sizeof(processCpus), &processCpus));
+  int firstCpu = 0;
+  while (!CPU_ISSET(firstCpu, &processCpus))
+    firstCpu++;
+
+  CThreadPolicies::SetIsolatedCpus({ firstCpu });
+  ThreadPolicy policy;
+  policy.cpus = { firstCpu };
+  CThreadPolicies::Set(THREAD_CLASS_AUDIO, policy);
+
+  cpu_set_t backgroundCpus;
+  cpu_set_t audioCpus;
+  RunThread(THREAD_CLASS_BACKGROUND_COMPUTE, [&backgroundCpus]() {
+    sched_getaffinity(0, sizeof(backgroundCpus), &backgroundCpus);
+  });
+  RunThread(THREAD_CLASS_AUDIO, [&audioCpus]() {
+    sched_getaffinity(0, sizeof(audioCpus), &audioCpus);
+  });
+
+  EXPECT_EQ(1, CPU_COUNT(&audioCpus));
+  EXPECT_TRUE(CPU_ISSET(firstCpu, &audioCpus));
+  if (CPU_COUNT(&processCpus) > 1)
+  {
+    EXPECT_FALSE(CPU_ISSET(firstCpu, &backgroundCpus));
+    EXPECT_EQ(CPU_COUNT(&processCpus) - 1, CPU_COUNT(&backgroundCpus));
+  }
+  else
+  {
+    // isolating the only cpu leaves background threads where they were
+    EXPECT_TRUE(CPU_EQUAL(&processCpus, &backgroundCpus));
+  }
+}
+
+TEST(TestThreadPolicy, RealtimeFallsBack)
+{
+  CPolicyGuard guard;
+  ThreadPolicy policy;
+  policy.realtimePriority = 1;
+  CThreadPolicies::Set(THREAD_CLASS_AUDIO, policy);
+
+  bool applied = false;
+  int schedPolicy = -1;
+  RunThread(THREAD_CLASS_AUDIO, [&applied, &schedPolicy]() {
+    applied = CThread::SetCurrentThreadClass(THREAD_CLASS_AUDIO);
+    sched_param param;
+    pthread_getschedparam(pthread_self(), &schedPolicy, &param);
+
+    // threads started from a real time thread don't stay real time
+    RunThread(THREAD_CLASS_DEFAULT, []() {
+      int childPolicy;
+      sched_param childParam;
+      pthread_getschedparam(pthread_self(), &childPolicy, &childParam);
+      EXPECT_EQ(SCHED_OTHER, childPolicy);
+    });
+  });
+
+  // without permission for real time scheduling the thread keeps the default one
+  EXPECT_EQ(applied ? SCHED_FIFO : SCHED_OTHER, schedPolicy);
+}
+#endif
+
+TEST(TestThreadPolicy, DISABLED_BenchmarkAudioJitterUnderScanLoad)
+{
+  // an audio output thread waking up every period while library scans keep
+  // all cpus busy, first with every thread in the default class, then with
+  // the policies for audio and background threads
+  const int scanThreads = std::max(2u, std::thread::hardware_concurrency()) * 2;
+  CPolicyGuard guard;
+
+  auto measure = [scanThreads](ThreadClass audioClass, ThreadClass scanClass) {
+    std::atomic<bool> stop(false);
+    std::vector<std::unique_ptr<CFunctionThread>> scans;
+    for (int i = 0; i < scanThreads; i++)
+    {
+      scans.emplace_back(new CFunctionThread(scanClass, [&stop]() {
+        volatile unsigned int hash = 0;
+        while (!stop)
+        {
+          for (unsigned int i = 0; i < 10000; i++)
+            hash = hash * 31 + i;
+        }
+      }));
+      scans.back()->Create();
+    }
+
+    std::vector<double> lateness;
+    lateness.reserve(BENCHMARK_AUDIO_CALLBACKS);
+    RunThread(audioClass, [&lateness]() {
+      const std::chrono::microseconds period(BENCHMARK_AUDIO_PERIOD_US);
+      auto next = std::chrono::steady_clock::now() + period;
+      for (int i = 0; i < BENCHMARK_AUDIO_CALLBACKS; i++)
+      {
+        std::this_thread::sleep_until(next);
+        const auto now = std::chrono::steady_clock::now();
+        lateness.push_back(std::chrono::duration<double, std::micro>(now - next).count());
+        next += period;
+        if (next < now)
+          next = now + period;
+      }
+    });
+
+    stop = true;
+    scans.clear();
+    std::sort(lateness.begin(), lateness.end());
+    return lateness;
+  };
+
+  const std::vector<double> unmanaged = measure(THREAD_CLASS_DEFAULT, THREAD_CLASS_DEFAULT);
+
+  ThreadPolicy audio;
+  audio.realtimePriority = 10;
+  audio.nice = -10;
+  CThreadPolicies::Set(THREAD_CLASS_AUDIO, audio);
+  ThreadPolicy background;
+  background.nice = 19;
+  CThreadPolicies::Set(THREAD_CLASS_BACKGROUND_COMPUTE, background);
+  const std::vector<double> managed = measure(THREAD_CLASS_AUDIO, THREAD_CLASS_BACKGROUND_COMPUTE);
+
+  printf("audio callbacks every %d us with %d scan threads: default classes median %.0f us, "
+         "99th percentile %.0f us, worst %.0f us late; with policies median %.0f us, 99th percentile %.0f us, worst %.0f us late\n",
+         BENCHMARK_AUDIO_PERIOD_US, scanThreads, unmanaged[unmanaged.size() / 2],
+         unmanaged[unmanaged.size() * 99 / 100], unmanaged.back(), managed[managed.size() / 2],
+         managed[managed.size() * 99 / 100], managed.back());
+}
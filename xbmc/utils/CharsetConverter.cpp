@@ -71,6 +71,12 @@
   #endif
 #endif
 
+#if !defined(TARGET_DARWIN)
+  /* UTF8_SOURCE is plain UTF-8, so conversions between UTF-8 and the Unicode encodings don't need
+     iconv. On darwin "UTF-8-MAC" composes decomposed characters which is left to iconv. */
+  #define UTF8_SOURCE_IS_UTF8 1
+#endif
+
 #define NO_ICONV ((iconv_t)-1)
 
 enum SpecialCharset
@@ -279,6 +285,10 @@ public:
   template<class INPUT,class OUTPUT>
   static bool convert(iconv_t type, int multiplier, const INPUT& strSource, OUTPUT& strDest, bool failOnInvalidChar = false);
 
+  static bool utf8ToUtf32(const std::string& strSource, std::u32string& strDest, bool failOnInvalidChar);
+  static bool utf8ToW(const std::string& strSource, std::wstring& strDest, bool failOnInvalidChar);
+  static bool utf32ToW(const std::u32string& strSource, std::wstring& strDest, bool failOnInvalidChar);
+
   static CConverterType m_stdConversion[NumberOfStdConversionTypes];
   static CCriticalSection m_critSectionFriBiDi;
 };
@@ -465,6 +475,35 @@ bool CCharsetConverter::CInnerConverter::convert(iconv_t type, int multiplier, c
   return true;
 }
 
+bool CCharsetConverter::CInnerConverter::utf8ToUtf32(const std::string& strSource, std::u32string& strDest, bool failOnInvalidChar)
+{
+#ifdef UTF8_SOURCE_IS_UTF8
+  return CUtf8Utils::Utf8ToUtf32(strSource, strDest, failOnInvalidChar);
+#else
+  return stdConvert(Utf8ToUtf32, strSource, strDest, failOnInvalidChar);
+#endif
+}
+
+bool CCharsetConverter::CInnerConverter::utf8ToW(const std::string& strSource, std::wstring& strDest, bool failOnInvalidChar)
+{
+#ifdef UTF8_SOURCE_IS_UTF8
+  return CUtf8Utils::Utf8ToW(strSource, strDest, failOnInvalidChar);
+#else
+  return stdConvert(Utf8toW, strSource, strDest, failOnInvalidChar);
+#endif
+}
+
+bool CCharsetConverter::CInnerConverter::utf32ToW(const std::u32string& strSource, std::wstring& strDest, bool failOnInvalidChar)
+{
+  // wchar_t holds UTF-32 on all platforms except windows
+  if (sizeof(wchar_t) == sizeof(char32_t))
+  {
+    strDest.assign(strSource.begin(), strSource.end());
+    return true;
+  }
+  return stdConvert(Utf32ToW, strSource, strDest, failOnInvalidChar);
+}
+
 bool CCharsetConverter::CInnerConverter::logicalToVisualBiDi(const std::u32string& stringSrc, std::u32string& stringDst, FriBidiCharType base /*= FRIBIDI_TYPE_LTR*/, const bool failOnBadString /*= false*/)
 {
   stringDst.clear();
@@ -634,7 +673,7 @@ void CCharsetConverter::reinitCharsetsFromSettings(void)
 
 bool CCharsetConverter::utf8ToUtf32(const std::string& utf8StringSrc, std::u32string& utf32StringDst, bool failOnBadChar /*= true*/)
 {
-  return CInnerConverter::stdConvert(Utf8ToUtf32, utf8StringSrc, utf32StringDst, failOnBadChar);
+  return CInnerConverter::utf8ToUtf32(utf8StringSrc, utf32StringDst, failOnBadChar);
 }
 
 std::u32string CCharsetConverter::utf8ToUtf32(const std::string& utf8StringSrc, bool failOnBadChar /*= true*/)
@@ -649,17 +688,17 @@ bool CCharsetConverter::utf8ToUtf32Visual(const std::string& utf8StringSrc, std:
   if (bVisualBiDiFlip)
   {
     std::u32string converted;
-    if (!CInnerConverter::stdConvert(Utf8ToUtf32, utf8StringSrc, converted, failOnBadChar))
+    if (!CInnerConverter::utf8ToUtf32(utf8StringSrc, converted, failOnBadChar))
       return false;
 
     return CInnerConverter::logicalToVisualBiDi(converted, utf32StringDst, forceLTRReadingOrder ? FRIBIDI_TYPE_LTR : FRIBIDI_TYPE_PDF, failOnBadChar);
   }
-  return CInnerConverter::stdConvert(Utf8ToUtf32, utf8StringSrc, utf32StringDst, failOnBadChar);
+  return CInnerConverter::utf8ToUtf32(utf8StringSrc, utf32StringDst, failOnBadChar);
 }
 
 bool CCharsetConverter::utf32ToUtf8(const std::u32string& utf32StringSrc, std::string& utf8StringDst, bool failOnBadChar /*= true*/)
 {
-  return CInnerConverter::stdConvert(Utf32ToUtf8, utf32StringSrc, utf8StringDst, failOnBadChar);
+  return CUtf8Utils::Utf32ToUtf8(utf32StringSrc, utf8StringDst, failOnBadChar);
 }
 
 std::string CCharsetConverter::utf32ToUtf8(const std::u32string& utf32StringSrc, bool failOnBadChar /*= false*/)
@@ -703,16 +742,16 @@ bool CCharsetConverter::utf8ToW(const std::string& utf8StringSrc, std::wstring&
   {
     wStringDst.clear();
     std::u32string utf32str;
-    if (!CInnerConverter::stdConvert(Utf8ToUtf32, utf8StringSrc, utf32str, failOnBadChar))
+    if (!CInnerConverter::utf8ToUtf32(utf8StringSrc, utf32str, failOnBadChar))
       return false;
 
     std::u32string utf32flipped;
     const bool bidiResult = CInnerConverter::logicalToVisualBiDi(utf32str, utf32flipped, forceLTRReadingOrder ? FRIBIDI_TYPE_LTR : FRIBIDI_TYPE_PDF, failOnBadChar);
 
-    return CInnerConverter::stdConvert(Utf32ToW, utf32flipped, wStringDst, failOnBadChar) && bidiResult;
+    return CInnerConverter::utf32ToW(utf32flipped, wStringDst, failOnBadChar) && bidiResult;
   }
 
-  return CInnerConverter::stdConvert(Utf8toW, utf8StringSrc, wStringDst, failOnBadChar);
+  return CInnerConverter::utf8ToW(utf8StringSrc, wStringDst, failOnBadChar);
 }
 
 bool CCharsetConverter::subtitleCharsetToUtf8(const std::string& stringSrc, std::string& utf8StringDst)
@@ -794,18 +833,26 @@ bool CCharsetConverter::unknownToUTF8(const std::string& stringSrc, std::string&
 
 bool CCharsetConverter::wToUTF8(const std::wstring& wStringSrc, std::string& utf8StringDst, bool failOnBadChar /*= false*/)
 {
-  return CInnerConverter::stdConvert(WtoUtf8, wStringSrc, utf8StringDst, failOnBadChar);
+  return CUtf8Utils::WToUtf8(wStringSrc, utf8StringDst, failOnBadChar);
 }
 
 bool CCharsetConverter::utf16BEtoUTF8(const std::u16string& utf16StringSrc, std::string& utf8StringDst)
 {
-  return CInnerConverter::stdConvert(Utf16BEtoUtf8, utf16StringSrc, utf8StringDst);
+#ifdef WORDS_BIGENDIAN
+  return CUtf8Utils::Utf16ToUtf8(utf16StringSrc, utf8StringDst, false, false);
+#else
+  return CUtf8Utils::Utf16ToUtf8(utf16StringSrc, utf8StringDst, true, false);
+#endif
 }
 
 bool CCharsetConverter::utf16LEtoUTF8(const std::u16string& utf16StringSrc,
                                       std::string& utf8StringDst)
 {
-  return CInnerConverter::stdConvert(Utf16LEtoUtf8, utf16StringSrc, utf8StringDst);
+#ifdef WORDS_BIGENDIAN
+  return CUtf8Utils::Utf16ToUtf8(utf16StringSrc, utf8StringDst, true, false);
+#else
+  return CUtf8Utils::Utf16ToUtf8(utf16StringSrc, utf8StringDst, false, false);
+#endif
 }
 
 bool CCharsetConverter::ucs2ToUTF8(const std::u16string& ucs2StringSrc, std::string& utf8StringDst)
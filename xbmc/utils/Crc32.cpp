@@ -7,7 +7,15 @@
  */
 
 #include "Crc32.h"
-#include "utils/StringUtils.h"
+
+#include <algorithm>
+#include <ctype.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRC32_HAVE_CLMUL
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
 
 uint32_t  crc_tab[256] =
 {
@@ -77,6 +85,142 @@ uint32_t  crc_tab[256] =
  0xBCB4666DL, 0xB8757BDAL, 0xB5365D03L, 0xB1F740B4L
 };
 
+namespace
+{
+
+const uint32_t CRC_POLYNOMIAL = 0x04C11DB7;
+
+// x^n mod P
+uint32_t XPowMod(unsigned int n)
+{
+  uint32_t remainder = 1;
+  while (n--)
+    remainder = (remainder & 0x80000000) ? (remainder << 1) ^ CRC_POLYNOMIAL : remainder << 1;
+  return remainder;
+}
+
+struct CrcTables
+{
+  CrcTables()
+  {
+    for (int byte = 0; byte < 256; byte++)
+    {
+      slices[0][byte] = crc_tab[byte];
+      for (int n = 1; n < 8; n++)
+        slices[n][byte] = (slices[n - 1][byte] << 8) ^ crc_tab[slices[n - 1][byte] >> 24];
+    }
+
+#ifdef CRC32_HAVE_CLMUL
+    unsigned int eax, ebx, ecx, edx;
+    useClmul = __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_PCLMUL) && (ecx & bit_SSSE3);
+#endif
+    fold1[0] = XPowMod(128);
+    fold1[1] = XPowMod(128 + 64);
+    fold4[0] = XPowMod(512);
+    fold4[1] = XPowMod(512 + 64);
+  }
+
+  //! slices[n][byte] is the crc of byte followed by n zero bytes
+  uint32_t slices[8][256];
+  //! multipliers folding the low and high half of a 128 bit block 128 or 512 bits ahead
+  uint64_t fold1[2];
+  uint64_t fold4[2];
+  bool useClmul = false;
+};
+
+const CrcTables& GetTables()
+{
+  static const CrcTables tables;
+  return tables;
+}
+
+// slice-by-8, eight table lookups per eight bytes without a dependency between them
+uint32_t ComputeSliced(const CrcTables& tables, uint32_t crc, const unsigned char* buffer, size_t count)
+{
+  const uint32_t (*t)[256] = tables.slices;
+  while (count >= 8)
+  {
+    crc ^= static_cast<uint32_t>(buffer[0]) << 24 | static_cast<uint32_t>(buffer[1]) << 16 |
+           static_cast<uint32_t>(buffer[2]) << 8 | buffer[3];
+    crc = t[7][crc >> 24] ^ t[6][(crc >> 16) & 0xFF] ^ t[5][(crc >> 8) & 0xFF] ^ t[4][crc & 0xFF] ^
+          t[3][buffer[4]] ^ t[2][buffer[5]] ^ t[1][buffer[6]] ^ t[0][buffer[7]];
+    buffer += 8;
+    count -= 8;
+  }
+  while (count--)
+    crc = (crc << 8) ^ crc_tab[((crc >> 24) ^ *buffer++) & 0xFF];
+  return crc;
+}
+
+#ifdef CRC32_HAVE_CLMUL
+// below this the setup of the folding costs more than it saves
+const size_t CLMUL_MIN_SIZE = 128;
+
+// blocks are byte swapped so that bit n of the register is the coefficient of x^n
+__attribute__((target("pclmul,ssse3")))
+inline __m128i LoadBlock(const unsigned char* buffer, __m128i swap)
+{
+  return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer)), swap);
+}
+
+// block * x^(n + 128) + next, reduced to less than 128 bits
+__attribute__((target("pclmul,ssse3")))
+inline __m128i Fold(__m128i block, __m128i multipliers, __m128i next)
+{
+  return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(block, multipliers, 0x11),
+                                     _mm_clmulepi64_si128(block, multipliers, 0x00)), next);
+}
+
+/*!
+ Folds four 128 bit lanes 512 bits ahead with carry-less multiplications until
+ less than 64 bytes are left, then folds the lanes into one. Its crc together
+ with the remaining bytes is computed with the tables. See "Fast CRC Computation
+ for Generic Polynomials Using PCLMULQDQ Instruction" by Intel.
+ */
+__attribute__((target("pclmul,ssse3")))
+uint32_t ComputeClmul(const CrcTables& tables, uint32_t crc, const unsigned char* buffer, size_t count)
+{
+  const __m128i swap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  const __m128i fold1 = _mm_set_epi64x(tables.fold1[1], tables.fold1[0]);
+  const __m128i fold4 = _mm_set_epi64x(tables.fold4[1], tables.fold4[0]);
+
+  // a crc of zero with the initial value xor-ed into the first 32 bits is the same
+  __m128i x0 = _mm_xor_si128(LoadBlock(buffer, swap), _mm_set_epi32(static_cast<int>(crc), 0, 0, 0));
+  __m128i x1 = LoadBlock(buffer + 16, swap);
+  __m128i x2 = LoadBlock(buffer + 32, swap);
+  __m128i x3 = LoadBlock(buffer + 48, swap);
+  buffer += 64;
+  count -= 64;
+
+  while (count >= 64)
+  {
+    x0 = Fold(x0, fold4, LoadBlock(buffer, swap));
+    x1 = Fold(x1, fold4, LoadBlock(buffer + 16, swap));
+    x2 = Fold(x2, fold4, LoadBlock(buffer + 32, swap));
+    x3 = Fold(x3, fold4, LoadBlock(buffer + 48, swap));
+    buffer += 64;
+    count -= 64;
+  }
+
+  x0 = Fold(x0, fold1, x1);
+  x0 = Fold(x0, fold1, x2);
+  x0 = Fold(x0, fold1, x3);
+  while (count >= 16)
+  {
+    x0 = Fold(x0, fold1, LoadBlock(buffer, swap));
+    buffer += 16;
+    count -= 16;
+  }
+
+  unsigned char block[16];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(block), _mm_shuffle_epi8(x0, swap));
+  crc = ComputeSliced(tables, 0, block, sizeof(block));
+  return ComputeSliced(tables, crc, buffer, count);
+}
+#endif
+
+}
+
 Crc32::Crc32()
 {
   Reset();
@@ -89,8 +233,16 @@ void Crc32::Reset()
 
 void Crc32::Compute(const char* buffer, size_t count)
 {
-   while (count--)
-      m_crc = (m_crc << 8) ^ crc_tab[((m_crc >> 24) ^ *buffer++) & 0xFF];
+  const CrcTables& tables = GetTables();
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(buffer);
+#ifdef CRC32_HAVE_CLMUL
+  if (tables.useClmul && count >= CLMUL_MIN_SIZE)
+  {
+    m_crc = ComputeClmul(tables, m_crc, bytes, count);
+    return;
+  }
+#endif
+  m_crc = ComputeSliced(tables, m_crc, bytes, count);
 }
 
 uint32_t Crc32::Compute(const std::string& strValue)
@@ -102,8 +254,19 @@ uint32_t Crc32::Compute(const std::string& strValue)
 
 uint32_t Crc32::ComputeFromLowerCase(const std::string& strValue)
 {
-  std::string strLower = strValue;
-  StringUtils::ToLower(strLower);
-  return Compute(strLower.c_str());
+  // lower case in chunks on the stack instead of copying the string, up to
+  // the first null character like before
+  Crc32 crc;
+  char lower[256];
+  const size_t length = strValue.find('\0');
+  const size_t size = length == std::string::npos ? strValue.size() : length;
+  for (size_t pos = 0; pos < size; pos += sizeof(lower))
+  {
+    const size_t chunk = std::min(size - pos, sizeof(lower));
+    for (size_t i = 0; i < chunk; i++)
+      lower[i] = static_cast<char>(::tolower(strValue[pos + i]));
+    crc.Compute(lower, chunk);
+  }
+  return crc;
 }
 
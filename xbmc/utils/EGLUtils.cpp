@@ -17,7 +17,9 @@
 
 #include <EGL/eglext.h>
 
+#include <cmath>
 #include <map>
+#include <vector>
 
 namespace
 {
@@ -25,6 +27,9 @@ namespace
 #ifndef EGL_NO_CONFIG_KHR
 #define EGL_NO_CONFIG_KHR static_cast<EGLConfig>(0)
 #endif
+#ifndef EGL_BUFFER_AGE_EXT
+#define EGL_BUFFER_AGE_EXT 0x313D
+#endif
 #ifndef EGL_CONTEXT_PRIORITY_LEVEL_IMG
 #define EGL_CONTEXT_PRIORITY_LEVEL_IMG 0x3100
 #endif
@@ -298,6 +303,14 @@ bool CEGLContextUtils::InitializeDisplay(EGLint renderingApi)
     return false;
   }
 
+  m_bufferAgeSupported = CEGLUtils::HasExtension(m_eglDisplay, "EGL_EXT_buffer_age") ||
+                         CEGLUtils::HasExtension(m_eglDisplay, "EGL_KHR_partial_update");
+
+  if (CEGLUtils::HasExtension(m_eglDisplay, "EGL_KHR_swap_buffers_with_damage"))
+    m_swapBuffersWithDamage = reinterpret_cast<SwapBuffersWithDamageProc>(eglGetProcAddress("eglSwapBuffersWithDamageKHR"));
+  else if (CEGLUtils::HasExtension(m_eglDisplay, "EGL_EXT_swap_buffers_with_damage"))
+    m_swapBuffersWithDamage = reinterpret_cast<SwapBuffersWithDamageProc>(eglGetProcAddress("eglSwapBuffersWithDamageEXT"));
+
   return true;
 }
 
@@ -312,9 +325,11 @@ bool CEGLContextUtils::ChooseConfig(EGLint renderableType, EGLint visualId)
 
   EGLint surfaceType = EGL_WINDOW_BIT;
   // for the non-trivial dirty region modes, we need the EGL buffer to be preserved across updates
+  // unless the buffer age tells us what to redraw
   int guiAlgorithmDirtyRegions = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_guiAlgorithmDirtyRegions;
-  if (guiAlgorithmDirtyRegions == DIRTYREGION_SOLVER_COST_REDUCTION ||
-      guiAlgorithmDirtyRegions == DIRTYREGION_SOLVER_UNION)
+  if (!(m_useBufferAge && m_bufferAgeSupported) &&
+      (guiAlgorithmDirtyRegions == DIRTYREGION_SOLVER_COST_REDUCTION ||
+       guiAlgorithmDirtyRegions == DIRTYREGION_SOLVER_UNION))
     surfaceType |= EGL_SWAP_BEHAVIOR_PRESERVED_BIT;
 
   CEGLAttributes<10> attribs;
@@ -461,6 +476,13 @@ void CEGLContextUtils::SurfaceAttrib()
     throw std::logic_error("Setting surface attributes requires a surface");
   }
 
+  // the contents of old back buffers are known, so only the regions changed since can be redrawn
+  if (m_useBufferAge && m_bufferAgeSupported)
+  {
+    CLog::Log(LOGDEBUG, "CEGLContextUtils::%s - using buffer age for dirty region rendering", __FUNCTION__);
+    return;
+  }
+
   // for the non-trivial dirty region modes, we need the EGL buffer to be preserved across updates
   int guiAlgorithmDirtyRegions = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_guiAlgorithmDirtyRegions;
   if (guiAlgorithmDirtyRegions == DIRTYREGION_SOLVER_COST_REDUCTION ||
@@ -582,5 +604,54 @@ bool CEGLContextUtils::TrySwapBuffers()
     return false;
   }
 
-  return (eglSwapBuffers(m_eglDisplay, m_eglSurface) == EGL_TRUE);
+  if (eglSwapBuffers(m_eglDisplay, m_eglSurface) != EGL_TRUE)
+    return false;
+
+  m_swapCount++;
+  return true;
+}
+
+bool CEGLContextUtils::TrySwapBuffers(const CDirtyRegionList& damage)
+{
+  if (damage.empty() || !m_swapBuffersWithDamage)
+    return TrySwapBuffers();
+
+  if (m_eglDisplay == EGL_NO_DISPLAY || m_eglSurface == EGL_NO_SURFACE)
+  {
+    return false;
+  }
+
+  EGLint height{0};
+  if (eglQuerySurface(m_eglDisplay, m_eglSurface, EGL_HEIGHT, &height) != EGL_TRUE)
+    return TrySwapBuffers();
+
+  // EGL expects x, y, width, height with the origin at the bottom left
+  std::vector<EGLint> rects;
+  rects.reserve(damage.size() * 4);
+  for (const auto& region : damage)
+  {
+    EGLint x1 = static_cast<EGLint>(std::floor(region.x1));
+    EGLint y1 = static_cast<EGLint>(std::floor(region.y1));
+    EGLint x2 = static_cast<EGLint>(std::ceil(region.x2));
+    EGLint y2 = static_cast<EGLint>(std::ceil(region.y2));
+    rects.insert(rects.end(), {x1, height - y2, x2 - x1, y2 - y1});
+  }
+
+  if (m_swapBuffersWithDamage(m_eglDisplay, m_eglSurface, rects.data(), static_cast<EGLint>(damage.size())) != EGL_TRUE)
+    return false;
+
+  m_swapCount++;
+  return true;
+}
+
+EGLint CEGLContextUtils::GetBufferAge() const
+{
+  if (!m_useBufferAge || !m_bufferAgeSupported || m_eglDisplay == EGL_NO_DISPLAY || m_eglSurface == EGL_NO_SURFACE)
+    return -1;
+
+  EGLint age{0};
+  if (eglQuerySurface(m_eglDisplay, m_eglSurface, EGL_BUFFER_AGE_EXT, &age) != EGL_TRUE)
+    return -1;
+
+  return age;
 }
@@ -14,6 +14,8 @@
 #include <stdexcept>
 #include <vector>
 
+#include "guilib/DirtyRegion.h"
+
 #include <EGL/egl.h>
 
 class CEGLUtils
@@ -193,6 +195,26 @@ public:
   void DestroyContext();
   bool SetVSync(bool enable);
   bool TrySwapBuffers();
+  /**
+   * Swap buffers telling EGL that only the given regions changed, if supported
+   *
+   * \param damage changed regions in surface coordinates, the whole surface if empty
+   */
+  bool TrySwapBuffers(const CDirtyRegionList& damage);
+  /**
+   * Redraw according to the age of the back buffer instead of asking for a
+   * preserved back buffer. Has to be called before the surface is created.
+   */
+  void SetUseBufferAge(bool useBufferAge) { m_useBufferAge = useBufferAge; }
+  /**
+   * Age of the current back buffer in frames, 0 if its contents are undefined
+   * or -1 if unknown
+   */
+  EGLint GetBufferAge() const;
+  /**
+   * Number of successful buffer swaps on the current surface
+   */
+  unsigned int GetSwapCount() const { return m_swapCount; }
   bool IsPlatformSupported() const;
   EGLint GetConfigAttrib(EGLint attribute) const;
 
@@ -223,4 +245,10 @@ private:
   EGLSurface m_eglSurface{EGL_NO_SURFACE};
   EGLContext m_eglContext{EGL_NO_CONTEXT};
   EGLConfig m_eglConfig{};
+
+  bool m_useBufferAge{false};
+  bool m_bufferAgeSupported{false};
+  unsigned int m_swapCount{0};
+  using SwapBuffersWithDamageProc = EGLBoolean (EGLAPIENTRYP)(EGLDisplay, EGLSurface, const EGLint*, EGLint);
+  SwapBuffersWithDamageProc m_swapBuffersWithDamage{nullptr};
 };
@@ -0,0 +1,193 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "FastHash.h"
+
+#include <cstring>
+
+#include "utils/EndianSwap.h"
+#include "utils/StringUtils.h"
+
+namespace KODI
+{
+namespace UTILITY
+{
+
+namespace
+{
+
+const uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+const uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+const uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+const uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t RotateLeft(uint64_t value, int bits)
+{
+  return (value << bits) | (value >> (64 - bits));
+}
+
+inline uint64_t Read64(const unsigned char* data)
+{
+  uint64_t value;
+  memcpy(&value, data, sizeof(value));
+  return Endian_SwapLE64(value);
+}
+
+inline uint32_t Read32(const unsigned char* data)
+{
+  uint32_t value;
+  memcpy(&value, data, sizeof(value));
+  return Endian_SwapLE32(value);
+}
+
+inline uint64_t Round(uint64_t accumulator, uint64_t input)
+{
+  accumulator += input * PRIME2;
+  return RotateLeft(accumulator, 31) * PRIME1;
+}
+
+inline uint64_t MergeRound(uint64_t hash, uint64_t accumulator)
+{
+  hash ^= Round(0, accumulator);
+  return hash * PRIME1 + PRIME4;
+}
+
+// consumes all complete 32 byte stripes and returns how many bytes that were
+inline std::size_t ProcessStripes(uint64_t (&accumulators)[4], const unsigned char* data, std::size_t size)
+{
+  const unsigned char* const start = data;
+  uint64_t v1 = accumulators[0];
+  uint64_t v2 = accumulators[1];
+  uint64_t v3 = accumulators[2];
+  uint64_t v4 = accumulators[3];
+  while (size >= 32)
+  {
+    v1 = Round(v1, Read64(data));
+    v2 = Round(v2, Read64(data + 8));
+    v3 = Round(v3, Read64(data + 16));
+    v4 = Round(v4, Read64(data + 24));
+    data += 32;
+    size -= 32;
+  }
+  accumulators[0] = v1;
+  accumulators[1] = v2;
+  accumulators[2] = v3;
+  accumulators[3] = v4;
+  return data - start;
+}
+
+uint64_t Finish(const uint64_t (&accumulators)[4], uint64_t seed, uint64_t totalSize,
+                const unsigned char* data, std::size_t size)
+{
+  uint64_t hash;
+  if (totalSize >= 32)
+  {
+    hash = RotateLeft(accumulators[0], 1) + RotateLeft(accumulators[1], 7) +
+           RotateLeft(accumulators[2], 12) + RotateLeft(accumulators[3], 18);
+    for (uint64_t accumulator : accumulators)
+      hash = MergeRound(hash, accumulator);
+  }
+  else
+    hash = seed + PRIME5;
+
+  hash += totalSize;
+
+  for (; size >= 8; data += 8, size -= 8)
+  {
+    hash ^= Round(0, Read64(data));
+    hash = RotateLeft(hash, 27) * PRIME1 + PRIME4;
+  }
+  if (size >= 4)
+  {
+    hash ^= static_cast<uint64_t>(Read32(data)) * PRIME1;
+    hash = RotateLeft(hash, 23) * PRIME2 + PRIME3;
+    data += 4;
+    size -= 4;
+  }
+  for (; size > 0; data++, size--)
+  {
+    hash ^= *data * PRIME5;
+    hash = RotateLeft(hash, 11) * PRIME1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= PRIME2;
+  hash ^= hash >> 29;
+  hash *= PRIME3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+}
+
+CFastHash::CFastHash(uint64_t seed)
+: m_accumulators{seed + PRIME1 + PRIME2, seed + PRIME2, seed, seed - PRIME1}, m_seed(seed)
+{
+}
+
+void CFastHash::Update(std::string const& data)
+{
+  Update(data.c_str(), data.size());
+}
+
+void CFastHash::Update(void const* data, std::size_t size)
+{
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  m_totalSize += size;
+
+  if (m_bufferSize + size < sizeof(m_buffer))
+  {
+    if (size)
+      memcpy(m_buffer + m_bufferSize, bytes, size);
+    m_bufferSize += size;
+    return;
+  }
+
+  if (m_bufferSize)
+  {
+    const std::size_t fill = sizeof(m_buffer) - m_bufferSize;
+    memcpy(m_buffer + m_bufferSize, bytes, fill);
+    ProcessStripes(m_accumulators, m_buffer, sizeof(m_buffer));
+    bytes += fill;
+    size -= fill;
+    m_bufferSize = 0;
+  }
+
+  const std::size_t processed = ProcessStripes(m_accumulators, bytes, size);
+  m_bufferSize = size - processed;
+  if (m_bufferSize)
+    memcpy(m_buffer, bytes + processed, m_bufferSize);
+}
+
+std::string CFastHash::Finalize() const
+{
+  return StringUtils::Format("%016llx", static_cast<unsigned long long>(FinalizeRaw()));
+}
+
+uint64_t CFastHash::FinalizeRaw() const
+{
+  return Finish(m_accumulators, m_seed, m_totalSize, m_buffer, m_bufferSize);
+}
+
+uint64_t CFastHash::Calculate(std::string const& data)
+{
+  return Calculate(data.c_str(), data.size());
+}
+
+uint64_t CFastHash::Calculate(void const* data, std::size_t size, uint64_t seed)
+{
+  // no buffering needed when all the data is there
+  uint64_t accumulators[4] = {seed + PRIME1 + PRIME2, seed + PRIME2, seed, seed - PRIME1};
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  const std::size_t processed = ProcessStripes(accumulators, bytes, size);
+  return Finish(accumulators, seed, size, bytes + processed, size - processed);
+}
+
+}
+}
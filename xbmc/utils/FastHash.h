@@ -0,0 +1,68 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+
+namespace KODI
+{
+namespace UTILITY
+{
+
+/**
+ * Fast non-cryptographic 64 bit hash (XXH64) for cache keys and fingerprints
+ *
+ * Several times faster than \ref CDigest, but trivial to forge, so never use
+ * it where the data may be chosen by an attacker to collide on purpose.
+ */
+class CFastHash
+{
+public:
+  explicit CFastHash(uint64_t seed = 0);
+
+  /**
+   * Update hash with data
+   */
+  void Update(std::string const& data);
+  /**
+   * Update hash with data
+   */
+  void Update(void const* data, std::size_t size);
+  /**
+   * Get the hash of the data so far, more data may be added afterwards
+   *
+   * \return hash value as string in lower-case hexadecimal notation
+   */
+  std::string Finalize() const;
+  /**
+   * Get the hash of the data so far, more data may be added afterwards
+   */
+  uint64_t FinalizeRaw() const;
+
+  /**
+   * Calculate hash
+   */
+  static uint64_t Calculate(std::string const& data);
+  /**
+   * Calculate hash
+   */
+  static uint64_t Calculate(void const* data, std::size_t size, uint64_t seed = 0);
+
+private:
+  uint64_t m_accumulators[4];
+  uint64_t m_seed;
+  uint64_t m_totalSize{0};
+  unsigned char m_buffer[32];
+  std::size_t m_bufferSize{0};
+};
+
+}
+}
@@ -0,0 +1,202 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "JSONStreamWriter.h"
+
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include "utils/Variant.h"
+
+template<class TWriter>
+bool InternalWrite(TWriter& writer, const CVariant &value)
+{
+  switch (value.type())
+  {
+  case CVariant::VariantTypeInteger:
+    return writer.Int64(value.asInteger());
+
+  case CVariant::VariantTypeUnsignedInteger:
+    return writer.Uint64(value.asUnsignedInteger());
+
+  case CVariant::VariantTypeDouble:
+    return writer.Double(value.asDouble());
+
+  case CVariant::VariantTypeBoolean:
+    return writer.Bool(value.asBoolean());
+
+  case CVariant::VariantTypeString:
+    return writer.String(value.c_str(), value.size());
+
+  case CVariant::VariantTypeArray:
+    if (!writer.StartArray())
+      return false;
+
+    for (CVariant::const_iterator_array itr = value.begin_array(); itr != value.end_array(); ++itr)
+    {
+      if (!InternalWrite(writer, *itr))
+        return false;
+    }
+
+    return writer.EndArray(value.size());
+
+  case CVariant::VariantTypeObject:
+    if (!writer.StartObject())
+      return false;
+
+    for (CVariant::const_iterator_map itr = value.begin_map(); itr != value.end_map(); ++itr)
+    {
+      if (!writer.Key(itr->first.c_str()) ||
+        !InternalWrite(writer, itr->second))
+        return false;
+    }
+
+    return writer.EndObject(value.size());
+
+  case CVariant::VariantTypeConstNull:
+  case CVariant::VariantTypeNull:
+  default:
+    return writer.Null();
+  }
+
+  return false;
+}
+
+class CJSONStreamWriter::IWriter
+{
+public:
+  virtual ~IWriter() = default;
+
+  virtual bool StartObject() = 0;
+  virtual bool EndObject() = 0;
+  virtual bool StartArray() = 0;
+  virtual bool EndArray() = 0;
+  virtual bool Key(const std::string &key) = 0;
+  virtual bool Null() = 0;
+  virtual bool Bool(bool value) = 0;
+  virtual bool Int64(int64_t value) = 0;
+  virtual bool Uint64(uint64_t value) = 0;
+  virtual bool Double(double value) = 0;
+  virtual bool String(const std::string &value) = 0;
+  virtual bool Value(const CVariant &value) = 0;
+  virtual bool IsComplete() const = 0;
+  virtual std::string GetString() const = 0;
+};
+
+template<class TWriter>
+class CJSONStreamWriter::CWriter : public CJSONStreamWriter::IWriter
+{
+public:
+  CWriter() : m_writer(m_buffer) { }
+
+  TWriter& GetWriter() { return m_writer; }
+
+  bool StartObject() override { return m_writer.StartObject(); }
+  bool EndObject() override { return m_writer.EndObject(); }
+  bool StartArray() override { return m_writer.StartArray(); }
+  bool EndArray() override { return m_writer.EndArray(); }
+  bool Key(const std::string &key) override { return m_writer.Key(key.c_str(), key.size()); }
+  bool Null() override { return m_writer.Null(); }
+  bool Bool(bool value) override { return m_writer.Bool(value); }
+  bool Int64(int64_t value) override { return m_writer.Int64(value); }
+  bool Uint64(uint64_t value) override { return m_writer.Uint64(value); }
+  bool Double(double value) override { return m_writer.Double(value); }
+  bool String(const std::string &value) override { return m_writer.String(value.c_str(), value.size()); }
+  bool Value(const CVariant &value) override { return InternalWrite(m_writer, value); }
+  bool IsComplete() const override { return m_writer.IsComplete(); }
+  std::string GetString() const override { return std::string(m_buffer.GetString(), m_buffer.GetSize()); }
+
+private:
+  rapidjson::StringBuffer m_buffer;
+  TWriter m_writer;
+};
+
+CJSONStreamWriter::CJSONStreamWriter(bool compact)
+{
+  if (compact)
+    m_writer.reset(new CWriter<rapidjson::Writer<rapidjson::StringBuffer>>());
+  else
+  {
+    CWriter<rapidjson::PrettyWriter<rapidjson::StringBuffer>>* writer = new CWriter<rapidjson::PrettyWriter<rapidjson::StringBuffer>>();
+    writer->GetWriter().SetIndent('\t', 1);
+    m_writer.reset(writer);
+  }
+}
+
+CJSONStreamWriter::~CJSONStreamWriter() = default;
+
+bool CJSONStreamWriter::StartObject()
+{
+  return m_writer->StartObject();
+}
+
+bool CJSONStreamWriter::EndObject()
+{
+  return m_writer->EndObject();
+}
+
+bool CJSONStreamWriter::StartArray()
+{
+  return m_writer->StartArray();
+}
+
+bool CJSONStreamWriter::EndArray()
+{
+  return m_writer->EndArray();
+}
+
+bool CJSONStreamWriter::Key(const std::string &key)
+{
+  return m_writer->Key(key);
+}
+
+bool CJSONStreamWriter::Null()
+{
+  return m_writer->Null();
+}
+
+bool CJSONStreamWriter::Bool(bool value)
+{
+  return m_writer->Bool(value);
+}
+
+bool CJSONStreamWriter::Int64(int64_t value)
+{
+  return m_writer->Int64(value);
+}
+
+bool CJSONStreamWriter::Uint64(uint64_t value)
+{
+  return m_writer->Uint64(value);
+}
+
+bool CJSONStreamWriter::Double(double value)
+{
+  return m_writer->Double(value);
+}
+
+bool CJSONStreamWriter::String(const std::string &value)
+{
+  return m_writer->String(value);
+}
+
+bool CJSONStreamWriter::Value(const CVariant &value)
+{
+  return m_writer->Value(value);
+}
+
+bool CJSONStreamWriter::IsComplete() const
+{
+  return m_writer->IsComplete();
+}
+
+std::string CJSONStreamWriter::GetString() const
+{
+  return m_writer->GetString();
+}
@@ -0,0 +1,62 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+class CVariant;
+
+/*!
+ \brief Writes JSON text token by token
+
+ Allows producing JSON output directly from the data it represents instead
+ of building a CVariant tree first. Complete CVariant values can be written
+ at any point as well.
+ */
+class CJSONStreamWriter
+{
+public:
+  explicit CJSONStreamWriter(bool compact);
+  ~CJSONStreamWriter();
+
+  bool StartObject();
+  bool EndObject();
+  bool StartArray();
+  bool EndArray();
+  bool Key(const std::string &key);
+
+  bool Null();
+  bool Bool(bool value);
+  bool Int64(int64_t value);
+  bool Uint64(uint64_t value);
+  bool Double(double value);
+  bool String(const std::string &value);
+  bool Value(const CVariant &value);
+
+  /*!
+   \brief Whether a complete JSON value has been written
+   */
+  bool IsComplete() const;
+
+  /*!
+   \brief Get the JSON text written so far
+   */
+  std::string GetString() const;
+
+private:
+  CJSONStreamWriter(const CJSONStreamWriter&) = delete;
+  CJSONStreamWriter& operator=(const CJSONStreamWriter&) = delete;
+
+  class IWriter;
+  template<class TWriter> class CWriter;
+
+  std::unique_ptr<IWriter> m_writer;
+};
@@ -40,10 +40,12 @@ private:
     return true;
   }
 
-  void PushObject(CVariant variant);
+  void PushObject(CVariant&& variant);
   void PopObject();
 
   CVariant& m_parsedObject;
+  // the tree is built in place and only handed over once it is complete
+  CVariant m_root;
   std::vector<CVariant *> m_parse;
   std::string m_key;
 
@@ -58,6 +60,7 @@ private:
 
 CJSONVariantParserHandler::CJSONVariantParserHandler(CVariant& parsedObject)
   : m_parsedObject(parsedObject),
+    m_root(),
     m_parse(),
     m_key(),
     m_status(PARSE_STATUS::Variable)
@@ -65,7 +68,7 @@ CJSONVariantParserHandler::CJSONVariantParserHandler(CVariant& parsedObject)
 
 bool CJSONVariantParserHandler::Null()
 {
-  PushObject(CVariant::ConstNullVariant);
+  PushObject(CVariant(CVariant::ConstNullVariant));
   PopObject();
 
   return true;
@@ -146,28 +149,33 @@ bool CJSONVariantParserHandler::EndArray(rapidjson::SizeType elementCount)
   return true;
 }
 
-void CJSONVariantParserHandler::PushObject(CVariant variant)
+void CJSONVariantParserHandler::PushObject(CVariant&& variant)
 {
+  PARSE_STATUS status = PARSE_STATUS::Variable;
+  if (variant.isObject())
+    status = PARSE_STATUS::Object;
+  else if (variant.isArray())
+    status = PARSE_STATUS::Array;
+
   if (m_status == PARSE_STATUS::Object)
   {
-    (*m_parse[m_parse.size() - 1])[m_key] = variant;
-    m_parse.push_back(&(*m_parse[m_parse.size() - 1])[m_key]);
+    CVariant& member = (*m_parse[m_parse.size() - 1])[m_key];
+    member = std::move(variant);
+    m_parse.push_back(&member);
   }
   else if (m_status == PARSE_STATUS::Array)
   {
     CVariant *temp = m_parse[m_parse.size() - 1];
-    temp->push_back(variant);
+    temp->push_back(std::move(variant));
     m_parse.push_back(&(*temp)[temp->size() - 1]);
   }
   else if (m_parse.empty())
-    m_parse.push_back(new CVariant(variant));
+  {
+    m_root = std::move(variant);
+    m_parse.push_back(&m_root);
+  }
 
-  if (variant.isObject())
-    m_status = PARSE_STATUS::Object;
-  else if (variant.isArray())
-    m_status = PARSE_STATUS::Array;
-  else
-    m_status = PARSE_STATUS::Variable;
+  m_status = status;
 }
 
 void CJSONVariantParserHandler::PopObject()
@@ -187,8 +195,7 @@ void CJSONVariantParserHandler::PopObject()
   }
   else
   {
-    m_parsedObject = *variant;
-    delete variant;
+    m_parsedObject = std::move(m_root);
 
     m_status = PARSE_STATUS::Variable;
   }
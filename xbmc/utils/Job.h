@@ -101,7 +101,7 @@ public:
     PRIORITY_HIGH,
     PRIORITY_DEDICATED, // will create a new worker if no worker is available at queue time
   };
-  CJob() { m_callback = NULL; };
+  CJob() { m_callback = NULL; m_id = 0; };
 
   /*!
    \brief Destructor for job objects.
@@ -157,4 +157,5 @@ public:
 private:
   friend class CJobManager;
   CJobManager *m_callback;
+  unsigned int m_id;
 };
@@ -10,12 +10,20 @@
 #include <algorithm>
 #include <functional>
 #include <stdexcept>
+#include <thread>
 #include "threads/SingleLock.h"
 #include "utils/log.h"
+#include "utils/Trace.h"
 #ifdef TARGET_POSIX
 #include "platform/linux/XTimeUtils.h"
 #endif
 
+namespace
+{
+// queue of the pool worker running on this thread, jobs it adds are queued there
+thread_local int currentWorkerQueue = CJobWorker::DEDICATED_WORKER;
+}
+
 bool CJob::ShouldCancel(unsigned int progress, unsigned int total) const
 {
   if (m_callback)
@@ -23,9 +31,12 @@ bool CJob::ShouldCancel(unsigned int progress, unsigned int total) const
   return false;
 }
 
-CJobWorker::CJobWorker(CJobManager *manager) : CThread("JobWorker")
+CJobWorker::CJobWorker(CJobManager *manager, int queue)
+: CThread("JobWorker", queue == DEDICATED_WORKER ? XbmcThreads::THREAD_CLASS_BACKGROUND_IO
+                                                  : XbmcThreads::THREAD_CLASS_BACKGROUND_COMPUTE)
 {
   m_jobManager = manager;
+  m_queue = queue;
   Create(true); // start work immediately, and kill ourselves when we're done
 }
 
@@ -41,7 +52,7 @@ CJobWorker::~CJobWorker()
 
 void CJobWorker::Process()
 {
-  SetPriority( GetMinPriority() );
+  currentWorkerQueue = m_queue;
   while (true)
   {
     // request an item from our manager (this call is blocking)
@@ -49,6 +60,7 @@ void CJobWorker::Process()
     if (!job)
       break;
 
+    TRACE_SPAN("CJobWorker::Process");
     bool success = false;
     try
     {
@@ -166,10 +178,24 @@ CJobManager &CJobManager::GetInstance()
 }
 
 CJobManager::CJobManager()
+: m_poolSize(std::max(5u, std::thread::hardware_concurrency()))
 {
   m_jobCounter = 0;
   m_running = true;
   m_pauseJobs = false;
+  m_poolStarted = false;
+  m_nextQueue = 0;
+  m_poolProcessing = 0;
+  m_wakeGeneration = 0;
+  m_sleepingWorkers = 0;
+  m_idleDedicatedWorkers = 0;
+  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+    m_queued[priority] = 0;
+  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_DEDICATED; ++priority)
+    m_processing[priority] = 0;
+
+  for (unsigned int i = 0; i < m_poolSize; ++i)
+    m_workerQueues.emplace_back(new WorkerQueues());
 }
 
 void CJobManager::Restart()
@@ -183,190 +209,369 @@ void CJobManager::Restart()
 
 void CJobManager::CancelJobs()
 {
-  CSingleLock lock(m_section);
   m_running = false;
 
-  // clear any pending jobs
-  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_DEDICATED; ++priority)
+  // cancel all known jobs: queued ones are freed, running ones lose their callback
+  for (JobShard &shard : m_shards)
   {
-    for_each(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), [](CWorkItem& wi) { wi.FreeJob(); });
-    m_jobQueue[priority].clear();
+    CSingleLock shardLock(shard.section);
+    for (auto it = shard.jobs.begin(); it != shard.jobs.end();)
+    {
+      CWorkItem *item = it->second;
+      item->Cancel();
+      if (item->m_state == CWorkItem::State::Queued)
+      {
+        item->m_state = CWorkItem::State::Cancelled;
+        item->FreeJob();
+        it = shard.jobs.erase(it);
+      }
+      else
+        ++it;
+    }
   }
 
-  // cancel any callbacks on jobs still processing
-  for_each(m_processing.begin(), m_processing.end(), [](CWorkItem& wi) { wi.Cancel(); });
+  // clear any pending jobs
+  for (auto &queues : m_workerQueues)
+  {
+    for (WorkQueue &queue : queues->priorities)
+      ClearWorkQueue(queue);
+  }
+  ClearWorkQueue(m_pausableQueue);
+  {
+    CSingleLock lock(m_dedicatedSection);
+    for (CWorkItem *item : m_dedicatedQueue)
+      DropWorkItem(item);
+    m_dedicatedQueue.clear();
+  }
 
   // tell our workers to finish
+  CSingleLock lock(m_section);
   while (m_workers.size())
   {
     lock.Leave();
-    m_jobEvent.Set();
-    Sleep(0); // yield after setting the event to give the workers some time to die
+    WakeWorkers(true);
+    Sleep(0); // yield after waking the workers to give them some time to die
     lock.Enter();
   }
+  m_poolStarted = false;
 }
 
-unsigned int CJobManager::AddJob(CJob *job, IJobCallback *callback, CJob::PRIORITY priority)
+void CJobManager::ClearWorkQueue(WorkQueue &queue)
 {
-  CSingleLock lock(m_section);
+  CSingleLock lock(queue.section);
+  for (CWorkItem *item : queue.items)
+  {
+    m_queued[item->m_priority]--;
+    DropWorkItem(item);
+  }
+  queue.items.clear();
+}
+
+void CJobManager::DropWorkItem(CWorkItem *item)
+{
+  {
+    // the job may have been queued after cancelling all jobs
+    JobShard &shard = GetShard(item->m_id);
+    CSingleLock lock(shard.section);
+    if (item->m_state == CWorkItem::State::Queued)
+    {
+      item->FreeJob();
+      shard.jobs.erase(item->m_id);
+    }
+  }
+  delete item;
+}
 
+unsigned int CJobManager::AddJob(CJob *job, IJobCallback *callback, CJob::PRIORITY priority)
+{
   if (!m_running)
     return 0;
 
   // increment the job counter, ensuring 0 (invalid job) is never hit
-  m_jobCounter++;
-  if (m_jobCounter == 0)
-    m_jobCounter++;
+  unsigned int id = ++m_jobCounter;
+  if (id == 0)
+    id = ++m_jobCounter;
 
   // create a work item for this job
-  CWorkItem work(job, m_jobCounter, priority, callback);
-  m_jobQueue[priority].push_back(work);
+  CWorkItem *work = new CWorkItem(job, id, priority, callback);
+  job->m_id = id;
+  {
+    JobShard &shard = GetShard(id);
+    CSingleLock lock(shard.section);
+    shard.jobs[id] = work;
+  }
 
-  StartWorkers(priority);
-  return work.m_id;
+  if (priority == CJob::PRIORITY_DEDICATED)
+  {
+    CSingleLock lock(m_dedicatedSection);
+    m_dedicatedQueue.push_back(work);
+    if (m_idleDedicatedWorkers >= m_dedicatedQueue.size())
+      m_dedicatedCondition.notify();
+    else
+    {
+      // nobody is free to take the job right away - create a worker for it
+      CSingleLock workersLock(m_section);
+      m_workers.push_back(new CJobWorker(this, CJobWorker::DEDICATED_WORKER));
+    }
+    return id;
+  }
+
+  StartWorkers();
+
+  // jobs added from a pool worker stay with it, others are spread over all workers
+  unsigned int queue = currentWorkerQueue >= 0 ? currentWorkerQueue : m_nextQueue++ % m_poolSize;
+  // counted before a worker can take the job, the count may be ahead of the queues but never behind
+  m_queued[priority]++;
+  {
+    WorkQueue &workQueue = GetQueue(queue, priority);
+    CSingleLock lock(workQueue.section);
+    workQueue.items.push_back(work);
+  }
+
+  WakeWorkers();
+  return id;
 }
 
 void CJobManager::CancelJob(unsigned int jobID)
 {
-  CSingleLock lock(m_section);
+  JobShard &shard = GetShard(jobID);
+  CSingleLock lock(shard.section);
 
-  // check whether we have this job in the queue
-  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_DEDICATED; ++priority)
+  auto it = shard.jobs.find(jobID);
+  if (it == shard.jobs.end())
+    return;
+
+  CWorkItem *item = it->second;
+  if (item->m_state == CWorkItem::State::Queued)
   {
-    JobQueue::iterator i = find(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), jobID);
-    if (i != m_jobQueue[priority].end())
-    {
-      delete i->m_job;
-      m_jobQueue[priority].erase(i);
-      return;
-    }
+    // the work item stays in its queue until a worker drops it
+    item->m_state = CWorkItem::State::Cancelled;
+    item->FreeJob();
+    shard.jobs.erase(it);
   }
-  // or if we're processing it
-  Processing::iterator it = find(m_processing.begin(), m_processing.end(), jobID);
-  if (it != m_processing.end())
-    it->m_callback = NULL; // job is in progress, so only thing to do is to remove callback
+  else
+    item->Cancel(); // job is in progress, so only thing to do is to remove callback
 }
 
-void CJobManager::StartWorkers(CJob::PRIORITY priority)
+void CJobManager::StartWorkers()
 {
-  CSingleLock lock(m_section);
+  if (m_poolStarted)
+    return;
 
-  // check how many free threads we have
-  if (m_processing.size() >= GetMaxWorkers(priority))
+  CSingleLock lock(m_section);
+  if (m_poolStarted || !m_running)
     return;
 
-  // do we have any sleeping threads?
-  if (m_processing.size() < m_workers.size())
+  for (unsigned int queue = 0; queue < m_poolSize; ++queue)
+    m_workers.push_back(new CJobWorker(this, queue));
+  m_poolStarted = true;
+}
+
+void CJobManager::WakeWorkers(bool all /* = false */)
+{
+  m_wakeGeneration++;
+  if (m_sleepingWorkers > 0 || all)
+  {
+    CSingleLock lock(m_wakeSection);
+    if (all)
+      m_wakeCondition.notifyAll();
+    else
+      m_wakeCondition.notify();
+  }
+
+  if (all)
   {
-    m_jobEvent.Set();
-    return;
+    CSingleLock lock(m_dedicatedSection);
+    m_dedicatedCondition.notifyAll();
   }
+}
 
-  // everyone is busy - we need more workers
-  m_workers.push_back(new CJobWorker(this));
+CJobManager::WorkQueue &CJobManager::GetQueue(unsigned int queue, CJob::PRIORITY priority)
+{
+  if (priority == CJob::PRIORITY_LOW_PAUSABLE)
+    return m_pausableQueue;
+  return m_workerQueues[queue]->priorities[priority - CJob::PRIORITY_LOW];
 }
 
-CJob *CJobManager::PopJob()
+bool CJobManager::ReserveWorker(CJob::PRIORITY priority)
 {
-  CSingleLock lock(m_section);
-  for (int priority = CJob::PRIORITY_DEDICATED; priority >= CJob::PRIORITY_LOW_PAUSABLE; --priority)
+  unsigned int processing = m_poolProcessing;
+  while (processing < GetMaxWorkers(priority))
+  {
+    if (m_poolProcessing.compare_exchange_weak(processing, processing + 1))
+      return true;
+  }
+  return false;
+}
+
+CJobManager::CWorkItem *CJobManager::TakeWorkItem(unsigned int queue, CJob::PRIORITY priority)
+{
+  // start with our own queue, then steal from the others
+  const unsigned int queues = priority == CJob::PRIORITY_LOW_PAUSABLE ? 1 : m_poolSize;
+  for (unsigned int i = 0; i < queues; ++i)
+  {
+    WorkQueue &workQueue = GetQueue((queue + i) % m_poolSize, priority);
+    while (true)
+    {
+      CWorkItem *item;
+      {
+        CSingleLock lock(workQueue.section);
+        if (workQueue.items.empty())
+          break;
+        item = workQueue.items.front();
+        workQueue.items.pop_front();
+      }
+      m_queued[priority]--;
+
+      if (StartWorkItem(item))
+        return item;
+      DropWorkItem(item); // cancelled while queued
+    }
+  }
+  return NULL;
+}
+
+bool CJobManager::StartWorkItem(CWorkItem *item)
+{
+  JobShard &shard = GetShard(item->m_id);
+  CSingleLock lock(shard.section);
+  if (item->m_state == CWorkItem::State::Cancelled)
+    return false;
+
+  item->m_state = CWorkItem::State::Running;
+  item->m_job->m_callback = this;
+  m_processing[item->m_priority]++;
+  return true;
+}
+
+CJob *CJobManager::PopJob(int queue)
+{
+  for (int priority = CJob::PRIORITY_HIGH; priority >= CJob::PRIORITY_LOW_PAUSABLE; --priority)
   {
     // Check whether we're pausing pausable jobs
     if (priority == CJob::PRIORITY_LOW_PAUSABLE && m_pauseJobs)
       continue;
 
-    if (m_jobQueue[priority].size() && m_processing.size() < GetMaxWorkers(CJob::PRIORITY(priority)))
-    {
-      // pop the job off the queue
-      CWorkItem job = m_jobQueue[priority].front();
-      m_jobQueue[priority].pop_front();
-
-      // add to the processing vector
-      m_processing.push_back(job);
-      job.m_job->m_callback = this;
-      return job.m_job;
-    }
+    if (m_queued[priority] == 0)
+      continue;
+
+    // lower priorities allow even fewer workers
+    if (!ReserveWorker(CJob::PRIORITY(priority)))
+      break;
+
+    CWorkItem *item = TakeWorkItem(queue, CJob::PRIORITY(priority));
+    if (item)
+      return item->m_job;
+    m_poolProcessing--;
   }
   return NULL;
 }
 
 void CJobManager::PauseJobs()
 {
-  CSingleLock lock(m_section);
   m_pauseJobs = true;
 }
 
 void CJobManager::UnPauseJobs()
 {
-  CSingleLock lock(m_section);
   m_pauseJobs = false;
+  WakeWorkers(true);
 }
 
 bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
 {
-  CSingleLock lock(m_section);
-
   if (m_pauseJobs)
     return false;
 
-  for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); ++it)
-  {
-    if (priority == it->m_priority)
-      return true;
-  }
-  return false;
+  return m_processing[priority] > 0;
 }
 
 int CJobManager::IsProcessing(const std::string &type) const
 {
   int jobsMatched = 0;
-  CSingleLock lock(m_section);
 
   if (m_pauseJobs)
     return 0;
 
-  for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); ++it)
+  for (const JobShard &shard : m_shards)
   {
-    if (type == std::string(it->m_job->GetType()))
-      jobsMatched++;
+    CSingleLock lock(shard.section);
+    for (const auto &job : shard.jobs)
+    {
+      const CWorkItem *item = job.second;
+      if (item->m_state == CWorkItem::State::Running && type == std::string(item->m_job->GetType()))
+        jobsMatched++;
+    }
   }
   return jobsMatched;
 }
 
 CJob *CJobManager::GetNextJob(const CJobWorker *worker)
 {
-  CSingleLock lock(m_section);
+  if (worker->GetQueue() == CJobWorker::DEDICATED_WORKER)
+    return GetNextDedicatedJob(worker);
+
+  // pool workers stay around until the manager is cancelled
   while (m_running)
   {
-    // grab a job off the queue if we have one
-    CJob *job = PopJob();
+    const unsigned int generation = m_wakeGeneration;
+
+    // grab a job off the queues if we have one
+    CJob *job = PopJob(worker->GetQueue());
     if (job)
       return job;
+
+    // sleep until something changes, unless it already did while we were looking
+    m_sleepingWorkers++;
+    {
+      CSingleLock lock(m_wakeSection);
+      if (m_running && generation == m_wakeGeneration)
+        m_wakeCondition.wait(lock);
+    }
+    m_sleepingWorkers--;
+  }
+  // have no jobs
+  RemoveWorker(worker);
+  return NULL;
+}
+
+CJob *CJobManager::GetNextDedicatedJob(const CJobWorker *worker)
+{
+  CSingleLock lock(m_dedicatedSection);
+  while (m_running)
+  {
+    // grab a job off the queue if we have one
+    while (!m_dedicatedQueue.empty())
+    {
+      CWorkItem *item = m_dedicatedQueue.front();
+      m_dedicatedQueue.pop_front();
+      if (StartWorkItem(item))
+        return item->m_job;
+      DropWorkItem(item); // cancelled while queued
+    }
+
     // no jobs are left - sleep for 30 seconds to allow new jobs to come in
-    lock.Leave();
-    bool newJob = m_jobEvent.WaitMSec(30000);
-    lock.Enter();
-    if (!newJob)
+    m_idleDedicatedWorkers++;
+    bool newJob = m_dedicatedCondition.wait(lock, 30000);
+    m_idleDedicatedWorkers--;
+    if (!newJob && m_dedicatedQueue.empty())
       break;
   }
-  // ensure no jobs have come in during the period after
-  // timeout and before we held the lock
-  CJob *job = PopJob();
-  if (job)
-    return job;
   // have no jobs
+  lock.Leave();
   RemoveWorker(worker);
   return NULL;
 }
 
 bool CJobManager::OnJobProgress(unsigned int progress, unsigned int total, const CJob *job) const
 {
-  CSingleLock lock(m_section);
-  // find the job in the processing queue, and check whether it's cancelled (no callback)
-  Processing::const_iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  const JobShard &shard = GetShard(job->m_id);
+  CSingleLock lock(shard.section);
+  // find the job, and check whether it's cancelled (no callback)
+  auto i = shard.jobs.find(job->m_id);
+  if (i != shard.jobs.end())
   {
-    CWorkItem item(*i);
+    CWorkItem item(*i->second);
     lock.Leave(); // leave section prior to call
     if (item.m_callback)
     {
@@ -379,30 +584,39 @@ bool CJobManager::OnJobProgress(unsigned int progress, unsigned int total, const
 
 void CJobManager::OnJobComplete(bool success, CJob *job)
 {
-  CSingleLock lock(m_section);
-  // remove the job from the processing queue
-  Processing::iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  JobShard &shard = GetShard(job->m_id);
+  CSingleLock lock(shard.section);
+  auto i = shard.jobs.find(job->m_id);
+  if (i == shard.jobs.end())
+    return;
+
+  // tell any listeners we're done with the job, then delete it
+  CWorkItem *item = i->second;
+  IJobCallback *callback = item->m_callback;
+  lock.Leave();
+  try
   {
-    // tell any listeners we're done with the job, then delete it
-    CWorkItem item(*i);
-    lock.Leave();
-    try
-    {
-      if (item.m_callback)
-        item.m_callback->OnJobComplete(item.m_id, success, item.m_job);
-    }
-    catch (...)
-    {
-      CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, item.m_job->GetType());
-    }
-    lock.Enter();
-    Processing::iterator j = find(m_processing.begin(), m_processing.end(), job);
-    if (j != m_processing.end())
-      m_processing.erase(j);
-    lock.Leave();
-    item.FreeJob();
+    if (callback)
+      callback->OnJobComplete(item->m_id, success, item->m_job);
   }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, item->m_job->GetType());
+  }
+  lock.Enter();
+  shard.jobs.erase(item->m_id);
+  lock.Leave();
+
+  m_processing[item->m_priority]--;
+  if (item->m_priority != CJob::PRIORITY_DEDICATED)
+  {
+    // a worker became free, jobs waiting for it may run now
+    m_poolProcessing--;
+    WakeWorkers();
+  }
+
+  item->FreeJob();
+  delete item;
 }
 
 void CJobManager::RemoveWorker(const CJobWorker *worker)
@@ -414,10 +628,7 @@ void CJobManager::RemoveWorker(const CJobWorker *worker)
     m_workers.erase(i); // workers auto-delete
 }
 
-unsigned int CJobManager::GetMaxWorkers(CJob::PRIORITY priority)
+unsigned int CJobManager::GetMaxWorkers(CJob::PRIORITY priority) const
 {
-  static const unsigned int max_workers = 5;
-  if (priority == CJob::PRIORITY_DEDICATED)
-    return 10000; // A large number..
-  return max_workers - (CJob::PRIORITY_HIGH - priority);
+  return m_poolSize - (CJob::PRIORITY_HIGH - priority);
 }
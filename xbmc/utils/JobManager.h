@@ -8,9 +8,14 @@
 
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <queue>
+#include <unordered_map>
 #include <vector>
 #include <string>
+#include "threads/Condition.h"
 #include "threads/CriticalSection.h"
 #include "threads/Thread.h"
 #include "Job.h"
@@ -20,12 +25,22 @@ class CJobManager;
 class CJobWorker : public CThread
 {
 public:
-  explicit CJobWorker(CJobManager *manager);
+  /*!
+   \brief Create and start a worker
+   \param manager the manager to request jobs from.
+   \param queue the job queue owned by this worker, or DEDICATED_WORKER for a worker of the dedicated lane.
+   */
+  CJobWorker(CJobManager *manager, int queue);
   ~CJobWorker() override;
 
   void Process() override;
+
+  int GetQueue() const { return m_queue; }
+
+  static const int DEDICATED_WORKER = -1;
 private:
   CJobManager  *m_jobManager;
+  int           m_queue;
 };
 
 template<typename F>
@@ -186,6 +201,13 @@ private:
  priority levels.  Lower priority jobs are executed only if there are sufficient
  spare worker threads free to allow for higher priority jobs that may arise.
 
+ Jobs are run by a fixed pool of workers sized to the number of cores. Every worker
+ owns a queue per priority, jobs added by a worker go to its own queue and jobs added
+ by other threads are distributed round robin. Idle workers steal jobs from the queues
+ of the other workers. Pausable jobs share a single lane which is skipped while paused,
+ and dedicated jobs have their own lane that starts a new thread when no dedicated
+ worker is idle.
+
  \sa CJob and IJobCallback
  */
 class CJobManager final
@@ -193,21 +215,21 @@ class CJobManager final
   class CWorkItem
   {
   public:
+    enum class State
+    {
+      Queued,
+      Running,
+      Cancelled
+    };
+
     CWorkItem(CJob *job, unsigned int id, CJob::PRIORITY priority, IJobCallback *callback)
     {
       m_job = job;
       m_id = id;
       m_callback = callback;
       m_priority = priority;
+      m_state = State::Queued;
     }
-    bool operator==(unsigned int jobID) const
-    {
-      return m_id == jobID;
-    };
-    bool operator==(const CJob *job) const
-    {
-      return m_job == job;
-    };
     void FreeJob()
     {
       delete m_job;
@@ -221,6 +243,7 @@ class CJobManager final
     unsigned int  m_id;
     IJobCallback *m_callback;
     CJob::PRIORITY m_priority;
+    State         m_state;
   };
 
 public:
@@ -346,27 +369,75 @@ private:
   CJobManager(const CJobManager&) = delete;
   CJobManager const& operator=(CJobManager const&) = delete;
 
-  /*! \brief Pop a job off the job queue and add to the processing queue ready to process
+  struct WorkQueue
+  {
+    CCriticalSection       section;
+    std::deque<CWorkItem*> items;
+  };
+
+  //! queues of a pool worker, one per priority from PRIORITY_LOW to PRIORITY_HIGH
+  struct WorkerQueues
+  {
+    WorkQueue priorities[CJob::PRIORITY_HIGH - CJob::PRIORITY_LOW + 1];
+  };
+
+  //! all known jobs by id, split up to keep lookups from contending on one lock
+  struct JobShard
+  {
+    mutable CCriticalSection                     section;
+    std::unordered_map<unsigned int, CWorkItem*> jobs;
+  };
+
+  static const unsigned int JOB_SHARDS = 16;
+
+  /*! \brief Get a job for a pool worker, from its own queues or stolen from other workers
    \return the job to process, NULL if no jobs are available
    */
-  CJob *PopJob();
-
-  void StartWorkers(CJob::PRIORITY priority);
+  CJob *PopJob(int queue);
+  CJob *GetNextDedicatedJob(const CJobWorker *worker);
+
+  WorkQueue &GetQueue(unsigned int queue, CJob::PRIORITY priority);
+  CWorkItem *TakeWorkItem(unsigned int queue, CJob::PRIORITY priority);
+  bool StartWorkItem(CWorkItem *item);
+  bool ReserveWorker(CJob::PRIORITY priority);
+  void ClearWorkQueue(WorkQueue &queue);
+  void DropWorkItem(CWorkItem *item);
+  JobShard &GetShard(unsigned int jobID) { return m_shards[jobID % JOB_SHARDS]; }
+  const JobShard &GetShard(unsigned int jobID) const { return m_shards[jobID % JOB_SHARDS]; }
+
+  void StartWorkers();
+  void WakeWorkers(bool all = false);
   void RemoveWorker(const CJobWorker *worker);
-  static unsigned int GetMaxWorkers(CJob::PRIORITY priority);
+  unsigned int GetMaxWorkers(CJob::PRIORITY priority) const;
 
-  unsigned int m_jobCounter;
+  std::atomic<unsigned int> m_jobCounter;
 
-  typedef std::deque<CWorkItem>    JobQueue;
-  typedef std::vector<CWorkItem>   Processing;
   typedef std::vector<CJobWorker*> Workers;
 
-  JobQueue   m_jobQueue[CJob::PRIORITY_DEDICATED + 1];
-  bool       m_pauseJobs;
-  Processing m_processing;
-  Workers    m_workers;
+  const unsigned int m_poolSize;
+  std::vector<std::unique_ptr<WorkerQueues>> m_workerQueues;
+  WorkQueue                 m_pausableQueue;
+  std::atomic<unsigned int> m_nextQueue;
+  std::atomic<unsigned int> m_queued[CJob::PRIORITY_HIGH + 1];
+  std::atomic<unsigned int> m_poolProcessing;
+  std::atomic<unsigned int> m_processing[CJob::PRIORITY_DEDICATED + 1];
+  std::atomic<bool>         m_pauseJobs;
+
+  // idle pool workers sleep until the wake generation changes
+  CCriticalSection               m_wakeSection;
+  XbmcThreads::ConditionVariable m_wakeCondition;
+  std::atomic<unsigned int>      m_wakeGeneration;
+  std::atomic<unsigned int>      m_sleepingWorkers;
+
+  CCriticalSection               m_dedicatedSection;
+  XbmcThreads::ConditionVariable m_dedicatedCondition;
+  std::deque<CWorkItem*>         m_dedicatedQueue;
+  unsigned int                   m_idleDedicatedWorkers;
+
+  JobShard m_shards[JOB_SHARDS];
 
   mutable CCriticalSection m_section;
-  CEvent           m_jobEvent;
-  bool             m_running;
+  Workers          m_workers;
+  std::atomic<bool> m_poolStarted;
+  std::atomic<bool> m_running;
 };
@@ -0,0 +1,306 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "MemoryBudget.h"
+
+#include <algorithm>
+#include <fstream>
+#include <inttypes.h>
+#include <limits>
+#include <sstream>
+
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+
+#if defined(TARGET_POSIX)
+#include "platform/linux/XMemUtils.h"
+#elif defined(TARGET_WINDOWS)
+#include <windows.h>
+#endif
+
+namespace
+{
+
+// caches are trimmed above the high watermark of the memory limit, down to the low one
+const uint64_t HIGH_WATERMARK_PERCENT = 90;
+const uint64_t LOW_WATERMARK_PERCENT = 80;
+// if the low watermark can't be reached, the caches may grow this much before trimming again
+const uint64_t PRESSURE_MARGIN_PERCENT = 5;
+// share of the cache limit the trimmable caches keep when memory in use takes it all
+const uint64_t MIN_TRIMMABLE_PERCENT = 25;
+// trimmable caches above their limit are trimmed to this
+const uint64_t CACHE_WATERMARK_PERCENT = 90;
+
+#if defined(TARGET_LINUX) || defined(TARGET_ANDROID)
+bool ReadValue(const std::string& file, uint64_t& value)
+{
+  // "max" means no limit (v2) and fails like a missing file
+  std::ifstream stream(file);
+  return static_cast<bool>(stream >> value);
+}
+
+// page cache that is not in active use is reclaimed before the OOM killer
+// acts, so it doesn't count as used like in the usage files
+uint64_t ReadInactiveFile(const std::string& file, const std::string& key)
+{
+  std::ifstream stream(file);
+  std::string name;
+  uint64_t value;
+  while (stream >> name >> value)
+  {
+    if (name == key)
+      return value;
+  }
+  return 0;
+}
+
+bool GetCgroupMemory(uint64_t& used, uint64_t& limit)
+{
+  // lines of /proc/self/cgroup are hierarchy:controllers:path, for v2 with
+  // empty controllers. The path is relative to the mount, which usually is the
+  // root of the cgroup namespace in containers, then the path doesn't exist.
+  std::string v1Path;
+  std::string v2Path;
+  std::ifstream cgroups("/proc/self/cgroup");
+  std::string line;
+  while (std::getline(cgroups, line))
+  {
+    const size_t controllers = line.find(':');
+    const size_t path = line.find(':', controllers + 1);
+    if (controllers == std::string::npos || path == std::string::npos)
+      continue;
+    const std::string controller = line.substr(controllers + 1, path - controllers - 1);
+    if (controller.empty())
+      v2Path = line.substr(path + 1);
+    else
+    {
+      std::stringstream list(controller);
+      std::string name;
+      while (std::getline(list, name, ','))
+      {
+        if (name == "memory")
+          v1Path = line.substr(path + 1);
+      }
+    }
+  }
+
+  for (const std::string& dir : { "/sys/fs/cgroup" + v2Path, std::string("/sys/fs/cgroup") })
+  {
+    uint64_t usage;
+    if (ReadValue(dir + "/memory.max", limit) && ReadValue(dir + "/memory.current", usage))
+    {
+      used = usage - std::min(usage, ReadInactiveFile(dir + "/memory.stat", "inactive_file"));
+      return true;
+    }
+  }
+
+  if (!v1Path.empty())
+  {
+    for (const std::string& dir : { "/sys/fs/cgroup/memory" + v1Path, std::string("/sys/fs/cgroup/memory") })
+    {
+      uint64_t usage;
+      if (ReadValue(dir + "/memory.limit_in_bytes", limit) && ReadValue(dir + "/memory.usage_in_bytes", usage))
+      {
+        used = usage - std::min(usage, ReadInactiveFile(dir + "/memory.stat", "total_inactive_file"));
+        return true;
+      }
+    }
+  }
+  return false;
+}
+#endif
+
+}
+
+CMemoryBudget::CMemoryBudget() = default;
+
+CMemoryBudget::~CMemoryBudget() = default;
+
+CMemoryBudget& CMemoryBudget::GetInstance()
+{
+  static CMemoryBudget budget;
+  return budget;
+}
+
+void CMemoryBudget::RegisterConsumer(IMemoryConsumer* consumer, const std::string& name, MemoryPriority priority)
+{
+  CSingleLock lock(m_critSection);
+  m_consumers.push_back({ consumer, name, priority, 0, 0 });
+}
+
+void CMemoryBudget::UnregisterConsumer(IMemoryConsumer* consumer)
+{
+  CSingleLock lock(m_critSection);
+  m_consumers.erase(std::remove_if(m_consumers.begin(), m_consumers.end(), [consumer](const Consumer& entry) {
+    return entry.consumer == consumer;
+  }), m_consumers.end());
+}
+
+void CMemoryBudget::SetLimits(uint64_t memoryLimit, uint64_t cacheLimit)
+{
+  CSingleLock lock(m_critSection);
+  m_memoryLimit = memoryLimit;
+  m_cacheLimit = cacheLimit;
+}
+
+void CMemoryBudget::Process()
+{
+  uint64_t memoryUsed = 0;
+  uint64_t detectedLimit = 0;
+  if (!GetMemoryStatus(memoryUsed, detectedLimit))
+  {
+    memoryUsed = 0;
+    detectedLimit = 0;
+  }
+
+  CSingleLock lock(m_critSection);
+
+  std::shared_ptr<MemoryBudgetUsage> usage = std::make_shared<MemoryBudgetUsage>();
+  usage->memoryUsed = memoryUsed;
+  usage->memoryLimit = m_memoryLimit ? m_memoryLimit : detectedLimit;
+  usage->cacheLimit = m_cacheLimit ? m_cacheLimit : usage->memoryLimit / 4;
+
+  uint64_t trimmable = 0;
+  for (Consumer& consumer : m_consumers)
+  {
+    consumer.used = consumer.consumer->GetMemoryUsage();
+    consumer.trimmable = std::min(consumer.consumer->GetTrimmableMemory(), consumer.used);
+    usage->cacheUsed += consumer.used;
+    trimmable += consumer.trimmable;
+  }
+
+  // memory in use can't be freed, so only the trimmable caches are held to the
+  // cache limit, with what is left of it
+  uint64_t excess = 0;
+  if (usage->cacheLimit)
+  {
+    const uint64_t inUse = usage->cacheUsed - trimmable;
+    const uint64_t trimmableLimit = std::max(usage->cacheLimit > inUse ? usage->cacheLimit - inUse : 0,
+                                             usage->cacheLimit / 100 * MIN_TRIMMABLE_PERCENT);
+    if (trimmable > trimmableLimit)
+      excess = trimmable - trimmableLimit / 100 * CACHE_WATERMARK_PERCENT;
+  }
+
+  bool pressure = false;
+  if (memoryUsed && usage->memoryLimit)
+  {
+    const uint64_t high = usage->memoryLimit / 100 * HIGH_WATERMARK_PERCENT;
+    if (memoryUsed <= high)
+      m_pressureThreshold = 0;
+    else if (memoryUsed > std::max(high, m_pressureThreshold))
+    {
+      excess = std::max(excess, memoryUsed - usage->memoryLimit / 100 * LOW_WATERMARK_PERCENT);
+      pressure = true;
+    }
+  }
+
+  if (excess)
+  {
+    // lowest priority first, within a priority the biggest first
+    std::vector<Consumer*> order;
+    for (Consumer& consumer : m_consumers)
+      order.push_back(&consumer);
+    std::stable_sort(order.begin(), order.end(), [](const Consumer* a, const Consumer* b) {
+      return a->priority != b->priority ? a->priority < b->priority : a->trimmable > b->trimmable;
+    });
+
+    uint64_t freed = 0;
+    for (Consumer* consumer : order)
+    {
+      if (freed >= excess)
+        break;
+      if (!consumer->trimmable)
+        continue;
+
+      // don't ask for more than the consumer can free, it may free it from memory in use
+      const uint64_t request = std::min<uint64_t>(excess - freed, consumer->trimmable);
+      const uint64_t trimmed = std::min<uint64_t>(consumer->consumer->TrimMemory(static_cast<size_t>(request)), consumer->used);
+      if (!trimmed)
+        continue;
+
+      CLog::Log(LOGDEBUG, "CMemoryBudget::%s - %s freed %" PRIu64" of %" PRIu64" bytes", __FUNCTION__,
+                consumer->name.c_str(), trimmed, static_cast<uint64_t>(consumer->used));
+      consumer->used -= static_cast<size_t>(trimmed);
+      usage->cacheUsed -= trimmed;
+      freed += trimmed;
+
+      auto it = std::find_if(m_trimmed.begin(), m_trimmed.end(), [consumer](const MemoryConsumerUsage& entry) {
+        return entry.name == consumer->name;
+      });
+      if (it == m_trimmed.end())
+      {
+        MemoryConsumerUsage entry;
+        entry.name = consumer->name;
+        it = m_trimmed.insert(m_trimmed.end(), entry);
+      }
+      it->trimmed += trimmed;
+    }
+    m_totalTrimmed += freed;
+
+    // if the memory in use keeps usage above the low watermark, trimming every
+    // run would empty the caches over and over, so let them grow a bit first
+    if (pressure)
+      m_pressureThreshold = memoryUsed - std::min(freed, memoryUsed) + usage->memoryLimit / 100 * PRESSURE_MARGIN_PERCENT;
+  }
+  usage->trimmed = m_totalTrimmed;
+
+  // consumers of the same name are reported together
+  for (const Consumer& consumer : m_consumers)
+  {
+    auto it = std::find_if(usage->consumers.begin(), usage->consumers.end(), [&consumer](const MemoryConsumerUsage& entry) {
+      return entry.name == consumer.name;
+    });
+    if (it == usage->consumers.end())
+    {
+      MemoryConsumerUsage entry;
+      entry.name = consumer.name;
+      entry.priority = consumer.priority;
+      it = usage->consumers.insert(usage->consumers.end(), entry);
+    }
+    it->used += consumer.used;
+  }
+  for (MemoryConsumerUsage& entry : usage->consumers)
+  {
+    auto it = std::find_if(m_trimmed.begin(), m_trimmed.end(), [&entry](const MemoryConsumerUsage& trimmed) {
+      return trimmed.name == entry.name;
+    });
+    if (it != m_trimmed.end())
+      entry.trimmed = it->trimmed;
+  }
+
+  m_usage.Publish(std::move(usage));
+}
+
+std::shared_ptr<const MemoryBudgetUsage> CMemoryBudget::GetUsage() const
+{
+  return m_usage.Get();
+}
+
+bool CMemoryBudget::GetMemoryStatus(uint64_t& used, uint64_t& limit)
+{
+  MEMORYSTATUSEX stat;
+  stat.dwLength = sizeof(MEMORYSTATUSEX);
+  GlobalMemoryStatusEx(&stat);
+  if (!stat.ullTotalPhys)
+    return false;
+
+  limit = stat.ullTotalPhys;
+  used = stat.ullTotalPhys - std::min<uint64_t>(stat.ullAvailPhys, stat.ullTotalPhys);
+
+#if defined(TARGET_LINUX) || defined(TARGET_ANDROID)
+  // a cgroup limit below the physical memory is what matters
+  uint64_t cgroupUsed;
+  uint64_t cgroupLimit;
+  if (GetCgroupMemory(cgroupUsed, cgroupLimit) && cgroupLimit < limit)
+  {
+    used = cgroupUsed;
+    limit = cgroupLimit;
+  }
+#endif
+  return true;
+}
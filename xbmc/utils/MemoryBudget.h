@@ -0,0 +1,160 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "threads/CriticalSection.h"
+#include "threads/Snapshot.h"
+
+/*!
+ \brief Order in which caches are trimmed, lower priorities first
+ */
+enum MemoryPriority
+{
+  MEMORY_PRIORITY_LOW,    //!< cheap to rebuild or not in use
+  MEMORY_PRIORITY_NORMAL,
+  MEMORY_PRIORITY_HIGH,   //!< expensive to rebuild or in use
+};
+
+/*!
+ \brief A cache that takes part in the memory budget
+
+ Callbacks are made from the thread calling CMemoryBudget::Process(), which
+ is the application thread, while the budget holds its lock. Never register or
+ unregister while holding a lock the callbacks take.
+ */
+class IMemoryConsumer
+{
+public:
+  virtual ~IMemoryConsumer() = default;
+
+  /*!
+   \brief Get the number of bytes held by the cache, may be estimated
+   */
+  virtual size_t GetMemoryUsage() const = 0;
+
+  /*!
+   \brief Get the number of bytes TrimMemory() could free now, may be estimated
+
+   Memory in use, e.g. textures on screen, counts as usage but not as trimmable.
+   */
+  virtual size_t GetTrimmableMemory() const = 0;
+
+  /*!
+   \brief Free memory, least valuable entries first
+   \param bytes the number of bytes to free, the cache may free less or more
+   \return the number of bytes freed
+   */
+  virtual size_t TrimMemory(size_t bytes) = 0;
+};
+
+struct MemoryConsumerUsage
+{
+  std::string name;
+  MemoryPriority priority = MEMORY_PRIORITY_NORMAL;
+  uint64_t used = 0;    //!< bytes held by all consumers of this name
+  uint64_t trimmed = 0; //!< bytes freed on request of the budget so far
+};
+
+struct MemoryBudgetUsage
+{
+  uint64_t memoryLimit = 0; //!< memory available to Kodi, 0 when unknown
+  uint64_t memoryUsed = 0;
+  uint64_t cacheLimit = 0;  //!< limit of all caches together, 0 for none
+  uint64_t cacheUsed = 0;
+  uint64_t trimmed = 0;     //!< bytes freed on request of the budget so far
+  std::vector<MemoryConsumerUsage> consumers;
+};
+
+/*!
+ \brief Keeps the caches of Kodi within a common memory budget
+
+ Caches register as consumers and are asked for their usage periodically.
+ When all of them together exceed the cache limit, or memory gets low for the
+ whole process, they are asked to trim by priority until enough memory is
+ freed. Only what the caches can actually free is asked for: the trimmable
+ part of the caches gets what the memory in use leaves of the cache limit, but
+ at least a quarter of it, and is trimmed to 90% of that once exceeded.
+
+ The memory limit is the limit of the memory cgroup Kodi runs in, else the
+ physical memory, unless set in advancedsettings.xml. Used memory is the usage
+ of the cgroup, else of the whole system, as that is what the OOM killer acts
+ on. Caches are trimmed when usage exceeds 90% of the limit, down to 80%. When
+ that can't be reached, trimming again waits until usage grew by 5% of the
+ limit.
+ */
+class CMemoryBudget
+{
+public:
+  CMemoryBudget();
+  virtual ~CMemoryBudget();
+
+  static CMemoryBudget& GetInstance();
+
+  /*!
+   \brief Add a consumer, consumers with the same name are reported together
+   */
+  void RegisterConsumer(IMemoryConsumer* consumer, const std::string& name, MemoryPriority priority);
+  /*!
+   \brief Remove a consumer, waits for callbacks to the consumer in progress
+   */
+  void UnregisterConsumer(IMemoryConsumer* consumer);
+
+  /*!
+   \brief Set the limits in bytes
+   \param memoryLimit memory available to Kodi, 0 to detect
+   \param cacheLimit limit of all caches together, 0 for a quarter of the memory limit
+   */
+  void SetLimits(uint64_t memoryLimit, uint64_t cacheLimit);
+
+  /*!
+   \brief Update the usage and trim the caches if needed (called from app thread only)
+   */
+  void Process();
+
+  /*!
+   \brief Get the usage as of the last call to Process()
+   */
+  std::shared_ptr<const MemoryBudgetUsage> GetUsage() const;
+
+protected:
+  /*!
+   \brief Get the memory used and the limit as detected on the system
+   \return false if unknown
+   */
+  virtual bool GetMemoryStatus(uint64_t& used, uint64_t& limit);
+
+private:
+  CMemoryBudget(const CMemoryBudget&) = delete;
+  CMemoryBudget& operator=(const CMemoryBudget&) = delete;
+
+  struct Consumer
+  {
+    IMemoryConsumer* consumer;
+    std::string name;
+    MemoryPriority priority;
+    size_t used;
+    size_t trimmable;
+  };
+
+  std::vector<Consumer> m_consumers;
+  std::vector<MemoryConsumerUsage> m_trimmed; //!< per name, survives the consumers
+  uint64_t m_totalTrimmed = 0;
+  uint64_t m_pressureThreshold = 0; //!< usage to trim at when the low watermark couldn't be reached
+  uint64_t m_memoryLimit = 0;
+  uint64_t m_cacheLimit = 0;
+  CCriticalSection m_critSection;
+
+  CSnapshot<MemoryBudgetUsage> m_usage;
+};
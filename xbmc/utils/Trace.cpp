@@ -0,0 +1,244 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "filesystem/File.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "utils/JSONStreamWriter.h"
+#include "utils/log.h"
+
+namespace
+{
+
+/*!
+ Every slot is guarded by a sequence lock: the owning thread clears the
+ sequence while writing and stores the index of the span + 1 afterwards, so
+ readers can detect slots that are written or overwritten while they read.
+ */
+struct TraceEvent
+{
+  std::atomic<uint64_t> sequence;
+  std::atomic<const char*> name;
+  std::atomic<int64_t> start;
+  std::atomic<int64_t> duration;
+};
+
+struct TraceBuffer
+{
+  TraceEvent events[CTrace::TRACE_BUFFER_SIZE] = {};
+  std::atomic<uint64_t> written{0};
+
+  // the following members are protected by the section of the registry
+  uint64_t first = 0; // spans before were recorded by a previous owner
+  uint64_t tid = 0;
+  std::string threadName;
+  bool inUse = false;
+};
+
+struct TraceSpan
+{
+  const char* name;
+  int64_t start;
+  int64_t duration;
+};
+
+class CTraceRegistry
+{
+public:
+  TraceBuffer* Acquire()
+  {
+    CSingleLock lock(m_section);
+    auto it = std::find_if(m_buffers.begin(), m_buffers.end(),
+                           [](const std::unique_ptr<TraceBuffer>& buffer) { return !buffer->inUse; });
+    if (it == m_buffers.end())
+    {
+      m_buffers.emplace_back(new TraceBuffer);
+      it = m_buffers.end() - 1;
+    }
+
+    TraceBuffer* buffer = it->get();
+    buffer->inUse = true;
+    buffer->first = buffer->written.load(std::memory_order_relaxed);
+    buffer->tid = CThread::GetDisplayThreadId(CThread::GetCurrentThreadId());
+    CThread* thread = CThread::GetCurrentThread();
+    buffer->threadName = thread ? thread->GetName() : "";
+    return buffer;
+  }
+
+  void Release(TraceBuffer* buffer)
+  {
+    CSingleLock lock(m_section);
+    buffer->inUse = false;
+  }
+
+  CCriticalSection m_section;
+  std::vector<std::unique_ptr<TraceBuffer>> m_buffers;
+};
+
+CTraceRegistry& GetRegistry()
+{
+  // never destroyed, threads may still record spans during static destruction
+  static CTraceRegistry* registry = new CTraceRegistry;
+  return *registry;
+}
+
+class CThreadTraceBuffer
+{
+public:
+  CThreadTraceBuffer() : m_buffer(GetRegistry().Acquire()) {}
+  ~CThreadTraceBuffer() { GetRegistry().Release(m_buffer); }
+
+  TraceBuffer* const m_buffer;
+};
+
+thread_local CThreadTraceBuffer threadBuffer;
+
+void ReadSpans(const TraceBuffer& buffer, int64_t end, std::vector<TraceSpan>& spans)
+{
+  const uint64_t written = buffer.written.load(std::memory_order_acquire);
+  uint64_t index = written > CTrace::TRACE_BUFFER_SIZE ? written - CTrace::TRACE_BUFFER_SIZE : 0;
+  index = std::max(index, buffer.first);
+
+  for (; index < written; index++)
+  {
+    const TraceEvent& event = buffer.events[index % CTrace::TRACE_BUFFER_SIZE];
+    if (event.sequence.load(std::memory_order_acquire) != index + 1)
+      continue;
+
+    TraceSpan span;
+    span.name = event.name.load(std::memory_order_relaxed);
+    span.start = event.start.load(std::memory_order_relaxed);
+    span.duration = event.duration.load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (event.sequence.load(std::memory_order_relaxed) != index + 1)
+      continue;
+
+    if (span.start + span.duration >= end)
+      spans.push_back(span);
+  }
+}
+
+void WriteMetadata(CJSONStreamWriter& writer, const char* name, uint64_t tid, const std::string& value)
+{
+  writer.StartObject();
+  writer.Key("name");
+  writer.String(name);
+  writer.Key("ph");
+  writer.String("M");
+  writer.Key("pid");
+  writer.Uint64(1);
+  writer.Key("tid");
+  writer.Uint64(tid);
+  writer.Key("args");
+  writer.StartObject();
+  writer.Key("name");
+  writer.String(value);
+  writer.EndObject();
+  writer.EndObject();
+}
+
+} // unnamed namespace
+
+void CTrace::Record(const char* name, int64_t start, int64_t duration)
+{
+  TraceBuffer& buffer = *threadBuffer.m_buffer;
+  const uint64_t index = buffer.written.load(std::memory_order_relaxed);
+  TraceEvent& event = buffer.events[index % TRACE_BUFFER_SIZE];
+
+  event.sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  event.name.store(name, std::memory_order_relaxed);
+  event.start.store(start, std::memory_order_relaxed);
+  event.duration.store(duration, std::memory_order_relaxed);
+  event.sequence.store(index + 1, std::memory_order_release);
+
+  buffer.written.store(index + 1, std::memory_order_release);
+}
+
+std::string CTrace::Serialize(unsigned int milliseconds)
+{
+  const int64_t end = Now() - static_cast<int64_t>(milliseconds) * 1000;
+
+  CJSONStreamWriter writer(true);
+  writer.StartObject();
+  writer.Key("traceEvents");
+  writer.StartArray();
+  WriteMetadata(writer, "process_name", 0, "Kodi");
+
+  CTraceRegistry& registry = GetRegistry();
+  CSingleLock lock(registry.m_section);
+  std::vector<TraceSpan> spans;
+  for (const auto& buffer : registry.m_buffers)
+  {
+    spans.clear();
+    ReadSpans(*buffer, end, spans);
+    if (spans.empty())
+      continue;
+
+    if (!buffer->threadName.empty())
+      WriteMetadata(writer, "thread_name", buffer->tid, buffer->threadName);
+
+    for (const TraceSpan& span : spans)
+    {
+      writer.StartObject();
+      writer.Key("name");
+      writer.String(span.name);
+      writer.Key("ph");
+      writer.String("X");
+      writer.Key("ts");
+      writer.Int64(span.start);
+      writer.Key("dur");
+      writer.Int64(span.duration);
+      writer.Key("pid");
+      writer.Uint64(1);
+      writer.Key("tid");
+      writer.Uint64(buffer->tid);
+      writer.EndObject();
+    }
+  }
+  lock.Leave();
+
+  writer.EndArray();
+  writer.Key("displayTimeUnit");
+  writer.String("ms");
+  writer.EndObject();
+
+  return writer.GetString();
+}
+
+bool CTrace::Dump(const std::string& file, unsigned int milliseconds)
+{
+  const std::string trace = Serialize(milliseconds);
+
+  XFILE::CFile output;
+  if (!output.OpenForWrite(file, true) ||
+      output.Write(trace.c_str(), trace.size()) != static_cast<ssize_t>(trace.size()))
+  {
+    CLog::Log(LOGERROR, "CTrace::%s - failed to write trace to %s", __FUNCTION__, file.c_str());
+    return false;
+  }
+
+  CLog::Log(LOGNOTICE, "CTrace::%s - wrote trace of the last %u ms to %s", __FUNCTION__, milliseconds, file.c_str());
+  return true;
+}
+
+int64_t CTrace::Now()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
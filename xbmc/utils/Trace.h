@@ -0,0 +1,90 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+/*!
+ \brief Built-in tracing of timed spans
+
+ Every thread records the spans it completes into its own ring buffer, which
+ holds the most recent TRACE_BUFFER_SIZE spans of that thread. Recording takes
+ no lock and doesn't allocate, so the last seconds of activity are always
+ available and can be dumped in the Chrome trace event format (to be opened in
+ chrome://tracing or https://ui.perfetto.dev).
+
+ Spans are recorded with the TRACE_SPAN macro, which only does something when
+ built with ENABLE_TRACING (HAS_TRACING defined).
+ */
+class CTrace
+{
+public:
+  static const unsigned int TRACE_BUFFER_SIZE = 4096;
+
+  /*!
+   \brief Record a completed span of the calling thread
+   \param name name of the span, has to stay valid forever (string literal)
+   \param start start time as returned by Now()
+   \param duration duration in microseconds
+   */
+  static void Record(const char* name, int64_t start, int64_t duration);
+
+  /*!
+   \brief Get the spans of all threads that ended within the given period in
+   the Chrome trace event format
+   \param milliseconds the period to return, counting back from now
+   */
+  static std::string Serialize(unsigned int milliseconds);
+
+  /*!
+   \brief Write the spans of all threads that ended within the given period to
+   a file in the Chrome trace event format
+   \sa Serialize
+   */
+  static bool Dump(const std::string& file, unsigned int milliseconds);
+
+  /*!
+   \brief Monotonic time in microseconds used for the spans
+   */
+  static int64_t Now();
+};
+
+/*!
+ \brief Records the lifetime of the object as span of the current thread
+ */
+class CTraceSpan
+{
+public:
+  explicit CTraceSpan(const char* name)
+  : m_name(name),
+    m_start(CTrace::Now())
+  {
+  }
+
+  ~CTraceSpan()
+  {
+    CTrace::Record(m_name, m_start, CTrace::Now() - m_start);
+  }
+
+private:
+  CTraceSpan(const CTraceSpan&) = delete;
+  CTraceSpan& operator=(const CTraceSpan&) = delete;
+
+  const char* m_name;
+  int64_t m_start;
+};
+
+#if defined(HAS_TRACING)
+#define TRACE_SPAN_CONCAT2(a, b) a##b
+#define TRACE_SPAN_CONCAT(a, b) TRACE_SPAN_CONCAT2(a, b)
+#define TRACE_SPAN(name) CTraceSpan TRACE_SPAN_CONCAT(traceSpan, __LINE__)(name)
+#else
+#define TRACE_SPAN(name) ((void)0)
+#endif
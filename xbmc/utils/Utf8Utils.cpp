@@ -8,6 +8,365 @@
 
 #include "Utf8Utils.h"
 
+#include <stdint.h>
+#include <string.h>
+
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(HAS_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+
+/* Blocks of 16 US-ASCII characters are checked and converted at once, everything else
+   goes through the scalar code below */
+
+inline bool IsAscii16(const unsigned char* src)
+{
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+  return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src))) == 0;
+#elif defined(HAS_NEON)
+  const uint8x16_t bytes = vld1q_u8(src);
+  const uint8x8_t any = vorr_u8(vget_low_u8(bytes), vget_high_u8(bytes));
+  return (vget_lane_u64(vreinterpret_u64_u8(any), 0) & 0x8080808080808080ULL) == 0;
+#else
+  uint64_t bytes[2];
+  memcpy(bytes, src, sizeof(bytes));
+  return ((bytes[0] | bytes[1]) & 0x8080808080808080ULL) == 0;
+#endif
+}
+
+// widen 16 US-ASCII characters to UTF-16 or UTF-32 code units
+template<typename CHAR>
+inline void Widen16(const unsigned char* src, CHAR* dst)
+{
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+  const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+  const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+  __m128i* out = reinterpret_cast<__m128i*>(dst);
+  if (sizeof(CHAR) == 2)
+  {
+    _mm_storeu_si128(out, low);
+    _mm_storeu_si128(out + 1, high);
+  }
+  else
+  {
+    _mm_storeu_si128(out, _mm_unpacklo_epi16(low, zero));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(low, zero));
+    _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(high, zero));
+    _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(high, zero));
+  }
+#elif defined(HAS_NEON)
+  const uint8x16_t bytes = vld1q_u8(src);
+  const uint16x8_t low = vmovl_u8(vget_low_u8(bytes));
+  const uint16x8_t high = vmovl_u8(vget_high_u8(bytes));
+  if (sizeof(CHAR) == 2)
+  {
+    uint16_t* out = reinterpret_cast<uint16_t*>(dst);
+    vst1q_u16(out, low);
+    vst1q_u16(out + 8, high);
+  }
+  else
+  {
+    uint32_t* out = reinterpret_cast<uint32_t*>(dst);
+    vst1q_u32(out, vmovl_u16(vget_low_u16(low)));
+    vst1q_u32(out + 4, vmovl_u16(vget_high_u16(low)));
+    vst1q_u32(out + 8, vmovl_u16(vget_low_u16(high)));
+    vst1q_u32(out + 12, vmovl_u16(vget_high_u16(high)));
+  }
+#else
+  for (size_t i = 0; i < 16; i++)
+    dst[i] = src[i];
+#endif
+}
+
+// narrow 16 UTF-16 or UTF-32 code units to UTF-8 if all of them are US-ASCII characters
+template<typename CHAR>
+inline bool Narrow16(const CHAR* src, unsigned char* dst)
+{
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+  const __m128i* in = reinterpret_cast<const __m128i*>(src);
+  __m128i first;
+  __m128i second;
+  __m128i nonAscii;
+  if (sizeof(CHAR) == 2)
+  {
+    first = _mm_loadu_si128(in);
+    second = _mm_loadu_si128(in + 1);
+    nonAscii = _mm_andnot_si128(_mm_set1_epi16(0x7F), _mm_or_si128(first, second));
+  }
+  else
+  {
+    const __m128i a = _mm_loadu_si128(in);
+    const __m128i b = _mm_loadu_si128(in + 1);
+    const __m128i c = _mm_loadu_si128(in + 2);
+    const __m128i d = _mm_loadu_si128(in + 3);
+    nonAscii = _mm_andnot_si128(_mm_set1_epi32(0x7F), _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)));
+    first = _mm_packs_epi32(a, b);
+    second = _mm_packs_epi32(c, d);
+  }
+  if (_mm_movemask_epi8(_mm_cmpeq_epi8(nonAscii, _mm_setzero_si128())) != 0xFFFF)
+    return false;
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(first, second));
+  return true;
+#elif defined(HAS_NEON)
+  uint16x8_t first;
+  uint16x8_t second;
+  if (sizeof(CHAR) == 2)
+  {
+    const uint16_t* in = reinterpret_cast<const uint16_t*>(src);
+    first = vld1q_u16(in);
+    second = vld1q_u16(in + 8);
+  }
+  else
+  {
+    const uint32_t* in = reinterpret_cast<const uint32_t*>(src);
+    const uint32x4_t a = vld1q_u32(in);
+    const uint32x4_t b = vld1q_u32(in + 4);
+    const uint32x4_t c = vld1q_u32(in + 8);
+    const uint32x4_t d = vld1q_u32(in + 12);
+    const uint32x4_t any = vorrq_u32(vorrq_u32(a, b), vorrq_u32(c, d));
+    const uint32x2_t anyHalf = vorr_u32(vget_low_u32(any), vget_high_u32(any));
+    if ((vget_lane_u32(anyHalf, 0) | vget_lane_u32(anyHalf, 1)) & ~0x7FU)
+      return false;
+    first = vcombine_u16(vmovn_u32(a), vmovn_u32(b));
+    second = vcombine_u16(vmovn_u32(c), vmovn_u32(d));
+  }
+  const uint16x8_t any = vorrq_u16(first, second);
+  const uint16x4_t anyHalf = vorr_u16(vget_low_u16(any), vget_high_u16(any));
+  if (vget_lane_u64(vreinterpret_u64_u16(anyHalf), 0) & 0xFF80FF80FF80FF80ULL)
+    return false;
+  vst1q_u8(dst, vcombine_u8(vmovn_u16(first), vmovn_u16(second)));
+  return true;
+#else
+  char32_t any = 0;
+  for (size_t i = 0; i < 16; i++)
+    any |= static_cast<char32_t>(src[i]);
+  if (any & ~0x7FU)
+    return false;
+  for (size_t i = 0; i < 16; i++)
+    dst[i] = static_cast<unsigned char>(src[i]);
+  return true;
+#endif
+}
+
+// number of US-ASCII characters at the start of src
+size_t AsciiPrefix(const unsigned char* src, size_t len)
+{
+  size_t pos = 0;
+  while (pos + 16 <= len && IsAscii16(src + pos))
+    pos += 16;
+  while (pos < len && src[pos] < 0x80)
+    pos++;
+  return pos;
+}
+
+// copy the US-ASCII characters at the start of src to dst, returns the number of characters copied
+template<typename CHAR>
+size_t WidenAscii(const unsigned char* src, size_t len, CHAR* dst)
+{
+  size_t pos = 0;
+  for (; pos + 16 <= len && IsAscii16(src + pos); pos += 16)
+    Widen16(src + pos, dst + pos);
+  for (; pos < len && src[pos] < 0x80; pos++)
+    dst[pos] = src[pos];
+  return pos;
+}
+
+// copy the US-ASCII characters at the start of src to dst, returns the number of characters copied
+template<typename CHAR>
+size_t NarrowAscii(const CHAR* src, size_t len, unsigned char* dst)
+{
+  size_t pos = 0;
+  for (; pos + 16 <= len && Narrow16(src + pos, dst + pos); pos += 16)
+    ;
+  for (; pos < len && static_cast<char32_t>(src[pos]) < 0x80; pos++)
+    dst[pos] = static_cast<unsigned char>(src[pos]);
+  return pos;
+}
+
+// decode a single UTF-8 sequence, returns the length of the sequence or 0 if it's invalid
+inline size_t DecodeUtf8(const unsigned char* src, size_t len, char32_t& codePoint)
+{
+  const unsigned char chr = src[0];
+  if (chr < 0x80)
+  {
+    codePoint = chr;
+    return 1;
+  }
+  if (chr < 0xC2 || chr > 0xF4)
+    return 0;
+
+  if (chr < 0xE0)
+  {
+    if (len < 2 || (src[1] & 0xC0) != 0x80)
+      return 0;
+    codePoint = ((chr & 0x1F) << 6) | (src[1] & 0x3F);
+    return 2;
+  }
+
+  if (chr < 0xF0)
+  {
+    // no overlong sequences and no surrogates
+    const unsigned char min = chr == 0xE0 ? 0xA0 : 0x80;
+    const unsigned char max = chr == 0xED ? 0x9F : 0xBF;
+    if (len < 3 || src[1] < min || src[1] > max || (src[2] & 0xC0) != 0x80)
+      return 0;
+    codePoint = ((chr & 0x0F) << 12) | ((src[1] & 0x3F) << 6) | (src[2] & 0x3F);
+    return 3;
+  }
+
+  // no overlong sequences and nothing above U+10FFFF
+  const unsigned char min = chr == 0xF0 ? 0x90 : 0x80;
+  const unsigned char max = chr == 0xF4 ? 0x8F : 0xBF;
+  if (len < 4 || src[1] < min || src[1] > max || (src[2] & 0xC0) != 0x80 || (src[3] & 0xC0) != 0x80)
+    return 0;
+  codePoint = ((chr & 0x07) << 18) | ((src[1] & 0x3F) << 12) | ((src[2] & 0x3F) << 6) | (src[3] & 0x3F);
+  return 4;
+}
+
+inline unsigned char* EncodeUtf8(char32_t codePoint, unsigned char* dst)
+{
+  if (codePoint < 0x80)
+  {
+    *dst++ = static_cast<unsigned char>(codePoint);
+  }
+  else if (codePoint < 0x800)
+  {
+    *dst++ = static_cast<unsigned char>(0xC0 | (codePoint >> 6));
+    *dst++ = static_cast<unsigned char>(0x80 | (codePoint & 0x3F));
+  }
+  else if (codePoint < 0x10000)
+  {
+    *dst++ = static_cast<unsigned char>(0xE0 | (codePoint >> 12));
+    *dst++ = static_cast<unsigned char>(0x80 | ((codePoint >> 6) & 0x3F));
+    *dst++ = static_cast<unsigned char>(0x80 | (codePoint & 0x3F));
+  }
+  else
+  {
+    *dst++ = static_cast<unsigned char>(0xF0 | (codePoint >> 18));
+    *dst++ = static_cast<unsigned char>(0x80 | ((codePoint >> 12) & 0x3F));
+    *dst++ = static_cast<unsigned char>(0x80 | ((codePoint >> 6) & 0x3F));
+    *dst++ = static_cast<unsigned char>(0x80 | (codePoint & 0x3F));
+  }
+  return dst;
+}
+
+template<typename CHAR>
+inline char32_t CodeUnit(CHAR unit, bool swapBytes)
+{
+  const char32_t value = static_cast<char32_t>(unit);
+  if (sizeof(CHAR) == 2 && swapBytes)
+    return ((value & 0xFF) << 8) | ((value >> 8) & 0xFF);
+  return value;
+}
+
+template<typename STRING>
+bool Utf8ToUnicode(const std::string& utf8, STRING& dst, bool failOnBadChar)
+{
+  typedef typename STRING::value_type CHAR;
+
+  const unsigned char* const src = reinterpret_cast<const unsigned char*>(utf8.data());
+  const size_t len = utf8.length();
+
+  // a byte never results in more than one code unit
+  dst.resize(len);
+  CHAR* const begin = &dst[0];
+  CHAR* out = begin;
+
+  size_t pos = 0;
+  while (pos < len)
+  {
+    const size_t ascii = WidenAscii(src + pos, len - pos, out);
+    pos += ascii;
+    out += ascii;
+    if (pos == len)
+      break;
+
+    char32_t codePoint;
+    const size_t size = DecodeUtf8(src + pos, len - pos, codePoint);
+    if (size == 0)
+    {
+      if (failOnBadChar)
+      {
+        dst.clear();
+        return false;
+      }
+      pos++; // skip the invalid byte, the same way iconv based conversions do
+      continue;
+    }
+
+    if (sizeof(CHAR) == 2 && codePoint >= 0x10000)
+    {
+      codePoint -= 0x10000;
+      *out++ = static_cast<CHAR>(0xD800 + (codePoint >> 10));
+      *out++ = static_cast<CHAR>(0xDC00 + (codePoint & 0x3FF));
+    }
+    else
+      *out++ = static_cast<CHAR>(codePoint);
+    pos += size;
+  }
+
+  dst.resize(out - begin);
+  return true;
+}
+
+template<typename CHAR>
+bool UnicodeToUtf8(const CHAR* src, size_t len, std::string& utf8, bool swapBytes, bool failOnBadChar)
+{
+  // a UTF-16 code unit never results in more than three bytes, a UTF-32 code unit in more than four
+  utf8.resize(len * (sizeof(CHAR) == 2 ? 3 : 4));
+  unsigned char* const begin = reinterpret_cast<unsigned char*>(&utf8[0]);
+  unsigned char* out = begin;
+
+  size_t pos = 0;
+  while (pos < len)
+  {
+    if (!swapBytes)
+    {
+      const size_t ascii = NarrowAscii(src + pos, len - pos, out);
+      pos += ascii;
+      out += ascii;
+      if (pos == len)
+        break;
+    }
+
+    char32_t codePoint = CodeUnit(src[pos], swapBytes);
+    size_t units = 1;
+    if (sizeof(CHAR) == 2 && codePoint >= 0xD800 && codePoint <= 0xDBFF && pos + 1 < len)
+    {
+      const char32_t low = CodeUnit(src[pos + 1], swapBytes);
+      if (low >= 0xDC00 && low <= 0xDFFF)
+      {
+        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+        units = 2;
+      }
+    }
+
+    if ((codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF)
+    {
+      if (failOnBadChar)
+      {
+        utf8.clear();
+        return false;
+      }
+      pos++;
+      continue;
+    }
+
+    out = EncodeUtf8(codePoint, out);
+    pos += units;
+  }
+
+  utf8.resize(out - begin);
+  return true;
+}
+
+} // unnamed namespace
 
 CUtf8Utils::utf8CheckResult CUtf8Utils::checkStrForUtf8(const std::string& str)
 {
@@ -18,6 +377,10 @@ CUtf8Utils::utf8CheckResult CUtf8Utils::checkStrForUtf8(const std::string& str)
 
   while (pos < len)
   {
+    pos += AsciiPrefix(reinterpret_cast<const unsigned char*>(strC + pos), len - pos);
+    if (pos == len)
+      break;
+
     const size_t chrLen = SizeOfUtf8Char(strC + pos);
     if (chrLen == 0)
       return hiAscii; // non valid UTF-8 sequence
@@ -146,3 +509,28 @@ inline size_t CUtf8Utils::SizeOfUtf8Char(const char* const str)
 
   return 0; // invalid UTF-8 char sequence
 }
+
+bool CUtf8Utils::Utf8ToUtf32(const std::string& utf8, std::u32string& utf32, bool failOnBadChar)
+{
+  return Utf8ToUnicode(utf8, utf32, failOnBadChar);
+}
+
+bool CUtf8Utils::Utf8ToW(const std::string& utf8, std::wstring& wstr, bool failOnBadChar)
+{
+  return Utf8ToUnicode(utf8, wstr, failOnBadChar);
+}
+
+bool CUtf8Utils::Utf32ToUtf8(const std::u32string& utf32, std::string& utf8, bool failOnBadChar)
+{
+  return UnicodeToUtf8(utf32.data(), utf32.length(), utf8, false, failOnBadChar);
+}
+
+bool CUtf8Utils::WToUtf8(const std::wstring& wstr, std::string& utf8, bool failOnBadChar)
+{
+  return UnicodeToUtf8(wstr.data(), wstr.length(), utf8, false, failOnBadChar);
+}
+
+bool CUtf8Utils::Utf16ToUtf8(const std::u16string& utf16, std::string& utf8, bool swapBytes, bool failOnBadChar)
+{
+  return UnicodeToUtf8(utf16.data(), utf16.length(), utf8, swapBytes, failOnBadChar);
+}
@@ -37,6 +37,46 @@ public:
   static size_t RFindValidUtf8Char(const std::string& str, const size_t startPos);
 
   static size_t SizeOfUtf8Char(const std::string& str, const size_t charStart = 0);
+
+  /**
+   * Convert UTF-8 to UTF-32 without going through iconv
+   * @param utf8 string to convert
+   * @param utf32 receives the converted string
+   * @param failOnBadChar if true, fail on invalid sequences, otherwise skip invalid bytes
+   * @return false if failOnBadChar is set and an invalid sequence was found
+   */
+  static bool Utf8ToUtf32(const std::string& utf8, std::u32string& utf32, bool failOnBadChar);
+
+  /**
+   * Convert UTF-8 to wchar_t, which is UTF-32 or UTF-16 depending on the platform
+   * @sa Utf8ToUtf32
+   */
+  static bool Utf8ToW(const std::string& utf8, std::wstring& wstr, bool failOnBadChar);
+
+  /**
+   * Convert UTF-32 to UTF-8 without going through iconv
+   * @param utf32 string to convert
+   * @param utf8 receives the converted string
+   * @param failOnBadChar if true, fail on invalid code points, otherwise skip them
+   * @return false if failOnBadChar is set and an invalid code point was found
+   */
+  static bool Utf32ToUtf8(const std::u32string& utf32, std::string& utf8, bool failOnBadChar);
+
+  /**
+   * Convert wchar_t, which is UTF-32 or UTF-16 depending on the platform, to UTF-8
+   * @sa Utf32ToUtf8
+   */
+  static bool WToUtf8(const std::wstring& wstr, std::string& utf8, bool failOnBadChar);
+
+  /**
+   * Convert UTF-16 to UTF-8 without going through iconv
+   * @param utf16 string to convert
+   * @param utf8 receives the converted string
+   * @param swapBytes true if the byte order of utf16 differs from the byte order of the platform
+   * @param failOnBadChar if true, fail on unpaired surrogates, otherwise skip them
+   * @return false if failOnBadChar is set and an unpaired surrogate was found
+   */
+  static bool Utf16ToUtf8(const std::u16string& utf16, std::string& utf8, bool swapBytes, bool failOnBadChar);
 private:
   static size_t SizeOfUtf8Char(const char* const str);
 };
@@ -8,6 +8,8 @@
 
 #include "Variant.h"
 
+#include <algorithm>
+#include <new>
 #include <stdlib.h>
 #include <string.h>
 #include <utility>
@@ -144,21 +146,19 @@ CVariant::CVariant(VariantType type)
       m_data.dvalue = 0.0;
       break;
     case VariantTypeString:
-      m_data.string = new std::string();
+      new (&m_data.string) std::string();
       break;
     case VariantTypeWideString:
-      m_data.wstring = new std::wstring();
+      new (&m_data.wstring) std::wstring();
       break;
     case VariantTypeArray:
-      m_data.array = new VariantArray();
+      new (&m_data.array) VariantArray();
       break;
     case VariantTypeObject:
-      m_data.map = new VariantMap();
+      new (&m_data.map) VariantMap();
       break;
     default:
-#ifndef TARGET_WINDOWS_STORE // this corrupts the heap in Win10 UWP version
-      memset(&m_data, 0, sizeof(m_data));
-#endif
+      m_data.unsignedinteger = 0;
       break;
   }
 }
@@ -208,87 +208,84 @@ CVariant::CVariant(bool boolean)
 CVariant::CVariant(const char *str)
 {
   m_type = VariantTypeString;
-  m_data.string = new std::string(str);
+  new (&m_data.string) std::string(str);
 }
 
 CVariant::CVariant(const char *str, unsigned int length)
 {
   m_type = VariantTypeString;
-  m_data.string = new std::string(str, length);
+  new (&m_data.string) std::string(str, length);
 }
 
 CVariant::CVariant(const std::string &str)
 {
   m_type = VariantTypeString;
-  m_data.string = new std::string(str);
+  new (&m_data.string) std::string(str);
 }
 
 CVariant::CVariant(std::string &&str)
 {
   m_type = VariantTypeString;
-  m_data.string = new std::string(std::move(str));
+  new (&m_data.string) std::string(std::move(str));
 }
 
 CVariant::CVariant(const wchar_t *str)
 {
   m_type = VariantTypeWideString;
-  m_data.wstring = new std::wstring(str);
+  new (&m_data.wstring) std::wstring(str);
 }
 
 CVariant::CVariant(const wchar_t *str, unsigned int length)
 {
   m_type = VariantTypeWideString;
-  m_data.wstring = new std::wstring(str, length);
+  new (&m_data.wstring) std::wstring(str, length);
 }
 
 CVariant::CVariant(const std::wstring &str)
 {
   m_type = VariantTypeWideString;
-  m_data.wstring = new std::wstring(str);
+  new (&m_data.wstring) std::wstring(str);
 }
 
 CVariant::CVariant(std::wstring &&str)
 {
   m_type = VariantTypeWideString;
-  m_data.wstring = new std::wstring(std::move(str));
+  new (&m_data.wstring) std::wstring(std::move(str));
 }
 
 CVariant::CVariant(const std::vector<std::string> &strArray)
 {
   m_type = VariantTypeArray;
-  m_data.array = new VariantArray;
-  m_data.array->reserve(strArray.size());
+  new (&m_data.array) VariantArray;
+  m_data.array.reserve(strArray.size());
   for (const auto& item : strArray)
-    m_data.array->push_back(CVariant(item));
+    m_data.array.push_back(CVariant(item));
 }
 
 CVariant::CVariant(const std::map<std::string, std::string> &strMap)
 {
   m_type = VariantTypeObject;
-  m_data.map = new VariantMap;
+  new (&m_data.map) VariantMap;
+  // the map is already sorted by key
+  m_data.map.reserve(strMap.size());
   for (std::map<std::string, std::string>::const_iterator it = strMap.begin(); it != strMap.end(); ++it)
-    m_data.map->insert(make_pair(it->first, CVariant(it->second)));
+    m_data.map.emplace_back(it->first, CVariant(it->second));
 }
 
 CVariant::CVariant(const std::map<std::string, CVariant> &variantMap)
 {
   m_type = VariantTypeObject;
-  m_data.map = new VariantMap(variantMap.begin(), variantMap.end());
+  new (&m_data.map) VariantMap(variantMap.begin(), variantMap.end());
 }
 
 CVariant::CVariant(const CVariant &variant)
 {
-  m_type = VariantTypeNull;
-  *this = variant;
+  copyFrom(variant);
 }
 
-CVariant::CVariant(CVariant&& rhs)
+CVariant::CVariant(CVariant&& rhs) noexcept
 {
-  //Set this so that operator= don't try and run cleanup
-  //when we're not initialized.
-  m_type = VariantTypeNull;
-
-  *this = std::move(rhs);
+  moveFrom(std::move(rhs));
 }
 
 CVariant::~CVariant()
@@ -301,23 +298,19 @@ void CVariant::cleanup()
   switch (m_type)
   {
   case VariantTypeString:
-    delete m_data.string;
-    m_data.string = nullptr;
+    m_data.string.~basic_string();
     break;
 
   case VariantTypeWideString:
-    delete m_data.wstring;
-    m_data.wstring = nullptr;
+    m_data.wstring.~basic_string();
     break;
 
   case VariantTypeArray:
-    delete m_data.array;
-    m_data.array = nullptr;
+    m_data.array.~VariantArray();
     break;
 
   case VariantTypeObject:
-    delete m_data.map;
-    m_data.map = nullptr;
+    m_data.map.~VariantMap();
     break;
   default:
     break;
@@ -325,6 +318,100 @@ void CVariant::cleanup()
   m_type = VariantTypeNull;
 }
 
+void CVariant::copyFrom(const CVariant &rhs)
+{
+  m_type = rhs.m_type;
+
+  switch (m_type)
+  {
+  case VariantTypeInteger:
+    m_data.integer = rhs.m_data.integer;
+    break;
+  case VariantTypeUnsignedInteger:
+    m_data.unsignedinteger = rhs.m_data.unsignedinteger;
+    break;
+  case VariantTypeBoolean:
+    m_data.boolean = rhs.m_data.boolean;
+    break;
+  case VariantTypeDouble:
+    m_data.dvalue = rhs.m_data.dvalue;
+    break;
+  case VariantTypeString:
+    new (&m_data.string) std::string(rhs.m_data.string);
+    break;
+  case VariantTypeWideString:
+    new (&m_data.wstring) std::wstring(rhs.m_data.wstring);
+    break;
+  case VariantTypeArray:
+    new (&m_data.array) VariantArray(rhs.m_data.array);
+    break;
+  case VariantTypeObject:
+    new (&m_data.map) VariantMap(rhs.m_data.map);
+    break;
+  default:
+    m_data.unsignedinteger = 0;
+    break;
+  }
+}
+
+void CVariant::moveFrom(CVariant &&rhs)
+{
+  m_type = rhs.m_type;
+
+  switch (m_type)
+  {
+  case VariantTypeInteger:
+    m_data.integer = rhs.m_data.integer;
+    break;
+  case VariantTypeUnsignedInteger:
+    m_data.unsignedinteger = rhs.m_data.unsignedinteger;
+    break;
+  case VariantTypeBoolean:
+    m_data.boolean = rhs.m_data.boolean;
+    break;
+  case VariantTypeDouble:
+    m_data.dvalue = rhs.m_data.dvalue;
+    break;
+  case VariantTypeString:
+    new (&m_data.string) std::string(std::move(rhs.m_data.string));
+    break;
+  case VariantTypeWideString:
+    new (&m_data.wstring) std::wstring(std::move(rhs.m_data.wstring));
+    break;
+  case VariantTypeArray:
+    new (&m_data.array) VariantArray(std::move(rhs.m_data.array));
+    break;
+  case VariantTypeObject:
+    new (&m_data.map) VariantMap(std::move(rhs.m_data.map));
+    break;
+  default:
+    m_data.unsignedinteger = 0;
+    break;
+  }
+
+  // ConstNullVariant has to stay what it is when being moved from
+  if (rhs.m_type != VariantTypeConstNull)
+    rhs.cleanup();
+}
+
+CVariant::VariantMap::iterator CVariant::findMember(const std::string &key)
+{
+  return std::lower_bound(m_data.map.begin(), m_data.map.end(), key,
+                          [](const VariantMap::value_type &member, const std::string &key)
+                          {
+                            return member.first < key;
+                          });
+}
+
+CVariant::VariantMap::const_iterator CVariant::findMember(const std::string &key) const
+{
+  return std::lower_bound(m_data.map.begin(), m_data.map.end(), key,
+                          [](const VariantMap::value_type &member, const std::string &key)
+                          {
+                            return member.first < key;
+                          });
+}
+
 bool CVariant::isInteger() const
 {
   return isSignedInteger() || isUnsignedInteger();
@@ -391,9 +478,9 @@ int64_t CVariant::asInteger(int64_t fallback) const
     case VariantTypeDouble:
       return (int64_t)m_data.dvalue;
     case VariantTypeString:
-      return str2int64(*m_data.string, fallback);
+      return str2int64(m_data.string, fallback);
     case VariantTypeWideString:
-      return str2int64(*m_data.wstring, fallback);
+      return str2int64(m_data.wstring, fallback);
     default:
       return fallback;
   }
@@ -417,9 +504,9 @@ uint64_t CVariant::asUnsignedInteger(uint64_t fallback) const
     case VariantTypeDouble:
       return (uint64_t)m_data.dvalue;
     case VariantTypeString:
-      return str2uint64(*m_data.string, fallback);
+      return str2uint64(m_data.string, fallback);
     case VariantTypeWideString:
-      return str2uint64(*m_data.wstring, fallback);
+      return str2uint64(m_data.wstring, fallback);
     default:
       return fallback;
   }
@@ -443,9 +530,9 @@ double CVariant::asDouble(double fallback) const
     case VariantTypeUnsignedInteger:
       return (double)m_data.unsignedinteger;
     case VariantTypeString:
-      return str2double(*m_data.string, fallback);
+      return str2double(m_data.string, fallback);
     case VariantTypeWideString:
-      return str2double(*m_data.wstring, fallback);
+      return str2double(m_data.wstring, fallback);
     default:
       return fallback;
   }
@@ -464,9 +551,9 @@ float CVariant::asFloat(float fallback) const
     case VariantTypeUnsignedInteger:
       return (float)m_data.unsignedinteger;
     case VariantTypeString:
-      return (float)str2double(*m_data.string, fallback);
+      return (float)str2double(m_data.string, fallback);
     case VariantTypeWideString:
-      return (float)str2double(*m_data.wstring, fallback);
+      return (float)str2double(m_data.wstring, fallback);
     default:
       return fallback;
   }
@@ -487,11 +574,11 @@ bool CVariant::asBoolean(bool fallback) const
     case VariantTypeDouble:
       return (m_data.dvalue != 0);
     case VariantTypeString:
-      if (m_data.string->empty() || m_data.string->compare("0") == 0 || m_data.string->compare("false") == 0)
+      if (m_data.string.empty() || m_data.string.compare("0") == 0 || m_data.string.compare("false") == 0)
         return false;
       return true;
     case VariantTypeWideString:
-      if (m_data.wstring->empty() || m_data.wstring->compare(L"0") == 0 || m_data.wstring->compare(L"false") == 0)
+      if (m_data.wstring.empty() || m_data.wstring.compare(L"0") == 0 || m_data.wstring.compare(L"false") == 0)
         return false;
       return true;
     default:
@@ -506,7 +593,7 @@ std::string CVariant::asString(const std::string &fallback /* = "" */) const
   switch (m_type)
   {
     case VariantTypeString:
-      return *m_data.string;
+      return m_data.string;
     case VariantTypeBoolean:
       return m_data.boolean ? "true" : "false";
     case VariantTypeInteger:
@@ -527,7 +614,7 @@ std::wstring CVariant::asWideString(const std::wstring &fallback /* = L"" */) co
   switch (m_type)
   {
     case VariantTypeWideString:
-      return *m_data.wstring;
+      return m_data.wstring;
     case VariantTypeBoolean:
       return m_data.boolean ? L"true" : L"false";
     case VariantTypeInteger:
@@ -548,28 +635,36 @@ CVariant &CVariant::operator[](const std::string &key)
   if (m_type == VariantTypeNull)
   {
     m_type = VariantTypeObject;
-    m_data.map = new VariantMap;
+    new (&m_data.map) VariantMap;
   }
 
   if (m_type == VariantTypeObject)
-    return (*m_data.map)[key];
+  {
+    VariantMap::iterator it = findMember(key);
+    if (it == m_data.map.end() || it->first != key)
+      it = m_data.map.emplace(it, key, CVariant());
+    return it->second;
+  }
   else
     return ConstNullVariant;
 }
 
 const CVariant &CVariant::operator[](const std::string &key) const
 {
-  VariantMap::const_iterator it;
-  if (m_type == VariantTypeObject && (it = m_data.map->find(key)) != m_data.map->end())
-    return it->second;
-  else
-    return ConstNullVariant;
+  if (m_type == VariantTypeObject)
+  {
+    VariantMap::const_iterator it = findMember(key);
+    if (it != m_data.map.end() && it->first == key)
+      return it->second;
+  }
+
+  return ConstNullVariant;
 }
 
 CVariant &CVariant::operator[](unsigned int position)
 {
   if (m_type == VariantTypeArray && size() > position)
-    return m_data.array->at(position);
+    return m_data.array.at(position);
   else
     return ConstNullVariant;
 }
@@ -577,7 +672,7 @@ CVariant &CVariant::operator[](unsigned int position)
 const CVariant &CVariant::operator[](unsigned int position) const
 {
   if (m_type == VariantTypeArray && size() > position)
-    return m_data.array->at(position);
+    return m_data.array.at(position);
   else
     return ConstNullVariant;
 }
@@ -587,67 +682,23 @@ CVariant &CVariant::operator=(const CVariant &rhs)
   if (m_type == VariantTypeConstNull || this == &rhs)
     return *this;
 
+  // rhs may be part of this variant
+  CVariant copy(rhs);
   cleanup();
-
-  m_type = rhs.m_type;
-
-  switch (m_type)
-  {
-  case VariantTypeInteger:
-    m_data.integer = rhs.m_data.integer;
-    break;
-  case VariantTypeUnsignedInteger:
-    m_data.unsignedinteger = rhs.m_data.unsignedinteger;
-    break;
-  case VariantTypeBoolean:
-    m_data.boolean = rhs.m_data.boolean;
-    break;
-  case VariantTypeDouble:
-    m_data.dvalue = rhs.m_data.dvalue;
-    break;
-  case VariantTypeString:
-    m_data.string = new std::string(*rhs.m_data.string);
-    break;
-  case VariantTypeWideString:
-    m_data.wstring = new std::wstring(*rhs.m_data.wstring);
-    break;
-  case VariantTypeArray:
-    m_data.array = new VariantArray(rhs.m_data.array->begin(), rhs.m_data.array->end());
-    break;
-  case VariantTypeObject:
-    m_data.map = new VariantMap(rhs.m_data.map->begin(), rhs.m_data.map->end());
-    break;
-  default:
-    break;
-  }
+  moveFrom(std::move(copy));
 
   return *this;
 }
 
-CVariant& CVariant::operator=(CVariant&& rhs)
+CVariant& CVariant::operator=(CVariant&& rhs) noexcept
 {
   if (m_type == VariantTypeConstNull || this == &rhs)
     return *this;
 
-  //Make sure that if we're moved into we don't leak any pointers
-  if (m_type != VariantTypeNull)
-    cleanup();
-
-  m_type = rhs.m_type;
-  m_data = std::move(rhs.m_data);
-
-  //Should be enough to just set m_type here
-  //but better safe than sorry, could probably lead to coverity warnings
-  if (rhs.m_type == VariantTypeString)
-    rhs.m_data.string = nullptr;
-  else if (rhs.m_type == VariantTypeWideString)
-    rhs.m_data.wstring = nullptr;
-  else if (rhs.m_type == VariantTypeArray)
-    rhs.m_data.array = nullptr;
-  else if (rhs.m_type == VariantTypeObject)
-    rhs.m_data.map = nullptr;
-
-  rhs.m_type = VariantTypeNull;
+  // rhs may be part of this variant
+  CVariant temp(std::move(rhs));
+  cleanup();
+  moveFrom(std::move(temp));
 
   return *this;
 }
@@ -667,13 +718,13 @@ bool CVariant::operator==(const CVariant &rhs) const
     case VariantTypeDouble:
       return m_data.dvalue == rhs.m_data.dvalue;
     case VariantTypeString:
-      return *m_data.string == *rhs.m_data.string;
+      return m_data.string == rhs.m_data.string;
     case VariantTypeWideString:
-      return *m_data.wstring == *rhs.m_data.wstring;
+      return m_data.wstring == rhs.m_data.wstring;
     case VariantTypeArray:
-      return *m_data.array == *rhs.m_data.array;
+      return m_data.array == rhs.m_data.array;
     case VariantTypeObject:
-      return *m_data.map == *rhs.m_data.map;
+      return m_data.map == rhs.m_data.map;
     default:
       break;
     }
@@ -687,11 +738,11 @@ void CVariant::push_back(const CVariant &variant)
   if (m_type == VariantTypeNull)
   {
     m_type = VariantTypeArray;
-    m_data.array = new VariantArray;
+    new (&m_data.array) VariantArray;
   }
 
   if (m_type == VariantTypeArray)
-    m_data.array->push_back(variant);
+    m_data.array.push_back(variant);
 }
 
 void CVariant::push_back(CVariant &&variant)
@@ -699,11 +750,11 @@ void CVariant::push_back(CVariant &&variant)
   if (m_type == VariantTypeNull)
   {
     m_type = VariantTypeArray;
-    m_data.array = new VariantArray;
+    new (&m_data.array) VariantArray;
   }
 
   if (m_type == VariantTypeArray)
-    m_data.array->push_back(std::move(variant));
+    m_data.array.push_back(std::move(variant));
 }
 
 void CVariant::append(const CVariant &variant)
@@ -719,27 +770,25 @@ void CVariant::append(CVariant&& variant)
 const char *CVariant::c_str() const
 {
   if (m_type == VariantTypeString)
-    return m_data.string->c_str();
+    return m_data.string.c_str();
   else
     return NULL;
 }
 
 void CVariant::swap(CVariant &rhs)
 {
-  VariantType  temp_type = m_type;
-  VariantUnion temp_data = m_data;
-
-  m_type = rhs.m_type;
-  m_data = rhs.m_data;
+  if (this == &rhs)
+    return;
 
-  rhs.m_type = temp_type;
-  rhs.m_data = temp_data;
+  CVariant temp(std::move(rhs));
+  rhs.moveFrom(std::move(*this));
+  moveFrom(std::move(temp));
 }
 
 CVariant::iterator_array CVariant::begin_array()
 {
   if (m_type == VariantTypeArray)
-    return m_data.array->begin();
+    return m_data.array.begin();
   else
     return EMPTY_ARRAY.begin();
 }
@@ -747,7 +796,7 @@ CVariant::iterator_array CVariant::begin_array()
 CVariant::const_iterator_array CVariant::begin_array() const
 {
   if (m_type == VariantTypeArray)
-    return m_data.array->begin();
+    return m_data.array.begin();
   else
     return EMPTY_ARRAY.begin();
 }
@@ -755,7 +804,7 @@ CVariant::const_iterator_array CVariant::begin_array() const
 CVariant::iterator_array CVariant::end_array()
 {
   if (m_type == VariantTypeArray)
-    return m_data.array->end();
+    return m_data.array.end();
   else
     return EMPTY_ARRAY.end();
 }
@@ -763,7 +812,7 @@ CVariant::iterator_array CVariant::end_array()
 CVariant::const_iterator_array CVariant::end_array() const
 {
   if (m_type == VariantTypeArray)
-    return m_data.array->end();
+    return m_data.array.end();
   else
     return EMPTY_ARRAY.end();
 }
@@ -771,7 +820,7 @@ CVariant::const_iterator_array CVariant::end_array() const
 CVariant::iterator_map CVariant::begin_map()
 {
   if (m_type == VariantTypeObject)
-    return m_data.map->begin();
+    return m_data.map.begin();
   else
     return EMPTY_MAP.begin();
 }
@@ -779,7 +828,7 @@ CVariant::iterator_map CVariant::begin_map()
 CVariant::const_iterator_map CVariant::begin_map() const
 {
   if (m_type == VariantTypeObject)
-    return m_data.map->begin();
+    return m_data.map.begin();
   else
     return EMPTY_MAP.begin();
 }
@@ -787,7 +836,7 @@ CVariant::const_iterator_map CVariant::begin_map() const
 CVariant::iterator_map CVariant::end_map()
 {
   if (m_type == VariantTypeObject)
-    return m_data.map->end();
+    return m_data.map.end();
   else
     return EMPTY_MAP.end();
 }
@@ -795,7 +844,7 @@ CVariant::iterator_map CVariant::end_map()
 CVariant::const_iterator_map CVariant::end_map() const
 {
   if (m_type == VariantTypeObject)
-    return m_data.map->end();
+    return m_data.map.end();
   else
     return EMPTY_MAP.end();
 }
@@ -803,13 +852,13 @@ CVariant::const_iterator_map CVariant::end_map() const
 unsigned int CVariant::size() const
 {
   if (m_type == VariantTypeObject)
-    return m_data.map->size();
+    return m_data.map.size();
   else if (m_type == VariantTypeArray)
-    return m_data.array->size();
+    return m_data.array.size();
   else if (m_type == VariantTypeString)
-    return m_data.string->size();
+    return m_data.string.size();
   else if (m_type == VariantTypeWideString)
-    return m_data.wstring->size();
+    return m_data.wstring.size();
   else
     return 0;
 }
@@ -817,13 +866,13 @@ unsigned int CVariant::size() const
 bool CVariant::empty() const
 {
   if (m_type == VariantTypeObject)
-    return m_data.map->empty();
+    return m_data.map.empty();
   else if (m_type == VariantTypeArray)
-    return m_data.array->empty();
+    return m_data.array.empty();
   else if (m_type == VariantTypeString)
-    return m_data.string->empty();
+    return m_data.string.empty();
   else if (m_type == VariantTypeWideString)
-    return m_data.wstring->empty();
+    return m_data.wstring.empty();
   else if (m_type == VariantTypeNull)
     return true;
 
@@ -833,13 +882,13 @@ bool CVariant::empty() const
 void CVariant::clear()
 {
   if (m_type == VariantTypeObject)
-    m_data.map->clear();
+    m_data.map.clear();
   else if (m_type == VariantTypeArray)
-    m_data.array->clear();
+    m_data.array.clear();
   else if (m_type == VariantTypeString)
-    m_data.string->clear();
+    m_data.string.clear();
   else if (m_type == VariantTypeWideString)
-    m_data.wstring->clear();
+    m_data.wstring.clear();
 }
 
 void CVariant::erase(const std::string &key)
@@ -847,10 +896,14 @@ void CVariant::erase(const std::string &key)
   if (m_type == VariantTypeNull)
   {
     m_type = VariantTypeObject;
-    m_data.map = new VariantMap;
+    new (&m_data.map) VariantMap;
   }
   else if (m_type == VariantTypeObject)
-    m_data.map->erase(key);
+  {
+    VariantMap::iterator it = findMember(key);
+    if (it != m_data.map.end() && it->first == key)
+      m_data.map.erase(it);
+  }
 }
 
 void CVariant::erase(unsigned int position)
@@ -858,17 +911,20 @@ void CVariant::erase(unsigned int position)
   if (m_type == VariantTypeNull)
   {
     m_type = VariantTypeArray;
-    m_data.array = new VariantArray;
+    new (&m_data.array) VariantArray;
   }
 
   if (m_type == VariantTypeArray && position < size())
-    m_data.array->erase(m_data.array->begin() + position);
+    m_data.array.erase(m_data.array.begin() + position);
 }
 
 bool CVariant::isMember(const std::string &key) const
 {
   if (m_type == VariantTypeObject)
-    return m_data.map->find(key) != m_data.map->end();
+  {
+    VariantMap::const_iterator it = findMember(key);
+    return it != m_data.map.end() && it->first == key;
+  }
 
   return false;
 }
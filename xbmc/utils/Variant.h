@@ -11,6 +11,7 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <utility>
 #include <stdint.h>
 #include <wchar.h>
 
@@ -64,7 +65,7 @@ public:
   CVariant(const std::map<std::string, std::string> &strMap);
   CVariant(const std::map<std::string, CVariant> &variantMap);
   CVariant(const CVariant &variant);
-  CVariant(CVariant &&rhs);
+  CVariant(CVariant &&rhs) noexcept;
   ~CVariant();
 
 
@@ -98,7 +99,7 @@ public:
   const CVariant &operator[](unsigned int position) const;
 
   CVariant &operator=(const CVariant &rhs);
-  CVariant &operator=(CVariant &&rhs);
+  CVariant &operator=(CVariant &&rhs) noexcept;
   bool operator==(const CVariant &rhs) const;
   bool operator!=(const CVariant &rhs) const { return !(*this == rhs); }
 
@@ -113,7 +114,13 @@ public:
 
 private:
   typedef std::vector<CVariant> VariantArray;
-  typedef std::map<std::string, CVariant> VariantMap;
+  /*!
+   Members of an object, sorted by key. Lookups are binary searches over
+   contiguous memory and an object costs a single allocation, at the price of
+   references to members being invalidated when other members are added or
+   removed.
+   */
+  typedef std::vector<std::pair<std::string, CVariant>> VariantMap;
 
 public:
   typedef VariantArray::iterator        iterator_array;
@@ -144,16 +151,27 @@ public:
 
 private:
   void cleanup();
+  void copyFrom(const CVariant &rhs);
+  void moveFrom(CVariant &&rhs);
+
+  VariantMap::iterator findMember(const std::string &key);
+  VariantMap::const_iterator findMember(const std::string &key) const;
+
+  // strings and containers are stored in place, short strings don't need any
+  // allocation at all
   union VariantUnion
   {
+    VariantUnion() {}
+    ~VariantUnion() {}
+
     int64_t integer;
     uint64_t unsignedinteger;
     bool boolean;
     double dvalue;
-    std::string *string;
-    std::wstring *wstring;
-    VariantArray *array;
-    VariantMap *map;
+    std::string string;
+    std::wstring wstring;
+    VariantArray array;
+    VariantMap map;
   };
 
   VariantType m_type;
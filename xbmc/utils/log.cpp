@@ -12,10 +12,19 @@
 #include "settings/AdvancedSettings.h"
 #include "settings/SettingsComponent.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "threads/Thread.h"
 #include "utils/StringUtils.h"
 
+#include <algorithm>
+#include <atomic>
+#include <inttypes.h>
+#include <memory>
+#include <stdio.h>
+#include <thread>
+
 #if defined(TARGET_POSIX)
 #include "platform/posix/utils/PosixInterfaceForCLog.h"
 typedef class CPosixInterfaceForCLog PlatformInterfaceForCLog;
@@ -34,10 +43,105 @@ static const char* const logLevelNames[] =
 
 namespace
 {
+// lines queued in asynchronous mode, must be a power of two
+const size_t ASYNC_LOG_LINES = 8192;
+// queued lines reach the disk at least this often (ms)
+const unsigned int ASYNC_LOG_FLUSH_INTERVAL = 500;
+// the writer is woken up early once this many lines are waiting
+const size_t ASYNC_LOG_WAKEUP_LINES = ASYNC_LOG_LINES / 8;
+// buffers of longer lines aren't kept in the queue
+const size_t ASYNC_LOG_MAX_LINE_CAPACITY = 4096;
+
+/*!
+ * Bounded queue of formatted log lines with many producers and a single consumer. Producers
+ * claim a slot by advancing the enqueue position, the slot sequence hands the line to the writer.
+ */
+class CLogLineQueue
+{
+public:
+  CLogLineQueue() : m_slots(new Slot[ASYNC_LOG_LINES])
+  {
+    for (size_t i = 0; i < ASYNC_LOG_LINES; i++)
+      m_slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  bool Push(int logLevel, const std::string& line, size_t messageOffset)
+  {
+    size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true)
+    {
+      slot = &m_slots[pos & (ASYNC_LOG_LINES - 1)];
+      const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+      if (diff == 0)
+      {
+        if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      }
+      else if (diff < 0)
+        return false; // the writer didn't free this slot yet, we're full
+      else
+        pos = m_enqueuePos.load(std::memory_order_relaxed);
+    }
+
+    slot->logLevel = logLevel;
+    slot->messageOffset = messageOffset;
+    slot->line.assign(line);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  //! Pass the oldest line to write() and remove it, only to be called by the writer
+  template<typename F>
+  bool Pop(F&& write)
+  {
+    const size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+    Slot& slot = m_slots[pos & (ASYNC_LOG_LINES - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != pos + 1)
+      return false;
+
+    write(slot.logLevel, slot.line, slot.messageOffset);
+    if (slot.line.capacity() > ASYNC_LOG_MAX_LINE_CAPACITY)
+      std::string().swap(slot.line);
+
+    slot.sequence.store(pos + ASYNC_LOG_LINES, std::memory_order_release);
+    m_dequeuePos.store(pos + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  size_t Pending() const
+  {
+    return m_enqueuePos.load(std::memory_order_relaxed) - m_dequeuePos.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct Slot
+  {
+    std::atomic<size_t> sequence;
+    int logLevel = LOGNONE;
+    size_t messageOffset = 0;
+    std::string line;
+  };
+
+  std::unique_ptr<Slot[]> m_slots;
+  std::atomic<size_t> m_enqueuePos{0};
+  std::atomic<size_t> m_dequeuePos{0};
+};
+
 class CLogGlobals
 {
 public:
-  ~CLogGlobals() = default;
+  ~CLogGlobals()
+  {
+    m_async = false;
+    if (m_writer.joinable())
+    {
+      m_stopWriter = true;
+      m_writerEvent.Set();
+      m_writer.join();
+    }
+  }
   PlatformInterfaceForCLog m_platform;
   int         m_repeatCount = 0;
   int         m_repeatLogLevel = -1;
@@ -45,9 +149,59 @@ public:
   int         m_logLevel = LOG_LEVEL_DEBUG;
   int         m_extraLogLevels = 0;
   CCriticalSection critSec;
+
+  // asynchronous mode, the writer thread holds critSec while writing
+  std::atomic<bool> m_async{false};
+  std::unique_ptr<CLogLineQueue> m_queue;
+  std::thread m_writer;
+  std::atomic<bool> m_stopWriter{false};
+  std::atomic<bool> m_writerWaiting{false};
+  CEvent m_writerEvent;
+  std::atomic<uint64_t> m_droppedLines{0};
+  uint64_t m_reportedDroppedLines = 0;
+  CCriticalSection m_asyncSection;
 };
 
 static CLogGlobals g_logState;
+
+/*!
+ * Format a line as it's written to the log file
+ * \return position of the message in line
+ */
+size_t FormatLogLine(std::string& line, int logLevel, const std::string& message)
+{
+  static const char* prefixFormat = "%02d-%02d-%02d %02d:%02d:%02d.%03d T:%" PRIu64" %7s: ";
+
+  int year, month, day, hour, minute, second;
+  double millisecond;
+  PlatformInterfaceForCLog::GetCurrentLocalTime(year, month, day, hour, minute, second, millisecond);
+
+  char prefix[128];
+  const int length = snprintf(prefix, sizeof(prefix), prefixFormat,
+                              year,
+                              month,
+                              day,
+                              hour,
+                              minute,
+                              second,
+                              static_cast<int>(millisecond),
+                              (uint64_t)CThread::GetDisplayThreadId(CThread::GetCurrentThreadId()),
+                              levelNames[logLevel]);
+  line.assign(prefix, std::max(0, std::min(length, static_cast<int>(sizeof(prefix)) - 1)));
+  const size_t messageOffset = line.size();
+
+  /* fixup newline alignment, number of spaces should equal prefix length */
+  size_t start = 0;
+  for (size_t pos = message.find('\n'); pos != std::string::npos; pos = message.find('\n', start))
+  {
+    line.append(message, start, pos - start);
+    line.append("\n                                            ");
+    start = pos + 1;
+  }
+  line.append(message, start, std::string::npos);
+
+  return messageOffset;
+}
 }
 
 CLog::CLog() = default;
@@ -56,6 +210,8 @@ CLog::~CLog() = default;
 
 void CLog::Close()
 {
+  StopAsyncLogging();
+
   CSingleLock waitLock(g_logState.critSec);
   g_logState.m_platform.CloseLogFile();
   g_logState.m_repeatLine.clear();
@@ -63,6 +219,12 @@ void CLog::Close()
 
 void CLog::LogString(int logLevel, std::string&& logString)
 {
+  if (g_logState.m_async)
+  {
+    QueueLogString(logLevel, std::move(logString));
+    return;
+  }
+
   CSingleLock waitLock(g_logState.critSec);
   std::string strData(logString);
   StringUtils::TrimRight(strData);
@@ -188,26 +350,155 @@ void CLog::PrintDebugString(const std::string& line)
 
 bool CLog::WriteLogString(int logLevel, const std::string& logString)
 {
-  static const char* prefixFormat = "%02d-%02d-%02d %02d:%02d:%02d.%03d T:%" PRIu64" %7s: ";
+  std::string strData;
+  FormatLogLine(strData, logLevel, logString);
 
-  std::string strData(logString);
-  /* fixup newline alignment, number of spaces should equal prefix length */
-  StringUtils::Replace(strData, "\n", "\n                                            ");
+  return g_logState.m_platform.WriteStringToLog(strData);
+}
 
-  int year, month, day, hour, minute, second;
-  double millisecond;
-  g_logState.m_platform.GetCurrentLocalTime(year, month, day, hour, minute, second, millisecond);
-
-  strData = StringUtils::Format(prefixFormat,
-                                  year,
-                                  month,
-                                  day,
-                                  hour,
-                                  minute,
-                                  second,
-                                  static_cast<int>(millisecond),
-                                  (uint64_t)CThread::GetDisplayThreadId(CThread::GetCurrentThreadId()),
-                                  levelNames[logLevel]) + strData;
+void CLog::SetAsyncLogging(bool enabled)
+{
+  if (!enabled)
+  {
+    StopAsyncLogging();
+    return;
+  }
 
-  return g_logState.m_platform.WriteStringToLog(strData);
+  CSingleLock lock(g_logState.m_asyncSection);
+  if (g_logState.m_async)
+    return;
+
+  // the queue is kept once created, producers may still hold on to it after stopping
+  if (!g_logState.m_queue)
+    g_logState.m_queue.reset(new CLogLineQueue());
+
+  // not a CThread, those log about themselves
+  g_logState.m_stopWriter = false;
+  g_logState.m_writer = std::thread(WriteQueuedLogStrings);
+  g_logState.m_async = true;
+}
+
+uint64_t CLog::GetDroppedLines()
+{
+  return g_logState.m_droppedLines;
+}
+
+void CLog::StopAsyncLogging()
+{
+  CSingleLock lock(g_logState.m_asyncSection);
+  if (!g_logState.m_async)
+    return;
+
+  g_logState.m_async = false;
+  g_logState.m_stopWriter = true;
+  g_logState.m_writerEvent.Set();
+  g_logState.m_writer.join();
+
+  // write what was queued while the writer was stopping
+  CSingleLock waitLock(g_logState.critSec);
+  DrainQueuedLogStrings();
+  g_logState.m_platform.FlushLogFile();
+}
+
+void CLog::QueueLogString(int logLevel, std::string&& logString)
+{
+  StringUtils::TrimRight(logString);
+  if (logString.empty())
+    return;
+
+  // format on the calling thread, into a buffer that is reused for all its lines
+  static thread_local std::string line;
+  const size_t messageOffset = FormatLogLine(line, logLevel, logString);
+
+  if (!g_logState.m_queue->Push(logLevel, line, messageOffset))
+  {
+    g_logState.m_droppedLines++;
+    if (g_logState.m_writerWaiting.exchange(false))
+      g_logState.m_writerEvent.Set();
+    return;
+  }
+
+  // severe errors might be followed by a crash, get them to disk right away
+  if ((logLevel & LOGMASK) >= LOGSEVERE)
+    g_logState.m_writerEvent.Set();
+  else if (g_logState.m_queue->Pending() >= ASYNC_LOG_WAKEUP_LINES && g_logState.m_writerWaiting.exchange(false))
+    g_logState.m_writerEvent.Set();
+}
+
+void CLog::WriteQueuedLogStrings()
+{
+  XbmcThreads::EndTime nextFlush(ASYNC_LOG_FLUSH_INTERVAL);
+  bool unflushed = false;
+
+  while (true)
+  {
+    const bool stop = g_logState.m_stopWriter;
+    {
+      CSingleLock waitLock(g_logState.critSec);
+      if (DrainQueuedLogStrings())
+        unflushed = true;
+
+      if (unflushed && (stop || nextFlush.IsTimePast()))
+      {
+        g_logState.m_platform.FlushLogFile();
+        unflushed = false;
+        nextFlush.Set(ASYNC_LOG_FLUSH_INTERVAL);
+      }
+    }
+
+    if (stop)
+      break;
+
+    g_logState.m_writerWaiting = true;
+    if (g_logState.m_queue->Pending() < ASYNC_LOG_WAKEUP_LINES)
+      g_logState.m_writerEvent.WaitMSec(unflushed ? nextFlush.MillisLeft() : ASYNC_LOG_FLUSH_INTERVAL);
+    g_logState.m_writerWaiting = false;
+  }
+}
+
+bool CLog::DrainQueuedLogStrings()
+{
+  bool written = false;
+
+  const uint64_t droppedLines = g_logState.m_droppedLines;
+  if (droppedLines != g_logState.m_reportedDroppedLines)
+  {
+    WriteLogString(LOGWARNING, StringUtils::Format("Dropped %" PRIu64 " log lines, the log queue was full.",
+                                                   droppedLines - g_logState.m_reportedDroppedLines));
+    g_logState.m_reportedDroppedLines = droppedLines;
+    written = true;
+  }
+
+  auto write = [](int logLevel, const std::string& line, size_t messageOffset)
+  {
+    // the same repeat handling as LogString(), on the message without the prefix
+    if (g_logState.m_repeatLogLevel == logLevel &&
+        line.compare(messageOffset, std::string::npos, g_logState.m_repeatLine) == 0)
+    {
+      g_logState.m_repeatCount++;
+      return;
+    }
+    else if (g_logState.m_repeatCount)
+    {
+      std::string strData2 = StringUtils::Format("Previous line repeats %d times.",
+                                                g_logState.m_repeatCount);
+      PrintDebugString(strData2);
+      WriteLogString(g_logState.m_repeatLogLevel, strData2);
+      g_logState.m_repeatCount = 0;
+    }
+
+    g_logState.m_repeatLine.assign(line, messageOffset, std::string::npos);
+    g_logState.m_repeatLogLevel = logLevel;
+
+#if defined(_DEBUG) || defined(PROFILE)
+    PrintDebugString(g_logState.m_repeatLine);
+#endif // defined(_DEBUG) || defined(PROFILE)
+
+    g_logState.m_platform.WriteStringToLog(line, (logLevel & LOGMASK) >= LOGSEVERE);
+  };
+
+  while (g_logState.m_queue->Pop(write))
+    written = true;
+
+  return written;
 }
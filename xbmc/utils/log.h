@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <stdint.h>
 #include <string>
 #include <utility>
 
@@ -98,8 +99,23 @@ public:
   static void SetExtraLogLevels(int level);
   static bool IsLogLevelLogged(int loglevel);
 
+  /*!
+   \brief Write the log file from a background thread.
+   Log calls then only format the line and queue it in a bounded buffer. Lines are dropped
+   and counted when the buffer is full. Disabling it, or calling Close(), waits until all
+   queued lines have been written.
+   */
+  static void SetAsyncLogging(bool enabled);
+  static uint64_t GetDroppedLines();
+
 protected:
   static void LogString(int logLevel, std::string&& logString);
   static void LogString(int logLevel, int component, std::string&& logString);
   static bool WriteLogString(int logLevel, const std::string& logString);
+
+private:
+  static void QueueLogString(int logLevel, std::string&& logString);
+  static void WriteQueuedLogStrings();
+  static bool DrainQueuedLogStrings();
+  static void StopAsyncLogging();
 };
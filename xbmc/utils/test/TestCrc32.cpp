@@ -6,7 +6,15 @@
  *  See LICENSES/README.md for more information.
  */
 
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
 #include "utils/Crc32.h"
+#include "utils/StringUtils.h"
 
 #include "gtest/gtest.h"
 
@@ -48,3 +56,141 @@ TEST(TestCrc32, Reset)
   varcrc = a;
   EXPECT_EQ(0xffffffff, varcrc);
 }
+
+namespace
+{
+
+const int BENCHMARK_PATHS = 1000000;
+const size_t BENCHMARK_BUFFER_SIZE = 64 * 1024 * 1024;
+
+//! The byte at a time implementation Crc32 used to have
+class CByteCrc32
+{
+public:
+  CByteCrc32()
+  {
+    for (uint32_t byte = 0; byte < 256; byte++)
+    {
+      uint32_t crc = byte << 24;
+      for (int bit = 0; bit < 8; bit++)
+        crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+      m_table[byte] = crc;
+    }
+  }
+
+  uint32_t Compute(const char* buffer, size_t count) const
+  {
+    uint32_t crc = 0xFFFFFFFF;
+    while (count--)
+      crc = (crc << 8) ^ m_table[((crc >> 24) ^ *buffer++) & 0xFF];
+    return crc;
+  }
+
+  uint32_t ComputeFromLowerCase(const std::string& strValue) const
+  {
+    std::string strLower = strValue;
+    StringUtils::ToLower(strLower);
+    return Compute(strLower.c_str(), strlen(strLower.c_str()));
+  }
+
+private:
+  uint32_t m_table[256];
+};
+
+std::string GetPath(int i)
+{
+  return "smb://NAS/Movies/Some Movie Title (" + std::to_string(1950 + i % 70) + ")/Some.Movie.Title." +
+         std::to_string(i) + ".1080p.BluRay.x264.MKV";
+}
+
+double Milliseconds(std::chrono::steady_clock::duration duration)
+{
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+}
+
+TEST(TestCrc32, MatchesByteAtATime)
+{
+  const CByteCrc32 reference;
+  std::mt19937 random(42);
+  std::vector<char> data(4096 + 16);
+  for (char& byte : data)
+    byte = static_cast<char>(random());
+
+  for (size_t size = 0; size <= 4096; size += size < 300 ? 1 : 61)
+  {
+    for (size_t offset = 0; offset < 16; offset += 5)
+    {
+      Crc32 crc;
+      crc.Compute(data.data() + offset, size);
+      ASSERT_EQ(reference.Compute(data.data() + offset, size), static_cast<uint32_t>(crc)) << size;
+
+      // in two parts
+      Crc32 parts;
+      parts.Compute(data.data() + offset, size / 3);
+      parts.Compute(data.data() + offset + size / 3, size - size / 3);
+      ASSERT_EQ(static_cast<uint32_t>(crc), static_cast<uint32_t>(parts)) << size;
+    }
+  }
+}
+
+TEST(TestCrc32, ComputeFromLowerCaseLong)
+{
+  const CByteCrc32 reference;
+  std::string path;
+  for (int i = 0; i < 20; i++)
+    path += GetPath(i) + "|";
+  EXPECT_EQ(reference.ComputeFromLowerCase(path), Crc32::ComputeFromLowerCase(path));
+
+  // stops at the first null character like it always did
+  const std::string withNull("ABC\0DEF", 7);
+  EXPECT_EQ(Crc32::ComputeFromLowerCase("ABC"), Crc32::ComputeFromLowerCase(withNull));
+}
+
+TEST(TestCrc32, DISABLED_BenchmarkPaths)
+{
+  const CByteCrc32 reference;
+  std::vector<std::string> paths;
+  paths.reserve(BENCHMARK_PATHS);
+  for (int i = 0; i < BENCHMARK_PATHS; i++)
+    paths.push_back(GetPath(i));
+
+  uint32_t sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (const std::string& path : paths)
+    sum += reference.ComputeFromLowerCase(path);
+  const double byteMs = Milliseconds(std::chrono::steady_clock::now() - start);
+
+  start = std::chrono::steady_clock::now();
+  for (const std::string& path : paths)
+    sum -= Crc32::ComputeFromLowerCase(path);
+  const double crcMs = Milliseconds(std::chrono::steady_clock::now() - start);
+
+  printf("%d paths of %zu bytes, ComputeFromLowerCase: byte at a time %.2f ms, now %.2f ms\n",
+         BENCHMARK_PATHS, paths[0].size(), byteMs, crcMs);
+  EXPECT_EQ(0u, sum);
+}
+
+TEST(TestCrc32, DISABLED_BenchmarkBuffer)
+{
+  const CByteCrc32 reference;
+  std::vector<char> buffer(BENCHMARK_BUFFER_SIZE);
+  std::mt19937 random(42);
+  for (char& byte : buffer)
+    byte = static_cast<char>(random());
+
+  auto start = std::chrono::steady_clock::now();
+  const uint32_t expected = reference.Compute(buffer.data(), buffer.size());
+  const double byteMs = Milliseconds(std::chrono::steady_clock::now() - start);
+
+  start = std::chrono::steady_clock::now();
+  Crc32 crc;
+  crc.Compute(buffer.data(), buffer.size());
+  const double crcMs = Milliseconds(std::chrono::steady_clock::now() - start);
+
+  printf("%zu MiB buffer: byte at a time %.2f ms (%.0f MiB/s), now %.2f ms (%.0f MiB/s)\n",
+         buffer.size() >> 20, byteMs, (buffer.size() >> 20) * 1000.0 / byteMs, crcMs,
+         (buffer.size() >> 20) * 1000.0 / crcMs);
+  EXPECT_EQ(expected, static_cast<uint32_t>(crc));
+}
@@ -0,0 +1,147 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "utils/Digest.h"
+#include "utils/FastHash.h"
+
+#include "gtest/gtest.h"
+
+using KODI::UTILITY::CDigest;
+using KODI::UTILITY::CFastHash;
+
+namespace
+{
+
+const int BENCHMARK_PATHS = 1000000;
+const size_t BENCHMARK_BUFFER_SIZE = 64 * 1024 * 1024;
+
+const char refdata[] = "abcdefghijklmnopqrstuvwxyz"
+                       "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                       "01234567890!@#$%^&*()";
+
+std::string GetPath(int i)
+{
+  return "smb://NAS/Movies/Some Movie Title (" + std::to_string(1950 + i % 70) + ")/Some.Movie.Title." +
+         std::to_string(i) + ".1080p.BluRay.x264.mkv";
+}
+
+double Milliseconds(std::chrono::steady_clock::duration duration)
+{
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+}
+
+TEST(TestFastHash, Calculate)
+{
+  // reference values of XXH64
+  EXPECT_EQ(0xEF46DB3751D8E999ULL, CFastHash::Calculate(""));
+  EXPECT_EQ(0xEF46DB3751D8E999ULL, CFastHash::Calculate(nullptr, 0));
+  EXPECT_EQ(0xD24EC4F1A98C6E5BULL, CFastHash::Calculate("a"));
+  EXPECT_EQ(0x44BC2CF5AD770999ULL, CFastHash::Calculate("abc"));
+  EXPECT_EQ(0xF7DFE208A6429641ULL, CFastHash::Calculate(refdata));
+  EXPECT_EQ(0x7FDC8D05D433B4EBULL, CFastHash::Calculate(refdata, sizeof(refdata) - 1, 42));
+}
+
+TEST(TestFastHash, Update)
+{
+  CFastHash empty;
+  EXPECT_EQ("ef46db3751d8e999", empty.Finalize());
+
+  // every split of the data gives the same hash
+  const std::string data(refdata);
+  for (size_t split = 0; split <= data.size(); split++)
+  {
+    CFastHash hash(42);
+    hash.Update(data.substr(0, split));
+    hash.Update(data.c_str() + split, data.size() - split);
+    ASSERT_EQ(0x7FDC8D05D433B4EBULL, hash.FinalizeRaw()) << split;
+  }
+
+  std::mt19937 random(42);
+  std::vector<unsigned char> bytes(1000);
+  for (unsigned char& byte : bytes)
+    byte = static_cast<unsigned char>(random());
+  CFastHash pieces;
+  for (size_t pos = 0; pos < bytes.size();)
+  {
+    const size_t size = std::min<size_t>(random() % 70, bytes.size() - pos);
+    pieces.Update(bytes.data() + pos, size);
+    pos += size;
+  }
+  EXPECT_EQ(CFastHash::Calculate(bytes.data(), bytes.size()), pieces.FinalizeRaw());
+}
+
+TEST(TestFastHash, DISABLED_BenchmarkPaths)
+{
+  // hashing the items of a directory like the library scanners do
+  std::vector<std::string> paths;
+  paths.reserve(BENCHMARK_PATHS);
+  for (int i = 0; i < BENCHMARK_PATHS; i++)
+    paths.push_back(GetPath(i));
+  const int64_t size = 1234567890;
+
+  auto start = std::chrono::steady_clock::now();
+  CDigest digest{CDigest::Type::MD5};
+  for (const std::string& path : paths)
+  {
+    digest.Update(path);
+    digest.Update(&size, sizeof(size));
+  }
+  digest.Finalize();
+  const double md5Ms = Milliseconds(std::chrono::steady_clock::now() - start);
+
+  start = std::chrono::steady_clock::now();
+  CFastHash hash;
+  for (const std::string& path : paths)
+  {
+    hash.Update(path);
+    hash.Update(&size, sizeof(size));
+  }
+  const std::string value = hash.Finalize();
+  const double fastMs = Milliseconds(std::chrono::steady_clock::now() - start);
+
+  start = std::chrono::steady_clock::now();
+  uint64_t sum = 0;
+  for (const std::string& path : paths)
+    sum += CFastHash::Calculate(path);
+  const double keysMs = Milliseconds(std::chrono::steady_clock::now() - start);
+
+  printf("%d paths of %zu bytes: MD5 %.2f ms, fast hash %.2f ms, one key per path %.2f ms\n",
+         BENCHMARK_PATHS, paths[0].size(), md5Ms, fastMs, keysMs);
+  EXPECT_EQ(16u, value.size());
+  EXPECT_NE(0u, sum);
+}
+
+TEST(TestFastHash, DISABLED_BenchmarkBuffer)
+{
+  std::vector<char> buffer(BENCHMARK_BUFFER_SIZE);
+  std::mt19937 random(42);
+  for (char& byte : buffer)
+    byte = static_cast<char>(random());
+
+  auto start = std::chrono::steady_clock::now();
+  CDigest::Calculate(CDigest::Type::MD5, buffer.data(), buffer.size());
+  const double md5Ms = Milliseconds(std::chrono::steady_clock::now() - start);
+
+  start = std::chrono::steady_clock::now();
+  const uint64_t value = CFastHash::Calculate(buffer.data(), buffer.size());
+  const double fastMs = Milliseconds(std::chrono::steady_clock::now() - start);
+
+  printf("%zu MiB buffer: MD5 %.2f ms (%.0f MiB/s), fast hash %.2f ms (%.0f MiB/s)\n",
+         buffer.size() >> 20, md5Ms, (buffer.size() >> 20) * 1000.0 / md5Ms, fastMs,
+         (buffer.size() >> 20) * 1000.0 / fastMs);
+  EXPECT_NE(0u, value);
+}
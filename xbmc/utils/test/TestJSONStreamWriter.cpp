@@ -0,0 +1,333 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#if defined(TARGET_LINUX)
+#include <malloc.h>
+#endif
+
+#include "utils/JSONStreamWriter.h"
+#include "utils/JSONVariantWriter.h"
+#include "utils/StreamDetails.h"
+#include "utils/StringUtils.h"
+#include "utils/Variant.h"
+#include "video/VideoInfoTag.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+// allocation statistics of the whole process, used by the benchmark
+std::atomic<uint64_t> allocationCount(0);
+std::atomic<uint64_t> allocatedBytes(0);
+std::atomic<uint64_t> liveBytes(0);
+std::atomic<uint64_t> peakLiveBytes(0);
+
+struct AllocationStats
+{
+  uint64_t count;
+  uint64_t bytes;
+  uint64_t peakBytes;
+};
+
+class CAllocationCounter
+{
+public:
+  CAllocationCounter()
+  : m_count(allocationCount),
+    m_bytes(allocatedBytes),
+    m_liveBytes(liveBytes)
+  {
+    peakLiveBytes = m_liveBytes;
+  }
+
+  AllocationStats Get() const
+  {
+    return { allocationCount - m_count, allocatedBytes - m_bytes, peakLiveBytes - m_liveBytes };
+  }
+
+private:
+  const uint64_t m_count;
+  const uint64_t m_bytes;
+  const uint64_t m_liveBytes;
+};
+
+}
+
+#if defined(TARGET_LINUX)
+// memory returned by the counting operator new is plain malloc() memory, sizes are taken from the allocator
+void* operator new(size_t size)
+{
+  void* ptr = malloc(size);
+  if (ptr == nullptr)
+    throw std::bad_alloc();
+
+  const uint64_t usableSize = malloc_usable_size(ptr);
+  allocationCount++;
+  allocatedBytes += usableSize;
+  const uint64_t live = liveBytes += usableSize;
+  uint64_t peak = peakLiveBytes;
+  while (live > peak && !peakLiveBytes.compare_exchange_weak(peak, live))
+    ;
+
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+  if (ptr == nullptr)
+    return;
+
+  liveBytes -= malloc_usable_size(ptr);
+  free(ptr);
+}
+#endif
+
+namespace
+{
+
+const int BENCHMARK_MOVIES = 10000;
+
+CVariant GetNestedVariant()
+{
+  CVariant variant;
+  variant["string"] = "value with \"quotes\"";
+  variant["integer"] = -42;
+  variant["unsigned"] = static_cast<uint64_t>(42);
+  variant["double"] = 0.5;
+  variant["boolean"] = true;
+  variant["null"] = CVariant();
+  variant["array"].push_back(1);
+  variant["array"].push_back("two");
+  variant["array"].push_back(CVariant(CVariant::VariantTypeObject));
+  variant["object"]["member"] = CVariant(CVariant::VariantTypeArray);
+  return variant;
+}
+
+void FillMovie(CVideoInfoTag& movie, int index)
+{
+  const std::string suffix = StringUtils::Format("%d", index);
+
+  movie.m_type = MediaTypeMovie;
+  movie.m_iDbId = index + 1;
+  movie.SetTitle("Movie " + suffix);
+  movie.SetOriginalTitle("Original movie " + suffix);
+  movie.SetSortTitle("Movie " + suffix);
+  movie.SetPlot("A rather long plot of movie " + suffix + ", describing what happens in a few sentences. "
+                "Long enough to be representative of what scrapers usually store in the library.");
+  movie.SetPlotOutline("Short outline of movie " + suffix);
+  movie.SetTagLine("Tagline of movie " + suffix);
+  movie.SetGenre({ "Action", "Adventure", "Science Fiction" });
+  movie.SetDirector({ "Director " + suffix });
+  movie.SetWritingCredits({ "Writer " + suffix, "Another writer" });
+  movie.SetStudio({ "Studio " + suffix });
+  movie.SetCountry({ "United States of America" });
+  movie.SetTags({ "tag", "another tag" });
+  movie.SetMPAARating("Rated PG-13");
+  movie.SetTrailer("plugin://plugin.video.trailers/?id=" + suffix);
+  movie.SetFileNameAndPath("/storage/movies/Movie " + suffix + "/movie.mkv");
+  movie.SetPremieredFromDBDate("2018-06-01");
+  movie.SetRating(7.5f, 1000 + index, "themoviedb", true);
+  movie.SetRating(7.1f, 2000 + index, "imdb");
+  movie.SetUniqueID("tt" + suffix, "imdb", true);
+  movie.SetUniqueID(suffix, "tmdb");
+  movie.m_iTop250 = index % 250;
+  movie.m_iUserRating = index % 10;
+
+  for (int i = 0; i < 10; i++)
+  {
+    SActorInfo actor;
+    actor.strName = StringUtils::Format("Actor %d", i);
+    actor.strRole = StringUtils::Format("Role %d", i);
+    actor.order = i;
+    movie.m_cast.push_back(actor);
+  }
+
+  CStreamDetailVideo* video = new CStreamDetailVideo();
+  video->m_strCodec = "h264";
+  video->m_iWidth = 1920;
+  video->m_iHeight = 1080;
+  video->m_fAspect = 1.78f;
+  video->m_iDuration = 7200;
+  movie.m_streamDetails.AddStream(video);
+
+  CStreamDetailAudio* audio = new CStreamDetailAudio();
+  audio->m_strCodec = "ac3";
+  audio->m_strLanguage = "eng";
+  audio->m_iChannels = 6;
+  movie.m_streamDetails.AddStream(audio);
+}
+
+bool WriteMovieTree(const std::vector<CVideoInfoTag>& movies, std::string& json)
+{
+  const int total = static_cast<int>(movies.size());
+  CVariant result;
+  result["limits"]["start"] = 0;
+  result["limits"]["end"] = total;
+  result["limits"]["total"] = total;
+  for (const CVideoInfoTag& movie : movies)
+  {
+    CVariant object;
+    movie.Serialize(object);
+    result["movies"].append(object);
+  }
+
+  CVariant response;
+  response["result"] = result;
+  return CJSONVariantWriter::Write(response, json, true);
+}
+
+bool StreamMovieList(const std::vector<CVideoInfoTag>& movies, std::string& json)
+{
+  const int total = static_cast<int>(movies.size());
+  CVariant limits;
+  limits["start"] = 0;
+  limits["end"] = total;
+  limits["total"] = total;
+
+  CJSONStreamWriter writer(true);
+  if (!writer.StartObject() || !writer.Key("result") || !writer.StartObject() ||
+      !writer.Key("limits") || !writer.Value(limits) ||
+      !writer.Key("movies") || !writer.StartArray())
+    return false;
+
+  for (const CVideoInfoTag& movie : movies)
+  {
+    CVariant object;
+    movie.Serialize(object);
+    if (!writer.Value(object))
+      return false;
+  }
+
+  if (!writer.EndArray() || !writer.EndObject() || !writer.EndObject())
+    return false;
+
+  json = writer.GetString();
+  return true;
+}
+
+void ReportBenchmark(const char* name, const AllocationStats& stats, std::chrono::steady_clock::duration duration)
+{
+  const double ms = std::chrono::duration<double, std::milli>(duration).count();
+  printf("%s: %d movies, %.2f ms, %llu allocations, %llu KiB allocated, %llu KiB peak\n",
+         name, BENCHMARK_MOVIES, ms,
+         static_cast<unsigned long long>(stats.count),
+         static_cast<unsigned long long>(stats.bytes / 1024),
+         static_cast<unsigned long long>(stats.peakBytes / 1024));
+}
+
+}
+
+TEST(TestJSONStreamWriter, WritesTokens)
+{
+  CJSONStreamWriter writer(true);
+  ASSERT_TRUE(writer.StartObject());
+  ASSERT_TRUE(writer.Key("list"));
+  ASSERT_TRUE(writer.StartArray());
+  ASSERT_TRUE(writer.Null());
+  ASSERT_TRUE(writer.Bool(false));
+  ASSERT_TRUE(writer.Int64(-1));
+  ASSERT_TRUE(writer.Uint64(1));
+  ASSERT_TRUE(writer.Double(0.5));
+  ASSERT_TRUE(writer.String("a\"b"));
+  ASSERT_TRUE(writer.EndArray());
+  EXPECT_FALSE(writer.IsComplete());
+  ASSERT_TRUE(writer.EndObject());
+  EXPECT_TRUE(writer.IsComplete());
+
+  EXPECT_STREQ("{\"list\":[null,false,-1,1,0.5,\"a\\\"b\"]}", writer.GetString().c_str());
+}
+
+TEST(TestJSONStreamWriter, WritesVariantsLikeJSONVariantWriter)
+{
+  const CVariant variant = GetNestedVariant();
+
+  for (bool compact : { true, false })
+  {
+    std::string expected;
+    ASSERT_TRUE(CJSONVariantWriter::Write(variant, expected, compact));
+
+    CJSONStreamWriter writer(compact);
+    ASSERT_TRUE(writer.Value(variant));
+    EXPECT_TRUE(writer.IsComplete());
+    EXPECT_EQ(expected, writer.GetString());
+  }
+}
+
+TEST(TestJSONStreamWriter, MixesTokensAndVariants)
+{
+  CVariant variant;
+  variant["limits"]["total"] = 2;
+  variant["items"].push_back(GetNestedVariant());
+  variant["items"].push_back(GetNestedVariant());
+
+  std::string expected;
+  ASSERT_TRUE(CJSONVariantWriter::Write(variant, expected, false));
+
+  CJSONStreamWriter writer(false);
+  ASSERT_TRUE(writer.StartObject());
+  ASSERT_TRUE(writer.Key("items"));
+  ASSERT_TRUE(writer.StartArray());
+  ASSERT_TRUE(writer.Value(GetNestedVariant()));
+  ASSERT_TRUE(writer.Value(GetNestedVariant()));
+  ASSERT_TRUE(writer.EndArray());
+  ASSERT_TRUE(writer.Key("limits"));
+  ASSERT_TRUE(writer.Value(variant["limits"]));
+  ASSERT_TRUE(writer.EndObject());
+
+  EXPECT_EQ(expected, writer.GetString());
+}
+
+TEST(TestJSONStreamWriter, StreamsMovieListLikeVariantTree)
+{
+  std::vector<CVideoInfoTag> movies(3);
+  for (int i = 0; i < 3; i++)
+    FillMovie(movies[i], i);
+
+  std::string tree;
+  ASSERT_TRUE(WriteMovieTree(movies, tree));
+  std::string streamed;
+  ASSERT_TRUE(StreamMovieList(movies, streamed));
+
+  EXPECT_EQ(tree, streamed);
+}
+
+TEST(TestJSONStreamWriter, DISABLED_BenchmarkMovieList)
+{
+  std::vector<CVideoInfoTag> movies(BENCHMARK_MOVIES);
+  for (int i = 0; i < BENCHMARK_MOVIES; i++)
+    FillMovie(movies[i], i);
+
+  // the way JSON-RPC responses were built: a CVariant tree of the whole list, written afterwards
+  std::string tree;
+  {
+    CAllocationCounter counter;
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(WriteMovieTree(movies, tree));
+    ReportBenchmark("CVariant tree", counter.Get(), std::chrono::steady_clock::now() - start);
+  }
+
+  // streamed: only a single movie exists as CVariant at a time
+  std::string streamed;
+  {
+    CAllocationCounter counter;
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(StreamMovieList(movies, streamed));
+    ReportBenchmark("streamed", counter.Get(), std::chrono::steady_clock::now() - start);
+  }
+
+  EXPECT_EQ(tree, streamed);
+}
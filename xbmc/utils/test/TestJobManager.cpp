@@ -10,7 +10,11 @@
 #include "utils/Job.h"
 
 #include "gtest/gtest.h"
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 #ifdef TARGET_POSIX
 #include "platform/linux/XTimeUtils.h"
@@ -170,3 +174,171 @@ TEST_F(TestJobManager, IsProcessing)
 
   job->FinishAndStopBlocking();
 }
+
+namespace
+{
+const unsigned int BENCHMARK_JOBS = 20000;
+const unsigned int BENCHMARK_PRODUCERS = 4;
+
+class CountingJob : public CJob
+{
+public:
+  explicit CountingJob(std::atomic<unsigned int> &started) : m_started(started) {}
+
+  bool DoWork() override
+  {
+    m_started++;
+    return true;
+  }
+
+private:
+  std::atomic<unsigned int> &m_started;
+};
+
+class LatencyJob : public CJob
+{
+public:
+  LatencyJob(std::chrono::steady_clock::duration &latency) :
+    m_latency(latency),
+    m_queued(std::chrono::steady_clock::now())
+  {
+  }
+
+  bool DoWork() override
+  {
+    m_latency = std::chrono::steady_clock::now() - m_queued;
+    return true;
+  }
+
+private:
+  std::chrono::steady_clock::duration &m_latency;
+  const std::chrono::steady_clock::time_point m_queued;
+};
+
+class CompletionCounter : public IJobCallback
+{
+public:
+  explicit CompletionCounter(unsigned int expected) : m_expected(expected) {}
+
+  void OnJobComplete(unsigned int jobID, bool success, CJob *job) override
+  {
+    if (++m_completed == m_expected)
+    {
+      m_done.Set();
+      m_signalled = true;
+    }
+  }
+
+  // returns once the last callback doesn't use this object anymore, so it may go out of scope
+  bool Wait(unsigned int milliseconds)
+  {
+    if (!m_done.WaitMSec(milliseconds))
+      return false;
+    while (!m_signalled)
+      std::this_thread::yield();
+    return true;
+  }
+
+  unsigned int Completed() const { return m_completed; }
+
+private:
+  const unsigned int m_expected;
+  std::atomic<unsigned int> m_completed{0};
+  std::atomic<bool> m_signalled{false};
+  CEvent m_done;
+};
+
+//! Adds jobs of mixed priorities from several threads at once
+void AddJobsConcurrently(unsigned int producerCount, unsigned int jobs, std::atomic<unsigned int> &started, CompletionCounter &callback)
+{
+  std::vector<std::thread> producers;
+  for (unsigned int i = 0; i < producerCount; i++)
+  {
+    producers.emplace_back([jobs, &started, &callback, i]() {
+      for (unsigned int job = 0; job < jobs; job++)
+        CJobManager::GetInstance().AddJob(new CountingJob(started), &callback,
+                                          CJob::PRIORITY(CJob::PRIORITY_LOW + (job + i) % 3));
+    });
+  }
+  for (auto &producer : producers)
+    producer.join();
+}
+}
+
+TEST_F(TestJobManager, CancelQueuedJob)
+{
+  // keep pausable jobs from starting, so the job is still queued when it is cancelled
+  CJobManager::GetInstance().PauseJobs();
+  std::atomic<unsigned int> started(0);
+  CompletionCounter callback(1);
+  unsigned int id = CJobManager::GetInstance().AddJob(new CountingJob(started), &callback, CJob::PRIORITY_LOW_PAUSABLE);
+  EXPECT_NE(0u, id);
+  CJobManager::GetInstance().CancelJob(id);
+  CJobManager::GetInstance().UnPauseJobs();
+
+  Sleep(100);
+  EXPECT_EQ(0u, started);
+  EXPECT_EQ(0u, callback.Completed());
+}
+
+TEST_F(TestJobManager, AddJobFromJob)
+{
+  std::atomic<unsigned int> started(0);
+  CompletionCounter callback(1);
+  CJobManager::GetInstance().Submit([&started, &callback]() {
+    CJobManager::GetInstance().AddJob(new CountingJob(started), &callback, CJob::PRIORITY_NORMAL);
+  }, CJob::PRIORITY_NORMAL);
+
+  EXPECT_TRUE(callback.Wait(5000));
+  EXPECT_EQ(1u, started);
+}
+
+TEST_F(TestJobManager, AddJobConcurrently)
+{
+  const unsigned int jobs = 500;
+  std::atomic<unsigned int> started(0);
+  CompletionCounter callback(jobs * BENCHMARK_PRODUCERS);
+
+  AddJobsConcurrently(BENCHMARK_PRODUCERS, jobs, started, callback);
+
+  ASSERT_TRUE(callback.Wait(20000));
+  EXPECT_EQ(jobs * BENCHMARK_PRODUCERS, started);
+}
+
+TEST_F(TestJobManager, DISABLED_BenchmarkThroughput)
+{
+  std::atomic<unsigned int> started(0);
+  CompletionCounter callback(BENCHMARK_JOBS * BENCHMARK_PRODUCERS);
+
+  const auto start = std::chrono::steady_clock::now();
+  AddJobsConcurrently(BENCHMARK_PRODUCERS, BENCHMARK_JOBS, started, callback);
+
+  ASSERT_TRUE(callback.Wait(60000));
+  const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  EXPECT_EQ(BENCHMARK_JOBS * BENCHMARK_PRODUCERS, started);
+
+  printf("%u producers, %u jobs: %.2f ms, %.0f jobs/s\n",
+         BENCHMARK_PRODUCERS, BENCHMARK_JOBS * BENCHMARK_PRODUCERS, ms,
+         BENCHMARK_JOBS * BENCHMARK_PRODUCERS * 1000.0 / ms);
+}
+
+TEST_F(TestJobManager, DISABLED_BenchmarkLatency)
+{
+  const unsigned int jobs = 1000;
+  std::vector<std::chrono::steady_clock::duration> latencies(jobs);
+
+  for (unsigned int i = 0; i < jobs; i++)
+  {
+    // one job at a time, so every job finds idle workers
+    CompletionCounter callback(1);
+    CJobManager::GetInstance().AddJob(new LatencyJob(latencies[i]), &callback, CJob::PRIORITY_NORMAL);
+    ASSERT_TRUE(callback.Wait(5000));
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  auto us = [](std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+  };
+  printf("%u jobs, start latency: median %.1f us, 99th percentile %.1f us, max %.1f us\n",
+         jobs, us(latencies[jobs / 2]), us(latencies[jobs * 99 / 100]), us(latencies.back()));
+}
@@ -0,0 +1,354 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "utils/MemoryBudget.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+const size_t KB = 1024;
+const size_t MB = 1024 * 1024;
+
+//! A cache of real allocations, oldest trimmed first, with entries in use that can't be trimmed
+class CTestCache : public IMemoryConsumer
+{
+public:
+  void Add(size_t size)
+  {
+    m_entries.emplace_back(size, 1);
+    m_used += size;
+  }
+
+  void SetInUse(size_t size) { m_inUse = size; }
+
+  size_t GetMemoryUsage() const override { return m_used + m_inUse; }
+  size_t GetTrimmableMemory() const override { return m_used; }
+
+  size_t TrimMemory(size_t bytes) override
+  {
+    m_trimRequests++;
+    size_t freed = 0;
+    while (freed < bytes && !m_entries.empty())
+    {
+      freed += m_entries.front().size();
+      m_entries.pop_front();
+    }
+    m_used -= freed;
+    return freed;
+  }
+
+  int m_trimRequests = 0;
+
+private:
+  std::deque<std::vector<char>> m_entries;
+  size_t m_used = 0;
+  size_t m_inUse = 0;
+};
+
+//! A cache that can't give anything back, like stream buffers in use
+class CPinnedCache : public IMemoryConsumer
+{
+public:
+  explicit CPinnedCache(size_t used) : m_used(used) {}
+  size_t GetMemoryUsage() const override { return m_used; }
+  size_t GetTrimmableMemory() const override { return 0; }
+  size_t TrimMemory(size_t bytes) override { return 0; }
+
+private:
+  size_t m_used;
+};
+
+//! Process memory is a fixed base plus whatever the caches hold
+class CTestBudget : public CMemoryBudget
+{
+public:
+  CTestBudget(uint64_t limit, uint64_t base, const std::vector<IMemoryConsumer*>& caches)
+  : m_limit(limit), m_base(base), m_caches(caches)
+  {
+  }
+
+protected:
+  bool GetMemoryStatus(uint64_t& used, uint64_t& limit) override
+  {
+    used = m_base;
+    for (const IMemoryConsumer* cache : m_caches)
+      used += cache->GetMemoryUsage();
+    limit = m_limit;
+    return true;
+  }
+
+private:
+  uint64_t m_limit;
+  uint64_t m_base;
+  std::vector<IMemoryConsumer*> m_caches;
+};
+
+const MemoryConsumerUsage* Find(const MemoryBudgetUsage& usage, const std::string& name)
+{
+  for (const MemoryConsumerUsage& consumer : usage.consumers)
+  {
+    if (consumer.name == name)
+      return &consumer;
+  }
+  return nullptr;
+}
+
+}
+
+TEST(TestMemoryBudget, CacheLimit)
+{
+  CTestCache low;
+  CTestCache normal;
+  CTestBudget budget(1024 * MB, 0, {});
+  budget.RegisterConsumer(&normal, "normal", MEMORY_PRIORITY_NORMAL);
+  budget.RegisterConsumer(&low, "low", MEMORY_PRIORITY_LOW);
+  budget.SetLimits(0, 100 * KB);
+
+  for (int i = 0; i < 8; i++)
+  {
+    low.Add(10 * KB);
+    normal.Add(10 * KB);
+  }
+  budget.Process();
+
+  // the low priority cache gives up its oldest entries first, down to 90% of the limit
+  EXPECT_EQ(10 * KB, low.GetMemoryUsage());
+  EXPECT_EQ(80 * KB, normal.GetMemoryUsage());
+  EXPECT_EQ(0, normal.m_trimRequests);
+
+  std::shared_ptr<const MemoryBudgetUsage> usage = budget.GetUsage();
+  EXPECT_EQ(1024 * MB, usage->memoryLimit);
+  EXPECT_EQ(100 * KB, usage->cacheLimit);
+  EXPECT_EQ(90 * KB, usage->cacheUsed);
+  EXPECT_EQ(70 * KB, usage->trimmed);
+  ASSERT_NE(nullptr, Find(*usage, "low"));
+  EXPECT_EQ(70 * KB, Find(*usage, "low")->trimmed);
+  EXPECT_EQ(MEMORY_PRIORITY_LOW, Find(*usage, "low")->priority);
+
+  // then the normal one
+  low.TrimMemory(10 * KB);
+  normal.Add(30 * KB);
+  budget.Process();
+  EXPECT_EQ(90 * KB, normal.GetMemoryUsage());
+  EXPECT_EQ(1, normal.m_trimRequests);
+
+  // nothing happens up to the limit
+  normal.Add(10 * KB);
+  budget.Process();
+  EXPECT_EQ(100 * KB, normal.GetMemoryUsage());
+  EXPECT_EQ(1, normal.m_trimRequests);
+}
+
+TEST(TestMemoryBudget, DefaultCacheLimit)
+{
+  CTestCache cache;
+  CTestBudget budget(400 * KB, 0, {});
+  budget.RegisterConsumer(&cache, "cache", MEMORY_PRIORITY_NORMAL);
+  for (int i = 0; i < 20; i++)
+    cache.Add(10 * KB);
+  budget.Process();
+
+  // a quarter of the memory limit
+  EXPECT_EQ(100 * KB, budget.GetUsage()->cacheLimit);
+  EXPECT_EQ(90 * KB, cache.GetMemoryUsage());
+}
+
+TEST(TestMemoryBudget, MemoryPressure)
+{
+  CTestCache low;
+  CTestCache high;
+  CPinnedCache pinned(100 * KB);
+  CTestBudget budget(1000 * KB, 700 * KB, { &low, &high, &pinned });
+  budget.RegisterConsumer(&pinned, "pinned", MEMORY_PRIORITY_LOW);
+  budget.RegisterConsumer(&high, "high", MEMORY_PRIORITY_HIGH);
+  budget.RegisterConsumer(&low, "low", MEMORY_PRIORITY_LOW);
+  budget.SetLimits(0, 1000 * KB);
+
+  for (int i = 0; i < 10; i++)
+  {
+    low.Add(5 * KB);
+    high.Add(10 * KB);
+  }
+
+  // 950 KB used, above 90% of the limit, has to go down to 80%
+  budget.Process();
+  EXPECT_EQ(0u, low.GetMemoryUsage());
+  EXPECT_EQ(0u, high.GetMemoryUsage());
+  EXPECT_EQ(150 * KB, budget.GetUsage()->trimmed);
+
+  // below the high watermark nothing happens
+  low.Add(50 * KB);
+  high.Add(40 * KB);
+  budget.Process();
+  EXPECT_EQ(50 * KB, low.GetMemoryUsage());
+  EXPECT_EQ(40 * KB, high.GetMemoryUsage());
+  EXPECT_EQ(890 * KB, budget.GetUsage()->memoryUsed);
+}
+
+TEST(TestMemoryBudget, InUseAboveCacheLimit)
+{
+  // textures on screen and the EPG alone take more than the cache limit
+  CTestCache textures;
+  CTestCache directories;
+  CPinnedCache epg(150 * KB);
+  CTestBudget budget(1024 * MB, 0, {});
+  budget.RegisterConsumer(&textures, "textures", MEMORY_PRIORITY_LOW);
+  budget.RegisterConsumer(&directories, "directories", MEMORY_PRIORITY_NORMAL);
+  budget.RegisterConsumer(&epg, "epg", MEMORY_PRIORITY_HIGH);
+  budget.SetLimits(0, 100 * KB);
+  textures.SetInUse(50 * KB);
+
+  // the caches that can be trimmed keep a quarter of the limit
+  directories.Add(10 * KB);
+  directories.Add(10 * KB);
+  budget.Process();
+  EXPECT_EQ(20 * KB, directories.GetMemoryUsage());
+  EXPECT_EQ(0, textures.m_trimRequests);
+  EXPECT_EQ(0, directories.m_trimRequests);
+  EXPECT_EQ(220 * KB, budget.GetUsage()->cacheUsed);
+
+  // and are trimmed when they exceed that, not emptied
+  textures.Add(10 * KB);
+  budget.Process();
+  EXPECT_EQ(50 * KB, textures.GetMemoryUsage());
+  EXPECT_EQ(20 * KB, directories.GetMemoryUsage());
+  EXPECT_EQ(0, directories.m_trimRequests);
+
+  // nor trimmed again while they don't grow
+  for (int i = 0; i < 10; i++)
+    budget.Process();
+  EXPECT_EQ(1, textures.m_trimRequests);
+  EXPECT_EQ(0, directories.m_trimRequests);
+  EXPECT_EQ(20 * KB, directories.GetMemoryUsage());
+  EXPECT_EQ(10 * KB, budget.GetUsage()->trimmed);
+  EXPECT_EQ(0u, Find(*budget.GetUsage(), "epg")->trimmed);
+}
+
+TEST(TestMemoryBudget, InUseAboveLowWatermark)
+{
+  CTestCache textures;
+  CPinnedCache inUse(920 * KB);
+  CTestBudget budget(1000 * KB, 0, { &textures, &inUse });
+  budget.RegisterConsumer(&textures, "textures", MEMORY_PRIORITY_LOW);
+  budget.RegisterConsumer(&inUse, "filecache", MEMORY_PRIORITY_HIGH);
+  budget.SetLimits(0, 1000 * KB);
+
+  // 940 KB used, the low watermark of 800 KB can't be reached
+  textures.Add(20 * KB);
+  budget.Process();
+  EXPECT_EQ(0u, textures.GetMemoryUsage());
+  EXPECT_EQ(1, textures.m_trimRequests);
+
+  // the cache may grow by 5% of the limit before it is trimmed again
+  textures.Add(20 * KB);
+  textures.Add(20 * KB);
+  budget.Process();
+  EXPECT_EQ(40 * KB, textures.GetMemoryUsage());
+  EXPECT_EQ(1, textures.m_trimRequests);
+
+  textures.Add(20 * KB);
+  budget.Process();
+  EXPECT_EQ(0u, textures.GetMemoryUsage());
+  EXPECT_EQ(2, textures.m_trimRequests);
+}
+
+TEST(TestMemoryBudget, ConfiguredMemoryLimit)
+{
+  CTestCache cache;
+  CTestBudget budget(0, 100 * KB, { &cache });
+  budget.RegisterConsumer(&cache, "cache", MEMORY_PRIORITY_NORMAL);
+  budget.SetLimits(200 * KB, 1000 * KB);
+  for (int i = 0; i < 10; i++)
+    cache.Add(10 * KB);
+  budget.Process();
+
+  EXPECT_EQ(200 * KB, budget.GetUsage()->memoryLimit);
+  EXPECT_EQ(60 * KB, cache.GetMemoryUsage());
+}
+
+TEST(TestMemoryBudget, ConsumersOfTheSameName)
+{
+  CPinnedCache first(10 * KB);
+  CPinnedCache second(20 * KB);
+  CTestBudget budget(1024 * MB, 0, {});
+  budget.RegisterConsumer(&first, "filecache", MEMORY_PRIORITY_HIGH);
+  budget.RegisterConsumer(&second, "filecache", MEMORY_PRIORITY_HIGH);
+  budget.Process();
+
+  std::shared_ptr<const MemoryBudgetUsage> usage = budget.GetUsage();
+  ASSERT_EQ(1u, usage->consumers.size());
+  EXPECT_EQ(30 * KB, usage->consumers[0].used);
+
+  budget.UnregisterConsumer(&first);
+  budget.Process();
+  // readers keep the version they got
+  EXPECT_EQ(30 * KB, usage->consumers[0].used);
+  EXPECT_EQ(20 * KB, budget.GetUsage()->consumers[0].used);
+
+  budget.UnregisterConsumer(&second);
+  budget.Process();
+  EXPECT_TRUE(budget.GetUsage()->consumers.empty());
+}
+
+TEST(TestMemoryBudget, SyntheticLoad)
+{
+  // caches of a 1 GB box growing under combined load, e.g. browsing the
+  // library while the EPG updates and a stream is buffered, on top of what
+  // the rest of Kodi needs
+  CTestCache directories;
+  CTestCache textures;
+  CTestCache fonts;
+  CPinnedCache epg(80 * MB);
+  CPinnedCache streamBuffer(64 * MB);
+  const uint64_t limit = 1024 * MB;
+  const uint64_t base = 600 * MB;
+  CTestBudget budget(limit, base, { &directories, &textures, &fonts, &epg, &streamBuffer });
+  budget.RegisterConsumer(&textures, "textures", MEMORY_PRIORITY_LOW);
+  budget.RegisterConsumer(&fonts, "fonts", MEMORY_PRIORITY_LOW);
+  budget.RegisterConsumer(&directories, "directories", MEMORY_PRIORITY_NORMAL);
+  budget.RegisterConsumer(&epg, "epg", MEMORY_PRIORITY_HIGH);
+  budget.RegisterConsumer(&streamBuffer, "filecache", MEMORY_PRIORITY_HIGH);
+
+  // in use memory takes most of the default cache limit of 256 MB
+  const uint64_t inUse = 96 * MB;
+  textures.SetInUse(inUse);
+  const uint64_t trimmableLimit = limit / 4 / 4;
+
+  std::mt19937 random(42);
+  for (int i = 0; i < 500; i++)
+  {
+    // the caches grow by up to 2.5 MB between two calls to Process()
+    directories.Add(random() % (512 * KB));
+    textures.Add(random() % (1536 * KB));
+    fonts.Add(random() % (512 * KB));
+
+    budget.Process();
+
+    const uint64_t trimmable = directories.GetTrimmableMemory() + textures.GetTrimmableMemory() +
+                               fonts.GetTrimmableMemory();
+    const uint64_t cacheUsed = directories.GetMemoryUsage() + textures.GetMemoryUsage() +
+                               fonts.GetMemoryUsage() + epg.GetMemoryUsage() + streamBuffer.GetMemoryUsage();
+    ASSERT_EQ(cacheUsed, budget.GetUsage()->cacheUsed) << i;
+    ASSERT_LE(trimmable, trimmableLimit) << i;
+    ASSERT_EQ(inUse, textures.GetMemoryUsage() - textures.GetTrimmableMemory()) << i;
+    ASSERT_LE(base + cacheUsed, limit / 100 * 90) << i;
+  }
+
+  std::shared_ptr<const MemoryBudgetUsage> usage = budget.GetUsage();
+  EXPECT_GT(Find(*usage, "textures")->trimmed, 0u);
+  EXPECT_GT(Find(*usage, "directories")->trimmed, 0u);
+  EXPECT_EQ(64 * MB, Find(*usage, "filecache")->used);
+  EXPECT_EQ(0u, Find(*usage, "filecache")->trimmed);
+  EXPECT_EQ(0u, Find(*usage, "epg")->trimmed);
+}
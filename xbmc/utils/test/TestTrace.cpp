@@ -0,0 +1,140 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/JSONVariantParser.h"
+#include "utils/Trace.h"
+#include "utils/Variant.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+const int BENCHMARK_THREADS = 4;
+const int BENCHMARK_SPANS = 1000000;
+
+std::vector<CVariant> GetSpans(unsigned int milliseconds, const std::string& name)
+{
+  CVariant trace;
+  EXPECT_TRUE(CJSONVariantParser::Parse(CTrace::Serialize(milliseconds), trace));
+  EXPECT_TRUE(trace["traceEvents"].isArray());
+
+  std::vector<CVariant> spans;
+  for (auto it = trace["traceEvents"].begin_array(); it != trace["traceEvents"].end_array(); ++it)
+  {
+    if ((*it)["ph"].asString() == "X" && (*it)["name"].asString() == name)
+      spans.push_back(*it);
+  }
+  return spans;
+}
+
+//! Records spans from several threads while another one keeps dumping, returns the number of dumps
+int RecordWhileDumping(int threadCount, int spans, const char* name, std::chrono::steady_clock::duration& duration)
+{
+  std::atomic<bool> done(false);
+  std::atomic<int> recording(threadCount);
+  std::vector<std::thread> threads;
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < threadCount; i++)
+  {
+    threads.emplace_back([spans, name, &recording]() {
+      for (int span = 0; span < spans; span++)
+        CTraceSpan traceSpan(name);
+
+      // the buffer of a finished thread is taken over by the next one, keep them all
+      recording--;
+      while (recording > 0)
+        std::this_thread::yield();
+    });
+  }
+
+  // dumping has to cope with spans being recorded meanwhile
+  int dumps = 0;
+  std::thread dumper([&done, &dumps]() {
+    while (!done)
+    {
+      CVariant trace;
+      EXPECT_TRUE(CJSONVariantParser::Parse(CTrace::Serialize(1000), trace));
+      dumps++;
+    }
+  });
+
+  for (auto& thread : threads)
+    thread.join();
+  duration = std::chrono::steady_clock::now() - start;
+  done = true;
+  dumper.join();
+  return dumps;
+}
+
+}
+
+TEST(TestTrace, RecordsSpans)
+{
+  const int64_t start = CTrace::Now();
+  {
+    CTraceSpan span("TestTrace::RecordsSpans");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+
+  std::vector<CVariant> spans = GetSpans(10000, "TestTrace::RecordsSpans");
+  ASSERT_EQ(1u, spans.size());
+  EXPECT_GE(spans[0]["ts"].asInteger(), start);
+  EXPECT_GE(spans[0]["dur"].asInteger(), 20000);
+  EXPECT_EQ(1, spans[0]["pid"].asInteger());
+  EXPECT_TRUE(spans[0].isMember("tid"));
+}
+
+TEST(TestTrace, SkipsOldSpans)
+{
+  CTrace::Record("TestTrace::SkipsOldSpans", CTrace::Now() - 5000000, 1000);
+
+  EXPECT_TRUE(GetSpans(1000, "TestTrace::SkipsOldSpans").empty());
+  EXPECT_EQ(1u, GetSpans(10000, "TestTrace::SkipsOldSpans").size());
+}
+
+TEST(TestTrace, KeepsMostRecentSpans)
+{
+  std::thread thread([]() {
+    for (unsigned int i = 0; i < 3 * CTrace::TRACE_BUFFER_SIZE; i++)
+      CTrace::Record("TestTrace::KeepsMostRecentSpans", CTrace::Now(), 1);
+  });
+  thread.join();
+
+  EXPECT_EQ(static_cast<size_t>(CTrace::TRACE_BUFFER_SIZE), GetSpans(10000, "TestTrace::KeepsMostRecentSpans").size());
+}
+
+TEST(TestTrace, RecordsWhileDumping)
+{
+  std::chrono::steady_clock::duration duration;
+  RecordWhileDumping(BENCHMARK_THREADS, 3 * CTrace::TRACE_BUFFER_SIZE, "TestTrace::RecordsWhileDumping", duration);
+
+  EXPECT_EQ(static_cast<size_t>(BENCHMARK_THREADS * CTrace::TRACE_BUFFER_SIZE),
+            GetSpans(60000, "TestTrace::RecordsWhileDumping").size());
+}
+
+TEST(TestTrace, DISABLED_BenchmarkThreads)
+{
+  std::chrono::steady_clock::duration duration;
+  const int dumps = RecordWhileDumping(BENCHMARK_THREADS, BENCHMARK_SPANS, "TestTrace::BenchmarkThreads", duration);
+
+  const double ns = std::chrono::duration<double, std::nano>(duration).count();
+  printf("%d threads, %d spans each: %.1f ns per span, %d concurrent dumps\n",
+         BENCHMARK_THREADS, BENCHMARK_SPANS, ns / (BENCHMARK_THREADS * BENCHMARK_SPANS), dumps);
+
+  EXPECT_EQ(static_cast<size_t>(BENCHMARK_THREADS * CTrace::TRACE_BUFFER_SIZE),
+            GetSpans(60000, "TestTrace::BenchmarkThreads").size());
+}
@@ -0,0 +1,279 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <iconv.h>
+
+#include "utils/Utf8Utils.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+const int LABEL_CONVERSIONS = 200000;
+const size_t SUBTITLE_SIZE = 4 * 1024 * 1024;
+const int SUBTITLE_CONVERSIONS = 5;
+
+#ifdef WORDS_BIGENDIAN
+const char* const UTF32_CHARSET = "UTF-32BE";
+#else
+const char* const UTF32_CHARSET = "UTF-32LE";
+#endif
+
+/*!
+ The way conversions between UTF-8 and UTF-32 were done before: a cached iconv
+ descriptor, the string including its terminator as input and an output buffer
+ that grows when needed.
+ */
+class CIconvConverter
+{
+public:
+  CIconvConverter(const char* from, const char* to)
+  : m_iconv(iconv_open(to, from))
+  {
+  }
+
+  ~CIconvConverter()
+  {
+    if (m_iconv != reinterpret_cast<iconv_t>(-1))
+      iconv_close(m_iconv);
+  }
+
+  template<typename INPUT, typename OUTPUT>
+  bool Convert(const INPUT& source, OUTPUT& dest, bool failOnBadChar)
+  {
+    dest.clear();
+    if (source.empty())
+      return true;
+
+    char* inBuf = const_cast<char*>(reinterpret_cast<const char*>(source.c_str()));
+    size_t inBytes = (source.length() + 1) * sizeof(typename INPUT::value_type);
+    std::vector<char> out((source.length() + 1) * 4);
+    char* outBuf = out.data();
+    size_t outBytes = out.size();
+
+    bool result = true;
+    while (iconv(m_iconv, &inBuf, &inBytes, &outBuf, &outBytes) == static_cast<size_t>(-1))
+    {
+      if (errno == E2BIG)
+      {
+        const size_t used = out.size() - outBytes;
+        out.resize(out.size() * 2);
+        outBuf = out.data() + used;
+        outBytes = out.size() - used;
+      }
+      else if (errno == EILSEQ && !failOnBadChar)
+      {
+        inBuf++;
+        inBytes--;
+      }
+      else
+      {
+        result = false;
+        break;
+      }
+    }
+    iconv(m_iconv, nullptr, nullptr, nullptr, nullptr);
+    if (!result)
+      return false;
+
+    const size_t length = (out.size() - outBytes) / sizeof(typename OUTPUT::value_type);
+    dest.assign(reinterpret_cast<const typename OUTPUT::value_type*>(out.data()), length - 1);
+    return true;
+  }
+
+private:
+  iconv_t m_iconv;
+};
+
+// text of a typical subtitle file: mostly US-ASCII with some accented and other non-latin characters
+std::string GetSubtitleText(size_t size)
+{
+  static const char* const lines[] = {
+    "1\n00:00:01,000 --> 00:00:04,000\n",
+    "Where are you going?\n\n",
+    "Qu'est-ce que tu fais l\xC3\xA0-bas, \xC3\xA9trange gar\xC3\xA7on?\n\n",
+    "\xD0\x93\xD0\xB4\xD0\xB5 \xD1\x82\xD1\x8B \xD0\xB1\xD1\x8B\xD0\xBB?\n\n",
+    "\xE6\x88\x91\xE5\x9C\xA8\xE8\xBF\x99\xE9\x87\x8C\xE3\x80\x82 \xF0\x9F\x98\x80\n\n",
+    "<i>Music playing in the background</i>\n\n",
+  };
+
+  std::string text;
+  text.reserve(size + 128);
+  for (size_t line = 0; text.size() < size; line++)
+    text += lines[line % (sizeof(lines) / sizeof(lines[0]))];
+  return text;
+}
+
+std::string GetRandomBytes(std::mt19937& random, size_t size)
+{
+  // mostly valid text, sprinkled with arbitrary bytes
+  std::uniform_int_distribution<int> kind(0, 9);
+  std::uniform_int_distribution<int> byte(1, 255);
+  const std::string valid = GetSubtitleText(256);
+  std::uniform_int_distribution<size_t> offset(0, valid.size() - 1);
+
+  std::string bytes;
+  while (bytes.size() < size)
+  {
+    if (kind(random) == 0)
+      bytes += static_cast<char>(byte(random));
+    else
+      bytes += valid[offset(random)];
+  }
+  return bytes;
+}
+
+double Milliseconds(std::chrono::steady_clock::duration duration)
+{
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+}
+
+TEST(TestUtf8Utils, Utf8ToUtf32)
+{
+  const std::string utf8 = "A long enough US-ASCII prefix, then \xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80 and US-ASCII again";
+  const std::u32string expected = U"A long enough US-ASCII prefix, then é€\U0001F600 and US-ASCII again";
+
+  std::u32string utf32;
+  EXPECT_TRUE(CUtf8Utils::Utf8ToUtf32(utf8, utf32, true));
+  EXPECT_EQ(expected, utf32);
+
+  std::string roundTrip;
+  EXPECT_TRUE(CUtf8Utils::Utf32ToUtf8(utf32, roundTrip, true));
+  EXPECT_EQ(utf8, roundTrip);
+
+  std::wstring wstr;
+  EXPECT_TRUE(CUtf8Utils::Utf8ToW(utf8, wstr, true));
+  EXPECT_EQ(std::wstring(L"A long enough US-ASCII prefix, then é€\U0001F600 and US-ASCII again"), wstr);
+  EXPECT_TRUE(CUtf8Utils::WToUtf8(wstr, roundTrip, true));
+  EXPECT_EQ(utf8, roundTrip);
+}
+
+TEST(TestUtf8Utils, InvalidUtf8)
+{
+  // overlong, surrogate, above U+10FFFF, truncated
+  const std::string utf8 = "a\xC0\xAF" "b\xED\xA0\x80" "c\xF4\x90\x80\x80" "d\xE2\x82";
+
+  std::u32string utf32;
+  EXPECT_FALSE(CUtf8Utils::Utf8ToUtf32(utf8, utf32, true));
+  EXPECT_TRUE(utf32.empty());
+
+  EXPECT_TRUE(CUtf8Utils::Utf8ToUtf32(utf8, utf32, false));
+  EXPECT_EQ(U"abcd", utf32);
+}
+
+TEST(TestUtf8Utils, Utf16ToUtf8)
+{
+  const std::u16string utf16 = u"US-ASCII text longer than a block é\U0001F600";
+  std::string utf8;
+  EXPECT_TRUE(CUtf8Utils::Utf16ToUtf8(utf16, utf8, false, true));
+  EXPECT_EQ("US-ASCII text longer than a block \xC3\xA9\xF0\x9F\x98\x80", utf8);
+
+  std::u16string swapped(utf16);
+  for (auto& unit : swapped)
+    unit = static_cast<char16_t>((unit << 8) | (unit >> 8));
+  EXPECT_TRUE(CUtf8Utils::Utf16ToUtf8(swapped, utf8, true, true));
+  EXPECT_EQ("US-ASCII text longer than a block \xC3\xA9\xF0\x9F\x98\x80", utf8);
+
+  // unpaired surrogate
+  EXPECT_FALSE(CUtf8Utils::Utf16ToUtf8(u"a\xD800" "b", utf8, false, true));
+  EXPECT_TRUE(CUtf8Utils::Utf16ToUtf8(u"a\xD800" "b", utf8, false, false));
+  EXPECT_EQ("ab", utf8);
+}
+
+TEST(TestUtf8Utils, MatchesIconv)
+{
+  CIconvConverter toUtf32("UTF-8", UTF32_CHARSET);
+  CIconvConverter toUtf8(UTF32_CHARSET, "UTF-8");
+  std::mt19937 random(42);
+
+  for (int i = 0; i < 1000; i++)
+  {
+    const std::string bytes = GetRandomBytes(random, i % 100 + 1);
+    for (bool failOnBadChar : { false, true })
+    {
+      std::u32string expected;
+      std::u32string utf32;
+      const bool expectedResult = toUtf32.Convert(bytes, expected, failOnBadChar);
+      ASSERT_EQ(expectedResult, CUtf8Utils::Utf8ToUtf32(bytes, utf32, failOnBadChar));
+      ASSERT_EQ(expected, utf32);
+
+      std::string expectedUtf8;
+      std::string utf8;
+      ASSERT_TRUE(toUtf8.Convert(utf32, expectedUtf8, true));
+      ASSERT_TRUE(CUtf8Utils::Utf32ToUtf8(utf32, utf8, true));
+      ASSERT_EQ(expectedUtf8, utf8);
+    }
+  }
+}
+
+TEST(TestUtf8Utils, DISABLED_BenchmarkLabels)
+{
+  const std::string label = "Season 3 \xE2\x80\xA2 Episode 12 \xE2\x80\x93 L\xC3\xA9gende";
+  CIconvConverter iconvConverter("UTF-8", UTF32_CHARSET);
+  std::u32string utf32;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < LABEL_CONVERSIONS; i++)
+    iconvConverter.Convert(label, utf32, false);
+  const double iconvMs = Milliseconds(std::chrono::steady_clock::now() - start);
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < LABEL_CONVERSIONS; i++)
+    CUtf8Utils::Utf8ToUtf32(label, utf32, false);
+  const double nativeMs = Milliseconds(std::chrono::steady_clock::now() - start);
+
+  printf("%d labels of %zu bytes to UTF-32: iconv %.2f ms, native %.2f ms\n",
+         LABEL_CONVERSIONS, label.size(), iconvMs, nativeMs);
+}
+
+TEST(TestUtf8Utils, DISABLED_BenchmarkSubtitles)
+{
+  const std::string subtitles = GetSubtitleText(SUBTITLE_SIZE);
+  CIconvConverter toUtf32("UTF-8", UTF32_CHARSET);
+  CIconvConverter toUtf8(UTF32_CHARSET, "UTF-8");
+  std::u32string utf32;
+  std::string utf8;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < SUBTITLE_CONVERSIONS; i++)
+    toUtf32.Convert(subtitles, utf32, false);
+  const double iconvMs = Milliseconds(std::chrono::steady_clock::now() - start);
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < SUBTITLE_CONVERSIONS; i++)
+    toUtf8.Convert(utf32, utf8, false);
+  const double iconvBackMs = Milliseconds(std::chrono::steady_clock::now() - start);
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < SUBTITLE_CONVERSIONS; i++)
+    CUtf8Utils::Utf8ToUtf32(subtitles, utf32, false);
+  const double nativeMs = Milliseconds(std::chrono::steady_clock::now() - start);
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < SUBTITLE_CONVERSIONS; i++)
+    CUtf8Utils::Utf32ToUtf8(utf32, utf8, false);
+  const double nativeBackMs = Milliseconds(std::chrono::steady_clock::now() - start);
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < SUBTITLE_CONVERSIONS; i++)
+    CUtf8Utils::isValidUtf8(subtitles);
+  const double validateMs = Milliseconds(std::chrono::steady_clock::now() - start);
+
+  printf("%zu KiB subtitles to UTF-32 and back: iconv %.2f / %.2f ms, native %.2f / %.2f ms, validation %.2f ms\n",
+         subtitles.size() / 1024, iconvMs / SUBTITLE_CONVERSIONS, iconvBackMs / SUBTITLE_CONVERSIONS,
+         nativeMs / SUBTITLE_CONVERSIONS, nativeBackMs / SUBTITLE_CONVERSIONS, validateMs / SUBTITLE_CONVERSIONS);
+  EXPECT_EQ(subtitles, utf8);
+}
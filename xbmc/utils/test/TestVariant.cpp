@@ -6,10 +6,61 @@
  *  See LICENSES/README.md for more information.
  */
 
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "utils/JSONVariantParser.h"
+#include "utils/JSONVariantWriter.h"
 #include "utils/Variant.h"
 
 #include "gtest/gtest.h"
 
+namespace
+{
+
+const int BENCHMARK_ITEMS = 2000;
+const int BENCHMARK_RUNS = 10;
+
+// similar to the result of VideoLibrary.GetMovies with a few properties
+CVariant GetMovies(int count)
+{
+  CVariant movies(CVariant::VariantTypeArray);
+  for (int i = 0; i < count; i++)
+  {
+    CVariant movie;
+    movie["movieid"] = i;
+    movie["label"] = "Movie number " + std::to_string(i);
+    movie["title"] = "Movie number " + std::to_string(i);
+    movie["year"] = 1950 + i % 70;
+    movie["rating"] = 5.0 + (i % 50) / 10.0;
+    movie["playcount"] = i % 3;
+    movie["runtime"] = 5400 + i;
+    movie["file"] = "smb://server/share/movies/Movie number " + std::to_string(i) + " (1080p).mkv";
+    movie["thumbnail"] = "image://video@smb%3a%2f%2fserver%2fshare%2fmovies%2fmovie.mkv/";
+    movie["genre"].push_back("Drama");
+    movie["genre"].push_back("Thriller");
+    movie["resume"]["position"] = 0.0;
+    movie["resume"]["total"] = 0.0;
+    movie["userrating"] = 0;
+    movies.push_back(std::move(movie));
+  }
+
+  CVariant result;
+  result["limits"]["start"] = 0;
+  result["limits"]["end"] = count;
+  result["limits"]["total"] = count;
+  result["movies"] = std::move(movies);
+  return result;
+}
+
+double Milliseconds(std::chrono::steady_clock::duration duration)
+{
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+}
+
 TEST(TestVariant, VariantTypeInteger)
 {
   CVariant a((int)0), b((int64_t)1);
@@ -333,3 +384,119 @@ TEST(TestVariant, isMember)
   EXPECT_TRUE(a.isMember("key1"));
   EXPECT_FALSE(a.isMember("key2"));
 }
+
+TEST(TestVariant, MembersSorted)
+{
+  CVariant a;
+  a["c"] = 3;
+  a["a"] = 1;
+  a["b"] = 2;
+  a["a"] = 4;
+
+  ASSERT_EQ(3u, a.size());
+  std::string keys;
+  for (auto it = a.begin_map(); it != a.end_map(); ++it)
+    keys += it->first;
+  EXPECT_EQ("abc", keys);
+  EXPECT_EQ(4, a["a"].asInteger());
+
+  a.erase("d");
+  a.erase("b");
+  EXPECT_EQ(2u, a.size());
+  EXPECT_FALSE(a.isMember("b"));
+  EXPECT_TRUE(a.isMember("c"));
+}
+
+TEST(TestVariant, AssignFromMember)
+{
+  CVariant a;
+  a["inner"]["value"] = "a string that is too long to be stored inline";
+  a = a["inner"];
+  EXPECT_STREQ("a string that is too long to be stored inline", a["value"].c_str());
+
+  CVariant b;
+  b["inner"]["value"] = 1;
+  b = std::move(b["inner"]);
+  EXPECT_EQ(1, b["value"].asInteger());
+}
+
+TEST(TestVariant, ConstNullStaysConst)
+{
+  CVariant a = std::move(CVariant::ConstNullVariant);
+  EXPECT_TRUE(a.isNull());
+  CVariant::ConstNullVariant = 1;
+  EXPECT_EQ(CVariant::VariantTypeConstNull, CVariant::ConstNullVariant.type());
+}
+
+TEST(TestVariant, JSONRoundTrip)
+{
+  const CVariant movies = GetMovies(50);
+  std::string json;
+  ASSERT_TRUE(CJSONVariantWriter::Write(movies, json, true));
+
+  CVariant parsed;
+  ASSERT_TRUE(CJSONVariantParser::Parse(json, parsed));
+  EXPECT_EQ(movies, parsed);
+}
+
+TEST(TestVariant, DISABLED_BenchmarkBuild)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < BENCHMARK_RUNS; i++)
+    GetMovies(BENCHMARK_ITEMS);
+  const double ms = Milliseconds(std::chrono::steady_clock::now() - start);
+
+  printf("build %d movies: %.2f ms\n", BENCHMARK_ITEMS, ms / BENCHMARK_RUNS);
+}
+
+TEST(TestVariant, DISABLED_BenchmarkSerialize)
+{
+  const CVariant movies = GetMovies(BENCHMARK_ITEMS);
+  std::string json;
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < BENCHMARK_RUNS; i++)
+    ASSERT_TRUE(CJSONVariantWriter::Write(movies, json, true));
+  const double ms = Milliseconds(std::chrono::steady_clock::now() - start);
+
+  printf("serialize %d movies (%zu KiB): %.2f ms\n", BENCHMARK_ITEMS, json.size() / 1024,
+         ms / BENCHMARK_RUNS);
+}
+
+TEST(TestVariant, DISABLED_BenchmarkParse)
+{
+  std::string json;
+  ASSERT_TRUE(CJSONVariantWriter::Write(GetMovies(BENCHMARK_ITEMS), json, true));
+  CVariant movies;
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < BENCHMARK_RUNS; i++)
+    ASSERT_TRUE(CJSONVariantParser::Parse(json, movies));
+  const double ms = Milliseconds(std::chrono::steady_clock::now() - start);
+
+  printf("parse %d movies (%zu KiB): %.2f ms\n", BENCHMARK_ITEMS, json.size() / 1024,
+         ms / BENCHMARK_RUNS);
+  EXPECT_EQ(GetMovies(BENCHMARK_ITEMS), movies);
+}
+
+TEST(TestVariant, DISABLED_BenchmarkLookup)
+{
+  const CVariant movies = GetMovies(BENCHMARK_ITEMS);
+  int64_t sum = 0;
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < BENCHMARK_RUNS; i++)
+  {
+    for (auto it = movies["movies"].begin_array(); it != movies["movies"].end_array(); ++it)
+    {
+      const CVariant& movie = *it;
+      sum += movie["movieid"].asInteger() + movie["year"].asInteger() + movie["playcount"].asInteger();
+      sum += movie["title"].size() + movie["file"].size() + movie["genre"].size();
+      sum += movie.isMember("tagline") ? 1 : 0;
+    }
+  }
+  const double ms = Milliseconds(std::chrono::steady_clock::now() - start);
+
+  printf("7 lookups in %d movies: %.2f ms\n", BENCHMARK_ITEMS, ms / BENCHMARK_RUNS);
+  EXPECT_NE(0, sum);
+}
@@ -6,9 +6,14 @@
  *  See LICENSES/README.md for more information.
  */
 
+#include <chrono>
+#include <inttypes.h>
 #include <stdlib.h>
+#include <thread>
+#include <vector>
 #include "utils/log.h"
 #include "utils/RegExp.h"
+#include "filesystem/Directory.h"
 #include "filesystem/File.h"
 #include "filesystem/SpecialProtocol.h"
 #include "utils/StringUtils.h"
@@ -139,3 +144,106 @@ TEST_F(Testlog, SetLogLevel)
   CLog::Close();
   EXPECT_TRUE(XFILE::CFile::Delete(logfile));
 }
+
+namespace
+{
+std::string ReadLogFile(const std::string &logfile)
+{
+  std::string logstring;
+  char buf[4096];
+  ssize_t bytesread;
+  XFILE::CFile file;
+
+  EXPECT_TRUE(file.Open(logfile));
+  while ((bytesread = file.Read(buf, sizeof(buf))) > 0)
+    logstring.append(buf, bytesread);
+  file.Close();
+  return logstring;
+}
+
+// keep the log on tmpfs for the benchmark, so the disk doesn't dominate the numbers
+std::string GetBenchmarkLogPath()
+{
+  if (XFILE::CDirectory::Exists("/dev/shm/"))
+    return "/dev/shm/";
+  return CSpecialProtocol::TranslatePath("special://temp/");
+}
+
+double LogFromThreads(unsigned int threads, unsigned int lines)
+{
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> loggers;
+  for (unsigned int i = 0; i < threads; i++)
+  {
+    loggers.emplace_back([i, lines]() {
+      for (unsigned int line = 0; line < lines; line++)
+        CLog::Log(LOGDEBUG, "benchmark thread %u line %u: some typical message text with a value of %d", i, line, line * 3);
+    });
+  }
+  for (auto &logger : loggers)
+    logger.join();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+}
+
+TEST_F(Testlog, AsyncLog)
+{
+  std::string appName = CCompileInfo::GetAppName();
+  StringUtils::ToLower(appName);
+  const std::string logfile = CSpecialProtocol::TranslatePath("special://temp/") + appName + ".log";
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/").c_str()));
+
+  CLog::SetAsyncLogging(true);
+  for (int i = 0; i < 100; i++)
+    CLog::Log(LOGDEBUG, "async log message %d", i);
+  CLog::Log(LOGDEBUG, "repeated async log message");
+  CLog::Log(LOGDEBUG, "repeated async log message");
+  CLog::Log(LOGDEBUG, "repeated async log message");
+  CLog::Log(LOGERROR, "multi line\nasync log message");
+  CLog::SetAsyncLogging(false);
+  CLog::Log(LOGINFO, "sync log message");
+  CLog::Close();
+
+  const std::string logstring = ReadLogFile(logfile);
+  size_t last = 0;
+  for (int i = 0; i < 100; i++)
+  {
+    const size_t pos = logstring.find(StringUtils::Format("DEBUG: async log message %d\n", i));
+    ASSERT_NE(std::string::npos, pos);
+    EXPECT_LT(last, pos);
+    last = pos;
+  }
+  EXPECT_NE(std::string::npos, logstring.find("DEBUG: repeated async log message\n"));
+  EXPECT_NE(std::string::npos, logstring.find("DEBUG: Previous line repeats 2 times."));
+  EXPECT_NE(std::string::npos, logstring.find("ERROR: multi line\n                                            async log message"));
+  EXPECT_LT(logstring.find("async log message\n"), logstring.find("INFO: sync log message"));
+
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+}
+
+TEST_F(Testlog, DISABLED_BenchmarkThreads)
+{
+  const unsigned int threads = 8;
+  const unsigned int lines = 20000;
+
+  std::string appName = CCompileInfo::GetAppName();
+  StringUtils::ToLower(appName);
+  const std::string path = GetBenchmarkLogPath();
+
+  for (bool async : { false, true })
+  {
+    EXPECT_TRUE(CLog::Init(path));
+    CLog::SetAsyncLogging(async);
+    const uint64_t dropped = CLog::GetDroppedLines();
+
+    const double seconds = LogFromThreads(threads, lines);
+    CLog::Close();
+
+    printf("%s: %u threads, %u lines: %.3f s, %.0f calls/s, %" PRIu64 " lines dropped\n",
+           async ? "async" : "sync", threads, threads * lines, seconds, threads * lines / seconds,
+           CLog::GetDroppedLines() - dropped);
+
+    EXPECT_TRUE(XFILE::CFile::Delete(path + appName + ".log"));
+  }
+  XFILE::CFile::Delete(path + appName + ".old.log");
+}
@@ -38,7 +38,6 @@
 #include "threads/SystemClock.h"
 #include "URL.h"
 #include "Util.h"
-#include "utils/Digest.h"
 #include "utils/FileExtensionProvider.h"
 #include "utils/log.h"
 #include "utils/RegExp.h"
@@ -55,7 +54,6 @@ using namespace ADDON;
 using namespace KODI::MESSAGING;
 
 using KODI::MESSAGING::HELPERS::DialogResponse;
-using KODI::UTILITY::CDigest;
 
 namespace VIDEO
 {
@@ -281,7 +279,15 @@ namespace VIDEO
       if (CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_bVideoLibraryUseFastHash && !URIUtils::IsPlugin(strDirectory))
         fastHash = GetFastHash(strDirectory, regexps);
 
-      if (m_database.GetPathHash(strDirectory, dbHash) && !fastHash.empty() && StringUtils::EqualsNoCase(fastHash, dbHash))
+      bool hasDbHash = m_database.GetPathHash(strDirectory, dbHash);
+      if (hasDbHash && !fastHash.empty() && IsLegacyPathHash(dbHash) &&
+          StringUtils::EqualsNoCase(dbHash, GetFastHash(strDirectory, regexps, true)))
+      { // fast hashed by an older version and unchanged
+        m_database.SetPathHash(strDirectory, fastHash);
+        dbHash = fastHash;
+      }
+
+      if (hasDbHash && !fastHash.empty() && StringUtils::EqualsNoCase(fastHash, dbHash))
       { // fast hashes match - no need to process anything
         hash = fastHash;
       }
@@ -296,6 +302,17 @@ namespace VIDEO
           GetPathHash(items, hash);
         else
           hash = fastHash;
+
+        if (hash != fastHash && !hash.empty() && IsLegacyPathHash(dbHash))
+        { // hashed by an older version, keep the path if it is unchanged
+          std::string legacyHash;
+          GetPathHash(items, legacyHash, true);
+          if (StringUtils::EqualsNoCase(dbHash, legacyHash))
+          {
+            m_database.SetPathHash(strDirectory, hash);
+            dbHash = hash;
+          }
+        }
       }
 
       if (StringUtils::EqualsNoCase(hash, dbHash))
@@ -331,7 +348,18 @@ namespace VIDEO
         items.SetPath(strDirectory);
         GetPathHash(items, hash);
         bSkip = true;
-        if (!m_database.GetPathHash(strDirectory, dbHash) || !StringUtils::EqualsNoCase(dbHash, hash))
+        bool hasDbHash = m_database.GetPathHash(strDirectory, dbHash);
+        if (hasDbHash && IsLegacyPathHash(dbHash))
+        { // hashed by an older version, keep the path if it is unchanged
+          std::string legacyHash;
+          GetPathHash(items, legacyHash, true);
+          if (StringUtils::EqualsNoCase(dbHash, legacyHash))
+          {
+            m_database.SetPathHash(strDirectory, hash);
+            dbHash = hash;
+          }
+        }
+        if (!hasDbHash || !StringUtils::EqualsNoCase(dbHash, hash))
           bSkip = false;
         else
           items.Clear();
@@ -858,7 +886,15 @@ namespace VIDEO
       else if (CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_bVideoLibraryUseFastHash)
         hash = GetRecursiveFastHash(item->GetPath(), regexps);
 
-      if (m_database.GetPathHash(item->GetPath(), dbHash) && (allowEmptyHash || !hash.empty()) && StringUtils::EqualsNoCase(dbHash, hash))
+      bool hasDbHash = m_database.GetPathHash(item->GetPath(), dbHash);
+      if (hasDbHash && !hash.empty() && !allowEmptyHash && IsLegacyPathHash(dbHash) &&
+          StringUtils::EqualsNoCase(dbHash, GetRecursiveFastHash(item->GetPath(), regexps, true)))
+      { // fast hashed by an older version and unchanged
+        m_database.SetPathHash(item->GetPath(), hash);
+        dbHash = hash;
+      }
+
+      if (hasDbHash && (allowEmptyHash || !hash.empty()) && StringUtils::EqualsNoCase(dbHash, hash))
       {
         // fast hashes match - no need to process anything
         bSkip = true;
@@ -882,6 +918,17 @@ namespace VIDEO
             // slow hashes match - no need to process anything
             bSkip = true;
           }
+          else if (IsLegacyPathHash(dbHash))
+          {
+            // hashed by an older version, keep the path if it is unchanged
+            std::string legacyHash;
+            GetPathHash(items, legacyHash, true);
+            if (StringUtils::EqualsNoCase(dbHash, legacyHash))
+            {
+              m_database.SetPathHash(item->GetPath(), hash);
+              bSkip = true;
+            }
+          }
         }
       }
 
@@ -1798,11 +1845,11 @@ namespace VIDEO
     }
   }
 
-  int CVideoInfoScanner::GetPathHash(const CFileItemList &items, std::string &hash)
+  int CVideoInfoScanner::GetPathHash(const CFileItemList &items, std::string &hash, bool legacy /* = false */)
   {
     // Create a hash based on the filenames, filesize and filedate.  Also count the number of files
     if (0 == items.Size()) return 0;
-    CDigest digest{CDigest::Type::MD5};
+    CPathHash digest(legacy);
     int count = 0;
     for (int i = 0; i < items.Size(); ++i)
     {
@@ -1844,9 +1891,9 @@ namespace VIDEO
   }
 
   std::string CVideoInfoScanner::GetFastHash(const std::string &directory,
-      const std::vector<std::string> &excludes) const
+      const std::vector<std::string> &excludes, bool legacy /* = false */) const
   {
-    CDigest digest{CDigest::Type::MD5};
+    CPathHash digest(legacy);
 
     if (excludes.size())
       digest.Update(StringUtils::Join(excludes, "|"));
@@ -1867,13 +1914,13 @@ namespace VIDEO
   }
 
   std::string CVideoInfoScanner::GetRecursiveFastHash(const std::string &directory,
-      const std::vector<std::string> &excludes) const
+      const std::vector<std::string> &excludes, bool legacy /* = false */) const
   {
     CFileItemList items;
     items.Add(CFileItemPtr(new CFileItem(directory, true)));
     CUtil::GetRecursiveDirsListing(directory, items, DIR_FLAG_NO_FILE_DIRS | DIR_FLAG_NO_FILE_INFO);
 
-    CDigest digest{CDigest::Type::MD5};
+    CPathHash digest(legacy);
 
     if (excludes.size())
       digest.Update(StringUtils::Join(excludes, "|"));
@@ -173,31 +173,39 @@ namespace VIDEO
      */
     void FetchActorThumbs(std::vector<SActorInfo>& actors, const std::string& strPath);
 
-    static int GetPathHash(const CFileItemList &items, std::string &hash);
+    /*! \brief Hash the files of a path to detect changes
+     \param items files of the path
+     \param hash [out] the hash
+     \param legacy true to compute the MD5 hash older versions stored, see IsLegacyPathHash()
+     \return number of video files
+     */
+    static int GetPathHash(const CFileItemList &items, std::string &hash, bool legacy = false);
 
     /*! \brief Retrieve a "fast" hash of the given directory (if available)
      Performs a stat() on the directory, and uses modified time to create a "fast"
      hash of the folder. If no modified time is available, the create time is used,
      and if neither are available, an empty hash is returned.
      In case exclude from scan expressions are present, the string array will be appended
-     to the md5 hash to ensure we're doing a re-scan whenever the user modifies those.
+     to the hash to ensure we're doing a re-scan whenever the user modifies those.
      \param directory folder to hash
      \param excludes string array of exclude expressions
-     \return the md5 hash of the folder"
+     \param legacy true to compute the MD5 hash older versions stored, see IsLegacyPathHash()
+     \return the hash of the folder
      */
-    std::string GetFastHash(const std::string &directory, const std::vector<std::string> &excludes) const;
+    std::string GetFastHash(const std::string &directory, const std::vector<std::string> &excludes, bool legacy = false) const;
 
     /*! \brief Retrieve a "fast" hash of the given directory recursively (if available)
      Performs a stat() on the directory, and uses modified time to create a "fast"
      hash of each folder. If no modified time is available, the create time is used,
      and if neither are available, an empty hash is returned.
      In case exclude from scan expressions are present, the string array will be appended
-     to the md5 hash to ensure we're doing a re-scan whenever the user modifies those.
+     to the hash to ensure we're doing a re-scan whenever the user modifies those.
      \param directory folder to hash (recursively)
      \param excludes string array of exclude expressions
-     \return the md5 hash of the folder
+     \param legacy true to compute the MD5 hash older versions stored, see IsLegacyPathHash()
+     \return the hash of the folder
      */
-    std::string GetRecursiveFastHash(const std::string &directory, const std::vector<std::string> &excludes) const;
+    std::string GetRecursiveFastHash(const std::string &directory, const std::vector<std::string> &excludes, bool legacy = false) const;
 
     /*! \brief Decide whether a folder listing could use the "fast" hash
      Fast hashing can be done whenever the folder contains no scannable subfolders, as the
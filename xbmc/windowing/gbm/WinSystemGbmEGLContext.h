@@ -39,7 +39,9 @@ public:
 protected:
   CWinSystemGbmEGLContext(EGLenum platform, std::string const& platformExtension) :
     m_eglContext(platform, platformExtension)
-  {}
+  {
+    m_eglContext.SetUseBufferAge(true);
+  }
 
   /**
    * Inheriting classes should override InitWindowSystem() without parameters
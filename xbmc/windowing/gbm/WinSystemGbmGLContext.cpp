@@ -95,7 +95,7 @@ void CWinSystemGbmGLContext::PresentRender(bool rendered, bool videoLayer)
   {
     if (rendered)
     {
-      if (!m_eglContext.TrySwapBuffers())
+      if (!m_eglContext.TrySwapBuffers(m_damagedRegions))
       {
         CEGLUtils::LogError("eglSwapBuffers failed");
         throw std::runtime_error("eglSwapBuffers failed");
@@ -108,6 +108,8 @@ void CWinSystemGbmGLContext::PresentRender(bool rendered, bool videoLayer)
     Sleep(10);
   }
 
+  m_damagedRegions.clear();
+
   if (m_delayDispReset && m_dispResetTimer.IsTimePast())
   {
     m_delayDispReset = false;
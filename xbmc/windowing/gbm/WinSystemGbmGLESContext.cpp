@@ -107,7 +107,7 @@ void CWinSystemGbmGLESContext::PresentRender(bool rendered, bool videoLayer)
   {
     if (rendered)
     {
-      if (!m_eglContext.TrySwapBuffers())
+      if (!m_eglContext.TrySwapBuffers(m_damagedRegions))
       {
         CEGLUtils::LogError("eglSwapBuffers failed");
         throw std::runtime_error("eglSwapBuffers failed");
@@ -120,6 +120,8 @@ void CWinSystemGbmGLESContext::PresentRender(bool rendered, bool videoLayer)
     Sleep(10);
   }
 
+  m_damagedRegions.clear();
+
   if (m_delayDispReset && m_dispResetTimer.IsTimePast())
   {
     m_delayDispReset = false;
@@ -33,6 +33,8 @@ public:
   bool InitWindowSystem() override;
   bool SetFullScreen(bool fullScreen, RESOLUTION_INFO& res, bool blankOtherDisplays) override;
   void PresentRender(bool rendered, bool videoLayer) override;
+  int GetBufferAge() override { return m_eglContext.GetBufferAge(); }
+  unsigned int GetSwapCount() override { return m_eglContext.GetSwapCount(); }
 protected:
   void SetVSyncImpl(bool enable) override { return; };
   void PresentRenderImpl(bool rendered) override {};
@@ -20,7 +20,9 @@ using namespace KODI::WINDOWING::WAYLAND;
 
 CWinSystemWaylandEGLContext::CWinSystemWaylandEGLContext()
 : m_eglContext{EGL_PLATFORM_WAYLAND_EXT, "EGL_EXT_platform_wayland"}
-{}
+{
+  m_eglContext.SetUseBufferAge(true);
+}
 
 bool CWinSystemWaylandEGLContext::InitWindowSystemEGL(EGLint renderableType, EGLint apiType)
 {
@@ -118,13 +120,13 @@ void CWinSystemWaylandEGLContext::SetContextSize(CSizeInt size)
   }
 }
 
-void CWinSystemWaylandEGLContext::PresentFrame(bool rendered)
+void CWinSystemWaylandEGLContext::PresentFrame(bool rendered, const CDirtyRegionList& damage)
 {
   PrepareFramePresentation();
 
   if (rendered)
   {
-    if (!m_eglContext.TrySwapBuffers())
+    if (!m_eglContext.TrySwapBuffers(damage))
     {
       // For now we just hard fail if this fails
       // Theoretically, EGL_CONTEXT_LOST could be handled, but it needs to be checked
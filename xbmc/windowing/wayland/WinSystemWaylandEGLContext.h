@@ -42,7 +42,7 @@ protected:
   bool InitWindowSystemEGL(EGLint renderableType, EGLint apiType);
 
   CSizeInt GetNativeWindowAttachedSize();
-  void PresentFrame(bool rendered);
+  void PresentFrame(bool rendered, const CDirtyRegionList& damage = {});
   void SetContextSize(CSizeInt size) override;
 
   virtual bool CreateContext() = 0;
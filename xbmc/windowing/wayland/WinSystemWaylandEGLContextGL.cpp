@@ -96,7 +96,8 @@ void CWinSystemWaylandEGLContextGL::SetVSyncImpl(bool enable)
 
 void CWinSystemWaylandEGLContextGL::PresentRenderImpl(bool rendered)
 {
-  PresentFrame(rendered);
+  PresentFrame(rendered, m_damagedRegions);
+  m_damagedRegions.clear();
 }
 
 void CWinSystemWaylandEGLContextGL::delete_CVaapiProxy::operator()(CVaapiProxy *p) const
@@ -26,6 +26,8 @@ public:
   // Implementation of CWinSystemBase via CWinSystemWaylandEGLContext
   CRenderSystemBase *GetRenderSystem() override { return this; }
   bool InitWindowSystem() override;
+  int GetBufferAge() override { return m_eglContext.GetBufferAge(); }
+  unsigned int GetSwapCount() override { return m_eglContext.GetSwapCount(); }
 
 protected:
   bool CreateContext() override;
@@ -80,7 +80,8 @@ void CWinSystemWaylandEGLContextGLES::SetVSyncImpl(bool enable)
 
 void CWinSystemWaylandEGLContextGLES::PresentRenderImpl(bool rendered)
 {
-  PresentFrame(rendered);
+  PresentFrame(rendered, m_damagedRegions);
+  m_damagedRegions.clear();
 }
 
 void CWinSystemWaylandEGLContextGLES::delete_CVaapiProxy::operator()(CVaapiProxy *p) const
@@ -12,6 +12,7 @@
 #include "addons/Skin.h"
 #include "utils/CPUInfo.h"
 #include "utils/log.h"
+#include "utils/MemoryBudget.h"
 #include "CompileInfo.h"
 #include "filesystem/SpecialProtocol.h"
 #include "input/WindowTranslator.h"
@@ -116,6 +117,9 @@ void CGUIWindowDebugInfo::Process(unsigned int currentTime, CDirtyRegionList &di
                                 stat.ullAvailPhys/1024, stat.ullTotalPhys/1024, CServiceBroker::GetGUI()->GetInfoManager().GetInfoProviders().GetSystemInfoProvider().GetFPS(),
                                 strCores.c_str(), ucAppName.c_str(), dCPU, profiling.c_str());
 #endif
+    std::shared_ptr<const MemoryBudgetUsage> usage = CMemoryBudget::GetInstance().GetUsage();
+    info += StringUtils::Format("\nCACHE: %" PRIu64"/%" PRIu64" MB - trimmed %" PRIu64" MB",
+                                usage->cacheUsed >> 20, usage->cacheLimit >> 20, usage->trimmed >> 20);
   }
 
   // render the skin debug info